@@ -0,0 +1,107 @@
+/*
+ * File: adapt.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the resolver pool controller: grow by
+ *      half on a backlog, step back and trim once growth stops
+ *      paying off, and shrink by a quarter while the queue is
+ *      starved.
+ *
+ */
+
+#include "adapt.h"
+
+static int clamp(int threads, int min, int max){
+    if(threads < min){
+	return min;
+    }
+    if(threads > max){
+	return max;
+    }
+    return threads;
+}
+
+static int quarter(int threads){
+    return threads / 4 > 0 ? threads / 4 : 1;
+}
+
+static void set_ceiling(adapt* a, int ceiling){
+    a->ceiling = ceiling;
+    a->ceiling_age = 0;
+}
+
+void adapt_init(adapt* a, int min, int max, int threads){
+    a->min = min;
+    a->max = max;
+    a->threads = clamp(threads, min, max);
+    a->last_threads = a->threads;
+    a->last_change = 0;
+    a->trimming = 0;
+    a->ceiling = max;
+    a->ceiling_age = 0;
+    a->last_rate = 0.0;
+    a->last_latency_us = 0.0;
+}
+
+int adapt_step(adapt* a, const adapt_sample* s, const char** reason){
+    int no_gain = s->rate < a->last_rate * ADAPT_MIN_GAIN;
+    int no_loss = s->rate * ADAPT_MIN_GAIN >= a->last_rate;
+    int backlog = s->occupancy >= ADAPT_HIGH_WATER;
+    int trimming = 0;
+    int next = a->threads;
+
+    if(a->ceiling < a->max && ++a->ceiling_age >= ADAPT_PROBE_STEPS){
+	set_ceiling(a, a->max);
+    }
+
+    if(a->last_change > 0 && no_gain
+       && s->latency_us > a->last_latency_us * ADAPT_SLOWDOWN){
+	/* more threads only made each lookup wait longer */
+	next = a->last_threads;
+	set_ceiling(a, next);
+	trimming = 1;
+	*reason = "saturated";
+    }
+    else if(a->trimming && backlog && no_loss){
+	/* the last step back cost nothing: try fewer still */
+	next = a->threads - quarter(a->threads);
+	set_ceiling(a, clamp(next, a->min, a->max));
+	trimming = 1;
+	*reason = "trim";
+    }
+    else if(a->trimming && backlog){
+	/* that trim cost throughput: go back and stay */
+	next = a->last_threads;
+	set_ceiling(a, next);
+	*reason = "untrim";
+    }
+    else if(backlog && a->last_change > 0 && no_gain){
+	/* let one interval pass before probing again */
+	*reason = "no-gain";
+    }
+    else if(backlog && a->threads < a->ceiling){
+	next = a->threads + (a->threads / 2 > 0 ? a->threads / 2 : 1);
+	next = next < a->ceiling ? next : a->ceiling;
+	*reason = "backlog";
+    }
+    else if(s->occupancy < ADAPT_LOW_WATER && !s->input_done){
+	next = a->threads - quarter(a->threads);
+	*reason = "starved";
+    }
+    else{
+	*reason = "steady";
+    }
+
+    next = clamp(next, a->min, a->max);
+    a->last_change = next > a->threads ? 1 : next < a->threads ? -1 : 0;
+    a->trimming = trimming && a->last_change < 0;
+    if(a->last_change){
+	a->last_threads = a->threads;
+    }
+    a->threads = next;
+    a->last_rate = s->rate;
+    a->last_latency_us = s->latency_us;
+    return next;
+}
@@ -0,0 +1,69 @@
+/*
+ * File: adapt.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for the resolver pool controller.
+ *      Once per interval the caller samples how full the hostname
+ *      queue is, how many lookups finished per second and how
+ *      long each took; adapt_step() turns that into a new thread
+ *      count between min and max.
+ *
+ *      A queue that stays full means resolvers are behind, so the
+ *      pool grows by half. A growth step that brought no more
+ *      lookups per second and slower lookups is taken back (the
+ *      resolver or network is saturated, more threads only wait
+ *      longer), then the pool is trimmed by quarters for as long
+ *      as that costs no throughput. The size it settles on caps
+ *      growth until ADAPT_PROBE_STEPS intervals later, when the
+ *      controller probes upward again. A queue that stays nearly
+ *      empty while input is still being read means producers are
+ *      the limit, so the pool shrinks by a quarter.
+ *
+ */
+
+#ifndef ADAPT_H
+#define ADAPT_H
+
+#define ADAPT_DEFAULT_INTERVAL_MS 200
+/* queue occupancy that counts as a backlog / as starved */
+#define ADAPT_HIGH_WATER 0.5
+#define ADAPT_LOW_WATER 0.1
+/* a step must raise lookups/sec by this factor to count */
+#define ADAPT_MIN_GAIN 1.05
+/* lookups this much slower after a fruitless step undo it */
+#define ADAPT_SLOWDOWN 1.25
+/* intervals a saturation ceiling holds before probing again */
+#define ADAPT_PROBE_STEPS 50
+
+typedef struct adapt_sample_s{
+    double occupancy;           /* queued / capacity, 0..1 */
+    double rate;                /* lookups finished per second */
+    double latency_us;          /* mean time per lookup */
+    int input_done;             /* every producer has finished */
+} adapt_sample;
+
+typedef struct adapt_s{
+    int min;
+    int max;
+    int threads;
+    int last_threads;           /* count before the last change */
+    int last_change;            /* +1 grew, -1 shrank, 0 held */
+    int trimming;               /* last change was a saturation step back */
+    int ceiling;                /* growth limit found by saturation */
+    int ceiling_age;            /* intervals since the ceiling was set */
+    double last_rate;
+    double last_latency_us;
+} adapt;
+
+/* Function to start a controller at threads, clamped to [min, max] */
+void adapt_init(adapt* a, int min, int max, int threads);
+
+/* Function to take one interval's sample
+ * Returns the new thread count and sets *reason to a word
+ * naming the rule that chose it
+ */
+int adapt_step(adapt* a, const adapt_sample* s, const char** reason);
+
+#endif
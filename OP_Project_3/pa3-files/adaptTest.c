@@ -0,0 +1,112 @@
+/*
+ * File: adaptTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the resolver pool
+ *      controller. A simulated resolver whose throughput tops
+ *      out at a fixed thread count must draw the pool up from
+ *      the minimum and settle near that count without passing
+ *      max; a starved queue must shrink the pool to min, but
+ *      not once the input is finished.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "adapt.h"
+
+#define TEST_STEPS 100
+
+/* A resolver that scales linearly up to knee threads; past it
+ * throughput stays flat and every lookup waits longer */
+static void simulate(const adapt* a, int knee, adapt_sample* s){
+    int useful = a->threads < knee ? a->threads : knee;
+
+    s->rate = useful * 1000.0;
+    s->latency_us = 1000.0 * a->threads / useful;
+    s->occupancy = a->threads < knee ? 1.0 : 0.6;
+    s->input_done = 0;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    adapt a;
+    adapt_sample s;
+    const char* reason;
+    int step;
+    int peak;
+    int grew = 0;
+
+    /* Test the start count is clamped */
+    adapt_init(&a, 2, 8, 100);
+    if(a.threads != 8){
+	fprintf(stderr, "error: start 100 clamped to %d, not 8\n", a.threads);
+    }
+    adapt_init(&a, 2, 8, 0);
+    if(a.threads != 2){
+	fprintf(stderr, "error: start 0 clamped to %d, not 2\n", a.threads);
+    }
+
+    /* Test growing to a saturation knee of 20 threads */
+    adapt_init(&a, 1, 256, 1);
+    peak = 0;
+    for(step = 0; step < TEST_STEPS; step++){
+	simulate(&a, 20, &s);
+	adapt_step(&a, &s, &reason);
+	if(a.threads > peak){
+	    peak = a.threads;
+	}
+	if(a.threads < 1 || a.threads > 256){
+	    fprintf(stderr, "error: %d threads is out of bounds\n", a.threads);
+	    break;
+	}
+    }
+    if(a.threads < 20 || a.threads > 30 || peak > 64){
+	fprintf(stderr, "error: knee 20 settled at %d threads, peak %d\n", a.threads, peak);
+    }
+
+    /* Test that max caps a growing pool */
+    adapt_init(&a, 1, 6, 1);
+    for(step = 0; step < TEST_STEPS; step++){
+	simulate(&a, 1000, &s);
+	adapt_step(&a, &s, &reason);
+	if(a.threads > 6){
+	    fprintf(stderr, "error: grew past max to %d\n", a.threads);
+	    break;
+	}
+	grew |= a.threads == 6;
+    }
+    if(!grew){
+	fprintf(stderr, "error: never reached max 6 (at %d)\n", a.threads);
+    }
+
+    /* Test a starved queue shrinks to min */
+    adapt_init(&a, 3, 64, 64);
+    memset(&s, 0, sizeof(s));
+    s.rate = 500.0;
+    s.latency_us = 100.0;
+    for(step = 0; step < TEST_STEPS; step++){
+	adapt_step(&a, &s, &reason);
+    }
+    if(a.threads != 3){
+	fprintf(stderr, "error: starved pool at %d threads, not min 3\n", a.threads);
+    }
+
+    /* Test an empty queue after the input is done leaves the pool */
+    adapt_init(&a, 1, 64, 32);
+    s.input_done = 1;
+    adapt_step(&a, &s, &reason);
+    if(a.threads != 32 || strcmp(reason, "steady") != 0){
+	fprintf(stderr, "error: drained input moved pool to %d (%s)\n", a.threads, reason);
+    }
+
+    return 0;
+}
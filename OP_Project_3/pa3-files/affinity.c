@@ -0,0 +1,266 @@
+/*
+ * File: affinity.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains thread placement. The sets are plain
+ *      bitmaps so callers need no _GNU_SOURCE; they become
+ *      cpu_set_t only here, for the scheduler calls.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sched.h>
+
+#include "affinity.h"
+
+#define AFFINITY_LINE_SIZE 4096
+
+static int set_has(const affinity_set* set, int cpu){
+    return (set->bits[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+static void set_add(affinity_set* set, int cpu){
+    set->bits[cpu / 64] |= (uint64_t) 1 << (cpu % 64);
+}
+
+int affinity_parse(const char* list, affinity_set* set){
+    const char* p = list;
+    char* end;
+    long first, last, cpu;
+
+    memset(set, 0, sizeof(*set));
+    while(*p){
+	if(!isdigit((unsigned char) *p)){
+	    return AFFINITY_FAILURE;
+	}
+	first = last = strtol(p, &end, 10);
+	p = end;
+	if(*p == '-'){
+	    if(!isdigit((unsigned char) p[1])){
+		return AFFINITY_FAILURE;
+	    }
+	    last = strtol(p + 1, &end, 10);
+	    p = end;
+	}
+	if(first > last || last >= AFFINITY_MAX_CPUS){
+	    return AFFINITY_FAILURE;
+	}
+	for(cpu = first; cpu <= last; cpu++){
+	    set_add(set, cpu);
+	}
+	/* sysfs lists end in a newline */
+	if(*p == ',' && p[1]){
+	    p++;
+	}
+	else if(*p == '\n' && !p[1]){
+	    p++;
+	}
+	else if(*p){
+	    return AFFINITY_FAILURE;
+	}
+    }
+    return affinity_count(set) > 0 ? AFFINITY_SUCCESS : AFFINITY_FAILURE;
+}
+
+void affinity_format(const affinity_set* set, char* buf, size_t size){
+    size_t used = 0;
+    int cpu, last;
+    int n;
+
+    if(size > 0){
+	buf[0] = '\0';
+    }
+    for(cpu = 0; cpu < AFFINITY_MAX_CPUS; cpu++){
+	if(!set_has(set, cpu)){
+	    continue;
+	}
+	for(last = cpu; last + 1 < AFFINITY_MAX_CPUS && set_has(set, last + 1); last++);
+	n = last > cpu ? snprintf(buf + used, size - used, "%s%d-%d", used ? "," : "", cpu, last)
+	               : snprintf(buf + used, size - used, "%s%d", used ? "," : "", cpu);
+	if(n < 0 || (size_t) n >= size - used){
+	    return;
+	}
+	used += n;
+	cpu = last;
+    }
+}
+
+int affinity_count(const affinity_set* set){
+    int n = 0;
+    int i;
+
+    for(i = 0; i < AFFINITY_MAX_CPUS / 64; i++){
+	n += __builtin_popcountll(set->bits[i]);
+    }
+    return n;
+}
+
+int affinity_nth(const affinity_set* set, int n){
+    int count = affinity_count(set);
+    int cpu;
+
+    if(count == 0){
+	return -1;
+    }
+    n %= count;
+    for(cpu = 0; cpu < AFFINITY_MAX_CPUS; cpu++){
+	if(set_has(set, cpu) && n-- == 0){
+	    return cpu;
+	}
+    }
+    return -1;
+}
+
+int affinity_subset(const affinity_set* set, const affinity_set* within){
+    int i;
+
+    for(i = 0; i < AFFINITY_MAX_CPUS / 64; i++){
+	if(set->bits[i] & ~within->bits[i]){
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+void affinity_only(affinity_set* set, int cpu){
+    memset(set, 0, sizeof(*set));
+    if(cpu >= 0 && cpu < AFFINITY_MAX_CPUS){
+	set_add(set, cpu);
+    }
+}
+
+static int by_int(const void* a, const void* b){
+    return *(const int*) a - *(const int*) b;
+}
+
+int affinity_load_from(affinity_topology* t, const char* dir, const affinity_set* allowed){
+    char path[AFFINITY_LINE_SIZE];
+    char line[AFFINITY_LINE_SIZE];
+    int ids[AFFINITY_MAX_NODES];
+    affinity_set cpus;
+    struct dirent* entry;
+    DIR* nodes;
+    FILE* f;
+    char* end;
+    int nids = 0;
+    int i, j;
+
+    memset(t, 0, sizeof(*t));
+    t->all = *allowed;
+    nodes = opendir(dir);
+    while(nodes && (entry = readdir(nodes)) && nids < AFFINITY_MAX_NODES){
+	if(strncmp(entry->d_name, "node", 4) == 0 && isdigit((unsigned char) entry->d_name[4])){
+	    ids[nids] = strtol(entry->d_name + 4, &end, 10);
+	    nids += *end == '\0';
+	}
+    }
+    if(nodes){
+	closedir(nodes);
+    }
+    qsort(ids, nids, sizeof(*ids), by_int);
+
+    for(i = 0; i < nids; i++){
+	snprintf(path, sizeof(path), "%s/node%d/cpulist", dir, ids[i]);
+	f = fopen(path, "r");
+	if(!f){
+	    continue;
+	}
+	/* a node with memory but no CPUs has an empty list */
+	if(fgets(line, sizeof(line), f) && affinity_parse(line, &cpus) == AFFINITY_SUCCESS){
+	    for(j = 0; j < AFFINITY_MAX_CPUS / 64; j++){
+		cpus.bits[j] &= allowed->bits[j];
+	    }
+	    if(affinity_count(&cpus) > 0){
+		t->node_ids[t->nnodes] = ids[i];
+		t->nodes[t->nnodes++] = cpus;
+	    }
+	}
+	fclose(f);
+    }
+
+    if(t->nnodes == 0){
+	t->node_ids[0] = 0;
+	t->nodes[0] = *allowed;
+	t->nnodes = 1;
+    }
+    return affinity_count(allowed) > 0 ? AFFINITY_SUCCESS : AFFINITY_FAILURE;
+}
+
+int affinity_load(affinity_topology* t){
+    affinity_set allowed;
+    cpu_set_t mask;
+    int cpu;
+
+    if(sched_getaffinity(0, sizeof(mask), &mask) < 0){
+	perror("Error reading the CPU affinity");
+	return AFFINITY_FAILURE;
+    }
+    memset(&allowed, 0, sizeof(allowed));
+    for(cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++){
+	if(CPU_ISSET(cpu, &mask)){
+	    set_add(&allowed, cpu);
+	}
+    }
+    return affinity_load_from(t, "/sys/devices/system/node", &allowed);
+}
+
+int affinity_node_of(const affinity_topology* t, int cpu){
+    int i;
+
+    if(cpu < 0 || cpu >= AFFINITY_MAX_CPUS){
+	return -1;
+    }
+    for(i = 0; i < t->nnodes; i++){
+	if(set_has(&t->nodes[i], cpu)){
+	    return i;
+	}
+    }
+    return -1;
+}
+
+int affinity_pin(pthread_t thread, const affinity_set* set){
+    cpu_set_t mask;
+    int cpu;
+
+    CPU_ZERO(&mask);
+    for(cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++){
+	if(set_has(set, cpu)){
+	    CPU_SET(cpu, &mask);
+	}
+    }
+    return pthread_setaffinity_np(thread, sizeof(mask), &mask) == 0
+	? AFFINITY_SUCCESS : AFFINITY_FAILURE;
+}
+
+void affinity_track_init(affinity_track* a){
+    memset(a, 0, sizeof(*a));
+    a->last_cpu = -1;
+    a->last_node = -1;
+}
+
+void affinity_note(affinity_track* a, const affinity_topology* t){
+    int cpu = sched_getcpu();
+    int node;
+
+    if(cpu < 0){
+	return;
+    }
+    node = affinity_node_of(t, cpu);
+    if(a->last_cpu >= 0 && cpu != a->last_cpu){
+	a->migrations++;
+	if(node != a->last_node){
+	    a->node_migrations++;
+	}
+    }
+    a->last_cpu = cpu;
+    a->last_node = node;
+    a->samples++;
+}
@@ -0,0 +1,105 @@
+/*
+ * File: affinity.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for thread placement: CPU lists like
+ *      "0-3,8", the NUMA nodes the process may run on (from
+ *      /sys/devices/system/node, or one node of every allowed CPU
+ *      where there is no such directory), pinning a thread to a
+ *      set of CPUs, and counting how often a thread was found on
+ *      another CPU or node than last time.
+ *
+ *      Memory is placed by first touch: a page lands on the node
+ *      of the thread that first writes it, so buffers a pinned
+ *      thread allocates and fills itself are node local without
+ *      any NUMA library.
+ *
+ */
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define AFFINITY_FAILURE -1
+#define AFFINITY_SUCCESS 0
+
+#define AFFINITY_MAX_CPUS 1024
+#define AFFINITY_MAX_NODES 64
+
+typedef struct affinity_set_s{
+    uint64_t bits[AFFINITY_MAX_CPUS / 64];
+} affinity_set;
+
+typedef struct affinity_topology_s{
+    int nnodes;
+    int node_ids[AFFINITY_MAX_NODES];   /* the kernel's node numbers */
+    affinity_set nodes[AFFINITY_MAX_NODES]; /* allowed CPUs of each */
+    affinity_set all;                   /* every allowed CPU */
+} affinity_topology;
+
+/* Where one thread was last seen; owned by that thread */
+typedef struct affinity_track_s{
+    int last_cpu;                       /* -1 before the first note */
+    int last_node;
+    long samples;
+    long migrations;                    /* seen on another CPU */
+    long node_migrations;               /* ... on another node */
+} affinity_track;
+
+/* Function to parse a CPU list such as "0-3,8" into set
+ * Returns AFFINITY_SUCCESS, or AFFINITY_FAILURE if malformed,
+ * empty or past AFFINITY_MAX_CPUS
+ */
+int affinity_parse(const char* list, affinity_set* set);
+
+/* Function to write set as a CPU list into buf (size bytes) */
+void affinity_format(const affinity_set* set, char* buf, size_t size);
+
+/* Function to return the number of CPUs in set */
+int affinity_count(const affinity_set* set);
+
+/* Function to return the CPU number of the n-th CPU of set,
+ * counting round and round, or -1 if set is empty */
+int affinity_nth(const affinity_set* set, int n);
+
+/* Function to return nonzero if every CPU of set is in within */
+int affinity_subset(const affinity_set* set, const affinity_set* within);
+
+/* Function to make set hold just cpu */
+void affinity_only(affinity_set* set, int cpu);
+
+/* Function to find the NUMA nodes and the CPUs of each this
+ * process is allowed to run on; nodes with none are left out
+ * Returns AFFINITY_SUCCESS or AFFINITY_FAILURE
+ */
+int affinity_load(affinity_topology* t);
+
+/* Function to do the same from the node directories under dir
+ * (laid out like /sys/devices/system/node), keeping only the
+ * CPUs of allowed. Where dir has no nodes, every allowed CPU
+ * makes up one node.
+ * Returns AFFINITY_SUCCESS or AFFINITY_FAILURE
+ */
+int affinity_load_from(affinity_topology* t, const char* dir, const affinity_set* allowed);
+
+/* Function to return the index in t of cpu's node, or -1 */
+int affinity_node_of(const affinity_topology* t, int cpu);
+
+/* Function to let thread run only on the CPUs of set
+ * Returns AFFINITY_SUCCESS or AFFINITY_FAILURE
+ */
+int affinity_pin(pthread_t thread, const affinity_set* set);
+
+/* Function to start tracking the calling thread */
+void affinity_track_init(affinity_track* a);
+
+/* Function to note which CPU the calling thread is on now,
+ * counting a migration if it moved since the last note */
+void affinity_note(affinity_track* a, const affinity_topology* t);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * File: affinityTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for thread placement. CPU lists
+ *      must parse and print back the same, and bad ones must be
+ *      refused; nodes read from a made up sysfs tree must keep
+ *      only allowed CPUs and drop empty nodes, and a tree with no
+ *      nodes must give one node of everything; and a thread pinned
+ *      to a CPU must be found on it.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "affinity.h"
+
+#define TEST_DIR "affinityTest.tmp"
+
+static void write_node(int node, const char* cpulist){
+    char path[256];
+    FILE* f;
+
+    snprintf(path, sizeof(path), TEST_DIR "/node%d", node);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), TEST_DIR "/node%d/cpulist", node);
+    f = fopen(path, "w");
+    if(f){
+	fputs(cpulist, f);
+	fclose(f);
+    }
+}
+
+static void remove_node(int node){
+    char path[256];
+
+    snprintf(path, sizeof(path), TEST_DIR "/node%d/cpulist", node);
+    unlink(path);
+    snprintf(path, sizeof(path), TEST_DIR "/node%d", node);
+    rmdir(path);
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static const char* const bad[] = {"", "a", "3-1", "1,", "1-", "-1", "0-1024", "1,,2"};
+    affinity_topology t;
+    affinity_track track;
+    affinity_set set, allowed;
+    char text[256];
+    unsigned int i;
+
+    /* Test lists parse and print back */
+    if(affinity_parse("0-3,8,10-11", &set) == AFFINITY_FAILURE || affinity_count(&set) != 7
+       || affinity_nth(&set, 4) != 8 || affinity_nth(&set, 7) != 0){
+	fprintf(stderr, "error: list parsed wrong\n");
+    }
+    affinity_format(&set, text, sizeof(text));
+    if(strcmp(text, "0-3,8,10-11") != 0){
+	fprintf(stderr, "error: list printed as %s\n", text);
+    }
+    for(i = 0; i < sizeof(bad) / sizeof(bad[0]); i++){
+	if(affinity_parse(bad[i], &set) != AFFINITY_FAILURE){
+	    fprintf(stderr, "error: bad list \"%s\" accepted\n", bad[i]);
+	}
+    }
+
+    /* Test nodes keep allowed CPUs only, in node order */
+    mkdir(TEST_DIR, 0755);
+    write_node(1, "4-7\n");
+    write_node(0, "0-3\n");
+    write_node(2, "\n");
+    write_node(3, "8-9\n");
+    affinity_parse("1-2,4,9", &allowed);
+    if(affinity_load_from(&t, TEST_DIR, &allowed) == AFFINITY_FAILURE || t.nnodes != 3
+       || t.node_ids[0] != 0 || t.node_ids[1] != 1 || t.node_ids[2] != 3
+       || affinity_count(&t.nodes[0]) != 2 || affinity_nth(&t.nodes[1], 0) != 4
+       || affinity_node_of(&t, 9) != 2 || affinity_node_of(&t, 0) != -1){
+	fprintf(stderr, "error: read %d nodes\n", t.nnodes);
+    }
+    affinity_parse("2-4", &set);
+    if(affinity_subset(&set, &allowed) || !affinity_subset(&t.nodes[1], &allowed)){
+	fprintf(stderr, "error: subset check wrong\n");
+    }
+    for(i = 0; i < 4; i++){
+	remove_node(i);
+    }
+
+    /* Test no nodes is one node of everything */
+    if(affinity_load_from(&t, TEST_DIR, &allowed) == AFFINITY_FAILURE || t.nnodes != 1
+       || affinity_count(&t.nodes[0]) != 4){
+	fprintf(stderr, "error: no node tree gave %d nodes\n", t.nnodes);
+    }
+    rmdir(TEST_DIR);
+
+    /* Test pinning to one allowed CPU */
+    if(affinity_load(&t) == AFFINITY_FAILURE || t.nnodes < 1){
+	fprintf(stderr, "error: could not read this machine's nodes\n");
+	return 0;
+    }
+    affinity_only(&set, affinity_nth(&t.all, affinity_count(&t.all) - 1));
+    affinity_track_init(&track);
+    if(affinity_pin(pthread_self(), &set) == AFFINITY_FAILURE){
+	fprintf(stderr, "error: could not pin to an allowed CPU\n");
+    }
+    affinity_note(&track, &t);
+    affinity_note(&track, &t);
+    if(track.last_cpu != affinity_nth(&set, 0) || track.migrations != 0 || track.samples != 2){
+	fprintf(stderr, "error: pinned thread seen on CPU %d\n", track.last_cpu);
+    }
+    affinity_pin(pthread_self(), &t.all);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * File: arena.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the slab arena. Free slabs form a
+ *      Treiber stack threaded through each region's link array;
+ *      the head carries a counter bumped on every pop, so a slab
+ *      popped and pushed back between another thread's load and
+ *      compare-and-swap cannot be mistaken for an unchanged head.
+ *      Links live outside the slabs, so a stale read of one never
+ *      touches memory a new owner is writing.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define HEAD_HANDLE(h) ((uint32_t) (h))
+#define HEAD_TAG(h) ((uint64_t) (h) >> 32)
+#define HEAD(tag, handle) (((uint64_t) (tag) << 32) | (uint32_t) (handle))
+
+static atomic_uint* arena_link(arena* a, uint32_t handle){
+    arena_region* r = atomic_load_explicit(&a->regions[handle / ARENA_REGION_SLABS],
+					   memory_order_acquire);
+    return &r->next[handle % ARENA_REGION_SLABS];
+}
+
+/* Make sure the region holding handle exists */
+static int arena_grow(arena* a, uint32_t handle){
+    uint32_t index = handle / ARENA_REGION_SLABS;
+    arena_region* r;
+    int ret = ARENA_SUCCESS;
+
+    if(index >= ARENA_MAX_REGIONS){
+	return ARENA_FAILURE;
+    }
+    if(atomic_load_explicit(&a->regions[index], memory_order_acquire)){
+	return ARENA_SUCCESS;
+    }
+    pthread_mutex_lock(&a->grow_lock);
+    if(!atomic_load_explicit(&a->regions[index], memory_order_relaxed)){
+	r = aligned_alloc(ARENA_ALIGN, sizeof(*r) + ARENA_REGION_SLABS * a->slab_size);
+	if(r){
+	    memset(r->next, 0, sizeof(r->next));
+	    atomic_store_explicit(&a->regions[index], r, memory_order_release);
+	    atomic_fetch_add(&a->nregions, 1);
+	}
+	else{
+	    ret = ARENA_FAILURE;
+	}
+    }
+    pthread_mutex_unlock(&a->grow_lock);
+    return ret;
+}
+
+int arena_init(arena* a, size_t slab_size){
+    int i;
+
+    if(slab_size == 0){
+	return ARENA_FAILURE;
+    }
+    memset(a, 0, sizeof(*a));
+    a->slab_size = (slab_size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    for(i = 0; i < ARENA_MAX_REGIONS; i++){
+	atomic_init(&a->regions[i], NULL);
+    }
+    atomic_init(&a->free_head, HEAD(0, ARENA_NONE));
+    /* handle 0 is ARENA_NONE; the slab behind it is never used */
+    atomic_init(&a->fresh, 1);
+    if(pthread_mutex_init(&a->grow_lock, NULL)){
+	return ARENA_FAILURE;
+    }
+    return ARENA_SUCCESS;
+}
+
+uint32_t arena_get(arena* a){
+    uint64_t head = atomic_load_explicit(&a->free_head, memory_order_acquire);
+    uint32_t handle;
+    uint32_t next;
+
+    while(HEAD_HANDLE(head) != ARENA_NONE){
+	handle = HEAD_HANDLE(head);
+	next = atomic_load_explicit(arena_link(a, handle), memory_order_relaxed);
+	if(atomic_compare_exchange_weak_explicit(&a->free_head, &head,
+						 HEAD(HEAD_TAG(head) + 1, next),
+						 memory_order_acquire,
+						 memory_order_acquire)){
+	    atomic_fetch_add_explicit(&a->gets, 1, memory_order_relaxed);
+	    atomic_fetch_add_explicit(&a->reused, 1, memory_order_relaxed);
+	    return handle;
+	}
+    }
+
+    /* nothing to recycle: carve a new slab */
+    handle = atomic_fetch_add(&a->fresh, 1);
+    if(handle == ARENA_NONE || arena_grow(a, handle) == ARENA_FAILURE){
+	return ARENA_NONE;
+    }
+    atomic_fetch_add_explicit(&a->gets, 1, memory_order_relaxed);
+    return handle;
+}
+
+void arena_put(arena* a, uint32_t handle){
+    uint64_t head = atomic_load_explicit(&a->free_head, memory_order_relaxed);
+    atomic_uint* link = arena_link(a, handle);
+
+    do{
+	atomic_store_explicit(link, HEAD_HANDLE(head), memory_order_relaxed);
+    }while(!atomic_compare_exchange_weak_explicit(&a->free_head, &head,
+						  HEAD(HEAD_TAG(head), handle),
+						  memory_order_release,
+						  memory_order_relaxed));
+}
+
+void arena_cleanup(arena* a){
+    int i;
+
+    for(i = 0; i < ARENA_MAX_REGIONS; i++){
+	free(atomic_load(&a->regions[i]));
+	atomic_store(&a->regions[i], NULL);
+    }
+    pthread_mutex_destroy(&a->grow_lock);
+}
@@ -0,0 +1,81 @@
+/*
+ * File: arena.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a slab arena: fixed size slabs
+ *      carved out of large regions and recycled through a lock
+ *      free free list. Slabs are named by a 32 bit handle rather
+ *      than a pointer, so a handle fits in a queue payload next
+ *      to an item index, and any thread may return a slab that
+ *      another thread took.
+ *
+ *      Regions are only freed by arena_cleanup(); a busy arena
+ *      runs with no malloc() or free() once it has grown to its
+ *      working size.
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define ARENA_FAILURE -1
+#define ARENA_SUCCESS 0
+
+/* handle 0 is never a slab */
+#define ARENA_NONE 0
+#define ARENA_REGION_SLABS 1024
+#define ARENA_MAX_REGIONS 4096
+#define ARENA_ALIGN 64
+
+/* ARENA_REGION_SLABS slabs and their free list links */
+typedef struct arena_region_s{
+    atomic_uint next[ARENA_REGION_SLABS];
+    _Alignas(ARENA_ALIGN) char slabs[];
+} arena_region;
+
+typedef struct arena_s{
+    size_t slab_size;                   /* rounded up to ARENA_ALIGN */
+    _Atomic(arena_region*) regions[ARENA_MAX_REGIONS];
+    pthread_mutex_t grow_lock;
+    /* free list head: ABA tag << 32 | handle */
+    _Alignas(ARENA_ALIGN) atomic_uint_fast64_t free_head;
+    atomic_uint fresh;                  /* next never used handle */
+    /* counters */
+    atomic_long gets;
+    atomic_long reused;
+    atomic_int nregions;
+} arena;
+
+/* Function to set up an arena of slab_size byte slabs
+ * Returns ARENA_SUCCESS or ARENA_FAILURE
+ */
+int arena_init(arena* a, size_t slab_size);
+
+/* Function to take a slab
+ * Returns its handle, or ARENA_NONE if memory ran out
+ */
+uint32_t arena_get(arena* a);
+
+/* Function to return the memory of a slab taken with arena_get() */
+static inline void* arena_ptr(arena* a, uint32_t handle){
+    arena_region* r = atomic_load_explicit(&a->regions[handle / ARENA_REGION_SLABS],
+					   memory_order_acquire);
+    return r->slabs + (size_t) (handle % ARENA_REGION_SLABS) * a->slab_size;
+}
+
+/* Function to give a slab back; any thread may call it */
+void arena_put(arena* a, uint32_t handle);
+
+/* Function to free every region
+ * No slab may be used afterwards.
+ */
+void arena_cleanup(arena* a);
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * File: arenaTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the slab arena. Threads
+ *      take slabs, stamp them with their id, and hand them to
+ *      other threads to check and give back. A slab handed out
+ *      twice at once shows up as a stamp that changed under its
+ *      owner. Handles must be non zero, pointers aligned, and
+ *      returned slabs reused instead of growing the arena.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "arena.h"
+
+#define TEST_THREADS 4
+#define TEST_ROUNDS 200000
+#define TEST_HELD 64
+#define TEST_SLAB_SIZE 100
+
+typedef struct test_thread_s{
+    arena* a;
+    int id;
+    atomic_uint* handoff;       /* slot shared with the next thread */
+    atomic_uint* incoming;      /* slot shared with the previous one */
+    int errors;
+} test_thread;
+
+static int check_slab(arena* a, uint32_t handle, unsigned char stamp){
+    unsigned char* p = arena_ptr(a, handle);
+    int i;
+
+    for(i = 0; i < TEST_SLAB_SIZE; i++){
+	if(p[i] != stamp){
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+static void* churn(void* arg){
+    test_thread* t = arg;
+    uint32_t held[TEST_HELD];
+    uint32_t h;
+    int round, i;
+
+    memset(held, 0, sizeof(held));
+    for(round = 0; round < TEST_ROUNDS; round++){
+	i = round % TEST_HELD;
+	if(held[i] != ARENA_NONE){
+	    if(check_slab(t->a, held[i], (unsigned char) t->id)){
+		t->errors++;
+	    }
+	    /* pass it on, or give it back if the slot is busy */
+	    h = ARENA_NONE;
+	    if(!atomic_compare_exchange_strong(t->handoff, &h, held[i])){
+		arena_put(t->a, held[i]);
+	    }
+	}
+	held[i] = arena_get(t->a);
+	if(held[i] == ARENA_NONE || (uintptr_t) arena_ptr(t->a, held[i]) % ARENA_ALIGN){
+	    t->errors++;
+	    held[i] = ARENA_NONE;
+	    continue;
+	}
+	memset(arena_ptr(t->a, held[i]), t->id, TEST_SLAB_SIZE);
+
+	/* give back a slab another thread took */
+	h = atomic_exchange(t->incoming, ARENA_NONE);
+	if(h != ARENA_NONE){
+	    arena_put(t->a, h);
+	}
+    }
+    for(i = 0; i < TEST_HELD; i++){
+	if(held[i] != ARENA_NONE){
+	    arena_put(t->a, held[i]);
+	}
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static arena a;
+    test_thread threads[TEST_THREADS];
+    pthread_t ids[TEST_THREADS];
+    atomic_uint slots[TEST_THREADS];
+    uint32_t first, second;
+    int i;
+
+    if(arena_init(&a, TEST_SLAB_SIZE) == ARENA_FAILURE){
+	fprintf(stderr, "error: arena_init failed\n");
+	return 0;
+    }
+
+    /* Test that a returned slab is the next one handed out */
+    first = arena_get(&a);
+    arena_put(&a, first);
+    second = arena_get(&a);
+    if(first == ARENA_NONE || second != first){
+	fprintf(stderr, "error: slab %u not reused (got %u)\n", first, second);
+    }
+    arena_put(&a, second);
+
+    /* Test concurrent get/put, with slabs returned by other threads */
+    for(i = 0; i < TEST_THREADS; i++){
+	atomic_init(&slots[i], ARENA_NONE);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	threads[i].a = &a;
+	threads[i].id = i + 1;
+	threads[i].handoff = &slots[i];
+	threads[i].incoming = &slots[(i + TEST_THREADS - 1) % TEST_THREADS];
+	threads[i].errors = 0;
+	pthread_create(&ids[i], NULL, churn, &threads[i]);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(ids[i], NULL);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	if(threads[i].errors){
+	    fprintf(stderr, "error: thread %d saw %d bad slabs\n", i, threads[i].errors);
+	}
+	if(atomic_load(&slots[i]) != ARENA_NONE){
+	    arena_put(&a, atomic_load(&slots[i]));
+	}
+    }
+
+    /* at most TEST_HELD + 1 slabs per thread were ever out at once */
+    if(atomic_load(&a.fresh) > 2 + TEST_THREADS * (TEST_HELD + 1)){
+	fprintf(stderr, "error: arena grew to %u slabs\n", atomic_load(&a.fresh) - 1);
+    }
+    if(atomic_load(&a.reused) == 0){
+	fprintf(stderr, "error: no slab was reused\n");
+    }
+
+    /* Test that the arena grows past one region */
+    for(i = 0; i < 3 * ARENA_REGION_SLABS; i++){
+	if(arena_get(&a) == ARENA_NONE){
+	    fprintf(stderr, "error: arena_get failed while growing\n");
+	    break;
+	}
+    }
+    if(atomic_load(&a.nregions) < 3){
+	fprintf(stderr, "error: only %d regions after growing\n", atomic_load(&a.nregions));
+    }
+
+    arena_cleanup(&a);
+    return 0;
+}
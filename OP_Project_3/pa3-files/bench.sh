@@ -0,0 +1,246 @@
+#!/bin/bash
+
+#File: bench.sh
+#Project: CSCI 3753 Programming Assignment 2
+#Create Date: 2026/10/17
+#Modify Date: 2026/10/17
+#Description:
+#	Measure multi-lookup throughput against the LD_PRELOAD stub
+#	resolver (stub-resolver.so).
+#
+#	./bench.sh threads  sweep the resolver thread count. Every
+#	                    lookup costs STUB_RESOLVER_DELAY_US, so a
+#	                    truly parallel pipeline scales close to
+#	                    linearly.
+#	./bench.sh batch    sweep the queue batch size (-b) with a
+#	                    zero delay stub, so queue handoff cost
+#	                    dominates as it does once lookups are cached.
+#	./bench.sh async    sweep --max-inflight for the async engine
+#	                    against ./stub-dns answering after
+#	                    DNS_DELAY_MS, with one resolver thread.
+#	./bench.sh lookup   compare lookup against multi-lookup over
+#	                    NAMES x THREADS x QUEUE with the fake
+#	                    resolver (RESOLVER, see fakeresolver.h)
+#	                    and no cache, as CSV on stdout. Latency
+#	                    percentiles come from multi-lookup's
+#	                    --stats-json lookup stage; lookup has none.
+#	./bench.sh affinity compare unpinned threads, threads pinned
+#	                    one per CPU (CPUS, default every allowed
+#	                    CPU) and --numa, with the steal schedule
+#	                    and a zero delay stub. Migrations count
+#	                    batches a thread began on another CPU or
+#	                    node than its last; remote steals are
+#	                    names taken across nodes. Both stand in
+#	                    for cross socket cache line traffic.
+#	./bench.sh priority sweep --starve-limit (STARVE_LIMITS) with
+#	                    URGENT names marked --urgent behind NAMES
+#	                    bulk ones, through a QUEUE slot queue with
+#	                    a STUB_RESOLVER_DELAY_US stub. Shows each
+#	                    class's queue wait p50/p99 from -s: a low
+#	                    limit shares the resolvers more evenly, a
+#	                    high one keeps urgent waits short.
+#	./bench.sh procs    compare one process of TOTAL resolver
+#	                    threads with --procs K worker processes of
+#	                    TOTAL/K threads each, for each K in PROCS,
+#	                    against a STUB_RESOLVER_DELAY_US stub with
+#	                    no cache. K=1 is the cost of the rings alone.
+
+MODE=${1:-threads}
+TIMEFORMAT="%R"
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# Build an input list of $NAMES hostnames from the sample inputs
+gen_input(){
+    : > "$1"
+    while [ $(wc -l < "$1") -lt "$NAMES" ]; do
+	cat input/names*.txt >> "$1"
+    done
+    head -n "$NAMES" "$1" > "$1.tmp" && mv "$1.tmp" "$1"
+}
+
+# run <label> <multi-lookup args...>: print one result row
+run(){
+    local label=$1
+    shift
+    secs=$( { time LD_PRELOAD=./stub-resolver.so \
+	./multi-lookup "$@" "$WORKDIR/names.txt" "$WORKDIR/out.txt" \
+	> /dev/null 2>&1; } 2>&1 )
+    awk -v l="$label" -v s="$secs" -v n="$NAMES" \
+	'BEGIN { printf "%8d %10.3f %12.0f\n", l, s, n / s }'
+}
+
+# run_csv <program> <threads> <queue> <args...>: print one CSV row
+run_csv(){
+    local program=$1 threads=$2 queue=$3
+    shift 3
+    rm -f "$WORKDIR/stats.json"
+    secs=$( { time ./$program "$@" "$WORKDIR/names.txt" "$WORKDIR/out.txt" \
+	> /dev/null 2>&1; } 2>&1 )
+    pct=$(grep -s '"stage":"lookup"' "$WORKDIR/stats.json" \
+	| sed 's/.*"p50":\([0-9]*\).*"p99":\([0-9]*\).*/\1 \2/')
+    echo "$pct" | awk -v p="$program" -v n="$NAMES" -v t="$threads" \
+	-v q="$queue" -v s="$secs" '
+	{ if (NF == 2) { p50 = sprintf("%.0f", $1 / 1000); p99 = sprintf("%.0f", $2 / 1000) } }
+	END { printf "%s,%d,%s,%s,%.3f,%.0f,%s,%s\n", p, n, t, q, s, n / s, p50, p99 }'
+}
+
+# run_affinity <label> <multi-lookup args...>: print one row with
+# the -s placement counters
+run_affinity(){
+    local label=$1
+    shift
+    secs=$( { time LD_PRELOAD=./stub-resolver.so \
+	./multi-lookup -s "$@" "$WORKDIR/names.txt" "$WORKDIR/out.txt" \
+	> /dev/null 2> "$WORKDIR/stats.txt"; } 2>&1 )
+    grep '^affinity:' "$WORKDIR/stats.txt" | tr ' ' '\n' | awk -F= \
+	-v l="$label" -v s="$secs" -v n="$NAMES" '
+	{ v[$1] = $2 }
+	END { printf "%-10s %10.3f %12.0f %12d %16d %14d\n", l, s, n / s,
+	      v["migrations"], v["node_migrations"], v["remote_steals"] }'
+}
+
+# run_priority <label> <multi-lookup args...>: print one row with
+# the -s per class queue waits
+run_priority(){
+    local label=$1
+    shift
+    secs=$( { time LD_PRELOAD=./stub-resolver.so \
+	./multi-lookup -s "$@" --urgent "$WORKDIR/urgent.txt" "$WORKDIR/names.txt" \
+	"$WORKDIR/urgent.txt" "$WORKDIR/out.txt" > /dev/null 2> "$WORKDIR/stats.txt"; } 2>&1 )
+    grep '^priority:' "$WORKDIR/stats.txt" | tr ' ' '\n' | awk -F= \
+	-v l="$label" -v s="$secs" '
+	$1 == "class" { c = $2 }
+	{ v[c, $1] = $2 }
+	END { printf "%12s %10.3f %14d %14d %14d %14d %8d\n", l, s,
+	      v["urgent", "wait_p50_us"], v["urgent", "wait_p99_us"],
+	      v["bulk", "wait_p50_us"], v["bulk", "wait_p99_us"], v["bulk", "starved"] }'
+}
+
+# run_procs <threads> <procs> <multi-lookup args...>: print one row
+run_procs(){
+    local total=$1 k=$2
+    shift 2
+    secs=$( { time LD_PRELOAD=./stub-resolver.so \
+	./multi-lookup "$@" "$WORKDIR/names.txt" "$WORKDIR/out.txt" \
+	> /dev/null 2>&1; } 2>&1 )
+    awk -v t="$total" -v k="$k" -v s="$secs" -v n="$NAMES" \
+	'BEGIN { printf "%8d %8d %8d %10.3f %12.0f\n", t, k, k ? t / k : t, s, n / s }'
+}
+
+case $MODE in
+threads)
+    NAMES=${NAMES:-2000}
+    THREADS=${THREADS:-"1 2 4 8 16 32"}
+    export STUB_RESOLVER_DELAY_US=${STUB_RESOLVER_DELAY_US:-1000}
+    gen_input "$WORKDIR/names.txt"
+    echo "names=$NAMES delay_us=$STUB_RESOLVER_DELAY_US"
+    printf "%8s %10s %12s\n" threads seconds lookups/s
+    for t in $THREADS; do
+	run "$t" -t "$t"
+    done
+    ;;
+batch)
+    NAMES=${NAMES:-200000}
+    BATCHES=${BATCHES:-"1 2 4 8 16 32 64"}
+    RESOLVERS=${RESOLVERS:-4}
+    export STUB_RESOLVER_DELAY_US=${STUB_RESOLVER_DELAY_US:-0}
+    gen_input "$WORKDIR/names.txt"
+    echo "names=$NAMES delay_us=$STUB_RESOLVER_DELAY_US resolvers=$RESOLVERS"
+    printf "%8s %10s %12s\n" batch seconds lookups/s
+    for b in $BATCHES; do
+	run "$b" -t "$RESOLVERS" -b "$b"
+    done
+    ;;
+async)
+    NAMES=${NAMES:-5000}
+    INFLIGHT=${INFLIGHT:-"1 8 64 512 4096"}
+    DNS_DELAY_MS=${DNS_DELAY_MS:-1}
+    gen_input "$WORKDIR/names.txt"
+    : > "$WORKDIR/stub-dns.out"
+    ./stub-dns -p 0 -d "$DNS_DELAY_MS" > "$WORKDIR/stub-dns.out" &
+    STUB_PID=$!
+    trap 'kill $STUB_PID; rm -rf "$WORKDIR"' EXIT
+    while ! read -r _ _ _ PORT < "$WORKDIR/stub-dns.out" || [ -z "$PORT" ]; do
+	sleep 0.1
+    done
+    echo "names=$NAMES dns_delay_ms=$DNS_DELAY_MS resolvers=1"
+    printf "%8s %10s %12s\n" inflight seconds lookups/s
+    for n in $INFLIGHT; do
+	run "$n" -t 1 --no-cache --engine async \
+	    --nameserver "127.0.0.1:$PORT" --max-inflight "$n"
+    done
+    ;;
+lookup)
+    NAMES_LIST=${NAMES_LIST:-"1000 10000"}
+    THREADS=${THREADS:-"1 4 16 64"}
+    QUEUE=${QUEUE:-"4 16 256"}
+    RESOLVER=${RESOLVER:-"fake:latency=exp:500,fail=0.01"}
+    echo "program,names,threads,queue,seconds,lookups_per_s,p50_us,p99_us"
+    for NAMES in $NAMES_LIST; do
+	gen_input "$WORKDIR/names.txt"
+	run_csv lookup 1 - -r "$RESOLVER"
+	for t in $THREADS; do
+	    for qs in $QUEUE; do
+		run_csv multi-lookup "$t" "$qs" -t "$t" -q "$qs" --no-cache \
+		    --no-coalesce --resolver "$RESOLVER" \
+		    --stats-json "$WORKDIR/stats.json"
+	    done
+	done
+    done
+    ;;
+affinity)
+    NAMES=${NAMES:-200000}
+    RESOLVERS=${RESOLVERS:-4}
+    PRODUCERS=${PRODUCERS:-2}
+    CPUS=${CPUS:-$(awk '/Cpus_allowed_list/ { print $2 }' /proc/self/status)}
+    export STUB_RESOLVER_DELAY_US=${STUB_RESOLVER_DELAY_US:-0}
+    gen_input "$WORKDIR/names.txt"
+    echo "names=$NAMES resolvers=$RESOLVERS producers=$PRODUCERS cpus=$CPUS"
+    printf "%-10s %10s %12s %12s %16s %14s\n" placement seconds lookups/s \
+	migrations node_migrations remote_steals
+    ARGS="-t $RESOLVERS -p $PRODUCERS -b 16 --schedule steal"
+    run_affinity unpinned $ARGS
+    run_affinity pinned $ARGS --pin-producers "$CPUS" --pin-resolvers "$CPUS" \
+	--pin-writer "$CPUS"
+    run_affinity numa $ARGS --numa
+    ;;
+priority)
+    NAMES=${NAMES:-50000}
+    URGENT=${URGENT:-2000}
+    RESOLVERS=${RESOLVERS:-4}
+    QUEUE=${QUEUE:-64}
+    STARVE_LIMITS=${STARVE_LIMITS:-"1 16 256 4096"}
+    export STUB_RESOLVER_DELAY_US=${STUB_RESOLVER_DELAY_US:-50}
+    gen_input "$WORKDIR/names.txt"
+    head -n "$URGENT" "$WORKDIR/names.txt" > "$WORKDIR/urgent.txt"
+    echo "names=$NAMES urgent=$URGENT resolvers=$RESOLVERS queue=$QUEUE delay_us=$STUB_RESOLVER_DELAY_US"
+    printf "%12s %10s %14s %14s %14s %14s %8s\n" starve_limit seconds \
+	urgent_p50_us urgent_p99_us bulk_p50_us bulk_p99_us starved
+    for limit in $STARVE_LIMITS; do
+	run_priority "$limit" -t "$RESOLVERS" -p 2 -b 8 -q "$QUEUE" --starve-limit "$limit"
+    done
+    ;;
+procs)
+    NAMES=${NAMES:-20000}
+    TOTALS=${TOTALS:-"16 64 256"}
+    PROCS=${PROCS:-"1 2 4 8"}
+    export STUB_RESOLVER_DELAY_US=${STUB_RESOLVER_DELAY_US:-200}
+    gen_input "$WORKDIR/names.txt"
+    echo "names=$NAMES delay_us=$STUB_RESOLVER_DELAY_US (procs 0: threads only)"
+    printf "%8s %8s %8s %10s %12s\n" threads procs each seconds lookups/s
+    for total in $TOTALS; do
+	run_procs "$total" 0 -t "$total" -b 16 --no-cache --no-coalesce
+	for k in $PROCS; do
+	    if [ "$k" -le "$total" ]; then
+		run_procs "$total" "$k" --procs "$k" -t $((total / k)) -b 16 \
+		    --no-cache --no-coalesce
+	    fi
+	done
+    done
+    ;;
+*)
+    echo "Usage: $0 [threads|batch|async|lookup|affinity|priority|procs]" >&2
+    exit 1
+    ;;
+esac
@@ -0,0 +1,236 @@
+/*
+ * File: checkpoint.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains run checkpoints. A checkpoint file is
+ *
+ *          multi-lookup checkpoint 1
+ *          output BYTES
+ *          files N
+ *      then for each input file
+ *          file SIZE SPANS NAME
+ *          BEGIN END       (SPANS lines, the done byte spans)
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+int checkpoint_init(checkpoint* c, int nfiles){
+    memset(c, 0, sizeof(*c));
+    c->files = calloc(nfiles > 0 ? nfiles : 1, sizeof(*c->files));
+    if(!c->files){
+	perror("Error allocating checkpoint");
+	return CHECKPOINT_FAILURE;
+    }
+    c->nfiles = nfiles;
+    return CHECKPOINT_SUCCESS;
+}
+
+int checkpoint_set_file(checkpoint* c, int i, const char* name, long long size){
+    char* copy = strdup(name);
+
+    if(!copy){
+	perror("Error allocating checkpoint");
+	return CHECKPOINT_FAILURE;
+    }
+    free(c->files[i].name);
+    c->files[i].name = copy;
+    c->files[i].size = size;
+    return CHECKPOINT_SUCCESS;
+}
+
+int checkpoint_add(checkpoint* c, int i, size_t begin, size_t end){
+    checkpoint_file* f = &c->files[i];
+    checkpoint_span* grown;
+    int first, last;
+
+    if(begin >= end){
+	return CHECKPOINT_SUCCESS;
+    }
+    /* spans first .. last-1 overlap or touch [begin, end) */
+    for(first = 0; first < f->ndone && f->done[first].end < begin; first++);
+    for(last = first; last < f->ndone && f->done[last].begin <= end; last++){
+	if(f->done[last].begin < begin){
+	    begin = f->done[last].begin;
+	}
+	if(f->done[last].end > end){
+	    end = f->done[last].end;
+	}
+    }
+    if(last == first){
+	if(f->ndone == f->done_cap){
+	    f->done_cap = f->done_cap ? f->done_cap * 2 : 16;
+	    grown = realloc(f->done, f->done_cap * sizeof(*grown));
+	    if(!grown){
+		perror("Error growing checkpoint");
+		return CHECKPOINT_FAILURE;
+	    }
+	    f->done = grown;
+	}
+	memmove(&f->done[first + 1], &f->done[first], (f->ndone - first) * sizeof(*f->done));
+	f->ndone++;
+    }
+    else if(last > first + 1){
+	memmove(&f->done[first + 1], &f->done[last], (f->ndone - last) * sizeof(*f->done));
+	f->ndone -= last - first - 1;
+    }
+    f->done[first].begin = begin;
+    f->done[first].end = end;
+    return CHECKPOINT_SUCCESS;
+}
+
+int checkpoint_copy(checkpoint* dst, const checkpoint* src){
+    int i, j;
+
+    dst->output_bytes = src->output_bytes;
+    for(i = 0; i < src->nfiles && i < dst->nfiles; i++){
+	if(src->files[i].name
+	   && checkpoint_set_file(dst, i, src->files[i].name, src->files[i].size) == CHECKPOINT_FAILURE){
+	    return CHECKPOINT_FAILURE;
+	}
+	for(j = 0; j < src->files[i].ndone; j++){
+	    if(checkpoint_add(dst, i, src->files[i].done[j].begin,
+			      src->files[i].done[j].end) == CHECKPOINT_FAILURE){
+		return CHECKPOINT_FAILURE;
+	    }
+	}
+    }
+    return CHECKPOINT_SUCCESS;
+}
+
+int checkpoint_pending(const checkpoint* c, int i, checkpoint_span** spans){
+    const checkpoint_file* f = &c->files[i];
+    size_t size = f->size > 0 ? (size_t) f->size : 0;
+    size_t pos = 0;
+    int n = 0;
+    int j;
+
+    *spans = malloc((f->ndone + 1) * sizeof(**spans));
+    if(!*spans){
+	perror("Error allocating checkpoint");
+	return CHECKPOINT_FAILURE;
+    }
+    for(j = 0; j <= f->ndone && pos < size; j++){
+	size_t next = j < f->ndone && f->done[j].begin < size ? f->done[j].begin : size;
+	if(next > pos){
+	    (*spans)[n].begin = pos;
+	    (*spans)[n].end = next;
+	    n++;
+	}
+	if(j < f->ndone && f->done[j].end > pos){
+	    pos = f->done[j].end;
+	}
+    }
+    return n;
+}
+
+long long checkpoint_done_bytes(const checkpoint* c){
+    long long total = 0;
+    int i, j;
+
+    for(i = 0; i < c->nfiles; i++){
+	for(j = 0; j < c->files[i].ndone; j++){
+	    total += c->files[i].done[j].end - c->files[i].done[j].begin;
+	}
+    }
+    return total;
+}
+
+int checkpoint_save(const checkpoint* c, const char* path){
+    size_t len = strlen(path);
+    char tmp[len + 5];
+    FILE* out;
+    int i, j;
+    int ok;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    out = fopen(tmp, "w");
+    if(!out){
+	return CHECKPOINT_FAILURE;
+    }
+    fprintf(out, "%s\noutput %lld\nfiles %d\n", CHECKPOINT_MAGIC, c->output_bytes, c->nfiles);
+    for(i = 0; i < c->nfiles; i++){
+	const checkpoint_file* f = &c->files[i];
+	fprintf(out, "file %lld %d %s\n", f->size, f->ndone, f->name ? f->name : "");
+	for(j = 0; j < f->ndone; j++){
+	    fprintf(out, "%zu %zu\n", f->done[j].begin, f->done[j].end);
+	}
+    }
+    /* on disk before it replaces the old one */
+    ok = fflush(out) == 0 && fsync(fileno(out)) == 0;
+    if(fclose(out) != 0 || !ok || rename(tmp, path) != 0){
+	unlink(tmp);
+	return CHECKPOINT_FAILURE;
+    }
+    return CHECKPOINT_SUCCESS;
+}
+
+/* Parse an open checkpoint file into c */
+static int checkpoint_read(checkpoint* c, FILE* in){
+    char line[4096];
+    long long output, size;
+    int nfiles, ndone;
+    size_t begin, end;
+    int i, j;
+
+    if(!fgets(line, sizeof(line), in) || strcmp(line, CHECKPOINT_MAGIC "\n") != 0
+       || fscanf(in, "output %lld\nfiles %d\n", &output, &nfiles) != 2
+       || output < 0 || nfiles < 0
+       || checkpoint_init(c, nfiles) == CHECKPOINT_FAILURE){
+	return CHECKPOINT_FAILURE;
+    }
+    c->output_bytes = output;
+    for(i = 0; i < nfiles; i++){
+	if(fscanf(in, "file %lld %d ", &size, &ndone) != 2 || ndone < 0
+	   || !fgets(line, sizeof(line), in)){
+	    return CHECKPOINT_FAILURE;
+	}
+	line[strcspn(line, "\n")] = '\0';
+	if(checkpoint_set_file(c, i, line, size) == CHECKPOINT_FAILURE){
+	    return CHECKPOINT_FAILURE;
+	}
+	for(j = 0; j < ndone; j++){
+	    if(fscanf(in, "%zu %zu\n", &begin, &end) != 2
+	       || checkpoint_add(c, i, begin, end) == CHECKPOINT_FAILURE){
+		return CHECKPOINT_FAILURE;
+	    }
+	}
+    }
+    return CHECKPOINT_SUCCESS;
+}
+
+int checkpoint_load(checkpoint* c, const char* path){
+    FILE* in = fopen(path, "r");
+    int ret;
+
+    memset(c, 0, sizeof(*c));
+    if(!in){
+	return CHECKPOINT_FAILURE;
+    }
+    ret = checkpoint_read(c, in);
+    fclose(in);
+    if(ret == CHECKPOINT_FAILURE){
+	checkpoint_cleanup(c);
+	errno = EINVAL;
+    }
+    return ret;
+}
+
+void checkpoint_cleanup(checkpoint* c){
+    int i;
+
+    for(i = 0; i < c->nfiles; i++){
+	free(c->files[i].name);
+	free(c->files[i].done);
+    }
+    free(c->files);
+    memset(c, 0, sizeof(*c));
+}
@@ -0,0 +1,87 @@
+/*
+ * File: checkpoint.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for run checkpoints: which bytes of
+ *      each input file have had all their names written to the
+ *      output, and how long the output file was at the time. A
+ *      run that stops part way can be restarted from it, reading
+ *      only the byte spans not yet done and appending to the
+ *      output cut back to that length.
+ *
+ *      Checkpoints are small text files, replaced whole by
+ *      writing a temporary file and renaming it over the old one,
+ *      so a crash while saving leaves the previous one in place.
+ *
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+
+#define CHECKPOINT_FAILURE -1
+#define CHECKPOINT_SUCCESS 0
+
+#define CHECKPOINT_MAGIC "multi-lookup checkpoint 1"
+
+/* Bytes [begin, end) of an input file */
+typedef struct checkpoint_span_s{
+    size_t begin;
+    size_t end;
+} checkpoint_span;
+
+typedef struct checkpoint_file_s{
+    char* name;
+    long long size;
+    checkpoint_span* done;      /* sorted, none overlapping or touching */
+    int ndone;
+    int done_cap;
+} checkpoint_file;
+
+typedef struct checkpoint_s{
+    long long output_bytes;
+    checkpoint_file* files;
+    int nfiles;
+} checkpoint;
+
+/* Function to set up an empty checkpoint of nfiles inputs
+ * Returns CHECKPOINT_SUCCESS or CHECKPOINT_FAILURE
+ */
+int checkpoint_init(checkpoint* c, int nfiles);
+
+/* Function to name input file i and give its size */
+int checkpoint_set_file(checkpoint* c, int i, const char* name, long long size);
+
+/* Function to mark bytes [begin, end) of file i done, merging
+ * with the spans already there
+ */
+int checkpoint_add(checkpoint* c, int i, size_t begin, size_t end);
+
+/* Function to copy src's files and spans into an empty dst */
+int checkpoint_copy(checkpoint* dst, const checkpoint* src);
+
+/* Function to list the spans of file i that are not done
+ * Sets *spans to a malloc'd array the caller frees.
+ * Returns the number of spans, or CHECKPOINT_FAILURE
+ */
+int checkpoint_pending(const checkpoint* c, int i, checkpoint_span** spans);
+
+/* Function to return how many bytes of every file are done */
+long long checkpoint_done_bytes(const checkpoint* c);
+
+/* Function to write c to path, replacing it atomically */
+int checkpoint_save(const checkpoint* c, const char* path);
+
+/* Function to read the checkpoint at path into c
+ * Returns CHECKPOINT_FAILURE with errno ENOENT if there is none,
+ * or EINVAL if the file is not a checkpoint
+ */
+int checkpoint_load(checkpoint* c, const char* path);
+
+/* Function to free c's files and spans */
+void checkpoint_cleanup(checkpoint* c);
+
+#endif
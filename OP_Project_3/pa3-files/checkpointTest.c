@@ -0,0 +1,118 @@
+/*
+ * File: checkpointTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for run checkpoints. Done
+ *      spans added out of order, overlapping and touching must
+ *      merge; the pending spans must be exactly what is left of
+ *      each file; and a saved checkpoint must load back the same,
+ *      while a missing or damaged one must be refused.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+#define TEST_PATH "checkpointTest.tmp"
+
+static int same_spans(const checkpoint_span* spans, int n, const size_t* expect, int count){
+    int i;
+
+    if(n != count){
+	return 0;
+    }
+    for(i = 0; i < n; i++){
+	if(spans[i].begin != expect[2 * i] || spans[i].end != expect[2 * i + 1]){
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static const size_t done[] = {0, 10, 20, 60, 70, 75};
+    static const size_t pending[] = {10, 20, 60, 70, 75, 100};
+    checkpoint c;
+    checkpoint loaded;
+    checkpoint_span* spans;
+    FILE* f;
+    int n;
+
+    checkpoint_init(&c, 2);
+    checkpoint_set_file(&c, 0, "input/names 1.txt", 100);
+    checkpoint_set_file(&c, 1, "empty.txt", 0);
+    c.output_bytes = 1234;
+
+    /* Test spans merge */
+    checkpoint_add(&c, 0, 40, 50);
+    checkpoint_add(&c, 0, 0, 5);
+    checkpoint_add(&c, 0, 70, 75);
+    checkpoint_add(&c, 0, 20, 30);
+    checkpoint_add(&c, 0, 5, 10);     /* touches 0-5 */
+    checkpoint_add(&c, 0, 28, 45);    /* joins 20-30 and 40-50 */
+    checkpoint_add(&c, 0, 50, 60);
+    checkpoint_add(&c, 0, 22, 24);    /* inside */
+    checkpoint_add(&c, 0, 30, 30);    /* empty */
+    if(!same_spans(c.files[0].done, c.files[0].ndone, done, 3)){
+	fprintf(stderr, "error: %d spans after merging, first %zu-%zu\n",
+		c.files[0].ndone, c.files[0].done[0].begin, c.files[0].done[0].end);
+    }
+    if(checkpoint_done_bytes(&c) != 55){
+	fprintf(stderr, "error: %lld bytes done\n", checkpoint_done_bytes(&c));
+    }
+
+    /* Test pending spans */
+    n = checkpoint_pending(&c, 0, &spans);
+    if(!same_spans(spans, n, pending, 3)){
+	fprintf(stderr, "error: %d pending spans\n", n);
+    }
+    free(spans);
+    n = checkpoint_pending(&c, 1, &spans);
+    if(n != 0){
+	fprintf(stderr, "error: %d pending spans in an empty file\n", n);
+    }
+    free(spans);
+
+    /* Test save and load */
+    if(checkpoint_save(&c, TEST_PATH) != CHECKPOINT_SUCCESS){
+	fprintf(stderr, "error: could not save\n");
+    }
+    if(checkpoint_load(&loaded, TEST_PATH) != CHECKPOINT_SUCCESS){
+	fprintf(stderr, "error: could not load\n");
+	return 0;
+    }
+    if(loaded.nfiles != 2 || loaded.output_bytes != 1234
+       || strcmp(loaded.files[0].name, "input/names 1.txt") != 0 || loaded.files[0].size != 100
+       || !same_spans(loaded.files[0].done, loaded.files[0].ndone, done, 3)
+       || strcmp(loaded.files[1].name, "empty.txt") != 0 || loaded.files[1].ndone != 0){
+	fprintf(stderr, "error: loaded checkpoint differs\n");
+    }
+    checkpoint_cleanup(&loaded);
+
+    /* Test refusals */
+    f = fopen(TEST_PATH, "w");
+    fputs("multi-lookup checkpoint 1\noutput 5\nfiles 1\nfile 10 2 x\n0 5\n", f);
+    fclose(f);
+    if(checkpoint_load(&loaded, TEST_PATH) != CHECKPOINT_FAILURE || errno != EINVAL){
+	fprintf(stderr, "error: truncated checkpoint accepted\n");
+    }
+    unlink(TEST_PATH);
+    if(checkpoint_load(&loaded, TEST_PATH) != CHECKPOINT_FAILURE || errno != ENOENT){
+	fprintf(stderr, "error: missing checkpoint accepted\n");
+    }
+
+    checkpoint_cleanup(&c);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * File: coalesceTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for dnslookup_coalesced().
+ *      It defines its own slow getaddrinfo()/freeaddrinfo(),
+ *      which util.o links against instead of libc's, so the
+ *      test needs no network and can count real lookups.
+ *  
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "util.h"
+
+#define TEST_THREADS 16
+#define TEST_DELAY_MS 50
+
+static atomic_int lookups;
+
+int getaddrinfo(const char* node, const char* service,
+		const struct addrinfo* hints, struct addrinfo** res){
+
+    struct timespec ts = {0, TEST_DELAY_MS * 1000000L};
+    struct {
+	struct addrinfo info;
+	struct sockaddr_in addr;
+    }* r;
+
+    (void) service;
+    (void) hints;
+
+    atomic_fetch_add(&lookups, 1);
+    nanosleep(&ts, NULL);
+    if(strcmp(node, "fail.invalid") == 0){
+	return EAI_NONAME;
+    }
+
+    r = calloc(1, sizeof(*r));
+    r->addr.sin_family = AF_INET;
+    r->addr.sin_addr.s_addr = htonl(0x0A000001);
+    r->info.ai_family = AF_INET;
+    r->info.ai_addr = (struct sockaddr*) &r->addr;
+    r->info.ai_addrlen = sizeof(r->addr);
+    *res = &r->info;
+    return 0;
+}
+
+void freeaddrinfo(struct addrinfo* res){
+    free(res);
+}
+
+static void* lookup_thread(void* arg){
+    char ip[INET6_ADDRSTRLEN];
+    long errors = 0;
+
+    if(dnslookup_coalesced((const char*) arg, ip, sizeof(ip)) == UTIL_FAILURE){
+	if(strcmp((const char*) arg, "fail.invalid") != 0){
+	    errors++;
+	}
+    }
+    else if(strcmp(ip, "10.0.0.1") != 0){
+	errors++;
+    }
+    return (void*) errors;
+}
+
+/* Start TEST_THREADS lookups of hostname at once */
+static void run(const char* hostname){
+    pthread_t threads[TEST_THREADS];
+    void* errors;
+    int t;
+
+    for(t=0; t<TEST_THREADS; t++){
+	pthread_create(&threads[t], NULL, lookup_thread, (void*) hostname);
+    }
+    for(t=0; t<TEST_THREADS; t++){
+	pthread_join(threads[t], &errors);
+	if(errors){
+	    fprintf(stderr,
+		    "error: thread %d got a wrong result for %s\n",
+		    t, hostname);
+	}
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    long performed, coalesced;
+
+    /* Test that concurrent lookups of one name share a lookup */
+    run("example.com");
+    dnslookup_coalesced_stats(&performed, &coalesced);
+    if(atomic_load(&lookups) != 1 || performed != 1
+       || coalesced != TEST_THREADS - 1){
+	fprintf(stderr,
+		"error: expected 1 lookup and %d coalesced,"
+		" got %d (%ld) and %ld\n",
+		TEST_THREADS - 1, atomic_load(&lookups),
+		performed, coalesced);
+    }
+
+    /* Test that a finished flight is not reused */
+    run("example.com");
+    if(atomic_load(&lookups) != 2){
+	fprintf(stderr,
+		"error: second round did not look up again\n");
+    }
+
+    /* Test that failures are shared too */
+    run("fail.invalid");
+    if(atomic_load(&lookups) != 3){
+	fprintf(stderr,
+		"error: failed lookup was not coalesced\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * File: diskcache.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the mmap backed persistent DNS cache.
+ *      Lookups linearly probe at most DISKCACHE_MAX_PROBE slots
+ *      from the hash's home slot. When every slot in that window
+ *      is live, an insert evicts the one expiring soonest.
+ *      Expiry times are wall clock seconds so they survive
+ *      restarts.
+ *  
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "diskcache.h"
+
+/* 64 bit FNV-1a; 0 is reserved for empty slots */
+static uint64_t diskcache_hash(const char* s){
+    uint64_t h = 14695981039346656037ULL;
+    while(*s){
+	h ^= (unsigned char) *s++;
+	h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+static size_t diskcache_file_size(uint32_t nslots){
+    return DISKCACHE_HEADER_SIZE + (size_t) nslots * sizeof(diskcache_slot);
+}
+
+/* Write a fresh header and empty table. Caller holds the flock. */
+static int diskcache_format(int fd, uint32_t nslots){
+    diskcache_header h;
+
+    if(ftruncate(fd, 0) < 0 || ftruncate(fd, diskcache_file_size(nslots)) < 0){
+	perror("Error sizing cache file");
+	return DISKCACHE_FAILURE;
+    }
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, DISKCACHE_MAGIC, sizeof(h.magic));
+    h.version = DISKCACHE_VERSION;
+    h.header_size = DISKCACHE_HEADER_SIZE;
+    h.slot_size = sizeof(diskcache_slot);
+    h.nslots = nslots;
+    h.created = time(NULL);
+    if(pwrite(fd, &h, sizeof(h), 0) != (ssize_t) sizeof(h)){
+	perror("Error writing cache file header");
+	return DISKCACHE_FAILURE;
+    }
+    return DISKCACHE_SUCCESS;
+}
+
+/* Nonzero if the file starts with a header this build can use */
+static int diskcache_valid(int fd, diskcache_header* h){
+    struct stat st;
+
+    if(fstat(fd, &st) < 0 || st.st_size < DISKCACHE_HEADER_SIZE){
+	return 0;
+    }
+    if(pread(fd, h, sizeof(*h), 0) != (ssize_t) sizeof(*h)){
+	return 0;
+    }
+    return memcmp(h->magic, DISKCACHE_MAGIC, sizeof(h->magic)) == 0
+	&& h->version == DISKCACHE_VERSION
+	&& h->header_size == DISKCACHE_HEADER_SIZE
+	&& h->slot_size == sizeof(diskcache_slot)
+	&& h->nslots > 0 && (h->nslots & (h->nslots - 1)) == 0
+	&& (size_t) st.st_size >= diskcache_file_size(h->nslots);
+}
+
+int diskcache_open(diskcache* dc, const char* path, int nslots,
+		   int ttl, int negTtl){
+
+    diskcache_header h;
+    uint32_t n = 1;
+
+    if(nslots <= 0){
+	nslots = DISKCACHE_DEFAULT_SLOTS;
+    }
+    while(n < (uint32_t) nslots){
+	n <<= 1;
+    }
+
+    memset(dc, 0, sizeof(*dc));
+    dc->ttl = ttl;
+    dc->neg_ttl = negTtl;
+    dc->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if(dc->fd < 0){
+	perror("Error opening cache file");
+	return DISKCACHE_FAILURE;
+    }
+
+    /* only one process checks or (re)builds the layout at a time */
+    flock(dc->fd, LOCK_EX);
+    if(!diskcache_valid(dc->fd, &h)){
+	if(diskcache_format(dc->fd, n) == DISKCACHE_FAILURE
+	   || !diskcache_valid(dc->fd, &h)){
+	    flock(dc->fd, LOCK_UN);
+	    close(dc->fd);
+	    return DISKCACHE_FAILURE;
+	}
+    }
+    flock(dc->fd, LOCK_UN);
+
+    dc->map_size = diskcache_file_size(h.nslots);
+    dc->map = mmap(NULL, dc->map_size, PROT_READ | PROT_WRITE,
+		   MAP_SHARED, dc->fd, 0);
+    if(dc->map == MAP_FAILED){
+	perror("Error mapping cache file");
+	close(dc->fd);
+	return DISKCACHE_FAILURE;
+    }
+    dc->header = dc->map;
+    dc->slots = (diskcache_slot*) ((char*) dc->map + DISKCACHE_HEADER_SIZE);
+    dc->mask = h.nslots - 1;
+    pthread_mutex_init(&dc->write_lock, NULL);
+
+    return DISKCACHE_SUCCESS;
+}
+
+/* Copy a consistent snapshot of slot into out, retrying while a
+ * writer is mid-update. Returns 0 if the slot never settles (a
+ * writer died holding it), in which case it is treated as live
+ * but unusable. */
+static int diskcache_read_slot(diskcache_slot* slot, diskcache_slot* out){
+    unsigned int seq;
+    int tries;
+
+    for(tries = 0; tries < DISKCACHE_MAX_RETRY; tries++){
+	seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+	if(seq & 1){
+	    continue;
+	}
+	out->hash = slot->hash;
+	out->name_len = slot->name_len;
+	out->expires = slot->expires;
+	out->negative = slot->negative;
+	if(out->name_len <= DISKCACHE_NAME_MAX){
+	    memcpy(out->hostname, slot->hostname, out->name_len);
+	}
+	memcpy(out->ipstr, slot->ipstr, sizeof(out->ipstr));
+	atomic_thread_fence(memory_order_acquire);
+	if(atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq){
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+int diskcache_get(diskcache* dc, const char* hostname,
+		  char* ipstr, int maxSize){
+
+    uint64_t hash = diskcache_hash(hostname);
+    size_t len = strlen(hostname);
+    int64_t now = time(NULL);
+    diskcache_slot snap;
+    uint32_t i;
+
+    if(len > DISKCACHE_NAME_MAX){
+	atomic_fetch_add(&dc->misses, 1);
+	return DISKCACHE_MISS;
+    }
+
+    for(i = 0; i < DISKCACHE_MAX_PROBE; i++){
+	if(!diskcache_read_slot(&dc->slots[(hash + i) & dc->mask], &snap)){
+	    continue;
+	}
+	if(snap.hash == 0){
+	    /* never used: the name would have been placed here */
+	    break;
+	}
+	if(snap.hash != hash || snap.name_len != len
+	   || memcmp(snap.hostname, hostname, len) != 0){
+	    continue;
+	}
+	if(snap.expires <= now){
+	    break;
+	}
+	if(snap.negative){
+	    atomic_fetch_add(&dc->negative_hits, 1);
+	    return DISKCACHE_NEGATIVE;
+	}
+	snap.ipstr[sizeof(snap.ipstr)-1] = '\0';
+	strncpy(ipstr, snap.ipstr, maxSize);
+	ipstr[maxSize-1] = '\0';
+	atomic_fetch_add(&dc->hits, 1);
+	return DISKCACHE_HIT;
+    }
+
+    atomic_fetch_add(&dc->misses, 1);
+    return DISKCACHE_MISS;
+}
+
+/* Bytes of list to store: all of it, or up to the last
+ * separator that leaves room for the terminator */
+static size_t diskcache_fit_list(const char* list){
+    size_t len = strlen(list);
+    const char* sep;
+    const char* cut = NULL;
+
+    if(len <= DISKCACHE_ADDRS_MAX){
+	return len;
+    }
+    for(sep = strstr(list, UTIL_ADDR_SEP);
+	sep && (size_t) (sep - list) <= DISKCACHE_ADDRS_MAX;
+	sep = strstr(sep + 1, UTIL_ADDR_SEP)){
+	cut = sep;
+    }
+    return cut ? (size_t) (cut - list) : 0;
+}
+
+void diskcache_put(diskcache* dc, const char* hostname, const char* ipstr){
+
+    uint64_t hash = diskcache_hash(hostname);
+    size_t len = strlen(hostname);
+    int64_t now = time(NULL);
+    diskcache_slot* slot;
+    diskcache_slot* victim = NULL;
+    unsigned int seq;
+    uint32_t i;
+
+    if(len > DISKCACHE_NAME_MAX){
+	return;
+    }
+
+    pthread_mutex_lock(&dc->write_lock);
+    flock(dc->fd, LOCK_EX);
+
+    /* same name, else first unused or expired slot, else the
+     * live slot closest to expiry */
+    for(i = 0; i < DISKCACHE_MAX_PROBE; i++){
+	slot = &dc->slots[(hash + i) & dc->mask];
+	if(slot->hash == hash && slot->name_len == len
+	   && memcmp(slot->hostname, hostname, len) == 0){
+	    victim = slot;
+	    break;
+	}
+	if(slot->hash == 0 || slot->expires <= now){
+	    if(!victim || victim->expires > now){
+		victim = slot;
+	    }
+	    if(slot->hash == 0){
+		break;
+	    }
+	}
+	else if(!victim || (victim->expires > now
+			    && slot->expires < victim->expires)){
+	    victim = slot;
+	}
+    }
+
+    /* an odd seq means a writer died mid-update; step past it */
+    seq = atomic_load_explicit(&victim->seq, memory_order_relaxed);
+    seq += seq & 1;
+    atomic_store_explicit(&victim->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    victim->hash = hash;
+    victim->name_len = len;
+    memcpy(victim->hostname, hostname, len + 1);
+    victim->negative = (ipstr == NULL);
+    victim->expires = now + (ipstr ? dc->ttl : dc->neg_ttl);
+    memset(victim->ipstr, 0, sizeof(victim->ipstr));
+    if(ipstr){
+	memcpy(victim->ipstr, ipstr, diskcache_fit_list(ipstr));
+    }
+
+    atomic_store_explicit(&victim->seq, seq + 2, memory_order_release);
+    atomic_fetch_add(&dc->header->writes, 1);
+
+    flock(dc->fd, LOCK_UN);
+    pthread_mutex_unlock(&dc->write_lock);
+    atomic_fetch_add(&dc->writes, 1);
+}
+
+void diskcache_close(diskcache* dc){
+    munmap(dc->map, dc->map_size);
+    close(dc->fd);
+    pthread_mutex_destroy(&dc->write_lock);
+}
@@ -0,0 +1,115 @@
+/*
+ * File: diskcache.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a persistent hostname to IP
+ *      cache kept in a file and used through mmap. The file is
+ *      a versioned header followed by a fixed size open
+ *      addressing hash table, so a warm lookup touches one or
+ *      two pages and no syscalls.
+ *
+ *      Any number of processes may share one file. Writers take
+ *      an exclusive flock (plus a mutex inside the process);
+ *      readers take no lock and validate each slot with its
+ *      sequence counter instead.
+ *  
+ */
+
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "util.h"
+
+#define DISKCACHE_FAILURE -1
+#define DISKCACHE_SUCCESS 0
+
+/* diskcache_get results, same meaning as dnscache_get */
+#define DISKCACHE_MISS 0
+#define DISKCACHE_HIT 1
+#define DISKCACHE_NEGATIVE 2
+
+#define DISKCACHE_MAGIC "MLCACHE"
+#define DISKCACHE_VERSION 2
+#define DISKCACHE_DEFAULT_SLOTS 65536
+#define DISKCACHE_NAME_MAX 255
+/* longest address list kept per name; longer lists lose
+ * their trailing addresses */
+#define DISKCACHE_ADDRS_MAX 255
+/* slots examined from the home slot before giving up */
+#define DISKCACHE_MAX_PROBE 16
+#define DISKCACHE_HEADER_SIZE 4096
+/* reads of a slot a writer is holding before skipping it */
+#define DISKCACHE_MAX_RETRY 1000
+
+typedef struct diskcache_header_s{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t nslots;
+    int64_t created;
+    atomic_uint_least64_t writes;
+} diskcache_header;
+
+/* seq is odd while a writer is filling the slot */
+typedef struct diskcache_slot_s{
+    atomic_uint seq;
+    uint32_t name_len;
+    uint64_t hash;
+    int64_t expires;
+    uint8_t negative;
+    char ipstr[DISKCACHE_ADDRS_MAX + 1];
+    char hostname[DISKCACHE_NAME_MAX + 1];
+} diskcache_slot;
+
+typedef struct diskcache_s{
+    int fd;
+    void* map;
+    size_t map_size;
+    diskcache_header* header;
+    diskcache_slot* slots;
+    uint32_t mask;
+    int ttl;
+    int neg_ttl;
+    pthread_mutex_t write_lock;
+    atomic_long hits;
+    atomic_long negative_hits;
+    atomic_long misses;
+    atomic_long writes;
+} diskcache;
+
+/* Function to open (or create) the cache file at path
+ * nslots sizes a new file and is rounded up to a power of two
+ * (default if <= 0); an existing file keeps its own size.
+ * A file with another version is rebuilt empty.
+ * ttl and negTtl are in seconds
+ * Returns DISKCACHE_SUCCESS or DISKCACHE_FAILURE
+ */
+int diskcache_open(diskcache* dc, const char* path, int nslots,
+		   int ttl, int negTtl);
+
+/* Function to look hostname up without taking any lock
+ * On DISKCACHE_HIT copies the cached address list into ipstr
+ * Returns DISKCACHE_HIT, DISKCACHE_NEGATIVE or DISKCACHE_MISS
+ */
+int diskcache_get(diskcache* dc, const char* hostname,
+		  char* ipstr, int maxSize);
+
+/* Function to store a lookup result under the writer lock
+ * ipstr NULL records a failed lookup; an address list is cut
+ * at a UTIL_ADDR_SEP to fit DISKCACHE_ADDRS_MAX
+ * Names longer than DISKCACHE_NAME_MAX are not cached
+ */
+void diskcache_put(diskcache* dc, const char* hostname, const char* ipstr);
+
+/* Function to unmap and close the cache file */
+void diskcache_close(diskcache* dc);
+
+#endif
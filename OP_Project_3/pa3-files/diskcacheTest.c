@@ -0,0 +1,157 @@
+/*
+ * File: diskcacheTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the persistent mmap
+ *      cache file, including several processes reading and
+ *      writing one small file at once.
+ *  
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "diskcache.h"
+
+#define TEST_PROCS 4
+#define TEST_ROUNDS 20000
+#define TEST_NAMES 500
+
+/* Each name always maps to the same address, so any hit with a
+ * different one means a torn read */
+static void test_name(int i, char* name, char* ip){
+    sprintf(name, "host%d.example.com", i);
+    sprintf(ip, "10.%d.%d.%d", i % 7, i / 256, i % 256);
+}
+
+static int child(const char* path, int id){
+    diskcache dc;
+    char name[64], ip[INET6_ADDRSTRLEN], got[INET6_ADDRSTRLEN];
+    int r, i, errors = 0;
+
+    if(diskcache_open(&dc, path, 0, 60, 60) == DISKCACHE_FAILURE){
+	return 1;
+    }
+    srand(id + 1);
+    for(r=0; r<TEST_ROUNDS; r++){
+	i = rand() % TEST_NAMES;
+	test_name(i, name, ip);
+	if(rand() % 4 == 0){
+	    diskcache_put(&dc, name, ip);
+	}
+	else if(diskcache_get(&dc, name, got, sizeof(got)) == DISKCACHE_HIT
+		&& strcmp(got, ip) != 0){
+	    errors++;
+	}
+    }
+    diskcache_close(&dc);
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    /* Setup local vars */
+    char path[] = "/tmp/diskcacheTest.XXXXXX";
+    diskcache dc;
+    char ip[INET6_ADDRSTRLEN];
+    diskcache_header h;
+    pid_t pids[TEST_PROCS];
+    int i, status;
+    int fd = mkstemp(path);
+
+    if(fd < 0){
+	perror("error: mkstemp");
+	return EXIT_FAILURE;
+    }
+    close(fd);
+
+    /* Create on an empty file */
+    if(diskcache_open(&dc, path, 1000, 60, 0) == DISKCACHE_FAILURE){
+	fprintf(stderr,
+		"error: diskcache_open failed!\n");
+	return EXIT_FAILURE;
+    }
+    if(dc.mask != 1023){
+	fprintf(stderr,
+		"error: slot count not rounded to 1024\n");
+    }
+
+    /* Test miss, then hit after put */
+    if(diskcache_get(&dc, "example.com", ip, sizeof(ip)) != DISKCACHE_MISS){
+	fprintf(stderr,
+		"error: empty cache file should miss\n");
+    }
+    diskcache_put(&dc, "example.com", "93.184.216.34");
+    if(diskcache_get(&dc, "example.com", ip, sizeof(ip)) != DISKCACHE_HIT
+       || strcmp(ip, "93.184.216.34") != 0){
+	fprintf(stderr,
+		"error: cached address not returned\n");
+    }
+
+    /* Test that negative entries use their own ttl (0 here) */
+    diskcache_put(&dc, "bad.invalid", NULL);
+    if(diskcache_get(&dc, "bad.invalid", ip, sizeof(ip)) != DISKCACHE_MISS){
+	fprintf(stderr,
+		"error: negative entry outlived its ttl\n");
+    }
+    diskcache_close(&dc);
+
+    /* Test persistence and negative hits across a reopen */
+    diskcache_open(&dc, path, 0, 60, 60);
+    if(dc.mask != 1023){
+	fprintf(stderr,
+		"error: reopen did not keep the file's slot count\n");
+    }
+    if(diskcache_get(&dc, "example.com", ip, sizeof(ip)) != DISKCACHE_HIT
+       || strcmp(ip, "93.184.216.34") != 0){
+	fprintf(stderr,
+		"error: entry lost across reopen\n");
+    }
+    diskcache_put(&dc, "bad.invalid", NULL);
+    if(diskcache_get(&dc, "bad.invalid", ip, sizeof(ip)) != DISKCACHE_NEGATIVE){
+	fprintf(stderr,
+		"error: failed lookup not cached as negative\n");
+    }
+    diskcache_close(&dc);
+
+    /* Test that a file from another version is rebuilt */
+    fd = open(path, O_RDWR);
+    pread(fd, &h, sizeof(h), 0);
+    h.version = DISKCACHE_VERSION + 1;
+    pwrite(fd, &h, sizeof(h), 0);
+    close(fd);
+    diskcache_open(&dc, path, 64, 60, 60);
+    if(diskcache_get(&dc, "example.com", ip, sizeof(ip)) != DISKCACHE_MISS
+       || dc.header->version != DISKCACHE_VERSION || dc.mask != 63){
+	fprintf(stderr,
+		"error: old version file not rebuilt\n");
+    }
+    diskcache_close(&dc);
+
+    /* Test several processes hammering a 64 slot file */
+    for(i=0; i<TEST_PROCS; i++){
+	if((pids[i] = fork()) == 0){
+	    _exit(child(path, i));
+	}
+    }
+    for(i=0; i<TEST_PROCS; i++){
+	waitpid(pids[i], &status, 0);
+	if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+	    fprintf(stderr,
+		    "error: process %d saw a torn entry\n", i);
+	}
+    }
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,650 @@
+/*
+ * File: dnsasync.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the asynchronous DNS engine. Each event
+ *      loop owns one connected UDP socket per nameserver, a
+ *      table of in-flight queries indexed by the 16 bit query
+ *      ID, and a list of those queries in deadline order. Every
+ *      query gets the same timeout, so appending on send keeps
+ *      that list sorted and expiry only looks at its head.
+ *
+ *      Submitters append to a loop's mutex protected list and
+ *      poke its eventfd; everything else happens on the loop
+ *      thread without locks.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "dnsasync.h"
+
+#define DNSASYNC_EVENTS 64
+#define DNSASYNC_SOCKBUF (4 * 1024 * 1024)
+#define DNSASYNC_RESOLV_CONF "/etc/resolv.conf"
+
+/* DNS header flag bits and codes used here */
+#define DNS_FLAG_QR 0x8000
+#define DNS_FLAG_TC 0x0200
+#define DNS_FLAG_RD 0x0100
+#define DNS_RCODE_MASK 0x000F
+#define DNS_RCODE_NOERROR 0
+#define DNS_RCODE_SERVFAIL 2
+#define DNS_RCODE_NXDOMAIN 3
+#define DNS_RCODE_REFUSED 5
+#define DNS_TYPE_A 1
+#define DNS_CLASS_IN 1
+#define DNS_HEADER_SIZE 12
+
+static long long dnsasync_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint16_t get16(const unsigned char* p){
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static void put16(unsigned char* p, uint16_t v){
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+/* Build a recursive query for hostname's A record into buf.
+ * Returns the packet length, or -1 if hostname is not a valid
+ * DNS name. */
+static int dnsasync_build_query(unsigned char* buf, int size,
+				uint16_t id, const char* hostname){
+    unsigned char* p = buf + DNS_HEADER_SIZE;
+    unsigned char* end = buf + size;
+    const char* label = hostname;
+    const char* dot;
+    size_t len;
+
+    if(size < DNS_HEADER_SIZE + 5 || strlen(hostname) > 253){
+	return -1;
+    }
+    memset(buf, 0, DNS_HEADER_SIZE);
+    put16(buf, id);
+    put16(buf + 2, DNS_FLAG_RD);
+    put16(buf + 4, 1);
+
+    while(*label){
+	dot = strchr(label, '.');
+	len = dot ? (size_t) (dot - label) : strlen(label);
+	if(len == 0 || len > 63 || p + len + 1 + 5 > end){
+	    return -1;
+	}
+	*p++ = (unsigned char) len;
+	memcpy(p, label, len);
+	p += len;
+	label += len;
+	if(*label == '.'){
+	    label++;
+	}
+    }
+    if(p == buf + DNS_HEADER_SIZE){
+	return -1;
+    }
+    *p++ = 0;
+    put16(p, DNS_TYPE_A);
+    put16(p + 2, DNS_CLASS_IN);
+    return (int) (p + 4 - buf);
+}
+
+/* Offset just past the (possibly compressed) name at off, or -1 */
+static int dnsasync_skip_name(const unsigned char* buf, int len, int off){
+    while(off < len){
+	if(buf[off] == 0){
+	    return off + 1;
+	}
+	if((buf[off] & 0xC0) == 0xC0){
+	    return off + 2 <= len ? off + 2 : -1;
+	}
+	off += buf[off] + 1;
+    }
+    return -1;
+}
+
+/* Parse a server entry: host, host:port or [v6host]:port */
+static int dnsasync_parse_server(const char* entry, struct sockaddr_storage* ss,
+				 socklen_t* sslen){
+    char host[INET6_ADDRSTRLEN + 2];
+    const char* port = NULL;
+    const char* close;
+    size_t hlen;
+    int portnum = DNSASYNC_PORT;
+    struct sockaddr_in* sin = (struct sockaddr_in*) ss;
+    struct sockaddr_in6* sin6 = (struct sockaddr_in6*) ss;
+
+    if(entry[0] == '['){
+	close = strchr(entry, ']');
+	if(!close){
+	    return DNSASYNC_FAILURE;
+	}
+	hlen = close - entry - 1;
+	entry++;
+	if(close[1] == ':'){
+	    port = close + 2;
+	}
+    }
+    else{
+	port = strchr(entry, ':');
+	/* more than one colon: bare IPv6 address, no port */
+	if(port && strchr(port + 1, ':')){
+	    port = NULL;
+	}
+	hlen = port ? (size_t) (port - entry) : strlen(entry);
+	if(port){
+	    port++;
+	}
+    }
+    if(hlen == 0 || hlen >= sizeof(host)){
+	return DNSASYNC_FAILURE;
+    }
+    memcpy(host, entry, hlen);
+    host[hlen] = '\0';
+    if(port){
+	portnum = atoi(port);
+	if(portnum <= 0 || portnum > 65535){
+	    return DNSASYNC_FAILURE;
+	}
+    }
+
+    memset(ss, 0, sizeof(*ss));
+    if(inet_pton(AF_INET, host, &sin->sin_addr) == 1){
+	sin->sin_family = AF_INET;
+	sin->sin_port = htons(portnum);
+	*sslen = sizeof(*sin);
+	return DNSASYNC_SUCCESS;
+    }
+    if(inet_pton(AF_INET6, host, &sin6->sin6_addr) == 1){
+	sin6->sin6_family = AF_INET6;
+	sin6->sin6_port = htons(portnum);
+	*sslen = sizeof(*sin6);
+	return DNSASYNC_SUCCESS;
+    }
+    return DNSASYNC_FAILURE;
+}
+
+static int dnsasync_add_server(dnsasync* e, const char* entry){
+    if(e->nservers == DNSASYNC_MAX_SERVERS){
+	return DNSASYNC_SUCCESS;
+    }
+    if(dnsasync_parse_server(entry, &e->servers[e->nservers],
+			     &e->server_lens[e->nservers]) == DNSASYNC_FAILURE){
+	fprintf(stderr, "Bad nameserver address: %s\n", entry);
+	return DNSASYNC_FAILURE;
+    }
+    e->nservers++;
+    return DNSASYNC_SUCCESS;
+}
+
+static int dnsasync_read_resolv_conf(dnsasync* e){
+    FILE* fp = fopen(DNSASYNC_RESOLV_CONF, "r");
+    char line[256];
+    char addr[INET6_ADDRSTRLEN + 2];
+
+    if(!fp){
+	perror("Error opening " DNSASYNC_RESOLV_CONF);
+	return DNSASYNC_FAILURE;
+    }
+    while(fgets(line, sizeof(line), fp)){
+	if(sscanf(line, " nameserver %47s", addr) == 1){
+	    /* link local scope ids are not supported; skip them */
+	    if(!strchr(addr, '%')){
+		dnsasync_add_server(e, addr);
+	    }
+	}
+    }
+    fclose(fp);
+    return DNSASYNC_SUCCESS;
+}
+
+/* Remove q from its loop's tables and hand its result back */
+static void dnsasync_finish(dnsasync_loop* loop, dnsasync_query* q,
+			    int status, const char* ipstr){
+    dnsasync* e = loop->engine;
+
+    q->tprev->tnext = q->tnext;
+    q->tnext->tprev = q->tprev;
+    /* a query that never got an ID must not free another's */
+    if(loop->by_id[q->id] == q){
+	loop->by_id[q->id] = NULL;
+    }
+
+    atomic_fetch_add(status == UTIL_SUCCESS ? &e->answered : &e->failed, 1);
+    q->cb(q->arg, status, ipstr);
+    free(q);
+
+    atomic_fetch_sub(&loop->held, 1);
+    sem_post(&e->slots);
+    if(atomic_fetch_sub(&e->inflight, 1) == 1){
+	pthread_mutex_lock(&e->idle_lock);
+	pthread_cond_broadcast(&e->idle);
+	pthread_mutex_unlock(&e->idle_lock);
+    }
+}
+
+/* (Re)send q to its current server and move it to the back of
+ * the deadline list */
+static void dnsasync_send(dnsasync_loop* loop, dnsasync_query* q){
+    dnsasync* e = loop->engine;
+
+    q->tprev->tnext = q->tnext;
+    q->tnext->tprev = q->tprev;
+    q->deadline_ns = dnsasync_now_ns() + (long long) e->timeout_ms * 1000000LL;
+    q->tprev = loop->timeouts.tprev;
+    q->tnext = &loop->timeouts;
+    loop->timeouts.tprev->tnext = q;
+    loop->timeouts.tprev = q;
+
+    /* a failed send is just a lost packet: the timeout retries it */
+    send(loop->socks[q->server], q->packet, q->packet_len, MSG_DONTWAIT);
+    atomic_fetch_add(q->tries ? &e->resent : &e->sent, 1);
+    q->tries++;
+}
+
+/* Retry q on the next server, or fail it once out of tries */
+static void dnsasync_retry(dnsasync_loop* loop, dnsasync_query* q){
+    dnsasync* e = loop->engine;
+
+    if(q->tries > e->retries){
+	dnsasync_finish(loop, q, UTIL_FAILURE, NULL);
+	return;
+    }
+    q->server = (q->server + 1) % e->nservers;
+    dnsasync_send(loop, q);
+}
+
+/* Give a newly submitted query a free ID and send it. A loop holds
+ * at most DNSASYNC_LOOP_INFLIGHT queries, so one is always free;
+ * the probe still stops after every ID, failing the query. */
+static void dnsasync_start(dnsasync_loop* loop, dnsasync_query* q){
+    uint16_t id = (uint16_t) rand_r(&loop->rand_state);
+    int probed = 0;
+
+    while(loop->by_id[id] && probed < DNSASYNC_IDS){
+	id++;
+	probed++;
+    }
+    q->id = id;
+    q->tprev = q->tnext = q;
+    if(probed == DNSASYNC_IDS){
+	dnsasync_finish(loop, q, UTIL_FAILURE, NULL);
+	return;
+    }
+    put16(q->packet, id);
+    loop->by_id[id] = q;
+    dnsasync_send(loop, q);
+}
+
+/* Match one reply to its query and complete or retry it */
+static void dnsasync_handle_reply(dnsasync_loop* loop,
+				  const unsigned char* buf, int len){
+    dnsasync* e = loop->engine;
+    dnsasync_query* q;
+    uint16_t flags, ancount, type, rdlen;
+    int qlen, off, i, n;
+    int used = 0;
+    char ipstr[INET6_ADDRSTRLEN];
+    char list[UTIL_ADDRLIST_SIZE];
+
+    if(len < DNS_HEADER_SIZE){
+	return;
+    }
+    q = loop->by_id[get16(buf)];
+    flags = get16(buf + 2);
+    qlen = q ? q->packet_len - DNS_HEADER_SIZE : 0;
+
+    /* must be a reply to a live ID carrying our exact question */
+    if(!q || !(flags & DNS_FLAG_QR) || get16(buf + 4) != 1
+       || len < DNS_HEADER_SIZE + qlen
+       || strncasecmp((const char*) buf + DNS_HEADER_SIZE,
+		      (const char*) q->packet + DNS_HEADER_SIZE,
+		      qlen - 4) != 0
+       || memcmp(buf + DNS_HEADER_SIZE + qlen - 4,
+		 q->packet + q->packet_len - 4, 4) != 0){
+	atomic_fetch_add(&e->mismatched, 1);
+	return;
+    }
+
+    switch(flags & DNS_RCODE_MASK){
+    case DNS_RCODE_NOERROR:
+	break;
+    case DNS_RCODE_SERVFAIL:
+    case DNS_RCODE_REFUSED:
+	dnsasync_retry(loop, q);
+	return;
+    default:
+	dnsasync_finish(loop, q, UTIL_FAILURE, NULL);
+	return;
+    }
+    if(flags & DNS_FLAG_TC){
+	dnsasync_finish(loop, q, UTIL_FAILURE, NULL);
+	return;
+    }
+
+    /* every A record in the answer section */
+    ancount = get16(buf + 6);
+    off = DNS_HEADER_SIZE + qlen;
+    for(i = 0; i < ancount; i++){
+	off = dnsasync_skip_name(buf, len, off);
+	if(off < 0 || off + 10 > len){
+	    break;
+	}
+	type = get16(buf + off);
+	rdlen = get16(buf + off + 8);
+	off += 10;
+	if(off + rdlen > len){
+	    break;
+	}
+	if(type == DNS_TYPE_A && rdlen == 4
+	   && inet_ntop(AF_INET, buf + off, ipstr, sizeof(ipstr))){
+	    n = snprintf(list + used, sizeof(list) - used, "%s%s",
+			 used ? UTIL_ADDR_SEP : "", ipstr);
+	    if(n >= (int) sizeof(list) - used){
+		list[used] = '\0';
+		break;
+	    }
+	    used += n;
+	}
+	off += rdlen;
+    }
+    /* NOERROR with no address (or a malformed answer) fails */
+    dnsasync_finish(loop, q, used ? UTIL_SUCCESS : UTIL_FAILURE,
+		    used ? list : NULL);
+}
+
+static void dnsasync_take_submissions(dnsasync_loop* loop){
+    dnsasync_query* q;
+    dnsasync_query* next;
+    uint64_t count;
+
+    if(read(loop->evfd, &count, sizeof(count)) < 0){
+	/* nothing pending; the list check below is still right */
+    }
+    pthread_mutex_lock(&loop->lock);
+    q = loop->submit_head;
+    loop->submit_head = loop->submit_tail = NULL;
+    pthread_mutex_unlock(&loop->lock);
+
+    for(; q; q = next){
+	next = q->next;
+	dnsasync_start(loop, q);
+    }
+}
+
+static void* dnsasync_loop_run(void* arg){
+    dnsasync_loop* loop = arg;
+    dnsasync* e = loop->engine;
+    struct epoll_event events[DNSASYNC_EVENTS];
+    unsigned char buf[DNSASYNC_MAX_PACKET];
+    dnsasync_query* q;
+    long long now;
+    int timeout, n, i, len;
+
+    for(;;){
+	if(loop->timeouts.tnext != &loop->timeouts){
+	    now = dnsasync_now_ns();
+	    timeout = (int) ((loop->timeouts.tnext->deadline_ns - now
+			      + 999999) / 1000000);
+	    if(timeout < 0){
+		timeout = 0;
+	    }
+	}
+	else if(atomic_load(&e->stop)){
+	    break;
+	}
+	else{
+	    timeout = -1;
+	}
+
+	n = epoll_wait(loop->epfd, events, DNSASYNC_EVENTS, timeout);
+	for(i = 0; i < n; i++){
+	    if(events[i].data.fd == loop->evfd){
+		dnsasync_take_submissions(loop);
+		continue;
+	    }
+	    /* drain the socket; refused/unreachable errors are ignored */
+	    while((len = recv(events[i].data.fd, buf, sizeof(buf),
+			      MSG_DONTWAIT)) >= 0){
+		dnsasync_handle_reply(loop, buf, len);
+	    }
+	}
+
+	now = dnsasync_now_ns();
+	while((q = loop->timeouts.tnext) != &loop->timeouts
+	      && q->deadline_ns <= now){
+	    atomic_fetch_add(&e->timeouts_hit, 1);
+	    dnsasync_retry(loop, q);
+	}
+    }
+    return NULL;
+}
+
+static int dnsasync_loop_init(dnsasync* e, dnsasync_loop* loop, int index){
+    struct epoll_event ev;
+    int bufsize = DNSASYNC_SOCKBUF;
+    int s;
+
+    memset(loop, 0, sizeof(*loop));
+    loop->engine = e;
+    loop->rand_state = (unsigned int) (dnsasync_now_ns() ^ (index * 7919));
+    loop->timeouts.tprev = loop->timeouts.tnext = &loop->timeouts;
+    pthread_mutex_init(&loop->lock, NULL);
+    loop->by_id = calloc(DNSASYNC_IDS, sizeof(dnsasync_query*));
+    loop->epfd = epoll_create1(0);
+    loop->evfd = eventfd(0, EFD_NONBLOCK);
+    if(!loop->by_id || loop->epfd < 0 || loop->evfd < 0){
+	perror("Error setting up DNS event loop");
+	return DNSASYNC_FAILURE;
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = loop->evfd;
+    epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->evfd, &ev);
+
+    for(s = 0; s < e->nservers; s++){
+	loop->socks[s] = socket(e->servers[s].ss_family,
+				SOCK_DGRAM | SOCK_NONBLOCK, 0);
+	if(loop->socks[s] < 0
+	   || connect(loop->socks[s], (struct sockaddr*) &e->servers[s],
+		      e->server_lens[s]) < 0){
+	    perror("Error opening DNS socket");
+	    return DNSASYNC_FAILURE;
+	}
+	/* a burst of answers must not overflow the default buffer;
+	 * the kernel caps this at net.core.rmem_max */
+	setsockopt(loop->socks[s], SOL_SOCKET, SO_RCVBUF,
+		   &bufsize, sizeof(bufsize));
+	ev.data.fd = loop->socks[s];
+	epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->socks[s], &ev);
+    }
+
+    if(pthread_create(&loop->thread, NULL, dnsasync_loop_run, loop)){
+	fprintf(stderr, "Error creating DNS event loop thread\n");
+	return DNSASYNC_FAILURE;
+    }
+    return DNSASYNC_SUCCESS;
+}
+
+int dnsasync_init(dnsasync* e, const char* servers, int loops,
+		  int maxInflight, int timeoutMs, int retries){
+
+    char* list;
+    char* entry;
+    char* save;
+    int i;
+
+    memset(e, 0, sizeof(*e));
+    e->nloops = loops > 0 ? loops : DNSASYNC_DEFAULT_LOOPS;
+    e->max_inflight = maxInflight > 0 ? maxInflight : DNSASYNC_DEFAULT_INFLIGHT;
+    e->timeout_ms = timeoutMs > 0 ? timeoutMs : DNSASYNC_DEFAULT_TIMEOUT_MS;
+    e->retries = retries >= 0 ? retries : DNSASYNC_DEFAULT_RETRIES;
+
+    /* every loop needs a free ID for each query it may hold */
+    if(e->max_inflight > e->nloops * DNSASYNC_LOOP_INFLIGHT){
+	e->max_inflight = e->nloops * DNSASYNC_LOOP_INFLIGHT;
+    }
+
+    if(servers){
+	list = strdup(servers);
+	for(entry = strtok_r(list, ",", &save); entry;
+	    entry = strtok_r(NULL, ",", &save)){
+	    if(dnsasync_add_server(e, entry) == DNSASYNC_FAILURE){
+		free(list);
+		return DNSASYNC_FAILURE;
+	    }
+	}
+	free(list);
+    }
+    else if(dnsasync_read_resolv_conf(e) == DNSASYNC_FAILURE){
+	return DNSASYNC_FAILURE;
+    }
+    if(e->nservers == 0){
+	fprintf(stderr, "No nameservers configured\n");
+	return DNSASYNC_FAILURE;
+    }
+
+    sem_init(&e->slots, 0, e->max_inflight);
+    pthread_mutex_init(&e->idle_lock, NULL);
+    pthread_cond_init(&e->idle, NULL);
+
+    e->loops = calloc(e->nloops, sizeof(dnsasync_loop));
+    if(!e->loops){
+	perror("Error allocating DNS event loops");
+	return DNSASYNC_FAILURE;
+    }
+    for(i = 0; i < e->nloops; i++){
+	if(dnsasync_loop_init(e, &e->loops[i], i) == DNSASYNC_FAILURE){
+	    return DNSASYNC_FAILURE;
+	}
+    }
+    return DNSASYNC_SUCCESS;
+}
+
+int dnsasync_set_rate(dnsasync* e, double rate, int burst){
+    int s;
+
+    for(s = 0; s < e->nservers; s++){
+	if(throttle_init(&e->limits[s], rate, burst, 0, 0, 0) == THROTTLE_FAILURE){
+	    return DNSASYNC_FAILURE;
+	}
+    }
+    return DNSASYNC_SUCCESS;
+}
+
+void dnsasync_submit(dnsasync* e, const char* hostname,
+		     dnsasync_callback cb, void* arg){
+
+    dnsasync_query* q = malloc(sizeof(*q));
+    dnsasync_loop* loop;
+    uint64_t one = 1;
+    int was_empty;
+
+    if(!q){
+	cb(arg, UTIL_FAILURE, NULL);
+	return;
+    }
+    q->packet_len = dnsasync_build_query(q->packet, sizeof(q->packet),
+					 0, hostname);
+    if(q->packet_len < 0){
+	free(q);
+	atomic_fetch_add(&e->failed, 1);
+	cb(arg, UTIL_FAILURE, NULL);
+	return;
+    }
+    q->cb = cb;
+    q->arg = arg;
+    q->tries = 0;
+    q->next = NULL;
+
+    /* wait for the token before taking a slot, so a slow bucket
+       does not hold slots other servers could use */
+    q->server = atomic_fetch_add(&e->next_server, 1) % e->nservers;
+    throttle_enter(&e->limits[q->server]);
+
+    while(sem_wait(&e->slots) != 0){
+    }
+    atomic_fetch_add(&e->inflight, 1);
+
+    /* deal it to the next loop with room: a loop whose server is
+       timing out fills up while the others drain. Our slot means
+       the loops hold fewer than max_inflight, so one has room. */
+    for(;;){
+	loop = &e->loops[atomic_fetch_add(&e->next_loop, 1) % e->nloops];
+	if(atomic_fetch_add(&loop->held, 1) < DNSASYNC_LOOP_INFLIGHT){
+	    break;
+	}
+	atomic_fetch_sub(&loop->held, 1);
+	if(atomic_load(&e->next_loop) % e->nloops == 0){
+	    sched_yield();
+	}
+    }
+    pthread_mutex_lock(&loop->lock);
+    was_empty = (loop->submit_head == NULL);
+    if(was_empty){
+	loop->submit_head = q;
+    }
+    else{
+	loop->submit_tail->next = q;
+    }
+    loop->submit_tail = q;
+    pthread_mutex_unlock(&loop->lock);
+
+    /* the loop drains the whole list per wakeup */
+    if(was_empty && write(loop->evfd, &one, sizeof(one)) < 0){
+	perror("Error waking DNS event loop");
+    }
+}
+
+void dnsasync_drain(dnsasync* e){
+    pthread_mutex_lock(&e->idle_lock);
+    while(atomic_load(&e->inflight) > 0){
+	pthread_cond_wait(&e->idle, &e->idle_lock);
+    }
+    pthread_mutex_unlock(&e->idle_lock);
+}
+
+void dnsasync_cleanup(dnsasync* e){
+    uint64_t one = 1;
+    int i, s;
+
+    dnsasync_drain(e);
+    atomic_store(&e->stop, 1);
+    for(i = 0; i < e->nloops; i++){
+	if(write(e->loops[i].evfd, &one, sizeof(one)) < 0){
+	    perror("Error waking DNS event loop");
+	}
+    }
+    for(i = 0; i < e->nloops; i++){
+	dnsasync_loop* loop = &e->loops[i];
+	pthread_join(loop->thread, NULL);
+	for(s = 0; s < e->nservers; s++){
+	    close(loop->socks[s]);
+	}
+	close(loop->evfd);
+	close(loop->epfd);
+	free(loop->by_id);
+	pthread_mutex_destroy(&loop->lock);
+    }
+    free(e->loops);
+    for(s = 0; s < e->nservers; s++){
+	throttle_cleanup(&e->limits[s]);
+    }
+    sem_destroy(&e->slots);
+    pthread_mutex_destroy(&e->idle_lock);
+    pthread_cond_destroy(&e->idle);
+}
@@ -0,0 +1,152 @@
+/*
+ * File: dnsasync.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for an asynchronous DNS engine.
+ *      Instead of one blocked thread per getaddrinfo() call, a
+ *      few event loop threads send raw A queries over
+ *      non-blocking UDP sockets and wait for answers with
+ *      epoll, so thousands of queries can be in flight at once.
+ *      Answers are matched to queries by ID and question, lost
+ *      packets are retried on the next nameserver, and queries
+ *      that run out of retries fail with a timeout.
+ *
+ *      Each nameserver can be given its own token bucket with
+ *      dnsasync_set_rate(); new queries are dealt to the servers
+ *      in turn and wait for a token from theirs. Retries are not
+ *      held back, so a server that stops answering does not stall
+ *      the others.
+ *
+ *      Only A records are requested, and truncated (TC)
+ *      answers count as failures since there is no TCP
+ *      fallback.
+ *
+ */
+
+#ifndef DNSASYNC_H
+#define DNSASYNC_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "util.h"
+#include "throttle.h"
+
+#define DNSASYNC_FAILURE -1
+#define DNSASYNC_SUCCESS 0
+
+#define DNSASYNC_PORT 53
+#define DNSASYNC_MAX_SERVERS 8
+#define DNSASYNC_MAX_PACKET 512
+#define DNSASYNC_IDS 65536
+/* queries one loop may hold; half its IDs, so a free one is near */
+#define DNSASYNC_LOOP_INFLIGHT (DNSASYNC_IDS / 2)
+#define DNSASYNC_DEFAULT_LOOPS 1
+#define DNSASYNC_DEFAULT_INFLIGHT 1024
+#define DNSASYNC_DEFAULT_TIMEOUT_MS 2000
+#define DNSASYNC_DEFAULT_RETRIES 2
+
+/* Called once per submitted query, on an event loop thread.
+ * status is UTIL_SUCCESS with every A record in ipstr, joined
+ * like dnsresult_join(), or UTIL_FAILURE with ipstr NULL. */
+typedef void (*dnsasync_callback)(void* arg, int status, const char* ipstr);
+
+typedef struct dnsasync_query_s{
+    struct dnsasync_query_s* next;          /* submission list */
+    struct dnsasync_query_s* tprev;         /* timeout list, in deadline order */
+    struct dnsasync_query_s* tnext;
+    dnsasync_callback cb;
+    void* arg;
+    long long deadline_ns;
+    int tries;
+    int server;
+    uint16_t id;
+    int packet_len;
+    unsigned char packet[DNSASYNC_MAX_PACKET];
+} dnsasync_query;
+
+struct dnsasync_s;
+
+/* One event loop thread and everything only it touches, apart
+ * from the submission list and the held count */
+typedef struct dnsasync_loop_s{
+    struct dnsasync_s* engine;
+    pthread_t thread;
+    int epfd;
+    int evfd;
+    int socks[DNSASYNC_MAX_SERVERS];
+    pthread_mutex_t lock;
+    dnsasync_query* submit_head;
+    dnsasync_query* submit_tail;
+    dnsasync_query timeouts;                /* list sentinel */
+    dnsasync_query** by_id;
+    atomic_int held;                        /* submitted, not finished */
+    unsigned int rand_state;
+} dnsasync_loop;
+
+typedef struct dnsasync_s{
+    struct sockaddr_storage servers[DNSASYNC_MAX_SERVERS];
+    socklen_t server_lens[DNSASYNC_MAX_SERVERS];
+    int nservers;
+    throttle limits[DNSASYNC_MAX_SERVERS];
+    atomic_uint next_server;
+    dnsasync_loop* loops;
+    int nloops;
+    int timeout_ms;
+    int retries;
+    int max_inflight;
+    sem_t slots;
+    atomic_uint next_loop;
+    atomic_int stop;
+    atomic_long inflight;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle;
+    /* counters */
+    atomic_long sent;
+    atomic_long resent;
+    atomic_long answered;
+    atomic_long failed;
+    atomic_long timeouts_hit;
+    atomic_long mismatched;
+} dnsasync;
+
+/* Function to start the engine
+ * servers is a comma separated list of host[:port] or
+ * [v6host]:port entries; NULL reads /etc/resolv.conf
+ * loops, maxInflight, timeoutMs and retries use the defaults
+ * above when <= 0 (retries when < 0)
+ * Returns DNSASYNC_SUCCESS or DNSASYNC_FAILURE
+ */
+int dnsasync_init(dnsasync* e, const char* servers, int loops,
+		  int maxInflight, int timeoutMs, int retries);
+
+/* Function to allow each nameserver rate queries a second, up
+ * to burst at once; call it before the first submit
+ * Returns DNSASYNC_SUCCESS or DNSASYNC_FAILURE
+ */
+int dnsasync_set_rate(dnsasync* e, double rate, int burst);
+
+/* Function to queue an A lookup for hostname
+ * Blocks while maxInflight queries are outstanding, or for its
+ * nameserver's next token. hostname
+ * is copied into the query, cb runs exactly once.
+ */
+void dnsasync_submit(dnsasync* e, const char* hostname,
+		     dnsasync_callback cb, void* arg);
+
+/* Function to wait until every submitted query has completed */
+void dnsasync_drain(dnsasync* e);
+
+/* Function to stop the loops and free the engine
+ * Outstanding queries are drained first
+ */
+void dnsasync_cleanup(dnsasync* e);
+
+#endif
@@ -0,0 +1,274 @@
+/*
+ * File: dnsasyncTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the async DNS engine.
+ *      Each test starts ./stub-dns on a free loopback port with
+ *      a different misbehaviour (delay, packet loss, bogus
+ *      replies, silence) and checks every query completes
+ *      exactly once with the right answer, and that per server
+ *      rate limits hold.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "dnsasync.h"
+
+#define TEST_NAMES 2000
+#define TEST_NAMELEN 64
+#define TEST_RATE 2000
+#define TEST_RATED 200
+
+typedef struct test_query_s{
+    char hostname[TEST_NAMELEN];
+    char expected[INET6_ADDRSTRLEN];    /* empty: must fail */
+    atomic_int calls;
+    int ok;
+} test_query;
+
+static test_query queries[TEST_NAMES];
+
+/* Start ./stub-dns with args and return its port, or -1 */
+static int start_stub(const char* args, pid_t* pid){
+    int fds[2];
+    int port = -1;
+    char cmd[128];
+    FILE* out;
+
+    if(pipe(fds) < 0){
+	return -1;
+    }
+    *pid = fork();
+    if(*pid == 0){
+	dup2(fds[1], STDOUT_FILENO);
+	close(fds[0]);
+	close(fds[1]);
+	snprintf(cmd, sizeof(cmd), "exec ./stub-dns -p 0 %s", args);
+	execl("/bin/sh", "sh", "-c", cmd, (char*) NULL);
+	_exit(127);
+    }
+    close(fds[1]);
+    out = fdopen(fds[0], "r");
+    if(!out || fscanf(out, "listening on port %d", &port) != 1){
+	port = -1;
+    }
+    if(out){
+	fclose(out);
+    }
+    return port;
+}
+
+static long long now_ns(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void stop_stub(pid_t pid){
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+static void done(void* arg, int status, const char* ipstr){
+    test_query* t = arg;
+
+    atomic_fetch_add(&t->calls, 1);
+    if(status == UTIL_SUCCESS){
+	t->ok = t->expected[0] && strcmp(ipstr, t->expected) == 0;
+    }
+    else{
+	t->ok = !t->expected[0];
+    }
+}
+
+static void fill_queries(int count){
+    unsigned long hash, addr;
+    const char* c;
+    int i;
+
+    for(i = 0; i < count; i++){
+	test_query* t = &queries[i];
+	atomic_store(&t->calls, 0);
+	t->ok = 0;
+	t->expected[0] = '\0';
+	if(i % 50 == 7){
+	    snprintf(t->hostname, TEST_NAMELEN, "missing%d.invalid", i);
+	    continue;
+	}
+	if(i % 50 == 9){
+	    snprintf(t->hostname, TEST_NAMELEN, "broken%d.servfail", i);
+	    continue;
+	}
+	snprintf(t->hostname, TEST_NAMELEN, "host%d.example.com", i);
+	hash = 5381;
+	for(c = t->hostname; *c; c++){
+	    hash = hash * 33 + (unsigned char) *c;
+	}
+	addr = htonl(0x0A000000UL | (hash & 0x00FFFFFFUL));
+	inet_ntop(AF_INET, &addr, t->expected, sizeof(t->expected));
+    }
+}
+
+/* Resolve count names through servers and check every answer */
+static void run(const char* label, const char* servers, int count,
+		int loops, int inflight, int timeoutMs, int retries,
+		dnsasync* e){
+
+    int i, wrong = 0, repeated = 0;
+
+    fill_queries(count);
+    if(dnsasync_init(e, servers, loops, inflight, timeoutMs, retries)
+       == DNSASYNC_FAILURE){
+	fprintf(stderr, "error: %s: dnsasync_init failed\n", label);
+	return;
+    }
+    for(i = 0; i < count; i++){
+	dnsasync_submit(e, queries[i].hostname, done, &queries[i]);
+    }
+    dnsasync_drain(e);
+    for(i = 0; i < count; i++){
+	if(atomic_load(&queries[i].calls) != 1){
+	    repeated++;
+	}
+	else if(!queries[i].ok){
+	    wrong++;
+	}
+    }
+    if(repeated || wrong){
+	fprintf(stderr,
+		"error: %s: %d callbacks missing or repeated,"
+		" %d wrong answers\n", label, repeated, wrong);
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    dnsasync e;
+    pid_t good, lossy, bogus, dead;
+    long long start, elapsed;
+    int port, dead_port, i;
+    char servers[64];
+
+    good = 0;
+    lossy = 0;
+    bogus = 0;
+    dead = 0;
+
+    /* Test many queries in flight with a slow server */
+    port = start_stub("-d 20", &good);
+    if(port < 0){
+	fprintf(stderr, "error: could not start ./stub-dns\n");
+	return 0;
+    }
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d", port);
+    run("delay", servers, TEST_NAMES, 2, 4096, 2000, 2, &e);
+    if(atomic_load(&e.timeouts_hit) != 0){
+	fprintf(stderr, "error: delay: %ld unexpected timeouts\n",
+		atomic_load(&e.timeouts_hit));
+    }
+    dnsasync_cleanup(&e);
+
+    /* Test that an in-flight cap below the load still completes */
+    run("inflight", servers, TEST_NAMES, 1, 16, 2000, 2, &e);
+    dnsasync_cleanup(&e);
+
+    /* Test retries over a server that drops 20% of queries */
+    port = start_stub("-l 20", &lossy);
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d", port);
+    run("loss", servers, 500, 1, 1024, 50, 8, &e);
+    if(atomic_load(&e.resent) == 0){
+	fprintf(stderr, "error: loss: nothing was retried\n");
+    }
+    dnsasync_cleanup(&e);
+    stop_stub(lossy);
+
+    /* Test that replies with the wrong ID are ignored */
+    port = start_stub("-b", &bogus);
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d", port);
+    run("bogus", servers, 500, 1, 1024, 2000, 2, &e);
+    if(atomic_load(&e.mismatched) == 0){
+	fprintf(stderr, "error: bogus: no mismatched replies seen\n");
+    }
+    dnsasync_cleanup(&e);
+    stop_stub(bogus);
+
+    /* Test fail over from a silent server to a working one */
+    dead_port = start_stub("-l 100", &dead);
+    stop_stub(good);
+    port = start_stub("", &good);
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d,127.0.0.1:%d",
+	     dead_port, port);
+    run("failover", servers, 200, 1, 1024, 50, 2, &e);
+    dnsasync_cleanup(&e);
+
+    /* Test each of two servers is held to its own rate */
+    fill_queries(TEST_RATED);
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d,127.0.0.1:%d", port, port);
+    dnsasync_init(&e, servers, 1, 1024, 2000, 2);
+    dnsasync_set_rate(&e, TEST_RATE, 1);
+    start = now_ns();
+    for(i = 0; i < TEST_RATED; i++){
+	dnsasync_submit(&e, queries[i].hostname, done, &queries[i]);
+    }
+    dnsasync_drain(&e);
+    elapsed = now_ns() - start;
+    /* half the queries each, the first of each half free */
+    if(elapsed < (TEST_RATED / 2 - 1) * (1000000000LL / TEST_RATE)
+       || atomic_load(&e.limits[0].delayed) == 0 || atomic_load(&e.limits[1].delayed) == 0){
+	fprintf(stderr, "error: rate: %d queries to 2 servers at %d/s took %lld ns\n",
+		TEST_RATED, TEST_RATE, elapsed);
+    }
+    for(i = 0; i < TEST_RATED; i++){
+	if(atomic_load(&queries[i].calls) != 1 || !queries[i].ok){
+	    fprintf(stderr, "error: rate: %s answered wrong\n", queries[i].hostname);
+	}
+    }
+    dnsasync_cleanup(&e);
+
+    /* Test that a silent server times every query out */
+    fill_queries(20);
+    snprintf(servers, sizeof(servers), "127.0.0.1:%d", dead_port);
+    dnsasync_init(&e, servers, 1, 1024, 20, 1);
+    for(i = 0; i < 20; i++){
+	queries[i].expected[0] = '\0';
+	dnsasync_submit(&e, queries[i].hostname, done, &queries[i]);
+    }
+    dnsasync_drain(&e);
+    if(atomic_load(&e.failed) != 20 || atomic_load(&e.timeouts_hit) != 40){
+	fprintf(stderr,
+		"error: silent: expected 20 failures after 40 timeouts,"
+		" got %ld and %ld\n",
+		atomic_load(&e.failed), atomic_load(&e.timeouts_hit));
+    }
+    dnsasync_cleanup(&e);
+    stop_stub(dead);
+    stop_stub(good);
+
+    /* Test that names that do not fit in a query fail at once */
+    dnsasync_init(&e, "127.0.0.1:9", 1, 0, 0, 0);
+    fill_queries(1);
+    strcpy(queries[0].hostname, "bad..name");
+    queries[0].expected[0] = '\0';
+    dnsasync_submit(&e, queries[0].hostname, done, &queries[0]);
+    if(atomic_load(&queries[0].calls) != 1 || !queries[0].ok){
+	fprintf(stderr, "error: malformed name was not rejected\n");
+    }
+    dnsasync_cleanup(&e);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * File: dnscache.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains a sharded, TTL based DNS result cache.
+ *      The shard is picked from the top bits of the hostname
+ *      hash and the bucket from the low bits, so the two are
+ *      independent. Expired entries are dropped lazily when a
+ *      lookup or insert walks past them.
+ *  
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dnscache.h"
+
+#define DNSCACHE_INITIAL_BUCKETS 64
+
+static long long dnscache_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* 64 bit FNV-1a */
+static uint64_t dnscache_hash(const char* s){
+    uint64_t h = 14695981039346656037ULL;
+    while(*s){
+	h ^= (unsigned char) *s++;
+	h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static dnscache_shard* dnscache_shard_for(dnscache* c, uint64_t hash){
+    return &c->shards[(hash >> 40) & (c->nshards - 1)];
+}
+
+int dnscache_init(dnscache* c, int shards, int ttl, int negTtl){
+
+    int i;
+    int n = 1;
+
+    if(shards <= 0){
+	shards = DNSCACHE_DEFAULT_SHARDS;
+    }
+    while(n < shards){
+	n <<= 1;
+    }
+
+    c->nshards = n;
+    c->ttl_ns = (long long) ttl * 1000000000LL;
+    c->neg_ttl_ns = (long long) negTtl * 1000000000LL;
+    c->shards = aligned_alloc(64, sizeof(dnscache_shard) * n);
+    if(!c->shards){
+	perror("Error on dnscache Malloc");
+	return DNSCACHE_FAILURE;
+    }
+    memset(c->shards, 0, sizeof(dnscache_shard) * n);
+
+    for(i=0; i < n; i++){
+	pthread_mutex_init(&c->shards[i].lock, NULL);
+	c->shards[i].nbuckets = DNSCACHE_INITIAL_BUCKETS;
+	c->shards[i].buckets = calloc(DNSCACHE_INITIAL_BUCKETS,
+				      sizeof(dnscache_entry*));
+	if(!c->shards[i].buckets){
+	    perror("Error on dnscache Malloc");
+	    return DNSCACHE_FAILURE;
+	}
+    }
+
+    return DNSCACHE_SUCCESS;
+}
+
+/* Double the bucket array once the shard averages one entry per
+ * bucket. Caller holds the shard lock. */
+static void dnscache_grow(dnscache_shard* s){
+    int nbuckets = s->nbuckets * 2;
+    dnscache_entry** buckets = calloc(nbuckets, sizeof(dnscache_entry*));
+    dnscache_entry* e;
+    dnscache_entry* next;
+    int i;
+
+    if(!buckets){
+	/* keep the longer chains */
+	return;
+    }
+    for(i=0; i < s->nbuckets; i++){
+	for(e = s->buckets[i]; e; e = next){
+	    next = e->next;
+	    e->next = buckets[e->hash & (nbuckets - 1)];
+	    buckets[e->hash & (nbuckets - 1)] = e;
+	}
+    }
+    free(s->buckets);
+    s->buckets = buckets;
+    s->nbuckets = nbuckets;
+}
+
+/* Find hostname in its bucket, unlinking expired entries on the
+ * way. Caller holds the shard lock. */
+static dnscache_entry** dnscache_find(dnscache_shard* s, uint64_t hash,
+				      const char* hostname, long long now){
+    dnscache_entry** link = &s->buckets[hash & (s->nbuckets - 1)];
+    dnscache_entry* e;
+
+    while((e = *link) != NULL){
+	if(e->expires_ns <= now){
+	    *link = e->next;
+	    free(e->ipstr);
+	    free(e);
+	    s->count--;
+	    s->expired++;
+	    continue;
+	}
+	if(e->hash == hash && strcmp(e->hostname, hostname) == 0){
+	    return link;
+	}
+	link = &e->next;
+    }
+    return link;
+}
+
+int dnscache_get(dnscache* c, const char* hostname,
+		 char* ipstr, int maxSize){
+
+    uint64_t hash = dnscache_hash(hostname);
+    dnscache_shard* s = dnscache_shard_for(c, hash);
+    dnscache_entry* e;
+    int ret = DNSCACHE_MISS;
+
+    pthread_mutex_lock(&s->lock);
+    e = *dnscache_find(s, hash, hostname, dnscache_now_ns());
+    if(e && e->negative){
+	s->negative_hits++;
+	ret = DNSCACHE_NEGATIVE;
+    }
+    else if(e){
+	strncpy(ipstr, e->ipstr, maxSize);
+	ipstr[maxSize-1] = '\0';
+	s->hits++;
+	ret = DNSCACHE_HIT;
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return ret;
+}
+
+void dnscache_put(dnscache* c, const char* hostname,
+		  const char* ipstr, long long lookupNs){
+
+    uint64_t hash = dnscache_hash(hostname);
+    dnscache_shard* s = dnscache_shard_for(c, hash);
+    long long now = dnscache_now_ns();
+    dnscache_entry** link;
+    dnscache_entry* e;
+    size_t len = strlen(hostname);
+
+    pthread_mutex_lock(&s->lock);
+    s->misses++;
+    s->miss_ns += lookupNs;
+
+    link = dnscache_find(s, hash, hostname, now);
+    e = *link;
+    if(!e){
+	/* new entry goes at the head of its chain */
+	e = malloc(sizeof(*e) + len + 1);
+	if(!e){
+	    pthread_mutex_unlock(&s->lock);
+	    return;
+	}
+	memcpy(e->hostname, hostname, len + 1);
+	e->hash = hash;
+	e->ipstr = NULL;
+	link = &s->buckets[hash & (s->nbuckets - 1)];
+	e->next = *link;
+	*link = e;
+	s->count++;
+    }
+
+    free(e->ipstr);
+    e->ipstr = ipstr ? strdup(ipstr) : NULL;
+    e->negative = (ipstr == NULL);
+    e->expires_ns = now + (ipstr ? c->ttl_ns : c->neg_ttl_ns);
+    if(ipstr && !e->ipstr){
+	/* out of memory: let the next lookup drop the entry */
+	e->negative = 1;
+	e->expires_ns = now;
+    }
+
+    if(s->count > s->nbuckets){
+	dnscache_grow(s);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+int dnscache_lookup(dnscache* c, const char* hostname,
+		    char* firstIPstr, int maxSize){
+
+    long long start;
+    int ret;
+
+    switch(dnscache_get(c, hostname, firstIPstr, maxSize)){
+    case DNSCACHE_HIT:
+	return UTIL_SUCCESS;
+    case DNSCACHE_NEGATIVE:
+	return UTIL_FAILURE;
+    }
+
+    /* Two threads missing on the same name both look it up;
+     * the second put just refreshes the entry. */
+    start = dnscache_now_ns();
+    ret = dnslookup(hostname, firstIPstr, maxSize);
+    dnscache_put(c, hostname, ret == UTIL_SUCCESS ? firstIPstr : NULL,
+		 dnscache_now_ns() - start);
+
+    return ret;
+}
+
+void dnscache_get_stats(dnscache* c, dnscache_stats* stats){
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+    for(i=0; i < c->nshards; i++){
+	dnscache_shard* s = &c->shards[i];
+	pthread_mutex_lock(&s->lock);
+	stats->entries += s->count;
+	stats->hits += s->hits;
+	stats->negative_hits += s->negative_hits;
+	stats->misses += s->misses;
+	stats->expired += s->expired;
+	stats->miss_ns += s->miss_ns;
+	pthread_mutex_unlock(&s->lock);
+    }
+
+    /* every hit saved roughly one average miss */
+    if(stats->misses > 0){
+	stats->saved_ns = (stats->miss_ns / stats->misses)
+	    * (stats->hits + stats->negative_hits);
+    }
+}
+
+void dnscache_cleanup(dnscache* c){
+    int i, j;
+    dnscache_entry* e;
+    dnscache_entry* next;
+
+    for(i=0; i < c->nshards; i++){
+	dnscache_shard* s = &c->shards[i];
+	for(j=0; j < s->nbuckets; j++){
+	    for(e = s->buckets[j]; e; e = next){
+		next = e->next;
+		free(e->ipstr);
+		free(e);
+	    }
+	}
+	free(s->buckets);
+	pthread_mutex_destroy(&s->lock);
+    }
+    free(c->shards);
+}
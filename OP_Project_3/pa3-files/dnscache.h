@@ -0,0 +1,111 @@
+/*
+ * File: dnscache.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for an in-process DNS result cache
+ *      shared by all resolver threads. Entries are spread over
+ *      independently locked shards by hostname hash, so threads
+ *      only contend when they hit the same shard. Successful
+ *      lookups live for ttl seconds, failed ones for negTtl.
+ *      The cached value is any string, normally the address
+ *      list from dnslookup_list().
+ *  
+ */
+
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "util.h"
+
+#define DNSCACHE_FAILURE -1
+#define DNSCACHE_SUCCESS 0
+
+/* dnscache_get results */
+#define DNSCACHE_MISS 0
+#define DNSCACHE_HIT 1
+#define DNSCACHE_NEGATIVE 2
+
+#define DNSCACHE_DEFAULT_SHARDS 64
+#define DNSCACHE_DEFAULT_TTL 300
+#define DNSCACHE_DEFAULT_NEG_TTL 30
+
+typedef struct dnscache_entry_s{
+    struct dnscache_entry_s* next;
+    uint64_t hash;
+    long long expires_ns;
+    int negative;
+    char* ipstr;                        /* NULL when negative */
+    char hostname[];
+} dnscache_entry;
+
+/* One lock, one chained hash table and its counters per shard */
+typedef struct dnscache_shard_s{
+    _Alignas(64) pthread_mutex_t lock;
+    dnscache_entry** buckets;
+    int nbuckets;
+    int count;
+    long hits;
+    long negative_hits;
+    long misses;
+    long expired;
+    long long miss_ns;
+} dnscache_shard;
+
+typedef struct dnscache_s{
+    dnscache_shard* shards;
+    int nshards;
+    long long ttl_ns;
+    long long neg_ttl_ns;
+} dnscache;
+
+/* Totals over all shards */
+typedef struct dnscache_stats_s{
+    long entries;
+    long hits;
+    long negative_hits;
+    long misses;
+    long expired;
+    long long miss_ns;
+    long long saved_ns;
+} dnscache_stats;
+
+/* Function to initilize a new cache
+ * shards is rounded up to a power of two (default if <= 0)
+ * ttl and negTtl are in seconds
+ * Returns DNSCACHE_SUCCESS or DNSCACHE_FAILURE
+ */
+int dnscache_init(dnscache* c, int shards, int ttl, int negTtl);
+
+/* Function to look hostname up in the cache only
+ * On DNSCACHE_HIT copies the cached string into ipstr,
+ * cut to maxSize
+ * Returns DNSCACHE_HIT, DNSCACHE_NEGATIVE or DNSCACHE_MISS
+ */
+int dnscache_get(dnscache* c, const char* hostname,
+		 char* ipstr, int maxSize);
+
+/* Function to store a lookup result
+ * ipstr NULL records a failed lookup (negative entry)
+ * lookupNs is how long the lookup took, for the saved time stat
+ */
+void dnscache_put(dnscache* c, const char* hostname,
+		  const char* ipstr, long long lookupNs);
+
+/* Function to resolve through the cache, calling dnslookup()
+ * on a miss. Same contract as dnslookup().
+ */
+int dnscache_lookup(dnscache* c, const char* hostname,
+		    char* firstIPstr, int maxSize);
+
+/* Function to sum the per shard counters */
+void dnscache_get_stats(dnscache* c, dnscache_stats* stats);
+
+/* Function to free cache memory */
+void dnscache_cleanup(dnscache* c);
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * File: dnscacheTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the sharded DNS
+ *      result cache. Only dnscache_get/put are exercised,
+ *      so no network access is needed.
+ *  
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "dnscache.h"
+
+#define TEST_NAMES 10000
+#define TEST_THREADS 8
+
+static dnscache shared;
+
+/* Every thread stores and reads back its own slice of names
+ * while the others do the same on neighbouring shards */
+static void* thread_test(void* arg){
+    long t = (long) arg;
+    char name[64];
+    char ip[INET6_ADDRSTRLEN];
+    char got[INET6_ADDRSTRLEN];
+    long i;
+    long errors = 0;
+
+    for(i=t; i<TEST_NAMES; i+=TEST_THREADS){
+	sprintf(name, "host%ld.example.com", i);
+	sprintf(ip, "10.0.%ld.%ld", i / 256, i % 256);
+	dnscache_put(&shared, name, ip, 1000);
+    }
+    for(i=t; i<TEST_NAMES; i+=TEST_THREADS){
+	sprintf(name, "host%ld.example.com", i);
+	sprintf(ip, "10.0.%ld.%ld", i / 256, i % 256);
+	if(dnscache_get(&shared, name, got, sizeof(got)) != DNSCACHE_HIT
+	   || strcmp(ip, got) != 0){
+	    errors++;
+	}
+    }
+    return (void*) errors;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    /* Setup local vars */
+    dnscache c;
+    dnscache_stats stats;
+    char ip[INET6_ADDRSTRLEN];
+    pthread_t threads[TEST_THREADS];
+    void* errors;
+    long t;
+
+    /* Initialize Cache */
+    if(dnscache_init(&c, 4, 60, 60) == DNSCACHE_FAILURE){
+	fprintf(stderr,
+		"error: dnscache_init failed!\n");
+	return EXIT_FAILURE;
+    }
+
+    /* Test miss on empty cache */
+    if(dnscache_get(&c, "example.com", ip, sizeof(ip)) != DNSCACHE_MISS){
+	fprintf(stderr,
+		"error: empty cache should miss\n");
+    }
+
+    /* Test hit after put */
+    dnscache_put(&c, "example.com", "93.184.216.34", 2000000);
+    if(dnscache_get(&c, "example.com", ip, sizeof(ip)) != DNSCACHE_HIT
+       || strcmp(ip, "93.184.216.34") != 0){
+	fprintf(stderr,
+		"error: cached address not returned\n");
+    }
+
+    /* Test that a second put replaces the address */
+    dnscache_put(&c, "example.com", "93.184.216.35", 2000000);
+    if(dnscache_get(&c, "example.com", ip, sizeof(ip)) != DNSCACHE_HIT
+       || strcmp(ip, "93.184.216.35") != 0){
+	fprintf(stderr,
+		"error: replaced address not returned\n");
+    }
+
+    /* Test negative entry */
+    dnscache_put(&c, "bad.invalid", NULL, 2000000);
+    if(dnscache_get(&c, "bad.invalid", ip, sizeof(ip)) != DNSCACHE_NEGATIVE){
+	fprintf(stderr,
+		"error: failed lookup not cached as negative\n");
+    }
+
+    /* Test stats: 2 misses recorded by put, then 2 hits, 1 negative */
+    dnscache_get_stats(&c, &stats);
+    if(stats.entries != 2 || stats.hits != 2 || stats.negative_hits != 1
+       || stats.misses != 3 || stats.saved_ns != 2000000 * 3){
+	fprintf(stderr,
+		"error: stats entries=%ld hits=%ld negative_hits=%ld"
+		" misses=%ld saved_ns=%lld\n",
+		stats.entries, stats.hits, stats.negative_hits,
+		stats.misses, stats.saved_ns);
+    }
+    dnscache_cleanup(&c);
+
+    /* Test TTLs: positive entries live, negative expire at once */
+    dnscache_init(&c, 4, 60, 0);
+    dnscache_put(&c, "good.example", "10.0.0.1", 0);
+    dnscache_put(&c, "bad.invalid", NULL, 0);
+    if(dnscache_get(&c, "good.example", ip, sizeof(ip)) != DNSCACHE_HIT){
+	fprintf(stderr,
+		"error: positive entry expired early\n");
+    }
+    if(dnscache_get(&c, "bad.invalid", ip, sizeof(ip)) != DNSCACHE_MISS){
+	fprintf(stderr,
+		"error: negative entry outlived its ttl\n");
+    }
+    dnscache_get_stats(&c, &stats);
+    if(stats.expired != 1 || stats.entries != 1){
+	fprintf(stderr,
+		"error: expired entry not dropped\n");
+    }
+    dnscache_cleanup(&c);
+
+    /* Test concurrent put/get across shards and table growth */
+    dnscache_init(&shared, 0, 60, 60);
+    for(t=0; t<TEST_THREADS; t++){
+	pthread_create(&threads[t], NULL, thread_test, (void*) t);
+    }
+    for(t=0; t<TEST_THREADS; t++){
+	pthread_join(threads[t], &errors);
+	if(errors){
+	    fprintf(stderr,
+		    "error: thread %ld read back %ld wrong entries\n",
+		    t, (long) errors);
+	}
+    }
+    dnscache_get_stats(&shared, &stats);
+    if(stats.entries != TEST_NAMES){
+	fprintf(stderr,
+		"error: expected %d entries, found %ld\n",
+		TEST_NAMES, stats.entries);
+    }
+    dnscache_cleanup(&shared);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * File: dnslookupTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for dnslookup_all() and the
+ *      address list helpers. Like coalesceTest it defines its
+ *      own getaddrinfo()/freeaddrinfo(), here answering
+ *      "NAME-N" with N addresses alternating IPv4 and IPv6,
+ *      each returned twice the way glibc repeats addresses per
+ *      socket type.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "util.h"
+
+typedef struct test_addr_s{
+    struct addrinfo info;
+    struct sockaddr_in6 addr;
+} test_addr;
+
+int getaddrinfo(const char* node, const char* service,
+		const struct addrinfo* hints, struct addrinfo** res){
+
+    const char* dash = strrchr(node, '-');
+    int n = dash ? atoi(dash + 1) : 0;
+    struct addrinfo* head = NULL;
+    struct addrinfo** tail = &head;
+    test_addr* a;
+    int i;
+
+    (void) service;
+    (void) hints;
+
+    if(n <= 0){
+	return EAI_NONAME;
+    }
+    for(i = 0; i < 2 * n; i++){
+	a = calloc(1, sizeof(*a));
+	if(i / 2 % 2 == 0){
+	    struct sockaddr_in* sin = (struct sockaddr_in*) &a->addr;
+	    sin->sin_family = AF_INET;
+	    sin->sin_addr.s_addr = htonl(0x0A000000 + i / 2);
+	    a->info.ai_addrlen = sizeof(*sin);
+	}
+	else{
+	    a->addr.sin6_family = AF_INET6;
+	    a->addr.sin6_addr.s6_addr[0] = 0xfd;
+	    a->addr.sin6_addr.s6_addr[15] = i / 2;
+	    a->info.ai_addrlen = sizeof(a->addr);
+	}
+	a->info.ai_family = a->addr.sin6_family;
+	a->info.ai_addr = (struct sockaddr*) &a->addr;
+	*tail = &a->info;
+	tail = &a->info.ai_next;
+    }
+    *res = head;
+    return 0;
+}
+
+void freeaddrinfo(struct addrinfo* res){
+    struct addrinfo* next;
+    for(; res; res = next){
+	next = res->ai_next;
+	free(res);
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    dnsresult r;
+    char first[INET6_ADDRSTRLEN];
+    char list[UTIL_ADDRLIST_SIZE];
+    char small[24];
+
+    /* Test the inline case: no spill to the heap */
+    dnsresult_init(&r);
+    if(dnslookup_all("host-3", &r) != UTIL_SUCCESS || r.count != 3
+       || r.addrs != r.inline_addrs){
+	fprintf(stderr, "error: expected 3 inline addresses, got %d\n",
+		r.count);
+    }
+    else if(strcmp(r.addrs[0], "10.0.0.0") != 0
+	    || strcmp(r.addrs[1], "fd00::1") != 0
+	    || strcmp(r.addrs[2], "10.0.0.2") != 0){
+	fprintf(stderr, "error: wrong addresses %s %s %s\n",
+		r.addrs[0], r.addrs[1], r.addrs[2]);
+    }
+    dnsresult_join(&r, list, sizeof(list));
+    if(strcmp(list, "10.0.0.0, fd00::1, 10.0.0.2") != 0){
+	fprintf(stderr, "error: wrong joined list %s\n", list);
+    }
+
+    /* Test that a short buffer drops whole addresses */
+    if(dnsresult_join(&r, small, sizeof(small)) != 2
+       || strcmp(small, "10.0.0.0, fd00::1") != 0){
+	fprintf(stderr, "error: truncated list %s\n", small);
+    }
+    dnsresult_free(&r);
+
+    /* Test more addresses than fit inline */
+    dnslookup_all("big-20", &r);
+    if(r.count != 20 || r.addrs == r.inline_addrs
+       || strcmp(r.addrs[19], "fd00::13") != 0){
+	fprintf(stderr, "error: expected 20 spilled addresses, got %d\n",
+		r.count);
+    }
+    dnsresult_free(&r);
+    if(r.count != 0 || r.addrs != r.inline_addrs){
+	fprintf(stderr, "error: dnsresult_free did not reset\n");
+    }
+
+    /* Test the single address and failure paths */
+    if(dnslookup("host-2", first, sizeof(first)) != UTIL_SUCCESS
+       || strcmp(first, "10.0.0.0") != 0){
+	fprintf(stderr, "error: dnslookup returned %s\n", first);
+    }
+    if(dnslookup_list("none", list, sizeof(list)) != UTIL_FAILURE){
+	fprintf(stderr, "error: failed lookup succeeded\n");
+    }
+    if(dnslookup_list_coalesced("host-2", list, sizeof(list)) != UTIL_SUCCESS
+       || strcmp(list, "10.0.0.0, fd00::1") != 0){
+	fprintf(stderr, "error: coalesced list %s\n", list);
+    }
+    if(dnslookup_coalesced("host-2", first, sizeof(first)) != UTIL_SUCCESS
+       || strcmp(first, "10.0.0.0") != 0){
+	fprintf(stderr, "error: coalesced first address %s\n", first);
+    }
+
+    return 0;
+}
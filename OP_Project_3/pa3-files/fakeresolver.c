@@ -0,0 +1,382 @@
+/*
+ * File: fakeresolver.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the fake lookup backend. Each name gets
+ *      one 64 bit hash (djb2 mixed with the seed through
+ *      splitmix64); successive splitmix64 steps from it give the
+ *      uniform draws for failure and latency. Transient failures
+ *      are drawn from the same hash mixed with a count of tries.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+
+#include "fakeresolver.h"
+
+#define FAKE_LINE_SIZE 4096
+#define FAKE_MIN_TABLE 64
+
+static uint64_t splitmix64(uint64_t* state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static unsigned long djb2(const char* s){
+    unsigned long hash = 5381;
+
+    for(; *s; s++){
+	hash = hash * 33 + (unsigned char) *s;
+    }
+    return hash;
+}
+
+/* Uniform in (0, 1), never 0 so log() is safe */
+static double unit(uint64_t* state){
+    return ((splitmix64(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static fake_entry* fake_find(const fakeresolver* f, const char* hostname){
+    fake_entry* e;
+
+    if(!f->table){
+	return NULL;
+    }
+    for(e = f->table[djb2(hostname) & (f->table_size - 1)]; e; e = e->next){
+	if(strcmp(e->name, hostname) == 0){
+	    return e;
+	}
+    }
+    return NULL;
+}
+
+static int fake_table_add(fakeresolver* f, char* name, char** addrs, int count){
+    fake_entry* e;
+    fake_entry** grown;
+    size_t i, slot;
+    int j;
+
+    if(fake_find(f, name)){
+	fprintf(stderr, "fake resolver: %s is in the table twice\n", name);
+	return FAKERESOLVER_FAILURE;
+    }
+
+    /* keep the load factor under 1 */
+    if(f->entries + 1 > f->table_size){
+	size_t size = f->table_size ? f->table_size * 2 : FAKE_MIN_TABLE;
+	grown = calloc(size, sizeof(*grown));
+	if(!grown){
+	    return FAKERESOLVER_FAILURE;
+	}
+	for(i = 0; i < f->table_size; i++){
+	    while((e = f->table[i])){
+		f->table[i] = e->next;
+		slot = djb2(e->name) & (size - 1);
+		e->next = grown[slot];
+		grown[slot] = e;
+	    }
+	}
+	free(f->table);
+	f->table = grown;
+	f->table_size = size;
+    }
+
+    e = calloc(1, sizeof(*e));
+    if(!e || !(e->name = strdup(name))
+       || (count > 0 && !(e->addrs = malloc(count * sizeof(*e->addrs))))){
+	if(e){
+	    free(e->name);
+	}
+	free(e);
+	return FAKERESOLVER_FAILURE;
+    }
+    for(j = 0; j < count; j++){
+	strcpy(e->addrs[j], addrs[j]);
+    }
+    e->count = count;
+    slot = djb2(name) & (f->table_size - 1);
+    e->next = f->table[slot];
+    f->table[slot] = e;
+    f->entries++;
+    return FAKERESOLVER_SUCCESS;
+}
+
+static int fake_load_table(fakeresolver* f, const char* path){
+    FILE* fp = fopen(path, "r");
+    char line[FAKE_LINE_SIZE];
+    char* addrs[FAKE_LINE_SIZE / 2];
+    unsigned char buf[sizeof(struct in6_addr)];
+    char* name;
+    char* tok;
+    char* save;
+    int count;
+    int lineno = 0;
+
+    if(!fp){
+	perror("fake resolver: could not open table");
+	return FAKERESOLVER_FAILURE;
+    }
+    while(fgets(line, sizeof(line), fp)){
+	lineno++;
+	line[strcspn(line, "#")] = '\0';
+	name = strtok_r(line, " \t\r\n", &save);
+	if(!name){
+	    continue;
+	}
+	count = 0;
+	while((tok = strtok_r(NULL, " \t\r\n", &save))){
+	    if(inet_pton(AF_INET, tok, buf) != 1 && inet_pton(AF_INET6, tok, buf) != 1){
+		fprintf(stderr, "fake resolver: %s:%d: %s is not an address\n", path, lineno, tok);
+		fclose(fp);
+		return FAKERESOLVER_FAILURE;
+	    }
+	    addrs[count++] = tok;
+	}
+	if(fake_table_add(f, name, addrs, count) == FAKERESOLVER_FAILURE){
+	    fclose(fp);
+	    return FAKERESOLVER_FAILURE;
+	}
+    }
+    fclose(fp);
+    return FAKERESOLVER_SUCCESS;
+}
+
+/* Parse "kind:a[:b]" into f's latency */
+static int fake_parse_latency(fakeresolver* f, const char* value){
+    char kind[16];
+    double a = 0.0, b = 0.0;
+    int n = 0;
+    int m = 0;
+
+    if(sscanf(value, "%15[a-z]:%lf%n", kind, &a, &n) < 2){
+	return FAKERESOLVER_FAILURE;
+    }
+    if(value[n] == ':' && (sscanf(value + n, ":%lf%n", &b, &m) != 1 || value[n + m] != '\0')){
+	return FAKERESOLVER_FAILURE;
+    }
+    if(a < 0.0 || b < 0.0){
+	return FAKERESOLVER_FAILURE;
+    }
+    if(strcmp(kind, "const") == 0 && value[n] == '\0'){
+	f->latency = FAKE_LATENCY_CONST;
+    }
+    else if(strcmp(kind, "uniform") == 0 && value[n] == ':' && b >= a){
+	f->latency = FAKE_LATENCY_UNIFORM;
+    }
+    else if(strcmp(kind, "exp") == 0 && value[n] == '\0'){
+	f->latency = FAKE_LATENCY_EXP;
+    }
+    else if(strcmp(kind, "lognormal") == 0 && value[n] == ':'){
+	f->latency = FAKE_LATENCY_LOGNORMAL;
+    }
+    else{
+	return FAKERESOLVER_FAILURE;
+    }
+    f->latency_a = a;
+    f->latency_b = b;
+    return FAKERESOLVER_SUCCESS;
+}
+
+static int fake_lookup(void* ctx, const char* hostname, dnsresult* result){
+    fakeresolver* f = ctx;
+    fake_entry* e = fake_find(f, hostname);
+    long long us = fakeresolver_latency_us(f, hostname);
+    struct timespec ts;
+    char ipstr[INET6_ADDRSTRLEN];
+    unsigned long hash;
+    uint64_t state;
+    int i;
+
+    atomic_fetch_add_explicit(&f->lookups, 1, memory_order_relaxed);
+    if(us > 0){
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000;
+	while(nanosleep(&ts, &ts) != 0){
+	}
+	atomic_fetch_add_explicit(&f->slept_us, us, memory_order_relaxed);
+    }
+
+    if(f->again_rate > 0.0){
+	state = f->seed ^ djb2(hostname)
+	    ^ (atomic_fetch_add_explicit(&f->tries, 1, memory_order_relaxed) * 0xD1B54A32D192ED03ULL);
+	if(unit(&state) < f->again_rate){
+	    atomic_fetch_add_explicit(&f->transient, 1, memory_order_relaxed);
+	    return UTIL_TRANSIENT;
+	}
+    }
+    if(fakeresolver_fails(f, hostname)){
+	atomic_fetch_add_explicit(&f->failures, 1, memory_order_relaxed);
+	return UTIL_FAILURE;
+    }
+    if(e){
+	for(i = 0; i < e->count; i++){
+	    if(dnsresult_add(result, e->addrs[i]) == UTIL_FAILURE){
+		return UTIL_FAILURE;
+	    }
+	}
+	return UTIL_SUCCESS;
+    }
+
+    /* djb2, folded into 10.0.0.0/8 like stub-resolver.so */
+    hash = djb2(hostname);
+    snprintf(ipstr, sizeof(ipstr), "10.%lu.%lu.%lu",
+	     (hash >> 16) & 0xFF, (hash >> 8) & 0xFF, hash & 0xFF);
+    return dnsresult_add(result, ipstr);
+}
+
+int fakeresolver_init(fakeresolver* f, const char* spec){
+    char* copy;
+    char* opt;
+    char* value;
+    char* save;
+    char* end;
+    int ret = FAKERESOLVER_SUCCESS;
+
+    memset(f, 0, sizeof(*f));
+    f->resolver.name = FAKERESOLVER_PREFIX;
+    f->resolver.lookup = fake_lookup;
+    f->resolver.ctx = f;
+    atomic_init(&f->lookups, 0);
+    atomic_init(&f->failures, 0);
+    atomic_init(&f->transient, 0);
+    atomic_init(&f->tries, 0);
+    atomic_init(&f->slept_us, 0);
+
+    if(strncmp(spec, FAKERESOLVER_PREFIX, strlen(FAKERESOLVER_PREFIX)) != 0){
+	fprintf(stderr, "fake resolver: spec %s does not start with %s\n", spec, FAKERESOLVER_PREFIX);
+	return FAKERESOLVER_FAILURE;
+    }
+    opt = (char*) spec + strlen(FAKERESOLVER_PREFIX);
+    if(*opt == '\0'){
+	return FAKERESOLVER_SUCCESS;
+    }
+    if(*opt != ':' || opt[1] == '\0' || !(copy = strdup(opt + 1))){
+	fprintf(stderr, "fake resolver: bad spec %s\n", spec);
+	return FAKERESOLVER_FAILURE;
+    }
+
+    for(opt = strtok_r(copy, ",", &save); opt && ret == FAKERESOLVER_SUCCESS;
+	opt = strtok_r(NULL, ",", &save)){
+	value = strchr(opt, '=');
+	if(value){
+	    *value++ = '\0';
+	}
+	if(strcmp(opt, "strict") == 0 && !value){
+	    f->strict = 1;
+	}
+	else if(!value){
+	    ret = FAKERESOLVER_FAILURE;
+	}
+	else if(strcmp(opt, "latency") == 0){
+	    ret = fake_parse_latency(f, value);
+	}
+	else if(strcmp(opt, "fail") == 0){
+	    f->fail_rate = strtod(value, &end);
+	    if(*end != '\0' || end == value || f->fail_rate < 0.0 || f->fail_rate > 1.0){
+		ret = FAKERESOLVER_FAILURE;
+	    }
+	}
+	else if(strcmp(opt, "again") == 0){
+	    f->again_rate = strtod(value, &end);
+	    if(*end != '\0' || end == value || f->again_rate < 0.0 || f->again_rate > 1.0){
+		ret = FAKERESOLVER_FAILURE;
+	    }
+	}
+	else if(strcmp(opt, "seed") == 0){
+	    f->seed = strtoull(value, &end, 0);
+	    if(*end != '\0' || end == value){
+		ret = FAKERESOLVER_FAILURE;
+	    }
+	}
+	else if(strcmp(opt, "table") == 0){
+	    if(fake_load_table(f, value) == FAKERESOLVER_FAILURE){
+		free(copy);
+		fakeresolver_cleanup(f);
+		return FAKERESOLVER_FAILURE;
+	    }
+	}
+	else{
+	    ret = FAKERESOLVER_FAILURE;
+	}
+	if(ret == FAKERESOLVER_FAILURE){
+	    fprintf(stderr, "fake resolver: bad option %s%s%s\n", opt,
+		    value ? "=" : "", value ? value : "");
+	}
+    }
+    free(copy);
+    if(ret == FAKERESOLVER_FAILURE){
+	fakeresolver_cleanup(f);
+    }
+    return ret;
+}
+
+long long fakeresolver_latency_us(const fakeresolver* f, const char* hostname){
+    uint64_t state = f->seed ^ djb2(hostname);
+    double u, v;
+    double us = 0.0;
+
+    /* the first draw decides failure */
+    splitmix64(&state);
+    u = unit(&state);
+    switch(f->latency){
+    case FAKE_LATENCY_CONST:
+	us = f->latency_a;
+	break;
+    case FAKE_LATENCY_UNIFORM:
+	us = f->latency_a + u * (f->latency_b - f->latency_a);
+	break;
+    case FAKE_LATENCY_EXP:
+	us = -f->latency_a * log(u);
+	break;
+    case FAKE_LATENCY_LOGNORMAL:
+	/* Box-Muller */
+	v = unit(&state);
+	us = f->latency_a * exp(f->latency_b * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v));
+	break;
+    }
+    return (long long) (us + 0.5);
+}
+
+int fakeresolver_fails(const fakeresolver* f, const char* hostname){
+    uint64_t state = f->seed ^ djb2(hostname);
+    fake_entry* e = fake_find(f, hostname);
+
+    if(e){
+	if(e->count == 0){
+	    return 1;
+	}
+    }
+    else if(f->strict){
+	return 1;
+    }
+    return unit(&state) < f->fail_rate;
+}
+
+void fakeresolver_cleanup(fakeresolver* f){
+    fake_entry* e;
+    size_t i;
+
+    for(i = 0; i < f->table_size; i++){
+	while((e = f->table[i])){
+	    f->table[i] = e->next;
+	    free(e->addrs);
+	    free(e->name);
+	    free(e);
+	}
+    }
+    free(f->table);
+    f->table = NULL;
+    f->table_size = 0;
+    f->entries = 0;
+}
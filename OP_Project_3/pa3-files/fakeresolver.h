@@ -0,0 +1,91 @@
+/*
+ * File: fakeresolver.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a fake lookup backend that
+ *      plugs into dnsresolver_set(). It answers from a table of
+ *      names and addresses, or with a 10.x.y.z address derived
+ *      from the name (the same one stub-resolver.so gives), after
+ *      a simulated latency, and fails a set fraction of lookups.
+ *      The latency and whether a name fails are drawn from a hash
+ *      of the name and the seed, so a run is repeatable.
+ *
+ *      It is set up from a spec string:
+ *
+ *          fake[:key=value,...]
+ *
+ *      latency=const:US | uniform:MIN:MAX | exp:MEAN
+ *              | lognormal:MEDIAN:SIGMA   (microseconds, default 0)
+ *      fail=RATE     fraction of names that fail (default 0)
+ *      again=RATE    fraction of tries that fail with a transient
+ *                    error, like EAI_AGAIN (default 0); drawn
+ *                    afresh each try, so retries can succeed
+ *      seed=N        changes which names fail and how slow each is
+ *      table=PATH    lines of "hostname addr...", a name alone
+ *                    always fails, # starts a comment
+ *      strict        names not in the table fail
+ *
+ */
+
+#ifndef FAKERESOLVER_H
+#define FAKERESOLVER_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "util.h"
+
+#define FAKERESOLVER_FAILURE -1
+#define FAKERESOLVER_SUCCESS 0
+
+#define FAKERESOLVER_PREFIX "fake"
+
+enum fake_latency_kind { FAKE_LATENCY_CONST, FAKE_LATENCY_UNIFORM,
+			 FAKE_LATENCY_EXP, FAKE_LATENCY_LOGNORMAL };
+
+typedef struct fake_entry_s{
+    struct fake_entry_s* next;
+    char* name;
+    int count;
+    char (*addrs)[INET6_ADDRSTRLEN];
+} fake_entry;
+
+typedef struct fakeresolver_s{
+    dnsresolver resolver;
+    enum fake_latency_kind latency;
+    double latency_a;
+    double latency_b;
+    double fail_rate;
+    double again_rate;
+    uint64_t seed;
+    int strict;
+    fake_entry** table;
+    size_t table_size;
+    size_t entries;
+    atomic_long lookups;
+    atomic_long failures;
+    atomic_long transient;
+    atomic_ulong tries;
+    atomic_llong slept_us;
+} fakeresolver;
+
+/* Function to set up f from spec (see above); prints what is
+ * wrong with a bad spec or table to stderr.
+ * f->resolver is then ready for dnsresolver_set().
+ */
+int fakeresolver_init(fakeresolver* f, const char* spec);
+
+/* Function to return the latency f gives hostname, in
+ * microseconds, without sleeping
+ */
+long long fakeresolver_latency_us(const fakeresolver* f, const char* hostname);
+
+/* Function to return 1 if f fails hostname's lookups */
+int fakeresolver_fails(const fakeresolver* f, const char* hostname);
+
+/* Function to free the table */
+void fakeresolver_cleanup(fakeresolver* f);
+
+#endif
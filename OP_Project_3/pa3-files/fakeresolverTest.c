@@ -0,0 +1,192 @@
+/*
+ * File: fakeresolverTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the fake lookup backend.
+ *      Bad specs must be refused; table names must come back with
+ *      their addresses (once each) through dnslookup_all(); other
+ *      names must get stub-resolver.so's address, or fail when
+ *      strict; the fail rate and mean latency over many names
+ *      must be close to what was asked for, and the same from one
+ *      run to the next; and transient failures must be drawn per
+ *      try, so retries get through.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fakeresolver.h"
+
+#define TEST_TABLE "fakeresolverTest.tmp"
+#define TEST_NAMES 20000
+
+static const char* bad_specs[] = {
+    "dns", "fake:", "fake;fail=0.1", "fake:fail=2", "fake:fail=x", "fake:speed=1",
+    "fake:latency=exp", "fake:latency=uniform:5", "fake:latency=uniform:9:5",
+    "fake:latency=const:5:6", "fake:latency=normal:5", "fake:table=/nonexistent",
+    "fake:seed=", "fake:strict=1", "fake:again=1.5", "fake:again="
+};
+
+/* Mean latency and fail fraction over TEST_NAMES names */
+static void sample(const fakeresolver* f, double* mean_us, double* failed){
+    char name[64];
+    long long sum = 0;
+    int fails = 0;
+    int i;
+
+    for(i = 0; i < TEST_NAMES; i++){
+	snprintf(name, sizeof(name), "host%d.example.com", i);
+	sum += fakeresolver_latency_us(f, name);
+	fails += fakeresolver_fails(f, name);
+    }
+    *mean_us = (double) sum / TEST_NAMES;
+    *failed = (double) fails / TEST_NAMES;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    fakeresolver f;
+    fakeresolver g;
+    throttle t;
+    dnsresult r;
+    char name[64];
+    int resolved;
+    FILE* fp;
+    double mean, failed, mean2, failed2;
+    size_t i;
+
+    /* Test bad specs are refused */
+    for(i = 0; i < sizeof(bad_specs) / sizeof(bad_specs[0]); i++){
+	if(fakeresolver_init(&f, bad_specs[i]) != FAKERESOLVER_FAILURE){
+	    fprintf(stderr, "error: bad spec %s was accepted\n", bad_specs[i]);
+	    fakeresolver_cleanup(&f);
+	}
+    }
+
+    /* Test a table through dnslookup_all() */
+    fp = fopen(TEST_TABLE, "w");
+    if(!fp){
+	fprintf(stderr, "error: could not write %s\n", TEST_TABLE);
+	return 0;
+    }
+    fprintf(fp, "# name addrs\n"
+	    "two.example.com 192.0.2.1 2001:db8::1 192.0.2.1\n"
+	    "\n"
+	    "gone.example.com   # always fails\n");
+    fclose(fp);
+    if(fakeresolver_init(&f, "fake:table=" TEST_TABLE) != FAKERESOLVER_SUCCESS){
+	fprintf(stderr, "error: table spec refused\n");
+	return 0;
+    }
+    dnsresolver_set(&f.resolver);
+    dnsresult_init(&r);
+    if(dnslookup_all("two.example.com", &r) != UTIL_SUCCESS || r.count != 2
+       || strcmp(r.addrs[0], "192.0.2.1") != 0 || strcmp(r.addrs[1], "2001:db8::1") != 0){
+	fprintf(stderr, "error: table name came back with %d addresses\n", r.count);
+    }
+    dnsresult_free(&r);
+    dnsresult_init(&r);
+    if(dnslookup_all("gone.example.com", &r) != UTIL_FAILURE){
+	fprintf(stderr, "error: table name with no address resolved\n");
+    }
+    dnsresult_free(&r);
+
+    /* Test an unknown name gets stub-resolver.so's address */
+    dnsresult_init(&r);
+    if(dnslookup_all("a", &r) != UTIL_SUCCESS || r.count != 1
+       || strcmp(r.addrs[0], "10.2.182.6") != 0){
+	fprintf(stderr, "error: synthesized address is %s\n", r.count ? r.addrs[0] : "missing");
+    }
+    dnsresult_free(&r);
+    if(atomic_load(&f.lookups) != 3 || atomic_load(&f.failures) != 1){
+	fprintf(stderr, "error: %ld lookups %ld failures, expected 3 and 1\n",
+		atomic_load(&f.lookups), atomic_load(&f.failures));
+    }
+    dnsresolver_set(NULL);
+    fakeresolver_cleanup(&f);
+
+    /* Test strict fails names not in the table */
+    if(fakeresolver_init(&f, "fake:strict,table=" TEST_TABLE) != FAKERESOLVER_SUCCESS){
+	fprintf(stderr, "error: strict spec refused\n");
+	return 0;
+    }
+    if(!fakeresolver_fails(&f, "a") || fakeresolver_fails(&f, "two.example.com")){
+	fprintf(stderr, "error: strict table answers the wrong names\n");
+    }
+    fakeresolver_cleanup(&f);
+    unlink(TEST_TABLE);
+
+    /* Test the fail rate and latency distributions */
+    if(fakeresolver_init(&f, "fake:latency=exp:500,fail=0.1,seed=7") != FAKERESOLVER_SUCCESS
+       || fakeresolver_init(&g, "fake:latency=exp:500,fail=0.1,seed=7") != FAKERESOLVER_SUCCESS){
+	fprintf(stderr, "error: exp spec refused\n");
+	return 0;
+    }
+    sample(&f, &mean, &failed);
+    sample(&g, &mean2, &failed2);
+    if(mean < 475.0 || mean > 525.0 || failed < 0.09 || failed > 0.11){
+	fprintf(stderr, "error: exp:500 fail=0.1 gave mean %.1f failed %.3f\n", mean, failed);
+    }
+    if(mean != mean2 || failed != failed2){
+	fprintf(stderr, "error: the same seed gave different draws\n");
+    }
+    fakeresolver_init(&g, "fake:latency=exp:500,fail=0.1,seed=8");
+    sample(&g, &mean2, &failed2);
+    if(mean == mean2){
+	fprintf(stderr, "error: another seed gave the same draws\n");
+    }
+
+    fakeresolver_init(&f, "fake:latency=uniform:100:300");
+    sample(&f, &mean, &failed);
+    if(mean < 195.0 || mean > 205.0 || failed != 0.0){
+	fprintf(stderr, "error: uniform:100:300 gave mean %.1f failed %.3f\n", mean, failed);
+    }
+
+    /* lognormal mean is median * e^(sigma^2 / 2) */
+    fakeresolver_init(&f, "fake:latency=lognormal:1000:0.5");
+    sample(&f, &mean, &failed);
+    if(mean < 1100.0 || mean > 1165.0){
+	fprintf(stderr, "error: lognormal:1000:0.5 gave mean %.1f\n", mean);
+    }
+
+    /* Test transient failures are drawn per try */
+    fakeresolver_init(&f, "fake:again=1");
+    throttle_init(&t, 0.0, 0, 0, 2, 0);
+    dnsresolver_set(&f.resolver);
+    dnslookup_set_throttle(&t);
+    dnsresult_init(&r);
+    if(dnslookup_all("a", &r) != UTIL_FAILURE || atomic_load(&f.transient) != 3){
+	fprintf(stderr, "error: again=1 with 2 retries made %ld tries\n", atomic_load(&f.transient));
+    }
+    dnsresult_free(&r);
+    fakeresolver_init(&f, "fake:again=0.5");
+    resolved = 0;
+    for(i = 0; i < 1000; i++){
+	snprintf(name, sizeof(name), "host%zu.example.com", i);
+	resolved += dnslookup_all(name, &r) == UTIL_SUCCESS;
+	dnsresult_free(&r);
+    }
+    /* 1 - 0.5^3 of them, 875 */
+    if(resolved < 820 || resolved > 930 || atomic_load(&t.gave_up) != 1 + 1000 - resolved){
+	fprintf(stderr, "error: again=0.5 with 2 retries resolved %d of 1000\n", resolved);
+    }
+    dnslookup_set_throttle(NULL);
+    dnsresolver_set(NULL);
+    throttle_cleanup(&t);
+
+    fakeresolver_init(&f, "fake:latency=const:42");
+    if(fakeresolver_latency_us(&f, "anything") != 42){
+	fprintf(stderr, "error: const:42 gave %lld\n", fakeresolver_latency_us(&f, "anything"));
+    }
+
+    return 0;
+}
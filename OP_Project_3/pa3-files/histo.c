@@ -0,0 +1,109 @@
+/*
+ * File: histo.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the log linear latency histogram. A
+ *      value's bucket is found from its highest set bit and the
+ *      HISTO_SUB_BITS bits below it.
+ *
+ */
+
+#include "histo.h"
+
+static int histo_bucket(unsigned long long v){
+    int shift;
+
+    if(v < HISTO_SUB){
+	return (int) v;
+    }
+    shift = 63 - __builtin_clzll(v) - HISTO_SUB_BITS;
+    return (shift + 1) * HISTO_SUB + (int) ((v >> shift) - HISTO_SUB);
+}
+
+/* Highest value that lands in bucket i */
+static long long histo_bucket_top(int i){
+    int shift;
+
+    if(i < HISTO_SUB){
+	return i;
+    }
+    shift = i / HISTO_SUB - 1;
+    return ((((long long) HISTO_SUB + i % HISTO_SUB) << shift)
+	    + ((1LL << shift) - 1));
+}
+
+void histo_init(histo* h){
+    int i;
+
+    for(i = 0; i < HISTO_BUCKETS; i++){
+	atomic_init(&h->counts[i], 0);
+    }
+    atomic_init(&h->count, 0);
+    atomic_init(&h->sum, 0);
+    atomic_init(&h->max, 0);
+}
+
+void histo_record_n(histo* h, long long value, long n){
+    long long max;
+
+    if(n <= 0){
+	return;
+    }
+    if(value < 0){
+	value = 0;
+    }
+    atomic_fetch_add_explicit(&h->counts[histo_bucket(value)], n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value * n, memory_order_relaxed);
+    max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while(value > max
+	  && !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+						    memory_order_relaxed,
+						    memory_order_relaxed));
+}
+
+long long histo_percentile(const histo* h, double pct){
+    long total = 0;
+    long seen = 0;
+    long want;
+    long counts[HISTO_BUCKETS];
+    long long max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    long long top;
+    int i;
+
+    /* one pass to copy, so the count and buckets agree */
+    for(i = 0; i < HISTO_BUCKETS; i++){
+	counts[i] = atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+	total += counts[i];
+    }
+    if(total == 0){
+	return 0;
+    }
+    want = (long) (total * pct / 100.0 + 0.5);
+    if(want < 1){
+	want = 1;
+    }
+    for(i = 0; i < HISTO_BUCKETS; i++){
+	seen += counts[i];
+	if(seen >= want){
+	    break;
+	}
+    }
+    /* the top bucket's range may run past anything recorded */
+    top = histo_bucket_top(i < HISTO_BUCKETS ? i : HISTO_BUCKETS - 1);
+    return top < max ? top : max;
+}
+
+void histo_json(const histo* h, FILE* out){
+    long count = atomic_load(&h->count);
+    long long sum = atomic_load(&h->sum);
+    long long max = atomic_load(&h->max);
+
+    fprintf(out, "\"count\":%ld,\"mean\":%lld,\"p50\":%lld,\"p90\":%lld,"
+	    "\"p99\":%lld,\"p999\":%lld,\"max\":%lld",
+	    count, count > 0 ? sum / count : 0,
+	    histo_percentile(h, 50.0), histo_percentile(h, 90.0),
+	    histo_percentile(h, 99.0), histo_percentile(h, 99.9), max);
+}
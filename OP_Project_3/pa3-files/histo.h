@@ -0,0 +1,57 @@
+/*
+ * File: histo.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a log linear latency histogram
+ *      in the style of HdrHistogram. Values below 2^HISTO_SUB_BITS
+ *      get a bucket each; above that every power of two is split
+ *      into 2^HISTO_SUB_BITS buckets, so any recorded value is
+ *      known to within 1/32 (about 3%) over the whole 64 bit
+ *      range, in a fixed 16 KiB.
+ *
+ *      Buckets are atomic counters: any number of threads may
+ *      record into one histogram, and another may read it, with
+ *      no lock.
+ *
+ */
+
+#ifndef HISTO_H
+#define HISTO_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+#define HISTO_SUB_BITS 5
+#define HISTO_SUB (1 << HISTO_SUB_BITS)
+#define HISTO_BUCKETS ((64 - HISTO_SUB_BITS + 1) * HISTO_SUB)
+
+typedef struct histo_s{
+    atomic_long counts[HISTO_BUCKETS];
+    atomic_long count;
+    atomic_llong sum;
+    atomic_llong max;
+} histo;
+
+/* Function to empty a histogram */
+void histo_init(histo* h);
+
+/* Function to record n occurrences of value (negative counts as 0) */
+void histo_record_n(histo* h, long long value, long n);
+
+static inline void histo_record(histo* h, long long value){
+    histo_record_n(h, value, 1);
+}
+
+/* Function to return the value at or below which pct percent of
+ * the recorded values fall, as the top of its bucket (0 if empty)
+ */
+long long histo_percentile(const histo* h, double pct);
+
+/* Function to print the histogram's summary as the members of a
+ * JSON object (no braces): count, mean, percentiles and max
+ */
+void histo_json(const histo* h, FILE* out);
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * File: histoTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the latency histogram.
+ *      Small values must come back exactly and large ones within
+ *      one bucket (1/32); percentiles of a known distribution
+ *      must land within that error; and counts recorded from
+ *      several threads at once must all be kept.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "histo.h"
+
+#define TEST_THREADS 4
+#define TEST_RECORDS 100000
+
+static histo shared;
+
+/* |got - want| within want/HISTO_SUB, and never below want */
+static int close_enough(long long got, long long want){
+    return got >= want && got - want <= want / HISTO_SUB;
+}
+
+static void* record_many(void* arg){
+    long long base = *(long long*) arg;
+    int i;
+
+    for(i = 0; i < TEST_RECORDS; i++){
+	histo_record(&shared, base + i % 1000);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static histo h;
+    static const long long values[] = {0, 1, 31, 32, 33, 63, 64, 65, 1000,
+				       123456, 1LL << 40, (1LL << 62) + 12345};
+    pthread_t ids[TEST_THREADS];
+    long long bases[TEST_THREADS];
+    long long got;
+    size_t i;
+
+    /* Test one value at a time comes back within its bucket */
+    for(i = 0; i < sizeof(values) / sizeof(values[0]); i++){
+	histo_init(&h);
+	histo_record(&h, values[i]);
+	got = histo_percentile(&h, 50.0);
+	if(got != values[i]){
+	    /* clamped to max, so a lone value is exact */
+	    fprintf(stderr, "error: lone %lld came back as %lld\n", values[i], got);
+	}
+    }
+
+    /* Test small values are exact and large ones within 1/32 */
+    histo_init(&h);
+    histo_record(&h, 17);
+    histo_record(&h, 5000000);
+    if(histo_percentile(&h, 10.0) != 17){
+	fprintf(stderr, "error: p10 of {17, 5000000} is %lld\n", histo_percentile(&h, 10.0));
+    }
+
+    /* Test percentiles of 1..10000 */
+    histo_init(&h);
+    for(i = 1; i <= 10000; i++){
+	histo_record(&h, (long long) i);
+    }
+    if(!close_enough(histo_percentile(&h, 50.0), 5000)
+       || !close_enough(histo_percentile(&h, 99.0), 9900)
+       || histo_percentile(&h, 100.0) != 10000
+       || atomic_load(&h.count) != 10000
+       || atomic_load(&h.sum) != 50005000LL){
+	fprintf(stderr, "error: 1..10000: p50 %lld p99 %lld p100 %lld\n",
+		histo_percentile(&h, 50.0), histo_percentile(&h, 99.0),
+		histo_percentile(&h, 100.0));
+    }
+
+    /* Test record_n and negative values */
+    histo_init(&h);
+    histo_record_n(&h, 250, 3);
+    histo_record(&h, -5);
+    if(atomic_load(&h.count) != 4 || histo_percentile(&h, 25.0) != 0
+       || !close_enough(histo_percentile(&h, 75.0), 250)){
+	fprintf(stderr, "error: record_n/negative: count %ld p25 %lld p75 %lld\n",
+		atomic_load(&h.count), histo_percentile(&h, 25.0), histo_percentile(&h, 75.0));
+    }
+
+    /* Test an empty histogram */
+    histo_init(&h);
+    if(histo_percentile(&h, 99.0) != 0){
+	fprintf(stderr, "error: empty histogram p99 is %lld\n", histo_percentile(&h, 99.0));
+    }
+
+    /* Test concurrent recording */
+    histo_init(&shared);
+    for(i = 0; i < TEST_THREADS; i++){
+	bases[i] = (long long) i * 1000000;
+	pthread_create(&ids[i], NULL, record_many, &bases[i]);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(ids[i], NULL);
+    }
+    if(atomic_load(&shared.count) != TEST_THREADS * TEST_RECORDS
+       || atomic_load(&shared.max) != (TEST_THREADS - 1) * 1000000LL + 999){
+	fprintf(stderr, "error: concurrent count %ld max %lld\n",
+		atomic_load(&shared.count), atomic_load(&shared.max));
+    }
+
+    return 0;
+}
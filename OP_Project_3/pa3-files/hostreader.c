@@ -0,0 +1,242 @@
+/*
+ * File: hostreader.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the zero copy hostname reader. A file
+ *      is mapped into a reservation one page larger than the
+ *      file, so the tail of the last file page and the whole
+ *      spare page read as zeros. The scanner classifies 16
+ *      bytes per step with SSE2 compares (a plain byte loop
+ *      where SSE2 is missing); NUL counts as whitespace, so
+ *      every name ends inside the padding at the latest.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hostreader.h"
+
+static inline int is_space_byte(char c){
+    return c == ' ' || (c >= '\t' && c <= '\r') || c == '\0';
+}
+
+#ifdef __SSE2__
+
+/* Bit i set if p[i] is whitespace (as isspace()) or NUL */
+static inline unsigned int space_mask16(const char* p){
+    __m128i v = _mm_loadu_si128((const __m128i*) p);
+    /* \t \n \v \f \r are 9..13: subtract 9, then unsigned <= 4 */
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(9));
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+    __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i nul = _mm_cmpeq_epi8(v, _mm_setzero_si128());
+    return (unsigned int) _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(ctl, sp), nul));
+}
+
+/* First non space byte at or after p, or end */
+static const char* skip_space(const char* p, const char* end){
+    unsigned int m;
+
+    while(p < end){
+	m = ~space_mask16(p) & 0xFFFF;
+	if(m){
+	    p += __builtin_ctz(m);
+	    return p < end ? p : end;
+	}
+	p += 16;
+    }
+    return end;
+}
+
+/* First space or NUL byte at or after p; the padding guarantees one */
+static const char* find_space(const char* p){
+    unsigned int m;
+
+    for(;;){
+	m = space_mask16(p);
+	if(m){
+	    return p + __builtin_ctz(m);
+	}
+	p += 16;
+    }
+}
+
+#else
+
+static const char* skip_space(const char* p, const char* end){
+    while(p < end && is_space_byte(*p)){
+	p++;
+    }
+    return p;
+}
+
+static const char* find_space(const char* p){
+    while(!is_space_byte(*p)){
+	p++;
+    }
+    return p;
+}
+
+#endif
+
+/* Map fd so at least HOSTREADER_PAD zero bytes follow the data */
+static int hostreader_map(hostreader* r, int fd, size_t size){
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t reserve = (size + page - 1) / page * page + page;
+    char* base;
+
+    base = mmap(NULL, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED){
+	return HOSTREADER_FAILURE;
+    }
+    if(mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED){
+	munmap(base, reserve);
+	return HOSTREADER_FAILURE;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    r->base = base;
+    r->base_size = reserve;
+    r->mapped = 1;
+    r->pos = base;
+    r->end = base + size;
+    return HOSTREADER_SUCCESS;
+}
+
+/* Read fd to EOF in HOSTREADER_CHUNK steps into one buffer */
+static int hostreader_slurp(hostreader* r, int fd){
+    size_t cap = HOSTREADER_CHUNK;
+    size_t used = 0;
+    char* buf = malloc(cap + HOSTREADER_PAD);
+    char* grown;
+    ssize_t n;
+
+    if(!buf){
+	return HOSTREADER_FAILURE;
+    }
+    for(;;){
+	if(cap - used < HOSTREADER_CHUNK / 2){
+	    grown = realloc(buf, cap * 2 + HOSTREADER_PAD);
+	    if(!grown){
+		free(buf);
+		errno = ENOMEM;
+		return HOSTREADER_FAILURE;
+	    }
+	    buf = grown;
+	    cap *= 2;
+	}
+	n = read(fd, buf + used, cap - used);
+	if(n < 0 && errno == EINTR){
+	    continue;
+	}
+	if(n < 0){
+	    free(buf);
+	    return HOSTREADER_FAILURE;
+	}
+	if(n == 0){
+	    break;
+	}
+	used += n;
+    }
+    memset(buf + used, 0, HOSTREADER_PAD);
+
+    r->base = buf;
+    r->base_size = cap + HOSTREADER_PAD;
+    r->mapped = 0;
+    r->pos = buf;
+    r->end = buf + used;
+    return HOSTREADER_SUCCESS;
+}
+
+int hostreader_open(hostreader* r, const char* path){
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    int ret;
+    int saved;
+
+    memset(r, 0, sizeof(*r));
+    if(fd < 0){
+	return HOSTREADER_FAILURE;
+    }
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+       && hostreader_map(r, fd, (size_t) st.st_size) == HOSTREADER_SUCCESS){
+	ret = HOSTREADER_SUCCESS;
+    }
+    else{
+	ret = hostreader_slurp(r, fd);
+    }
+    saved = errno;
+    close(fd);
+    errno = saved;
+    return ret;
+}
+
+int hostreader_next(hostreader* r, const char** name, size_t* len){
+    const char* start = skip_space(r->pos, r->end);
+    const char* stop;
+
+    if(start >= r->end){
+	r->pos = r->end;
+	return 0;
+    }
+    stop = find_space(start);
+    /* a NUL inside the data ends a name like a space does */
+    r->pos = stop < r->end ? stop + 1 : r->end;
+    *name = start;
+    *len = stop - start;
+    return 1;
+}
+
+size_t hostreader_size(const hostreader* r){
+    return r->end - r->pos;
+}
+
+/* Move a range boundary at offset past the name it splits, so
+ * that name belongs to the range ending there */
+static const char* hostreader_align(const hostreader* r, size_t offset){
+    const char* p = r->pos + offset;
+
+    if(p >= r->end){
+	return r->end;
+    }
+    if(p > r->pos && !is_space_byte(p[-1])){
+	p = find_space(p);
+    }
+    return p < r->end ? p : r->end;
+}
+
+void hostreader_range(const hostreader* r, size_t begin, size_t end,
+		      hostreader* view){
+    memset(view, 0, sizeof(*view));
+    view->pos = hostreader_align(r, begin);
+    view->end = hostreader_align(r, end);
+    if(view->pos > view->end){
+	view->pos = view->end;
+    }
+}
+
+size_t hostreader_token_len(const char* name){
+    return find_space(name) - name;
+}
+
+void hostreader_close(hostreader* r){
+    if(r->mapped){
+	munmap(r->base, r->base_size);
+    }
+    else{
+	free(r->base);
+    }
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,74 @@
+/*
+ * File: hostreader.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a zero copy hostname reader.
+ *      The whole input file is mapped (or, for pipes and other
+ *      files mmap refuses, read into one buffer) and split on
+ *      whitespace 16 bytes at a time with SSE2. Hostnames come
+ *      back as (pointer, length) slices into that memory, so
+ *      reading a name allocates nothing.
+ *
+ *      The memory always ends in at least HOSTREADER_PAD zero
+ *      bytes past the data, which lets the scanner load whole
+ *      blocks without bounds checks and gives every slice a
+ *      terminator: hostreader_token_len() recovers a slice's
+ *      length from its pointer alone.
+ *
+ */
+
+#ifndef HOSTREADER_H
+#define HOSTREADER_H
+
+#include <stddef.h>
+
+#define HOSTREADER_FAILURE -1
+#define HOSTREADER_SUCCESS 0
+
+/* zero bytes guaranteed after the data */
+#define HOSTREADER_PAD 64
+/* read size when the file cannot be mapped */
+#define HOSTREADER_CHUNK (1 << 20)
+
+typedef struct hostreader_s{
+    char* base;             /* mapping or buffer start */
+    size_t base_size;       /* bytes reserved at base */
+    const char* pos;        /* next byte to scan */
+    const char* end;        /* end of file data */
+    int mapped;             /* base is an mmap, not malloc */
+} hostreader;
+
+/* Function to map or read the file at path
+ * Returns HOSTREADER_SUCCESS or HOSTREADER_FAILURE with errno set
+ */
+int hostreader_open(hostreader* r, const char* path);
+
+/* Function to return the next whitespace separated name
+ * Sets *name and *len and returns 1, or returns 0 at the end.
+ * name stays valid until hostreader_close().
+ */
+int hostreader_next(hostreader* r, const char** name, size_t* len);
+
+/* Function to return the size of r's file data */
+size_t hostreader_size(const hostreader* r);
+
+/* Function to set view up to return only the names of r that
+ * start in bytes [begin, end) of the data. A name crossing a
+ * boundary goes to the range it starts in, so ranges that tile
+ * the file return every name exactly once. view shares r's
+ * memory and must not be closed.
+ */
+void hostreader_range(const hostreader* r, size_t begin, size_t end,
+		      hostreader* view);
+
+/* Function to return the length of a name from hostreader_next()
+ * given only its pointer
+ */
+size_t hostreader_token_len(const char* name);
+
+/* Function to unmap or free the file data */
+void hostreader_close(hostreader* r);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * File: hostreaderTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the zero copy hostname
+ *      reader. Random files of names and mixed whitespace are
+ *      split by hostreader and by a plain byte loop, and the
+ *      two must agree, including at page boundaries, with no
+ *      trailing newline, and when reading from a pipe. Cutting
+ *      a file into random ranges must give the same names.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "hostreader.h"
+
+#define TEST_PATH "hostreaderTest.tmp"
+#define TEST_MAX_SIZE 20000
+
+static const char spaces[] = " \t\n\r\v\f";
+
+static int is_space(char c){
+    return c == '\0' || strchr(spaces, c) != NULL;
+}
+
+/* Fill buf with size bytes of names separated by whitespace runs */
+static void fill(char* buf, int size, unsigned int* seed){
+    int i = 0;
+    int n;
+
+    while(i < size){
+	n = 1 + rand_r(seed) % (rand_r(seed) % 8 ? 20 : 300);
+	while(n-- > 0 && i < size){
+	    buf[i++] = 'a' + rand_r(seed) % 26;
+	}
+	n = 1 + rand_r(seed) % 3;
+	while(n-- > 0 && i < size){
+	    buf[i++] = spaces[rand_r(seed) % (sizeof(spaces) - 1)];
+	}
+    }
+}
+
+/* Split path with hostreader and check it against buf */
+static int check(const char* label, const char* path,
+		 const char* buf, int size){
+    hostreader r;
+    const char* name;
+    size_t len;
+    int i = 0;
+    int start;
+    int errors = 0;
+
+    if(hostreader_open(&r, path) == HOSTREADER_FAILURE){
+	fprintf(stderr, "error: %s: could not open %s\n", label, path);
+	return 1;
+    }
+    for(;;){
+	while(i < size && is_space(buf[i])){
+	    i++;
+	}
+	start = i;
+	while(i < size && !is_space(buf[i])){
+	    i++;
+	}
+	if(!hostreader_next(&r, &name, &len)){
+	    if(start < size){
+		errors++;
+	    }
+	    break;
+	}
+	if(start == size || len != (size_t) (i - start)
+	   || memcmp(name, buf + start, len) != 0
+	   || hostreader_token_len(name) != len){
+	    errors++;
+	    break;
+	}
+    }
+    hostreader_close(&r);
+
+    if(errors){
+	fprintf(stderr, "error: %s: names differ near byte %d of %d\n",
+		label, start, size);
+    }
+    return errors;
+}
+
+/* Split path into pieces random ranges and check the names they
+ * return, in order, against the whole file */
+static int check_ranges(const char* label, const char* path,
+			int pieces, unsigned int* seed){
+    hostreader r, whole, view;
+    const char* name;
+    const char* expect;
+    size_t len, expect_len, size, begin, end;
+    int p;
+    int errors = 0;
+
+    if(hostreader_open(&r, path) == HOSTREADER_FAILURE
+       || hostreader_open(&whole, path) == HOSTREADER_FAILURE){
+	fprintf(stderr, "error: %s: could not open %s\n", label, path);
+	return 1;
+    }
+    size = hostreader_size(&r);
+    begin = 0;
+    for(p = 0; p < pieces && !errors; p++){
+	end = p == pieces - 1 ? size
+	    : begin + (size > begin ? rand_r(seed) % (size - begin + 1) : 0);
+	hostreader_range(&r, begin, end, &view);
+	while(hostreader_next(&view, &name, &len)){
+	    if(!hostreader_next(&whole, &expect, &expect_len)
+	       || expect_len != len || memcmp(expect, name, len) != 0){
+		errors++;
+		break;
+	    }
+	}
+	begin = end;
+    }
+    if(!errors && hostreader_next(&whole, &expect, &expect_len)){
+	errors++;
+    }
+    hostreader_close(&r);
+    hostreader_close(&whole);
+
+    if(errors){
+	fprintf(stderr, "error: %s: ranges lost or repeated a name\n", label);
+    }
+    return errors;
+}
+
+static void write_file(const char* buf, int size){
+    int fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || write(fd, buf, size) != size){
+	perror("Error writing " TEST_PATH);
+    }
+    close(fd);
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static char buf[TEST_MAX_SIZE];
+    static const int sizes[] = {0, 1, 15, 16, 17, 4095, 4096, 4097,
+				8192, TEST_MAX_SIZE};
+    unsigned int seed = 1;
+    hostreader r;
+    char label[64];
+    char path[64];
+    int fds[2];
+    pid_t pid;
+    size_t i;
+    int round;
+
+    /* Test random files of sizes around block and page edges */
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+	for(round = 0; round < 20; round++){
+	    fill(buf, sizes[i], &seed);
+	    /* every other round ends in the middle of a name */
+	    if(round % 2 && sizes[i] > 0){
+		buf[sizes[i] - 1] = 'z';
+	    }
+	    write_file(buf, sizes[i]);
+	    snprintf(label, sizeof(label), "size %d round %d", sizes[i], round);
+	    if(check(label, TEST_PATH, buf, sizes[i])
+	       || check_ranges(label, TEST_PATH, 1 + round % 7, &seed)){
+		break;
+	    }
+	}
+    }
+
+    /* Test that a NUL byte ends a name like whitespace */
+    memcpy(buf, "one\0two three", 13);
+    write_file(buf, 13);
+    check("embedded NUL", TEST_PATH, buf, 13);
+    unlink(TEST_PATH);
+
+    /* Test the read() path with a pipe */
+    fill(buf, TEST_MAX_SIZE, &seed);
+    if(pipe(fds) == 0){
+	pid = fork();
+	if(pid == 0){
+	    close(fds[0]);
+	    if(write(fds[1], buf, TEST_MAX_SIZE) != TEST_MAX_SIZE){
+		_exit(1);
+	    }
+	    _exit(0);
+	}
+	close(fds[1]);
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fds[0]);
+	check("pipe", path, buf, TEST_MAX_SIZE);
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+    }
+
+    /* Test a missing file */
+    if(hostreader_open(&r, "hostreaderTest.missing") != HOSTREADER_FAILURE){
+	fprintf(stderr, "error: opened a missing file\n");
+	hostreader_close(&r);
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * File: lookup-client.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains a thin client for multi-lookup --daemon.
+ *      It takes the same input and output files as multi-lookup,
+ *      sends the names to the daemon in batches and writes the
+ *      same lines, so scripts can switch over without paying for
+ *      a cold start on every list.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lookupd.h"
+
+#define MINARGS 4
+#define USAGE "[-a] [-b N] <socketPath> <inputFilePath> ... <outputFilePath|->"
+#define SBUFSIZE 1025
+#define INPUTFS "%1024s"
+#define DEFAULT_BATCH 256
+
+/* Look up the count names in batch and write their lines */
+static int flush_batch(int fd, char** batch, int count, int flags, FILE* out){
+    static lookupd_reply reply;
+    int i;
+
+    if(count == 0){
+	return LOOKUPD_SUCCESS;
+    }
+    if(lookupd_send(fd, (const char* const*) batch, count, flags) == LOOKUPD_FAILURE
+       || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != count){
+	fprintf(stderr, "Error talking to the lookup daemon\n");
+	return LOOKUPD_FAILURE;
+    }
+    for(i = 0; i < count; i++){
+	if(reply.answers[i].result != LOOKUPD_RESOLVED){
+	    fprintf(stderr, "DNS lookup error hostname: %s\n", batch[i]);
+	}
+	fprintf(out, "%s, %s\n", batch[i], reply.answers[i].ips);
+    }
+    return LOOKUPD_SUCCESS;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Local Vars */
+    const char* prog = argv[0];
+    FILE* inputfp = NULL;
+    FILE* outputfp = NULL;
+    char errorstr[SBUFSIZE];
+    char** batch;
+    int batch_size = DEFAULT_BATCH;
+    int flags = 0;
+    int count = 0;
+    int status = EXIT_SUCCESS;
+    int fd;
+    int opt;
+    int i;
+
+    /* Parse Options */
+    while((opt = getopt(argc, argv, "ab:")) != -1){
+	if(opt == 'a'){
+	    flags |= LOOKUPD_FLAG_ALL;
+	}
+	else if(opt == 'b' && atoi(optarg) >= 1 && atoi(optarg) <= LOOKUPD_MAX_NAMES){
+	    batch_size = atoi(optarg);
+	}
+	else{
+	    fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	    return EXIT_FAILURE;
+	}
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    /* Check Arguments */
+    if(argc < MINARGS){
+	fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
+	fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	return EXIT_FAILURE;
+    }
+
+    fd = lookupd_connect(argv[1]);
+    if(fd < 0){
+	sprintf(errorstr, "Error connecting to %.900s", argv[1]);
+	perror(errorstr);
+	return EXIT_FAILURE;
+    }
+
+    /* Open Output File */
+    outputfp = strcmp(argv[argc-1], "-") == 0 ? stdout : fopen(argv[argc-1], "w");
+    if(!outputfp){
+	perror("Error Opening Output File");
+	return EXIT_FAILURE;
+    }
+
+    batch = calloc(batch_size, sizeof(*batch));
+    for(i = 0; batch && i < batch_size; i++){
+	if(!(batch[i] = malloc(SBUFSIZE))){
+	    break;
+	}
+    }
+    if(!batch || i < batch_size){
+	perror("Error allocating names");
+	return EXIT_FAILURE;
+    }
+
+    /* Loop Through Input Files */
+    for(i=2; i<(argc-1) && status == EXIT_SUCCESS; i++){
+
+	/* Open Input File */
+	inputfp = fopen(argv[i], "r");
+	if(!inputfp){
+	    sprintf(errorstr, "Error Opening Input File: %.900s", argv[i]);
+	    perror(errorstr);
+	    continue;
+	}
+
+	/* Read File and send full batches */
+	while(fscanf(inputfp, INPUTFS, batch[count]) > 0){
+	    if(++count == batch_size){
+		if(flush_batch(fd, batch, count, flags, outputfp) == LOOKUPD_FAILURE){
+		    status = EXIT_FAILURE;
+		    break;
+		}
+		count = 0;
+	    }
+	}
+
+	/* Close Input File */
+	fclose(inputfp);
+    }
+    if(status == EXIT_SUCCESS && flush_batch(fd, batch, count, flags, outputfp) == LOOKUPD_FAILURE){
+	status = EXIT_FAILURE;
+    }
+
+    /* Close Output File */
+    if(outputfp != stdout){
+	fclose(outputfp);
+    }
+    close(fd);
+    for(i = 0; i < batch_size; i++){
+	free(batch[i]);
+    }
+    free(batch);
+
+    return status;
+}
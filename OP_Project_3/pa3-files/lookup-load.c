@@ -0,0 +1,211 @@
+/*
+ * File: lookup-load.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains a load generator for multi-lookup
+ *      --daemon. It reads hostnames from the input files, then
+ *      keeps -c connections busy for -d seconds, each sending
+ *      batches of -b names and waiting for the reply, and prints
+ *      the requests and names answered a second and the request
+ *      latency percentiles.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "lookupd.h"
+#include "histo.h"
+
+#define MINARGS 3
+#define USAGE "[-a] [-b N] [-c CONNS] [-d SECS] <socketPath> <inputFilePath> ..."
+#define SBUFSIZE 1025
+#define INPUTFS "%1024s"
+#define DEFAULT_BATCH 16
+#define DEFAULT_CONNS 4
+#define DEFAULT_SECS 5
+#define MAX_CONNS 4096
+
+static const char* socket_path;
+static char** names;
+static long nnames;
+static int batch_size = DEFAULT_BATCH;
+static int flags;
+static long long stop_ns;
+static atomic_long next_name;
+static atomic_long requests;
+static atomic_long answered;
+static atomic_long failed;
+static atomic_int broken;
+static histo latency;
+
+static long long now_ns(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int add_name(const char* name, long* cap){
+    char** grown;
+
+    if(nnames == *cap){
+	*cap = *cap ? *cap * 2 : 1024;
+	grown = realloc(names, *cap * sizeof(*names));
+	if(!grown){
+	    return -1;
+	}
+	names = grown;
+    }
+    names[nnames] = strdup(name);
+    return names[nnames++] ? 0 : -1;
+}
+
+/* One connection: send batches until the time is up */
+static void* load(void* arg){
+    const char* batch[LOOKUPD_MAX_NAMES];
+    lookupd_reply reply;
+    long long start, end;
+    long first;
+    int fd;
+    int i;
+
+    (void) arg;
+    memset(&reply, 0, sizeof(reply));
+    fd = lookupd_connect(socket_path);
+    if(fd < 0){
+	atomic_fetch_add(&broken, 1);
+	return NULL;
+    }
+    for(start = now_ns(); start < stop_ns; start = end){
+	/* every connection walks the same list, a batch at a time */
+	first = atomic_fetch_add(&next_name, batch_size);
+	for(i = 0; i < batch_size; i++){
+	    batch[i] = names[(first + i) % nnames];
+	}
+	if(lookupd_send(fd, batch, batch_size, flags) == LOOKUPD_FAILURE
+	   || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != batch_size){
+	    atomic_fetch_add(&broken, 1);
+	    break;
+	}
+	end = now_ns();
+	histo_record(&latency, end - start);
+	atomic_fetch_add(&requests, 1);
+	atomic_fetch_add(&answered, batch_size);
+	for(i = 0; i < reply.count; i++){
+	    if(reply.answers[i].result != LOOKUPD_RESOLVED){
+		atomic_fetch_add(&failed, 1);
+	    }
+	}
+    }
+    close(fd);
+    lookupd_reply_free(&reply);
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Local Vars */
+    const char* prog = argv[0];
+    FILE* inputfp = NULL;
+    char hostname[SBUFSIZE];
+    pthread_t* threads;
+    int conns = DEFAULT_CONNS;
+    int secs = DEFAULT_SECS;
+    long cap = 0;
+    long long start;
+    double elapsed;
+    int opt;
+    int i;
+
+    /* Parse Options */
+    while((opt = getopt(argc, argv, "ab:c:d:")) != -1){
+	if(opt == 'a'){
+	    flags |= LOOKUPD_FLAG_ALL;
+	}
+	else if(opt == 'b' && atoi(optarg) >= 1 && atoi(optarg) <= LOOKUPD_MAX_NAMES){
+	    batch_size = atoi(optarg);
+	}
+	else if(opt == 'c' && atoi(optarg) >= 1 && atoi(optarg) <= MAX_CONNS){
+	    conns = atoi(optarg);
+	}
+	else if(opt == 'd' && atoi(optarg) >= 1){
+	    secs = atoi(optarg);
+	}
+	else{
+	    fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	    return EXIT_FAILURE;
+	}
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    /* Check Arguments */
+    if(argc < MINARGS){
+	fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
+	fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	return EXIT_FAILURE;
+    }
+    socket_path = argv[1];
+
+    /* Read every name up front */
+    for(i = 2; i < argc; i++){
+	inputfp = fopen(argv[i], "r");
+	if(!inputfp){
+	    perror("Error Opening Input File");
+	    return EXIT_FAILURE;
+	}
+	while(fscanf(inputfp, INPUTFS, hostname) > 0){
+	    if(add_name(hostname, &cap) < 0){
+		perror("Error allocating names");
+		return EXIT_FAILURE;
+	    }
+	}
+	fclose(inputfp);
+    }
+    if(nnames == 0){
+	fprintf(stderr, "No hostnames in the input files\n");
+	return EXIT_FAILURE;
+    }
+
+    histo_init(&latency);
+    threads = calloc(conns, sizeof(*threads));
+    if(!threads){
+	perror("Error allocating threads");
+	return EXIT_FAILURE;
+    }
+    start = now_ns();
+    stop_ns = start + secs * 1000000000LL;
+    for(i = 0; i < conns; i++){
+	if(pthread_create(&threads[i], NULL, load, NULL) != 0){
+	    fprintf(stderr, "Error creating connection thread %d\n", i);
+	    conns = i;
+	    break;
+	}
+    }
+    for(i = 0; i < conns; i++){
+	pthread_join(threads[i], NULL);
+    }
+    elapsed = (now_ns() - start) / 1e9;
+
+    printf("connections=%d batch=%d seconds=%.2f requests=%ld names=%ld failed=%ld broken=%d\n",
+	   conns, batch_size, elapsed, atomic_load(&requests), atomic_load(&answered),
+	   atomic_load(&failed), atomic_load(&broken));
+    printf("requests_per_sec=%.0f names_per_sec=%.0f p50_us=%.1f p99_us=%.1f max_us=%.1f\n",
+	   atomic_load(&requests) / elapsed, atomic_load(&answered) / elapsed,
+	   histo_percentile(&latency, 50.0) / 1e3, histo_percentile(&latency, 99.0) / 1e3,
+	   atomic_load(&latency.max) / 1e3);
+
+    for(i = 0; i < nnames; i++){
+	free(names[i]);
+    }
+    free(names);
+    free(threads);
+    return atomic_load(&broken) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
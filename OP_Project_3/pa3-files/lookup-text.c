@@ -0,0 +1,94 @@
+/*
+ * File: lookup-text.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the converter from the binary result
+ *      file (multi-lookup --format binary) back to the text
+ *      output, one "hostname, addresses" line per record. With -c
+ *      each line starts with how many times the hostname came
+ *      up, which is how a --dedup file is usually read.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "resultfile.h"
+
+#define MINARGS 3
+#define USAGE "[-c] <resultFilePath> <outputFilePath|->"
+#define SBUFSIZE 1025
+
+int main(int argc, char* argv[]){
+
+    /* Local Vars */
+    const char* prog = argv[0];
+    FILE* outputfp = NULL;
+    char errorstr[SBUFSIZE];
+    resultfile_reader reader;
+    resultfile_entry entry;
+    int counts = 0;
+    int status = EXIT_SUCCESS;
+    int opt;
+    int ret;
+
+    /* Parse Options */
+    while((opt = getopt(argc, argv, "c")) != -1){
+	if(opt == 'c'){
+	    counts = 1;
+	}
+	else{
+	    fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	    return EXIT_FAILURE;
+	}
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    /* Check Arguments */
+    if(argc < MINARGS){
+	fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
+	fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	return EXIT_FAILURE;
+    }
+
+    if(resultfile_open(&reader, argv[1]) == RESULTFILE_FAILURE){
+	sprintf(errorstr, "Error reading result file %.900s", argv[1]);
+	perror(errorstr);
+	return EXIT_FAILURE;
+    }
+
+    /* Open Output File */
+    outputfp = strcmp(argv[2], "-") == 0 ? stdout : fopen(argv[2], "w");
+    if(!outputfp){
+	perror("Error Opening Output File");
+	resultfile_close(&reader);
+	return EXIT_FAILURE;
+    }
+
+    /* One line per record */
+    while((ret = resultfile_next(&reader, &entry)) == 1){
+	if(counts){
+	    fprintf(outputfp, "%" PRIu64 " ", entry.count);
+	}
+	fprintf(outputfp, "%s, %s\n", entry.hostname, entry.ips);
+    }
+    if(ret == RESULTFILE_FAILURE){
+	fprintf(stderr, "Result file %s is corrupt\n", argv[1]);
+	status = EXIT_FAILURE;
+    }
+
+    /* Close Output File */
+    if(outputfp != stdout && fclose(outputfp) != 0){
+	perror("Error writing output file");
+	status = EXIT_FAILURE;
+    }
+    resultfile_close(&reader);
+
+    return status;
+}
@@ -4,9 +4,14 @@
  * Project: CSCI 3753 Programming Assignment 2
  * Create Date: 2012/02/01
  * Modify Date: 2012/02/01
+ * Modify Date: 2026/10/17
  * Description:
  * 	This file contains the reference non-threaded
  *      solution to this assignment.
+ *
+ *      -r SPEC resolves through a fake backend (see
+ *      fakeresolver.h) so it can be benchmarked against
+ *      multi-lookup without a network.
  *  
  */
 
@@ -14,28 +19,52 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 
 #include "util.h"
+#include "fakeresolver.h"
 
 #define MINARGS 3
-#define USAGE "<inputFilePath> <outputFilePath>"
+#define USAGE "[-r fake[:...]] <inputFilePath> ... <outputFilePath>"
 #define SBUFSIZE 1025
 #define INPUTFS "%1024s"
 
 int main(int argc, char* argv[]){
 
     /* Local Vars */
+    const char* prog = argv[0];
     FILE* inputfp = NULL;
     FILE* outputfp = NULL;
     char hostname[SBUFSIZE];
     char errorstr[SBUFSIZE];
     char firstipstr[INET6_ADDRSTRLEN];
+    fakeresolver fake;
+    int use_fake = 0;
+    int opt;
     int i;
-    
+
+    /* Parse Options */
+    while((opt = getopt(argc, argv, "r:")) != -1){
+	/* the last -r wins */
+	if(use_fake){
+	    dnsresolver_set(NULL);
+	    fakeresolver_cleanup(&fake);
+	    use_fake = 0;
+	}
+	if(opt != 'r' || fakeresolver_init(&fake, optarg) == FAKERESOLVER_FAILURE){
+	    fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
+	    return EXIT_FAILURE;
+	}
+	dnsresolver_set(&fake.resolver);
+	use_fake = 1;
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
     /* Check Arguments */
     if(argc < MINARGS){
 	fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
-	fprintf(stderr, "Usage:\n %s %s\n", argv[0], USAGE);
+	fprintf(stderr, "Usage:\n %s %s\n", prog, USAGE);
 	return EXIT_FAILURE;
     }
 
@@ -78,5 +107,10 @@ int main(int argc, char* argv[]){
     /* Close Output File */
     fclose(outputfp);
 
+    if(use_fake){
+	dnsresolver_set(NULL);
+	fakeresolver_cleanup(&fake);
+    }
+
     return EXIT_SUCCESS;
 }
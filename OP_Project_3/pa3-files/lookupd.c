@@ -0,0 +1,565 @@
+/*
+ * File: lookupd.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the lookup daemon. An acceptor thread
+ *      starts one thread per connection; that thread reads a
+ *      request, puts each of its names on the shared job list
+ *      and waits for the resident resolver threads to answer
+ *      them all before writing the reply.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lookupd.h"
+
+/* Largest reply a client accepts */
+#define LOOKUPD_MAX_REPLY (4 + LOOKUPD_MAX_NAMES * (3 + UTIL_ADDRLIST_SIZE))
+
+static void put16(unsigned char* p, uint16_t v){
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void put32(unsigned char* p, uint32_t v){
+    put16(p, v >> 16);
+    put16(p + 2, v & 0xFFFF);
+}
+
+static uint16_t get16(const unsigned char* p){
+    return (uint16_t) (p[0] << 8 | p[1]);
+}
+
+static uint32_t get32(const unsigned char* p){
+    return (uint32_t) get16(p) << 16 | get16(p + 2);
+}
+
+/* Read exactly n bytes. Returns 1, 0 at end of file before any
+ * byte, or -1 on an error or a short read */
+static int read_full(int fd, void* buf, size_t n){
+    size_t got = 0;
+    ssize_t r;
+
+    while(got < n){
+	r = read(fd, (char*) buf + got, n - got);
+	if(r < 0 && errno == EINTR){
+	    continue;
+	}
+	if(r <= 0){
+	    return r == 0 && got == 0 ? 0 : -1;
+	}
+	got += r;
+    }
+    return 1;
+}
+
+static int write_full(int fd, const void* buf, size_t n){
+    size_t put = 0;
+    ssize_t w;
+
+    while(put < n){
+	w = send(fd, (const char*) buf + put, n - put, MSG_NOSIGNAL);
+	if(w < 0 && errno == EINTR){
+	    continue;
+	}
+	if(w <= 0){
+	    return LOOKUPD_FAILURE;
+	}
+	put += w;
+    }
+    return LOOKUPD_SUCCESS;
+}
+
+/* Grow *buf to at least size bytes */
+static int reserve(unsigned char** buf, size_t* cap, size_t size){
+    unsigned char* grown;
+
+    if(size <= *cap){
+	return LOOKUPD_SUCCESS;
+    }
+    grown = realloc(*buf, size);
+    if(!grown){
+	return LOOKUPD_FAILURE;
+    }
+    *buf = grown;
+    *cap = size;
+    return LOOKUPD_SUCCESS;
+}
+
+static int unix_address(const char* path, struct sockaddr_un* addr){
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr->sun_path)){
+	fprintf(stderr, "Socket path too long: %s\n", path);
+	return LOOKUPD_FAILURE;
+    }
+    strcpy(addr->sun_path, path);
+    return LOOKUPD_SUCCESS;
+}
+
+static void* lookupd_resolve(void* arg){
+    lookupd* d = arg;
+    lookupd_job* job;
+    lookupd_conn* conn;
+
+    for(;;){
+	pthread_mutex_lock(&d->jobs_lock);
+	while(!d->jobs_head && !atomic_load(&d->stopping)){
+	    pthread_cond_wait(&d->jobs_ready, &d->jobs_lock);
+	}
+	job = d->jobs_head;
+	if(job){
+	    d->jobs_head = job->next;
+	    if(!d->jobs_head){
+		d->jobs_tail = NULL;
+	    }
+	}
+	pthread_mutex_unlock(&d->jobs_lock);
+	if(!job){
+	    return NULL;
+	}
+
+	job->result = d->lookup(d->ctx, job->hostname, job->ips, sizeof(job->ips));
+	if(job->result != UTIL_SUCCESS){
+	    job->ips[0] = '\0';
+	    atomic_fetch_add(&d->failed, 1);
+	}
+	conn = job->conn;
+	pthread_mutex_lock(&conn->lock);
+	if(--conn->left == 0){
+	    pthread_cond_signal(&conn->done);
+	}
+	pthread_mutex_unlock(&conn->lock);
+    }
+}
+
+/* Send a reply with status and no answers */
+static void reply_status(int fd, int op, int status){
+    unsigned char frame[LOOKUPD_HEADER_SIZE + 4];
+
+    put32(frame, 4);
+    frame[4] = op;
+    frame[5] = status;
+    put16(frame + 6, 0);
+    write_full(fd, frame, sizeof(frame));
+}
+
+/* Split a request into jobs, each name copied with a NUL into
+ * names. Returns the name count, or LOOKUPD_FAILURE if malformed */
+static int parse_request(const unsigned char* req, size_t len, char* names,
+			 lookupd_job* jobs, lookupd_conn* conn){
+    size_t off = 4;
+    int count = get16(req + 2);
+    int nlen;
+    int i;
+
+    if(req[0] != LOOKUPD_OP_LOOKUP || count > LOOKUPD_MAX_NAMES){
+	return LOOKUPD_FAILURE;
+    }
+    for(i = 0; i < count; i++){
+	if(off + 2 > len){
+	    return LOOKUPD_FAILURE;
+	}
+	nlen = get16(req + off);
+	off += 2;
+	if(nlen == 0 || nlen > LOOKUPD_MAX_NAME || off + nlen > len){
+	    return LOOKUPD_FAILURE;
+	}
+	memcpy(names, req + off, nlen);
+	names[nlen] = '\0';
+	jobs[i].hostname = names;
+	jobs[i].conn = conn;
+	jobs[i].next = i + 1 < count ? &jobs[i + 1] : NULL;
+	names += nlen + 1;
+	off += nlen;
+    }
+    return off == len ? count : LOOKUPD_FAILURE;
+}
+
+/* Reply to a request whose jobs are all answered */
+static int reply_answers(int fd, const lookupd_job* jobs, int count, int flags,
+			 unsigned char** buf, size_t* cap){
+    size_t off = LOOKUPD_HEADER_SIZE + 4;
+    size_t len;
+    int i;
+
+    if(reserve(buf, cap, off + (size_t) count * (3 + UTIL_ADDRLIST_SIZE)) == LOOKUPD_FAILURE){
+	return LOOKUPD_FAILURE;
+    }
+    for(i = 0; i < count; i++){
+	len = flags & LOOKUPD_FLAG_ALL ? strlen(jobs[i].ips) : strcspn(jobs[i].ips, UTIL_ADDR_SEP);
+	(*buf)[off] = jobs[i].result == UTIL_SUCCESS ? LOOKUPD_RESOLVED : LOOKUPD_FAILED;
+	put16(*buf + off + 1, len);
+	memcpy(*buf + off + 3, jobs[i].ips, len);
+	off += 3 + len;
+    }
+    put32(*buf, off - LOOKUPD_HEADER_SIZE);
+    (*buf)[4] = LOOKUPD_OP_LOOKUP;
+    (*buf)[5] = LOOKUPD_STATUS_OK;
+    put16(*buf + 6, count);
+    return write_full(fd, *buf, off);
+}
+
+static void* lookupd_serve(void* arg){
+    lookupd_conn* conn = arg;
+    lookupd* d = conn->daemon;
+    unsigned char header[LOOKUPD_HEADER_SIZE];
+    unsigned char* req = NULL;
+    unsigned char* out = NULL;
+    unsigned char* names = NULL;
+    lookupd_job* jobs = NULL;
+    lookupd_job* grown;
+    size_t req_cap = 0, out_cap = 0, names_cap = 0;
+    int jobs_cap = 0;
+    size_t len;
+    int count;
+
+    while(read_full(conn->fd, header, sizeof(header)) == 1){
+	len = get32(header);
+	if(len < 4 || len > LOOKUPD_MAX_FRAME
+	   || reserve(&req, &req_cap, len) == LOOKUPD_FAILURE
+	   || reserve(&names, &names_cap, len) == LOOKUPD_FAILURE){
+	    atomic_fetch_add(&d->bad_requests, 1);
+	    reply_status(conn->fd, LOOKUPD_OP_LOOKUP, LOOKUPD_STATUS_BAD);
+	    break;
+	}
+	if(read_full(conn->fd, req, len) != 1){
+	    break;
+	}
+	count = get16(req + 2);
+	if(count > jobs_cap && count <= LOOKUPD_MAX_NAMES){
+	    grown = realloc(jobs, count * sizeof(*jobs));
+	    if(!grown){
+		break;
+	    }
+	    jobs = grown;
+	    jobs_cap = count;
+	}
+	count = parse_request(req, len, (char*) names, jobs, conn);
+	if(count == LOOKUPD_FAILURE){
+	    atomic_fetch_add(&d->bad_requests, 1);
+	    reply_status(conn->fd, req[0], LOOKUPD_STATUS_BAD);
+	    break;
+	}
+	atomic_fetch_add(&d->requests, 1);
+	atomic_fetch_add(&d->names, count);
+
+	if(count > 0){
+	    conn->left = count;
+	    pthread_mutex_lock(&d->jobs_lock);
+	    if(d->jobs_tail){
+		d->jobs_tail->next = &jobs[0];
+	    }
+	    else{
+		d->jobs_head = &jobs[0];
+	    }
+	    d->jobs_tail = &jobs[count - 1];
+	    if(count > 1){
+		pthread_cond_broadcast(&d->jobs_ready);
+	    }
+	    else{
+		pthread_cond_signal(&d->jobs_ready);
+	    }
+	    pthread_mutex_unlock(&d->jobs_lock);
+
+	    pthread_mutex_lock(&conn->lock);
+	    while(conn->left > 0){
+		pthread_cond_wait(&conn->done, &conn->lock);
+	    }
+	    pthread_mutex_unlock(&conn->lock);
+	}
+	if(reply_answers(conn->fd, jobs, count, req[1], &out, &out_cap) == LOOKUPD_FAILURE){
+	    break;
+	}
+    }
+
+    /* the client sees end of file now; the fd is closed when reaped */
+    shutdown(conn->fd, SHUT_RDWR);
+    free(req);
+    free(out);
+    free(names);
+    free(jobs);
+    pthread_mutex_lock(&d->conns_lock);
+    conn->finished = 1;
+    pthread_mutex_unlock(&d->conns_lock);
+    return NULL;
+}
+
+/* Join and free the connections whose threads are done, or all of
+ * them. Called with conns_lock held. */
+static void reap_conns(lookupd* d, int all){
+    lookupd_conn** link = &d->conns;
+    lookupd_conn* conn;
+
+    while((conn = *link)){
+	if(!all && !conn->finished){
+	    link = &conn->next;
+	    continue;
+	}
+	*link = conn->next;
+	pthread_join(conn->thread, NULL);
+	close(conn->fd);
+	pthread_mutex_destroy(&conn->lock);
+	pthread_cond_destroy(&conn->done);
+	free(conn);
+    }
+}
+
+static void* lookupd_accept(void* arg){
+    lookupd* d = arg;
+    lookupd_conn* conn;
+    int fd;
+
+    while(!atomic_load(&d->stopping)){
+	fd = accept(d->listen_fd, NULL, NULL);
+	if(fd < 0){
+	    if(errno != EINTR && errno != ECONNABORTED && !atomic_load(&d->stopping)){
+		perror("Error accepting a connection");
+		usleep(10000);
+	    }
+	    continue;
+	}
+	if(atomic_load(&d->stopping)){
+	    close(fd);
+	    break;
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	conn = calloc(1, sizeof(*conn));
+	if(!conn){
+	    close(fd);
+	    continue;
+	}
+	conn->daemon = d;
+	conn->fd = fd;
+	pthread_mutex_init(&conn->lock, NULL);
+	pthread_cond_init(&conn->done, NULL);
+
+	pthread_mutex_lock(&d->conns_lock);
+	reap_conns(d, 0);
+	if(pthread_create(&conn->thread, NULL, lookupd_serve, conn) != 0){
+	    pthread_mutex_unlock(&d->conns_lock);
+	    close(fd);
+	    free(conn);
+	    continue;
+	}
+	conn->next = d->conns;
+	d->conns = conn;
+	pthread_mutex_unlock(&d->conns_lock);
+	atomic_fetch_add(&d->connections, 1);
+    }
+    return NULL;
+}
+
+int lookupd_start(lookupd* d, const char* path, int threads,
+		  lookupd_fn lookup, void* ctx){
+
+    struct sockaddr_un addr;
+    int fd;
+    int i;
+
+    memset(d, 0, sizeof(*d));
+    if(threads < 1 || unix_address(path, &addr) == LOOKUPD_FAILURE){
+	return LOOKUPD_FAILURE;
+    }
+
+    /* a socket file nobody answers on is left from a dead daemon */
+    fd = lookupd_connect(path);
+    if(fd >= 0){
+	close(fd);
+	fprintf(stderr, "A daemon is already listening on %s\n", path);
+	return LOOKUPD_FAILURE;
+    }
+    unlink(path);
+
+    d->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(d->listen_fd < 0
+       || bind(d->listen_fd, (struct sockaddr*) &addr, sizeof(addr)) < 0
+       || listen(d->listen_fd, SOMAXCONN) < 0){
+	perror("Error listening on the daemon socket");
+	if(d->listen_fd >= 0){
+	    close(d->listen_fd);
+	}
+	return LOOKUPD_FAILURE;
+    }
+    d->path = strdup(path);
+    d->lookup = lookup;
+    d->ctx = ctx;
+    pthread_mutex_init(&d->jobs_lock, NULL);
+    pthread_cond_init(&d->jobs_ready, NULL);
+    pthread_mutex_init(&d->conns_lock, NULL);
+
+    d->resolvers = calloc(threads, sizeof(*d->resolvers));
+    if(!d->resolvers){
+	perror("Error allocating daemon threads");
+	return LOOKUPD_FAILURE;
+    }
+    for(i = 0; i < threads; i++){
+	if(pthread_create(&d->resolvers[i], NULL, lookupd_resolve, d) != 0){
+	    break;
+	}
+	d->nresolvers++;
+    }
+    if(d->nresolvers == 0 || pthread_create(&d->acceptor, NULL, lookupd_accept, d) != 0){
+	fprintf(stderr, "Error creating daemon threads\n");
+	return LOOKUPD_FAILURE;
+    }
+    return LOOKUPD_SUCCESS;
+}
+
+void lookupd_stop(lookupd* d){
+    lookupd_conn* conn;
+    int fd;
+    int i;
+
+    /* a blocked accept only wakes for a connection, so make one */
+    atomic_store(&d->stopping, 1);
+    fd = lookupd_connect(d->path);
+    pthread_join(d->acceptor, NULL);
+    if(fd >= 0){
+	close(fd);
+    }
+
+    /* finish the request in progress, then see end of file */
+    pthread_mutex_lock(&d->conns_lock);
+    for(conn = d->conns; conn; conn = conn->next){
+	shutdown(conn->fd, SHUT_RD);
+    }
+    reap_conns(d, 1);
+    pthread_mutex_unlock(&d->conns_lock);
+
+    pthread_mutex_lock(&d->jobs_lock);
+    pthread_cond_broadcast(&d->jobs_ready);
+    pthread_mutex_unlock(&d->jobs_lock);
+    for(i = 0; i < d->nresolvers; i++){
+	pthread_join(d->resolvers[i], NULL);
+    }
+
+    close(d->listen_fd);
+    unlink(d->path);
+    free(d->path);
+    free(d->resolvers);
+    pthread_mutex_destroy(&d->jobs_lock);
+    pthread_cond_destroy(&d->jobs_ready);
+    pthread_mutex_destroy(&d->conns_lock);
+}
+
+int lookupd_connect(const char* path){
+    struct sockaddr_un addr;
+    int fd;
+
+    if(unix_address(path, &addr) == LOOKUPD_FAILURE){
+	return LOOKUPD_FAILURE;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+	return LOOKUPD_FAILURE;
+    }
+    if(connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0){
+	close(fd);
+	return LOOKUPD_FAILURE;
+    }
+    return fd;
+}
+
+int lookupd_send(int fd, const char* const* names, int count, int flags){
+    unsigned char* frame;
+    size_t size = LOOKUPD_HEADER_SIZE + 4;
+    size_t off = size;
+    size_t len;
+    int ret;
+    int i;
+
+    if(count < 0 || count > LOOKUPD_MAX_NAMES){
+	return LOOKUPD_FAILURE;
+    }
+    for(i = 0; i < count; i++){
+	len = strlen(names[i]);
+	if(len == 0 || len > LOOKUPD_MAX_NAME){
+	    return LOOKUPD_FAILURE;
+	}
+	size += 2 + len;
+    }
+    frame = malloc(size);
+    if(!frame){
+	return LOOKUPD_FAILURE;
+    }
+    put32(frame, size - LOOKUPD_HEADER_SIZE);
+    frame[4] = LOOKUPD_OP_LOOKUP;
+    frame[5] = flags;
+    put16(frame + 6, count);
+    for(i = 0; i < count; i++){
+	len = strlen(names[i]);
+	put16(frame + off, len);
+	memcpy(frame + off + 2, names[i], len);
+	off += 2 + len;
+    }
+    ret = write_full(fd, frame, size);
+    free(frame);
+    return ret;
+}
+
+int lookupd_recv(int fd, lookupd_reply* reply){
+    unsigned char header[LOOKUPD_HEADER_SIZE];
+    lookupd_answer* grown;
+    unsigned char* p;
+    char* text;
+    size_t len, off, alen;
+    int count;
+    int i;
+
+    reply->count = 0;
+    if(read_full(fd, header, sizeof(header)) != 1){
+	return LOOKUPD_FAILURE;
+    }
+    len = get32(header);
+    /* answers are copied with their NULs after the frame */
+    if(len < 4 || len > LOOKUPD_MAX_REPLY
+       || reserve(&reply->buf, &reply->buf_cap, 2 * len) == LOOKUPD_FAILURE
+       || read_full(fd, reply->buf, len) != 1){
+	return LOOKUPD_FAILURE;
+    }
+    p = reply->buf;
+    count = get16(p + 2);
+    if(p[0] != LOOKUPD_OP_LOOKUP || p[1] != LOOKUPD_STATUS_OK){
+	return LOOKUPD_FAILURE;
+    }
+    if(count > reply->answers_cap){
+	grown = realloc(reply->answers, count * sizeof(*grown));
+	if(!grown){
+	    return LOOKUPD_FAILURE;
+	}
+	reply->answers = grown;
+	reply->answers_cap = count;
+    }
+    text = (char*) p + len;
+    off = 4;
+    for(i = 0; i < count; i++){
+	if(off + 3 > len || off + 3 + (alen = get16(p + off + 1)) > len){
+	    return LOOKUPD_FAILURE;
+	}
+	reply->answers[i].result = p[off];
+	reply->answers[i].ips = text;
+	memcpy(text, p + off + 3, alen);
+	text[alen] = '\0';
+	text += alen + 1;
+	off += 3 + alen;
+    }
+    reply->count = count;
+    return off == len ? LOOKUPD_SUCCESS : LOOKUPD_FAILURE;
+}
+
+void lookupd_reply_free(lookupd_reply* reply){
+    free(reply->answers);
+    free(reply->buf);
+    memset(reply, 0, sizeof(*reply));
+}
@@ -0,0 +1,160 @@
+/*
+ * File: lookupd.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for the lookup daemon: a server on a
+ *      Unix domain socket that answers batches of hostnames with a
+ *      resident pool of resolver threads, so callers do not pay
+ *      for thread startup and a cold cache on every list. The same
+ *      file has the client side of the protocol.
+ *
+ *      Every message is a frame: a 4 byte big endian length, then
+ *      that many bytes. All integers are big endian.
+ *
+ *      request     u8 op (LOOKUPD_OP_LOOKUP), u8 flags, u16 count,
+ *                  then count names, each u16 length and bytes
+ *      reply       u8 op, u8 status, u16 count, then count
+ *                  answers, each u8 result (0 resolved, 1 failed),
+ *                  u16 length and the addresses joined by
+ *                  UTIL_ADDR_SEP (just the first without
+ *                  LOOKUPD_FLAG_ALL)
+ *
+ *      A client may send several requests before reading the
+ *      replies; each connection's are answered one at a time, in
+ *      order. A request the daemon cannot parse gets a reply with
+ *      status LOOKUPD_STATUS_BAD and no answers, and the
+ *      connection is closed.
+ *
+ */
+
+#ifndef LOOKUPD_H
+#define LOOKUPD_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "util.h"
+
+#define LOOKUPD_FAILURE -1
+#define LOOKUPD_SUCCESS 0
+
+#define LOOKUPD_OP_LOOKUP 1
+#define LOOKUPD_FLAG_ALL 1
+#define LOOKUPD_STATUS_OK 0
+#define LOOKUPD_STATUS_BAD 1
+#define LOOKUPD_RESOLVED 0
+#define LOOKUPD_FAILED 1
+
+#define LOOKUPD_HEADER_SIZE 4
+#define LOOKUPD_MAX_NAMES 4096
+#define LOOKUPD_MAX_NAME 1024
+#define LOOKUPD_MAX_FRAME (4 + LOOKUPD_MAX_NAMES * (2 + LOOKUPD_MAX_NAME))
+
+/* Looks up hostname into ips (size bytes) as every address joined
+ * by UTIL_ADDR_SEP; returns UTIL_SUCCESS or UTIL_FAILURE. Called
+ * from many resolver threads at once with the same ctx.
+ */
+typedef int (*lookupd_fn)(void* ctx, const char* hostname, char* ips, int size);
+
+struct lookupd_conn_s;
+
+/* One name of a request, waiting for or held by a resolver */
+typedef struct lookupd_job_s{
+    struct lookupd_job_s* next;
+    struct lookupd_conn_s* conn;
+    const char* hostname;
+    int result;
+    char ips[UTIL_ADDRLIST_SIZE];
+} lookupd_job;
+
+struct lookupd_s;
+
+/* One client connection and the thread serving it */
+typedef struct lookupd_conn_s{
+    struct lookupd_conn_s* next;
+    struct lookupd_s* daemon;
+    pthread_t thread;
+    int fd;
+    int finished;               /* thread is done, join it */
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    int left;                   /* names of the request still out */
+} lookupd_conn;
+
+typedef struct lookupd_s{
+    char* path;
+    int listen_fd;
+    lookupd_fn lookup;
+    void* ctx;
+    pthread_t acceptor;
+    pthread_t* resolvers;
+    int nresolvers;
+    /* names waiting for a resolver */
+    pthread_mutex_t jobs_lock;
+    pthread_cond_t jobs_ready;
+    lookupd_job* jobs_head;
+    lookupd_job* jobs_tail;
+    atomic_int stopping;
+    /* live connections */
+    pthread_mutex_t conns_lock;
+    lookupd_conn* conns;
+    /* counters */
+    atomic_long connections;
+    atomic_long requests;
+    atomic_long names;
+    atomic_long failed;
+    atomic_long bad_requests;
+} lookupd;
+
+/* Answers to one request, pointing into the reply buffer */
+typedef struct lookupd_answer_s{
+    int result;                 /* LOOKUPD_RESOLVED or LOOKUPD_FAILED */
+    const char* ips;            /* "" when failed */
+} lookupd_answer;
+
+typedef struct lookupd_reply_s{
+    lookupd_answer* answers;
+    int count;
+    int answers_cap;
+    unsigned char* buf;
+    size_t buf_cap;
+} lookupd_reply;
+
+/* Function to listen on the socket at path and start threads
+ * resolver threads calling lookup. A stale socket file is
+ * replaced; one a daemon still answers on is not.
+ * Returns LOOKUPD_SUCCESS or LOOKUPD_FAILURE
+ */
+int lookupd_start(lookupd* d, const char* path, int threads,
+		  lookupd_fn lookup, void* ctx);
+
+/* Function to stop accepting, close every connection once its
+ * request in progress is answered, join every thread and remove
+ * the socket file
+ */
+void lookupd_stop(lookupd* d);
+
+/* Function to connect to the daemon at path
+ * Returns the socket or LOOKUPD_FAILURE
+ */
+int lookupd_connect(const char* path);
+
+/* Function to send one request for count names
+ * Returns LOOKUPD_SUCCESS or LOOKUPD_FAILURE
+ */
+int lookupd_send(int fd, const char* const* names, int count, int flags);
+
+/* Function to read the reply to the oldest request sent on fd
+ * into reply (initilized to zeros, reused across calls)
+ * Returns LOOKUPD_SUCCESS, or LOOKUPD_FAILURE if the connection
+ * broke or the daemon refused the request
+ */
+int lookupd_recv(int fd, lookupd_reply* reply);
+
+/* Function to free a reply's buffers */
+void lookupd_reply_free(lookupd_reply* reply);
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * File: lookupdTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the lookup daemon, run in
+ *      process with a made up lookup function. Answers must come
+ *      back in request order, with one address or all of them;
+ *      pipelined requests on one connection must keep their
+ *      order; many clients at once must each get their own
+ *      answers; a malformed request must be refused and its
+ *      connection closed; a second daemon must not take over a
+ *      live socket but may replace a stale one; and stopping
+ *      must remove the socket.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lookupd.h"
+
+#define TEST_PATH "lookupdTest.sock"
+#define TEST_CLIENTS 8
+#define TEST_REQUESTS 50
+#define TEST_BATCH 32
+
+static lookupd daemon_under_test;
+
+/* bad* fails, anything else gets two addresses from its length */
+static int fake_lookup(void* ctx, const char* hostname, char* ips, int size){
+    (void) ctx;
+    if(strncmp(hostname, "bad", 3) == 0){
+	return UTIL_FAILURE;
+    }
+    snprintf(ips, size, "192.0.2.%zu" UTIL_ADDR_SEP "2001:db8::%zx",
+	     strlen(hostname), strlen(hostname));
+    return UTIL_SUCCESS;
+}
+
+static void* client(void* arg){
+    long self = (long) arg;
+    char names[TEST_BATCH][32];
+    const char* batch[TEST_BATCH];
+    char expect[32];
+    lookupd_reply reply;
+    int fd = lookupd_connect(TEST_PATH);
+    int r, i;
+
+    memset(&reply, 0, sizeof(reply));
+    if(fd < 0){
+	fprintf(stderr, "error: client %ld could not connect\n", self);
+	return NULL;
+    }
+    for(r = 0; r < TEST_REQUESTS; r++){
+	for(i = 0; i < TEST_BATCH; i++){
+	    /* lengths differ by client, request and place */
+	    snprintf(names[i], sizeof(names[i]), "%.*s", 1 + (int) (self + r + i) % 30,
+		     "abcdefghijklmnopqrstuvwxyz0123456789");
+	    batch[i] = names[i];
+	}
+	if(lookupd_send(fd, batch, TEST_BATCH, 0) == LOOKUPD_FAILURE
+	   || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != TEST_BATCH){
+	    fprintf(stderr, "error: client %ld request %d failed\n", self, r);
+	    break;
+	}
+	for(i = 0; i < TEST_BATCH; i++){
+	    snprintf(expect, sizeof(expect), "192.0.2.%zu", strlen(names[i]));
+	    if(reply.answers[i].result != LOOKUPD_RESOLVED
+	       || strcmp(reply.answers[i].ips, expect) != 0){
+		fprintf(stderr, "error: client %ld got %s for %s\n", self,
+			reply.answers[i].ips, names[i]);
+	    }
+	}
+    }
+    lookupd_reply_free(&reply);
+    close(fd);
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static const char* const names[] = {"example.com", "bad.example.com", "a.io"};
+    static const unsigned char garbage[] = {0, 0, 0, 4, 9, 0, 0, 0};
+    pthread_t clients[TEST_CLIENTS];
+    lookupd other;
+    lookupd_reply reply;
+    struct sockaddr_un addr;
+    int fd, stale;
+    long i;
+
+    memset(&reply, 0, sizeof(reply));
+    unlink(TEST_PATH);
+
+    /* Test a stale socket file is replaced */
+    stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, TEST_PATH);
+    if(bind(stale, (struct sockaddr*) &addr, sizeof(addr)) < 0){
+	fprintf(stderr, "error: could not make a stale socket\n");
+    }
+    close(stale);
+    if(lookupd_start(&daemon_under_test, TEST_PATH, 4, fake_lookup, NULL) == LOOKUPD_FAILURE){
+	fprintf(stderr, "error: could not start over a stale socket\n");
+	return 0;
+    }
+
+    /* Test a live socket is not taken over */
+    if(lookupd_start(&other, TEST_PATH, 1, fake_lookup, NULL) != LOOKUPD_FAILURE){
+	fprintf(stderr, "error: second daemon took over a live socket\n");
+    }
+
+    /* Test answers, first address and all of them */
+    fd = lookupd_connect(TEST_PATH);
+    if(fd < 0){
+	fprintf(stderr, "error: could not connect\n");
+	return 0;
+    }
+    if(lookupd_send(fd, names, 3, 0) == LOOKUPD_FAILURE
+       || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != 3
+       || reply.answers[0].result != LOOKUPD_RESOLVED || strcmp(reply.answers[0].ips, "192.0.2.11") != 0
+       || reply.answers[1].result != LOOKUPD_FAILED || strcmp(reply.answers[1].ips, "") != 0
+       || strcmp(reply.answers[2].ips, "192.0.2.4") != 0){
+	fprintf(stderr, "error: first address answers wrong\n");
+    }
+    if(lookupd_send(fd, names, 3, LOOKUPD_FLAG_ALL) == LOOKUPD_FAILURE
+       || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != 3
+       || strcmp(reply.answers[0].ips, "192.0.2.11, 2001:db8::b") != 0){
+	fprintf(stderr, "error: all address answers wrong: %s\n",
+		reply.count ? reply.answers[0].ips : "none");
+    }
+
+    /* Test pipelined requests keep their order, and an empty one */
+    if(lookupd_send(fd, names + 2, 1, 0) == LOOKUPD_FAILURE
+       || lookupd_send(fd, names, 0, 0) == LOOKUPD_FAILURE
+       || lookupd_send(fd, names, 1, 0) == LOOKUPD_FAILURE){
+	fprintf(stderr, "error: pipelined send failed\n");
+    }
+    if(lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != 1
+       || strcmp(reply.answers[0].ips, "192.0.2.4") != 0
+       || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != 0
+       || lookupd_recv(fd, &reply) == LOOKUPD_FAILURE || reply.count != 1
+       || strcmp(reply.answers[0].ips, "192.0.2.11") != 0){
+	fprintf(stderr, "error: pipelined replies out of order\n");
+    }
+
+    /* Test a malformed request is refused and the connection closed */
+    if(write(fd, garbage, sizeof(garbage)) != sizeof(garbage)
+       || lookupd_recv(fd, &reply) != LOOKUPD_FAILURE
+       || lookupd_recv(fd, &reply) != LOOKUPD_FAILURE
+       || atomic_load(&daemon_under_test.bad_requests) != 1){
+	fprintf(stderr, "error: malformed request was not refused\n");
+    }
+    close(fd);
+
+    /* Test many clients at once */
+    for(i = 0; i < TEST_CLIENTS; i++){
+	pthread_create(&clients[i], NULL, client, (void*) i);
+    }
+    for(i = 0; i < TEST_CLIENTS; i++){
+	pthread_join(clients[i], NULL);
+    }
+    if(atomic_load(&daemon_under_test.names) != 6 + 2 + TEST_CLIENTS * TEST_REQUESTS * TEST_BATCH){
+	fprintf(stderr, "error: daemon counted %ld names\n", atomic_load(&daemon_under_test.names));
+    }
+
+    /* Test stopping removes the socket */
+    lookupd_stop(&daemon_under_test);
+    if(access(TEST_PATH, F_OK) == 0 || lookupd_connect(TEST_PATH) != LOOKUPD_FAILURE){
+	fprintf(stderr, "error: socket still there after stop\n");
+	unlink(TEST_PATH);
+    }
+    lookupd_reply_free(&reply);
+
+    return 0;
+}
@@ -12,171 +12,2645 @@ pthread_cond_t empty;
 
 
 queue q;
-int FILES_FINISHED;
+int PRODUCERS_FINISHED;
+int NUM_PRODUCERS;
 int NUM_INPUT_FILES;
-char* OUT_FILE;
+input_range* RANGES;
+int NUM_RANGES;
+atomic_int NEXT_RANGE;
+int OUT_FD;
+int ORDERED;
+outwriter WRITER;
+arena HOSTS;
+arena LOOKUPS;
 int THREAD_MAX;
+int MIN_THREADS = 1;
+int MAX_THREADS;              // 0: fixed pool of THREAD_MAX
+int ADAPT_MS = ADAPT_DEFAULT_INTERVAL_MS;
+atomic_int POOL_TARGET;
+int POOL_DRAINED;
+pthread_mutex_t pool_lock;
+pthread_cond_t pool_cond;
+atomic_long QUEUED;
+atomic_long LOOKUPS_DONE;
+atomic_llong LOOKUP_NS;
+// --stats-json: stage latencies (ns), sampled queue depth, and
+// the per thread counters, dumped by stats_thread
+FILE* STATS_OUT;
+int STATS_INTERVAL_MS = 100;
+long long START_NS;
+atomic_int STATS_STOP;
+pthread_mutex_t stats_lock;
+histo H_PARSE;
+histo H_QUEUE_WAIT;
+histo H_LOOKUP;
+histo H_FORMAT;
+histo H_WRITE;
+histo H_QUEUE_DEPTH;
+atomic_long LOOKUP_FAILURES;
+producer_stats* PRODUCER_STATS;
+resolver_stats* RESOLVER_STATS;
+int RESOLVER_SLOTS;
+atomic_int RESOLVERS_STARTED;
+int BATCH_SIZE = 1;
+int QUEUE_SIZE;                 // 0 until sized from the pool
+int BACKPRESSURE = BACKPRESSURE_BLOCK;
+spill SPILL;
+static const char* const BACKPRESSURE_NAMES[] = {"block", "spin", "spill"};
+int SCHEDULE = SCHEDULE_SHARED;
+workq WORKQ;                    // --schedule steal's per resolver deques
+// --urgent: the queue is a ring per class in PRIO instead of q, and
+// each class's wait for a resolver and until its lookup is done
+int PRIORITY;
+queue_prio PRIO;
+int STARVE_LIMIT = QUEUE_DEFAULT_STARVE_LIMIT;
+const char* const PRIORITY_NAMES[] = {"urgent", "bulk"};
+histo H_CLASS_WAIT[PRIORITY_CLASSES];
+histo H_CLASS_DONE[PRIORITY_CLASSES];
+int PRINT_STATS;
+int USE_CACHE = 1;
+dnscache CACHE;
+int USE_DISK_CACHE;
+diskcache DISK_CACHE;
+int USE_COALESCE = 1;
+int USE_ASYNC;
+int ALL_ADDRS;
+dnsasync ENGINE;
+// --resolver fake...: every getaddrinfo lookup goes to FAKE instead
+int USE_FAKE;
+fakeresolver FAKE;
+// Paces getaddrinfo lookups: --rate, --max-inflight, --dns-retries
+throttle LIMIT;
+// --daemon: serve lookups on this socket instead of reading files
+char* DAEMON_PATH;
+// --pin-* and --numa: where each role's threads run (NULL: anywhere)
+affinity_topology TOPOLOGY;
+int NUMA;
+affinity_set PIN_SETS[3];
+const affinity_set* PRODUCER_CPUS;
+const affinity_set* RESOLVER_CPUS;
+const affinity_set* WRITER_CPUS;
+// --numa: the node whose resolvers a producer feeds
+static __thread int PUSH_GROUP = -1;
+// --procs: PROCS worker processes of WORKER_THREADS threads do the
+// lookups; each resolver forwards its names to one over a ring
+int PROCS;
+int WORKER_THREADS;
+int WORKER_ID = -1;             // in a worker process, its index
+int RING_KB = DEFAULT_RING_KB;
+worker_proc* WORKERS;
+pthread_t REAPER;
+// --format binary: records go through WRITER, the table at the end
+int BINARY_OUT;
+resultfile RESULTS;
+// Input files and what earlier runs finished (nothing unless --resume)
+input_file* INPUT_FILES;
+checkpoint RESUME_FROM;
+int RESUMING;
+char* CHECKPOINT_PATH;          // NULL: no --checkpoint
+int CHECKPOINT_MS = CHECKPOINT_DEFAULT_INTERVAL_MS;
+int CHECKPOINT_STOP;
+long CHECKPOINTS_SAVED;
+pthread_mutex_t checkpoint_lock;
+pthread_cond_t checkpoint_cond;
 
 pthread_mutex_t queue_lock;
 pthread_mutex_t inc_lock;
-pthread_mutex_t out_lock;
 
-void* read_file(char* filename){
-    FILE* input = fopen(filename, "r");
+static inline long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
-    if(!input){
-        perror("Error opening input file.\n");
-        return NULL;
+// CLOCK_REALTIME ms from now, for pthread_cond_timedwait()
+static void deadline_after_ms(struct timespec* until, int ms){
+    clock_gettime(CLOCK_REALTIME, until);
+    until->tv_sec += ms / 1000;
+    until->tv_nsec += (ms % 1000) * 1000000L;
+    if(until->tv_nsec >= 1000000000L){
+        until->tv_sec++;
+        until->tv_nsec -= 1000000000L;
     }
-    char hostname[SBUFSIZE];
+}
 
-    // Push hostname to queue while locked
-    while(fscanf(input, INPUTFS, hostname) > 0){
-        pthread_mutex_lock(&queue_lock);
-        while(queue_is_full(&q)){
+// Add to a counter only its own thread writes; no locked instruction
+static inline void stat_add(atomic_llong* counter, long long v){
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + v,
+                          memory_order_relaxed);
+}
+
+// Start of a timed stage, 0 when --stats-json is off
+static inline long long stage_start(void){
+    return STATS_OUT ? now_ns() : 0;
+}
+
+static inline void stage_end(histo* h, long long start){
+    if(STATS_OUT){
+        histo_record(h, now_ns() - start);
+    }
+}
+
+static inline host_slab* host_slab_ptr(uint32_t slab){
+    return arena_ptr(&HOSTS, slab);
+}
+
+static inline host_item* host_handle_item(void* handle){
+    uintptr_t h = (uintptr_t) handle;
+    return &host_slab_ptr(h >> HOST_SLAB_SHIFT)->items[h & (HOST_SLAB_ITEMS - 1)];
+}
+
+// Next free item of the producer's current slab, taking a new slab
+// when it is used up. Returns the item's queue handle.
+static void* host_handle_new(uint32_t* slab, int* used){
+    if(*slab == ARENA_NONE || *used == HOST_SLAB_ITEMS){
+        *slab = arena_get(&HOSTS);
+        if(*slab == ARENA_NONE){
+            fprintf(stderr, "Error allocating hostname items\n");
+            exit(EXIT_FAILURE);
+        }
+        atomic_init(&host_slab_ptr(*slab)->refs, HOST_SLAB_ITEMS);
+        *used = 0;
+    }
+    return (void*) (((uintptr_t) *slab << HOST_SLAB_SHIFT) | (uintptr_t) (*used)++);
+}
+
+// Drop the references a producer's last slab will never hand out
+static void host_slab_retire(uint32_t slab, int used){
+    int unused = HOST_SLAB_ITEMS - used;
+    if(slab != ARENA_NONE && unused > 0
+       && atomic_fetch_sub(&host_slab_ptr(slab)->refs, unused) == unused){
+        arena_put(&HOSTS, slab);
+    }
+}
+
+// A resolver has written handle's line; the last one out returns
+// the whole slab to the arena
+static void host_handle_release(void* handle){
+    uint32_t slab = (uintptr_t) handle >> HOST_SLAB_SHIFT;
+    if(atomic_fetch_sub(&host_slab_ptr(slab)->refs, 1) == 1){
+        arena_put(&HOSTS, slab);
+    }
+}
+
+// --backpressure spill: copy names the queue has no room for to the
+// spill file and give back their slab slots. Resolvers take them from
+// there whenever the queue runs dry.
+static void hostq_spill(void** hostnames, int count, producer_stats* stats){
+    host_item items[count];
+    int i;
+    for(i=0 ; i < count ; i++){
+        items[i] = *host_handle_item(hostnames[i]);
+        host_handle_release(hostnames[i]);
+    }
+    if(spill_put(&SPILL, items, count) == SPILL_FAILURE){
+        perror("Error writing spill file");
+        exit(EXIT_FAILURE);
+    }
+    atomic_fetch_sub_explicit(&QUEUED, count, memory_order_relaxed);
+    stat_add(&stats->spilled, count);
+}
+
+// Up to max spilled names, 0 if there are none
+static int hostq_unspill(host_item* items, int max){
+    if(BACKPRESSURE != BACKPRESSURE_SPILL || spill_pending(&SPILL) == 0){
+        return 0;
+    }
+    int taken = spill_get(&SPILL, items, max);
+    if(taken < 0){
+        perror("Error reading spill file");
+        exit(EXIT_FAILURE);
+    }
+    return taken;
+}
+
+#ifndef QUEUE_LOCKFREE
+// The shared queue, q or with --urgent PRIO; callers hold queue_lock
+static int hostq_is_full(int cls){
+    return PRIORITY ? queue_prio_is_full(&PRIO, cls) : queue_is_full(&q);
+}
+
+static int hostq_is_empty(void){
+    return PRIORITY ? queue_prio_is_empty(&PRIO) : queue_is_empty(&q);
+}
+#endif
+
+// Queues without a shared lock: --schedule steal's per resolver
+// deques, or the lock-free queue. Neither call blocks with wait 0.
+static int hostq_push_some(void** hostnames, int count, int cls, int wait){
+#ifdef QUEUE_LOCKFREE
+    if(PRIORITY){
+        return wait ? queue_prio_push_many_wait(&PRIO, cls, hostnames, count)
+                    : queue_prio_push_many(&PRIO, cls, hostnames, count);
+    }
+    if(SCHEDULE != SCHEDULE_STEAL){
+        return wait ? queue_push_many_wait(&q, hostnames, count)
+                    : queue_push_many(&q, hostnames, count);
+    }
+#else
+    (void) cls;
+#endif
+    return workq_push_group(&WORKQ, PUSH_GROUP, hostnames, count, wait);
+}
+
+static int hostq_pop_some(void** hostnames, int max, int wait, int* cls, resolver_stats* stats){
+#ifdef QUEUE_LOCKFREE
+    if(PRIORITY){
+        return wait ? queue_prio_pop_many_wait(&PRIO, hostnames, max, cls)
+                    : queue_prio_pop_many(&PRIO, hostnames, max, cls);
+    }
+    if(SCHEDULE != SCHEDULE_STEAL){
+        return wait ? queue_pop_many_wait(&q, hostnames, max)
+                    : queue_pop_many(&q, hostnames, max);
+    }
+#else
+    (void) cls;
+#endif
+    int stolen;
+    int popped = workq_pop_many(&WORKQ, stats->id, hostnames, max, wait, &stolen);
+    stat_add(&stats->stolen, stolen);
+    return popped;
+}
+
+// hostq_push() without a shared lock. Returns how many are left for
+// the spill file; *t_full is when the queue was first found full.
+static int hostq_push_unlocked(void** hostnames, int count, int cls, producer_stats* stats,
+                               long long* t_full){
+    int spins = 0;
+    int pushed = hostq_push_some(hostnames, count, cls, 0);
+    hostnames += pushed;
+    count -= pushed;
+    if(count > 0){
+        *t_full = now_ns();
+        stat_add(&stats->full_waits, 1);
+    }
+    while(count > 0 && BACKPRESSURE == BACKPRESSURE_SPIN && spins++ < BACKPRESSURE_SPINS){
+        sched_yield();
+        pushed = hostq_push_some(hostnames, count, cls, 0);
+        hostnames += pushed;
+        count -= pushed;
+    }
+    if(count > 0 && BACKPRESSURE != BACKPRESSURE_SPILL){
+        hostq_push_some(hostnames, count, cls, 1);
+        count = 0;
+    }
+    return count;
+}
+
+#ifndef QUEUE_LOCKFREE
+// hostq_push() through queue_lock, same contract
+static int hostq_push_locked(void** hostnames, int count, int cls, producer_stats* stats,
+                             long long* t_full){
+    int spins = 0;
+    pthread_mutex_lock(&queue_lock);
+    while(count > 0){
+        if(hostq_is_full(cls)){
+            if(!*t_full){
+                *t_full = now_ns();
+                stat_add(&stats->full_waits, 1);
+            }
+            if(BACKPRESSURE == BACKPRESSURE_SPILL){
+                break;
+            }
+            if(BACKPRESSURE == BACKPRESSURE_SPIN && spins++ < BACKPRESSURE_SPINS){
+                pthread_mutex_unlock(&queue_lock);
+                sched_yield();
+                pthread_mutex_lock(&queue_lock);
+                continue;
+            }
+        }
+        while(hostq_is_full(cls)){
             pthread_cond_wait(&full, &queue_lock);
         }
 
-        queue_push(&q, strdup(hostname));
+        int pushed = PRIORITY ? queue_prio_push_many(&PRIO, cls, hostnames, count)
+                              : queue_push_many(&q, hostnames, count);
+        hostnames += pushed;
+        count -= pushed;
+
+        if(pushed > 1){
+            pthread_cond_broadcast(&empty);
+        }
+        else{
+            pthread_cond_signal(&empty);
+        }
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return count;
+}
+#endif
+
+// Hand count hostnames of priority class cls to the resolvers. When
+// the queue is full, --backpressure decides: block on it, retry
+// BACKPRESSURE_SPINS times first, or spill the rest. Time spent
+// waiting on a full queue is counted in stats either way.
+static void hostq_push(void** hostnames, int count, int cls, producer_stats* stats){
+    long long t_full = 0;
+    int left;
+    atomic_fetch_add_explicit(&QUEUED, count, memory_order_relaxed);
+#ifdef QUEUE_LOCKFREE
+    left = hostq_push_unlocked(hostnames, count, cls, stats, &t_full);
+#else
+    if(SCHEDULE == SCHEDULE_STEAL){
+        left = hostq_push_unlocked(hostnames, count, cls, stats, &t_full);
+    }
+    else{
+        left = hostq_push_locked(hostnames, count, cls, stats, &t_full);
+    }
+#endif
+    if(t_full){
+        stat_add(&stats->blocked_ns, now_ns() - t_full);
+    }
+    if(left > 0){
+        hostq_spill(hostnames + count - left, left, stats);
+    }
+}
+
+// hostq_pop() without a shared lock
+static int hostq_pop_unlocked(void** hostnames, host_item* spilled, int max, int* from_spill,
+                              int* cls, resolver_stats* stats){
+    // no lock to wait on; all time in here is waiting for work
+    long long t_start = now_ns();
+    int popped = 0;
+    if(BACKPRESSURE == BACKPRESSURE_SPILL){
+        popped = hostq_pop_some(hostnames, max, 0, cls, stats);
+    }
+    if(popped == 0){
+        // the queue is dry: refill from the spill file before sleeping
+        popped = hostq_unspill(spilled, max);
+        if(popped > 0){
+            *from_spill = 1;
+            return popped;
+        }
+        popped = hostq_pop_some(hostnames, max, 1, cls, stats);
+        // closed and drained: whatever was spilled is all that is left
+        if(popped == 0 && (popped = hostq_unspill(spilled, max)) > 0){
+            *from_spill = 1;
+            return popped;
+        }
+    }
+    stat_add(&stats->idle_ns, now_ns() - t_start);
+    atomic_fetch_sub_explicit(&QUEUED, popped, memory_order_relaxed);
+    return popped;
+}
+
+#ifndef QUEUE_LOCKFREE
+// hostq_pop() through queue_lock
+static int hostq_pop_locked(void** hostnames, host_item* spilled, int max, int* from_spill,
+                            int* cls, resolver_stats* stats){
+    long long t_start = now_ns();
+    pthread_mutex_lock(&queue_lock);
+    long long t_locked = now_ns();
+    stat_add(&stats->lock_wait_ns, t_locked - t_start);
+
+    // check if queue is empty
+    while(hostq_is_empty()){
+        pthread_mutex_lock(&inc_lock);
+        int que_empty = 0;
+        if(PRODUCERS_FINISHED == NUM_PRODUCERS) que_empty = 1;
+        pthread_mutex_unlock(&inc_lock);
+
+        // read after PRODUCERS_FINISHED, so a finished producer's
+        // last spill is seen
+        if(BACKPRESSURE == BACKPRESSURE_SPILL && spill_pending(&SPILL) > 0){
+            stat_add(&stats->lock_hold_ns, now_ns() - t_locked);
+            pthread_mutex_unlock(&queue_lock);
+            int taken = hostq_unspill(spilled, max);
+            if(taken > 0){
+                *from_spill = 1;
+                return taken;
+            }
+            pthread_mutex_lock(&queue_lock);
+            t_locked = now_ns();
+            continue;
+        }
+
+        if (que_empty){
+            stat_add(&stats->lock_hold_ns, now_ns() - t_locked);
+            pthread_mutex_unlock(&queue_lock);
+            return 0;
+
+        }
+
+        // time asleep on the condvar is idle, not hold time
+        long long t_wait = now_ns();
+        stat_add(&stats->lock_hold_ns, t_wait - t_locked);
+        pthread_cond_wait(&empty, &queue_lock);
+        t_locked = now_ns();
+        stat_add(&stats->idle_ns, t_locked - t_wait);
+
+    }
+    int popped = PRIORITY ? queue_prio_pop_many(&PRIO, hostnames, max, cls)
+                          : queue_pop_many(&q, (void**) hostnames, max);
+    atomic_fetch_sub_explicit(&QUEUED, popped, memory_order_relaxed);
+    // --urgent: a signal could wake a producer whose class is still full
+    if(popped > 1 || PRIORITY){
+        pthread_cond_broadcast(&full);
+    }
+    else{
+        pthread_cond_signal(&full);
+    }
+
+    stat_add(&stats->lock_hold_ns, now_ns() - t_locked);
+    pthread_mutex_unlock(&queue_lock);
+    return popped;
+}
+#endif
+
+// Take between 1 and max hostnames, blocking while the queue is empty.
+// With --backpressure spill an empty queue is refilled from the spill
+// file first: those names are copied to spilled and *from_spill set.
+// With --urgent they are all of one class, stored in *cls.
+// Returns 0 once every input file is finished and the queue and spill
+// file have drained.
+static int hostq_pop(void** hostnames, host_item* spilled, int max, int* from_spill,
+                     int* cls, resolver_stats* stats){
+    *from_spill = 0;
+    *cls = PRIORITY_BULK;
+#ifdef QUEUE_LOCKFREE
+    return hostq_pop_unlocked(hostnames, spilled, max, from_spill, cls, stats);
+#else
+    if(SCHEDULE == SCHEDULE_STEAL){
+        return hostq_pop_unlocked(hostnames, spilled, max, from_spill, cls, stats);
+    }
+    return hostq_pop_locked(hostnames, spilled, max, from_spill, cls, stats);
+#endif
+}
+
+// Count a finished producer. The last one wakes every resolver
+// waiting on an empty queue so they can see there is no more work.
+static void producer_finished(void){
+    pthread_mutex_lock(&inc_lock);
+    PRODUCERS_FINISHED++;
+    int all_done = (PRODUCERS_FINISHED == NUM_PRODUCERS);
+    pthread_mutex_unlock(&inc_lock);
+
+    if(all_done){
+        if(SCHEDULE == SCHEDULE_STEAL){
+            workq_close(&WORKQ);
+            return;
+        }
+#ifdef QUEUE_LOCKFREE
+        if(PRIORITY){
+            queue_prio_close(&PRIO);
+        }
+        else{
+            queue_close(&q);
+        }
+#else
+        pthread_mutex_lock(&queue_lock);
+        pthread_cond_broadcast(&empty);
+        pthread_mutex_unlock(&queue_lock);
+#endif
+    }
+}
+
+// Pin the calling thread, the index-th of its role: to one CPU of
+// cpus, or with --numa to every CPU of node index % nodes. Returns
+// the node's index in TOPOLOGY, or -1 if the thread runs anywhere.
+static int place_thread(const affinity_set* cpus, int index){
+    affinity_set one;
+    const affinity_set* set = NULL;
+    if(cpus){
+        affinity_only(&one, affinity_nth(cpus, index));
+        set = &one;
+    }
+    else if(NUMA){
+        set = &TOPOLOGY.nodes[index % TOPOLOGY.nnodes];
+    }
+    if(!set){
+        return -1;
+    }
+    if(affinity_pin(pthread_self(), set) == AFFINITY_FAILURE){
+        fprintf(stderr, "Error pinning thread %d to CPUs\n", index);
+        return -1;
+    }
+    return affinity_node_of(&TOPOLOGY, affinity_nth(set, 0));
+}
+
+// -s: note where the thread is, and publish its migration counts
+static void note_placement(affinity_track* track, atomic_llong* migrations,
+                           atomic_llong* node_migrations){
+    if(!PRINT_STATS){
+        return;
+    }
+    affinity_note(track, &TOPOLOGY);
+    atomic_store_explicit(migrations, track->migrations, memory_order_relaxed);
+    atomic_store_explicit(node_migrations, track->node_migrations, memory_order_relaxed);
+}
+
+// Queue a producer's batch, all of class cls. With --stats-json,
+// record the parse time per name since t_parse; with it or --urgent,
+// stamp the items for the queue wait and count the time blocked on a
+// full queue.
+static void push_batch(void** batch, int count, int cls, producer_stats* stats, long long t_parse){
+    stat_add(&stats->names, count);
+    if(!STATS_OUT && !PRIORITY){
+        hostq_push(batch, count, cls, stats);
+        return;
+    }
+    long long t_push = now_ns();
+    int i;
+    if(STATS_OUT){
+        histo_record_n(&H_PARSE, (t_push - t_parse) / count, count);
+    }
+    for(i=0 ; i < count ; i++){
+        host_handle_item(batch[i])->queued_ns = t_push;
+    }
+    hostq_push(batch, count, cls, stats);
+    stat_add(&stats->push_wait_ns, now_ns() - t_push);
+}
+
+// Producer: claim input ranges until none are left and queue their
+// hostnames BATCH_SIZE at a time. Each item points into the mapped
+// file, valid until main closes the readers, and carries its place
+// in the input for --ordered.
+void* read_ranges(void* arg){
+    producer_stats* stats = arg;
+    const char* hostname;
+    size_t len;
+    void* batch[BATCH_SIZE];
+    uint32_t slab = ARENA_NONE;
+    int used = 0;
+    int batched = 0;
+    int batch_cls = PRIORITY_BULK;
+    int r;
+    affinity_track track;
+    int node = place_thread(PRODUCER_CPUS, (int) (stats - PRODUCER_STATS));
+    PUSH_GROUP = NUMA ? node : -1;
+    affinity_track_init(&track);
+    long long t_parse = stage_start();
+
+    while((r = atomic_fetch_add(&NEXT_RANGE, 1)) < NUM_RANGES){
+        hostreader view;
+        uint64_t index = 0;
+        // a batch is one class; send the last file's names on first
+        if(batched > 0 && RANGES[r].file->priority != batch_cls){
+            push_batch(batch, batched, batch_cls, stats, t_parse);
+            batched = 0;
+            t_parse = stage_start();
+        }
+        batch_cls = RANGES[r].file->priority;
+        hostreader_range(&RANGES[r].file->reader, RANGES[r].begin, RANGES[r].end, &view);
+        stat_add(&stats->ranges, 1);
+        stat_add(&stats->bytes, view.end - view.pos);
+        while(hostreader_next(&view, &hostname, &len)){
+            void* handle = host_handle_new(&slab, &used);
+            host_item* item = host_handle_item(handle);
+            item->name = hostname;
+            item->seq = OUTWRITER_SEQ(r, index++);
+            batch[batched++] = handle;
+            if(batched == BATCH_SIZE){
+                note_placement(&track, &stats->migrations, &stats->node_migrations);
+                push_batch(batch, batched, batch_cls, stats, t_parse);
+                batched = 0;
+                t_parse = stage_start();
+            }
+        }
+        outwriter_range_done(&WRITER, r, index);
+    }
+    if(batched > 0){
+        push_batch(batch, batched, batch_cls, stats, t_parse);
+    }
+    host_slab_retire(slab, used);
+
+    producer_finished();
+    return NULL;
+}
+
+// Open every input and cut what is left of it (all of it, unless
+// --resume) into ranges of about total/NUM_PRODUCERS bytes, so a big
+// file is shared by several producers and small files are not split
+static int split_inputs(input_file* input_files){
+    checkpoint_span* pending[NUM_INPUT_FILES];
+    int npending[NUM_INPUT_FILES];
+    size_t total = 0;
+    int nspans = 0;
+    int i, j;
+
+    for (i=0 ; i < NUM_INPUT_FILES ; i++){
+        if(hostreader_open(&input_files[i].reader, input_files[i].name) == HOSTREADER_FAILURE){
+            fprintf(stderr, "Error opening input file %s: %s\n", input_files[i].name, strerror(errno));
+        }
+    }
+    if(RESUMING){
+        for (i=0 ; i < NUM_INPUT_FILES && i < RESUME_FROM.nfiles ; i++){
+            if(strcmp(RESUME_FROM.files[i].name, input_files[i].name) != 0
+               || RESUME_FROM.files[i].size != (long long) hostreader_size(&input_files[i].reader)){
+                break;
+            }
+        }
+        if(i != NUM_INPUT_FILES || i != RESUME_FROM.nfiles){
+            fprintf(stderr, "Checkpoint %s is for other input files\n", CHECKPOINT_PATH);
+            return -1;
+        }
+    }
+    else{
+        if(checkpoint_init(&RESUME_FROM, NUM_INPUT_FILES) == CHECKPOINT_FAILURE){
+            return -1;
+        }
+        for (i=0 ; i < NUM_INPUT_FILES ; i++){
+            if(checkpoint_set_file(&RESUME_FROM, i, input_files[i].name,
+                                   hostreader_size(&input_files[i].reader)) == CHECKPOINT_FAILURE){
+                return -1;
+            }
+        }
+    }
+    for (i=0 ; i < NUM_INPUT_FILES ; i++){
+        npending[i] = checkpoint_pending(&RESUME_FROM, i, &pending[i]);
+        if(npending[i] == CHECKPOINT_FAILURE){
+            return -1;
+        }
+        for(j = 0; j < npending[i]; j++){
+            total += pending[i][j].end - pending[i][j].begin;
+        }
+        nspans += npending[i];
+    }
+
+    size_t target = total / NUM_PRODUCERS + 1;
+    NUM_RANGES = 0;
+    RANGES = malloc((NUM_PRODUCERS + nspans + 1) * sizeof(*RANGES));
+    if(!RANGES){
+        perror("Error allocating input ranges");
+        return -1;
+    }
+    for (i=0 ; i < NUM_INPUT_FILES ; i++){
+        for(j = 0; j < npending[i]; j++){
+            size_t end = pending[i][j].end;
+            size_t begin;
+            for(begin = pending[i][j].begin; begin < end; begin += target){
+                input_range* r = &RANGES[NUM_RANGES++];
+                r->file = &input_files[i];
+                r->begin = begin;
+                r->end = begin + target < end ? begin + target : end;
+                hostreader_range(&r->file->reader, r->begin, r->end, &r->scan);
+                r->scanned = 0;
+                r->scanned_end = r->begin;
+            }
+        }
+        free(pending[i]);
+    }
+    return 0;
+}
+
+// Where the first index names of r end in its file. Counts on from
+// the last call, so over a run every name is counted once.
+static size_t range_names_end(input_range* r, uint64_t index){
+    const char* name;
+    size_t len;
+
+    while(r->scanned < index && hostreader_next(&r->scan, &name, &len)){
+        r->scanned++;
+        r->scanned_end = name + len - r->file->reader.base;
+    }
+    return r->scanned_end;
+}
+
+// --checkpoint: save the input bytes whose every name is in the
+// output file so far, and its length. The checkpoint thread calls
+// this, then main once more after the writer is done.
+static void checkpoint_write(void){
+    outwriter_progress* progress = malloc((NUM_RANGES + 1) * sizeof(*progress));
+    long long bytes;
+    checkpoint c;
+    int r;
+    size_t k;
+
+    if(!progress || outwriter_snapshot(&WRITER, progress, &bytes) == OUTWRITER_FAILURE){
+        free(progress);
+        fprintf(stderr, "Error taking a checkpoint\n");
+        return;
+    }
+    // a checkpoint must never count output that is not on disk yet
+    if(fdatasync(OUT_FD) < 0 && errno != EINVAL){
+        perror("Error syncing output file");
+    }
+    if(checkpoint_init(&c, NUM_INPUT_FILES) == CHECKPOINT_FAILURE
+       || checkpoint_copy(&c, &RESUME_FROM) == CHECKPOINT_FAILURE){
+        checkpoint_cleanup(&c);
+        for(r=0 ; r < NUM_RANGES ; r++){
+            free(progress[r].later);
+        }
+        free(progress);
+        return;
+    }
+    c.output_bytes = RESUME_FROM.output_bytes + bytes;
+    for(r=0 ; r < NUM_RANGES ; r++){
+        input_range* range = &RANGES[r];
+        int file = range->file - INPUT_FILES;
+        outwriter_progress* p = &progress[r];
+
+        if(p->count >= 0 && p->done == (uint64_t) p->count){
+            checkpoint_add(&c, file, range->begin, range->end);
+        }
+        else if(p->done > 0){
+            checkpoint_add(&c, file, range->begin, range_names_end(range, p->done));
+        }
+        // lines written past a gap: find each name from where the
+        // gap is, without moving the range's own count on
+        hostreader scan = range->scan;
+        uint64_t index = range->scanned;
+        const char* name = NULL;
+        size_t len = 0;
+        for(k = 0; k < p->nlater; k++){
+            while(index <= p->later[k] && hostreader_next(&scan, &name, &len)){
+                index++;
+            }
+            if(index == p->later[k] + 1){
+                size_t at = name - range->file->reader.base;
+                checkpoint_add(&c, file, at, at + len);
+            }
+        }
+        free(p->later);
+    }
+    free(progress);
+    if(checkpoint_save(&c, CHECKPOINT_PATH) == CHECKPOINT_FAILURE){
+        fprintf(stderr, "Error saving checkpoint %s: %s\n", CHECKPOINT_PATH, strerror(errno));
+    }
+    else{
+        CHECKPOINTS_SAVED++;
+    }
+    checkpoint_cleanup(&c);
+}
+
+// --checkpoint: save one every CHECKPOINT_MS until main says stop
+static void* checkpoint_thread(void* arg){
+    (void) arg;
+    struct timespec until;
+
+    pthread_mutex_lock(&checkpoint_lock);
+    deadline_after_ms(&until, CHECKPOINT_MS);
+    while(!CHECKPOINT_STOP){
+        if(pthread_cond_timedwait(&checkpoint_cond, &checkpoint_lock, &until) == ETIMEDOUT){
+            pthread_mutex_unlock(&checkpoint_lock);
+            checkpoint_write();
+            pthread_mutex_lock(&checkpoint_lock);
+            deadline_after_ms(&until, CHECKPOINT_MS);
+        }
+    }
+    pthread_mutex_unlock(&checkpoint_lock);
+    return NULL;
+}
+
+// Per producer time blocked on a full queue, printed to stderr with -s
+static void print_producer_stats(producer_stats* stats, int count){
+    long long names = 0, full_waits = 0, blocked_ns = 0, spilled = 0;
+    int i;
+
+    fprintf(stderr, "%8s %10s %10s %14s %10s\n",
+            "producer", "names", "full_waits", "blocked_us", "spilled");
+    for(i=0 ; i < count ; i++){
+        fprintf(stderr, "%8d %10lld %10lld %14lld %10lld\n", i, atomic_load(&stats[i].names),
+                atomic_load(&stats[i].full_waits), atomic_load(&stats[i].blocked_ns) / 1000,
+                atomic_load(&stats[i].spilled));
+        names += atomic_load(&stats[i].names);
+        full_waits += atomic_load(&stats[i].full_waits);
+        blocked_ns += atomic_load(&stats[i].blocked_ns);
+        spilled += atomic_load(&stats[i].spilled);
+    }
+    fprintf(stderr, "%8s %10lld %10lld %14lld %10lld\n", "total", names,
+            full_waits, blocked_ns / 1000, spilled);
+}
+
+void* producer_pool(){
+    pthread_t producer_threads[NUM_PRODUCERS];
+    fflush(stdout);
+
+    // Start every producer, then wait for all of them
+    int i;
+    for (i=0 ; i < NUM_PRODUCERS ; i++){
+
+        if(pthread_create(&producer_threads[i], NULL, read_ranges, &PRODUCER_STATS[i])){
+            fprintf(stderr, "Error creating producer thread %d\n", i);
+            producer_finished();
+            producer_threads[i] = pthread_self();
+        }
+    }
+
+    for(i=0 ; i < NUM_PRODUCERS ; i++){
+        if(!pthread_equal(producer_threads[i], pthread_self())){
+            pthread_join(producer_threads[i], NULL);
+        }
+    }
+
+    if(PRINT_STATS){
+        print_producer_stats(PRODUCER_STATS, NUM_PRODUCERS);
+    }
+    return NULL;
+}
+
+// Resolve through the memory cache, then the cache file, then the
+// network, sharing in-flight lookups of the same name. Same contract
+// as dnslookup_list(): every address goes in the caches.
+static int lookup_host(const char* hostname, char* ip, int size){
+    if(USE_CACHE){
+        switch(dnscache_get(&CACHE, hostname, ip, size)){
+        case DNSCACHE_HIT:
+            return UTIL_SUCCESS;
+        case DNSCACHE_NEGATIVE:
+            return UTIL_FAILURE;
+        }
+    }
+
+    long long start = now_ns();
+    int ret;
+    int disk = USE_DISK_CACHE ? diskcache_get(&DISK_CACHE, hostname, ip, size) : DISKCACHE_MISS;
+    if(disk == DISKCACHE_HIT){
+        ret = UTIL_SUCCESS;
+    }
+    else if(disk == DISKCACHE_NEGATIVE){
+        ret = UTIL_FAILURE;
+    }
+    else{
+        if(USE_COALESCE){
+            ret = dnslookup_list_coalesced(hostname, ip, size);
+        }
+        else{
+            ret = dnslookup_list(hostname, ip, size);
+        }
+        if(USE_DISK_CACHE){
+            diskcache_put(&DISK_CACHE, hostname, ret == UTIL_SUCCESS ? ip : NULL);
+        }
+    }
+
+    if(USE_CACHE){
+        dnscache_put(&CACHE, hostname, ret == UTIL_SUCCESS ? ip : NULL, now_ns() - start);
+    }
+    return ret;
+}
+
+// Queue hostname's output line from its address list: just the
+// first address, or all of them with -a. ips is NULL if the lookup
+// failed. seq is the name's place in the input.
+static void write_result(uint64_t seq, const char* hostname, const char* ips){
+    long long t_format = stage_start();
+    int ips_len = 0;
+    int failed = !ips;
+    if(failed){
+        atomic_fetch_add_explicit(&LOOKUP_FAILURES, 1, memory_order_relaxed);
+        fprintf(stderr, "DNS lookup error hostname: %s\n", hostname);
+        ips = "";
+    }
+    else{
+        ips_len = ALL_ADDRS ? (int) strlen(ips) : (int) strcspn(ips, UTIL_ADDR_SEP);
+    }
+
+    if(BINARY_OUT){
+        unsigned char record[RESULTFILE_MAX_RECORD];
+        int len = resultfile_add(&RESULTS, seq, hostname, failed ? NULL : ips,
+                                 ips_len, record);
+        if(len == RESULTFILE_FAILURE){
+            fprintf(stderr, "Error recording result for %s\n", hostname);
+        }
+        else if(len > 0){
+            outwriter_write(&WRITER, seq, (const char*) record, len);
+        }
+        stage_end(&H_FORMAT, t_format);
+        return;
+    }
+    char line[SBUFSIZE + UTIL_ADDRLIST_SIZE + 3];
+    int len = snprintf(line, sizeof(line), "%s, %.*s\n", hostname, ips_len, ips);
+    outwriter_write(&WRITER, seq, line, len);
+    stage_end(&H_FORMAT, t_format);
+}
+
+// Look up one hostname and write its line. Runs with no shared lock held.
+static void resolve_one(uint64_t seq, const char* hostname){
+    char ips[UTIL_ADDRLIST_SIZE];
+    long long t_lookup = stage_start();
+    int ret = lookup_host(hostname, ips, sizeof(ips));
+
+    stage_end(&H_LOOKUP, t_lookup);
+    if(ret == UTIL_FAILURE){
+        write_result(seq, hostname, NULL);
+    }
+    else{
+        write_result(seq, hostname, ips);
+    }
+}
+
+// A name handed to the async engine, owned until its answer arrives.
+// Each is one slab of the LOOKUPS arena.
+typedef struct async_lookup_s{
+    long long start;
+    uint64_t seq;
+    uint32_t slab;
+    char hostname[SBUFSIZE];
+} async_lookup;
+
+// Engine callback, on an event loop thread: fill the caches and
+// write the line
+static void async_done(void* arg, int status, const char* ip){
+    async_lookup* a = arg;
+    if(status != UTIL_SUCCESS){
+        ip = NULL;
+    }
+
+    if(USE_DISK_CACHE){
+        diskcache_put(&DISK_CACHE, a->hostname, ip);
+    }
+    if(USE_CACHE){
+        dnscache_put(&CACHE, a->hostname, ip, now_ns() - a->start);
+    }
+    stage_end(&H_LOOKUP, a->start);
+    write_result(a->seq, a->hostname, ip);
+    arena_put(&LOOKUPS, a->slab);
+}
+
+// Answer hostname from the caches, or submit a copy of it to the
+// async engine. Blocks while --max-inflight queries are outstanding.
+static void resolve_async(uint64_t seq, const char* hostname){
+    char ip[UTIL_ADDRLIST_SIZE];
+    long long start = now_ns();
+
+    if(USE_CACHE){
+        switch(dnscache_get(&CACHE, hostname, ip, sizeof(ip))){
+        case DNSCACHE_HIT:
+            stage_end(&H_LOOKUP, start);
+            write_result(seq, hostname, ip);
+            return;
+        case DNSCACHE_NEGATIVE:
+            stage_end(&H_LOOKUP, start);
+            write_result(seq, hostname, NULL);
+            return;
+        }
+    }
+
+    int disk = USE_DISK_CACHE ? diskcache_get(&DISK_CACHE, hostname, ip, sizeof(ip)) : DISKCACHE_MISS;
+    if(disk != DISKCACHE_MISS){
+        const char* found = disk == DISKCACHE_HIT ? ip : NULL;
+        if(USE_CACHE){
+            dnscache_put(&CACHE, hostname, found, now_ns() - start);
+        }
+        stage_end(&H_LOOKUP, start);
+        write_result(seq, hostname, found);
+        return;
+    }
+
+    uint32_t slab = arena_get(&LOOKUPS);
+    if(slab == ARENA_NONE){
+        write_result(seq, hostname, NULL);
+        return;
+    }
+    async_lookup* a = arena_ptr(&LOOKUPS, slab);
+    memcpy(a->hostname, hostname, strlen(hostname) + 1);
+    a->slab = slab;
+    a->start = start;
+    a->seq = seq;
+    dnsasync_submit(&ENGINE, a->hostname, async_done, a);
+}
+
+// Copy a queued name out of the mapped input into hostname,
+// cutting names longer than the old fscanf limit
+static void slice_hostname(const char* slice, char* hostname){
+    size_t len = hostreader_token_len(slice);
+    if(len > SBUFSIZE - 1){
+        len = SBUFSIZE - 1;
+    }
+    memcpy(hostname, slice, len);
+    hostname[len] = '\0';
+}
+
+// Adaptive pool: park while this resolver's slot is above the
+// target. Returns 0 once the input is drained and it should exit.
+static int resolver_wait_turn(int id){
+    if(id < atomic_load_explicit(&POOL_TARGET, memory_order_relaxed)){
+        return 1;
+    }
+    pthread_mutex_lock(&pool_lock);
+    while(id >= atomic_load(&POOL_TARGET) && !POOL_DRAINED){
+        pthread_cond_wait(&pool_cond, &pool_lock);
+    }
+    int run = !POOL_DRAINED;
+    pthread_mutex_unlock(&pool_lock);
+    return run;
+}
+
+// Every name is resolved: release parked resolvers and the controller
+static void pool_drained(void){
+    pthread_mutex_lock(&pool_lock);
+    POOL_DRAINED = 1;
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// --procs: a resolver's names on their way to its worker process
+typedef struct forward_batch_s{
+    worker_proc* worker;
+    unsigned char* buf;         // WORKER_BATCH_BYTES
+    size_t used;
+    long count;
+} forward_batch;
+
+// Move the batch into the worker's ring in one write. If the ring is
+// closed (the worker died) its names are lost, and counted.
+static void forward_flush(forward_batch* f){
+    if(f->count == 0){
+        return;
+    }
+    if(shmring_write(f->worker->names, f->buf, f->used) == SHMRING_FAILURE){
+        atomic_fetch_add(&f->worker->lost, f->count);
+    }
+    else{
+        atomic_fetch_add(&f->worker->sent, f->count);
+    }
+    f->used = 0;
+    f->count = 0;
+}
+
+static void forward_name(forward_batch* f, host_item* item, int cls, const char* hostname){
+    name_record n;
+    size_t size;
+    unsigned char* rec;
+
+    n.seq = item->seq;
+    n.queued_ns = item->queued_ns;
+    n.cls = cls;
+    n.len = strlen(hostname);
+    size = sizeof(n) + n.len;
+    rec = shmring_reserve(f->buf, WORKER_BATCH_BYTES, &f->used, size);
+    if(!rec){
+        forward_flush(f);
+        rec = shmring_reserve(f->buf, WORKER_BATCH_BYTES, &f->used, size);
+    }
+    memcpy(rec, &n, sizeof(n));
+    memcpy(rec + sizeof(n), hostname, n.len);
+    f->count++;
+}
+
+void* resolve_dns(void* arg){
+    resolver_stats* stats = arg;
+    forward_batch forward = {NULL, NULL, 0, 0};
+    void* batch[BATCH_SIZE];
+    host_item spilled[BACKPRESSURE == BACKPRESSURE_SPILL ? BATCH_SIZE : 1];
+    host_item* items[BATCH_SIZE];
+    char hostname[SBUFSIZE];
+    int from_spill;
+    int popped;
+    int cls;
+    int i;
+    affinity_track track;
+
+    // a pinned resolver's deque moves to memory on its own node
+    if(place_thread(RESOLVER_CPUS, stats->id) >= 0 && SCHEDULE == SCHEDULE_STEAL){
+        workq_place(&WORKQ, stats->id);
+    }
+    affinity_track_init(&track);
+    if(PROCS){
+        forward.worker = &WORKERS[stats->id];
+        forward.buf = malloc(WORKER_BATCH_BYTES);
+        if(!forward.buf){
+            fprintf(stderr, "Error allocating a worker batch\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    while(resolver_wait_turn(stats->id)
+          && (popped = hostq_pop(batch, spilled, BATCH_SIZE, &from_spill, &cls, stats)) > 0){
+        long long t_batch = now_ns();
+        note_placement(&track, &stats->migrations, &stats->node_migrations);
+        for(i=0 ; i < popped ; i++){
+            items[i] = from_spill ? &spilled[i] : host_handle_item(batch[i]);
+        }
+        if(STATS_OUT){
+            for(i=0 ; i < popped ; i++){
+                histo_record(&H_QUEUE_WAIT, t_batch - items[i]->queued_ns);
+            }
+        }
+        if(PRIORITY){
+            for(i=0 ; i < popped ; i++){
+                histo_record(&H_CLASS_WAIT[cls], t_batch - items[i]->queued_ns);
+            }
+        }
+        for(i=0 ; i < popped ; i++){
+            slice_hostname(items[i]->name, hostname);
+            if(PROCS){
+                forward_name(&forward, items[i], cls, hostname);
+            }
+            else if(USE_ASYNC){
+                resolve_async(items[i]->seq, hostname);
+            }
+            else{
+                resolve_one(items[i]->seq, hostname);
+            }
+            // async: until the query is handed to the engine; --procs:
+            // the collector records it when the answer comes back
+            if(PRIORITY && !PROCS){
+                histo_record(&H_CLASS_DONE[cls], now_ns() - items[i]->queued_ns);
+            }
+            if(!from_spill){
+                host_handle_release(batch[i]);
+            }
+        }
+        if(PROCS){
+            forward_flush(&forward);
+        }
+        stat_add(&stats->lookups, popped);
+        atomic_fetch_add_explicit(&LOOKUP_NS, now_ns() - t_batch, memory_order_relaxed);
+        atomic_fetch_add_explicit(&LOOKUPS_DONE, popped, memory_order_relaxed);
+    }
+    free(forward.buf);
+    pool_drained();
+    return NULL;
+}
+
+// Per resolver queue_lock contention and steals, printed to stderr with -s
+static void print_resolver_stats(resolver_stats* stats, int count){
+    long long lookups = 0, lock_wait_ns = 0, lock_hold_ns = 0, idle_ns = 0, stolen = 0;
+    int i;
+
+    fprintf(stderr, "%8s %10s %14s %14s %14s %10s\n",
+            "resolver", "lookups", "lock_wait_us", "lock_hold_us", "idle_us", "stolen");
+    for(i=0 ; i < count ; i++){
+        fprintf(stderr, "%8d %10lld %14lld %14lld %14lld %10lld\n", i, atomic_load(&stats[i].lookups),
+                atomic_load(&stats[i].lock_wait_ns) / 1000,
+                atomic_load(&stats[i].lock_hold_ns) / 1000,
+                atomic_load(&stats[i].idle_ns) / 1000,
+                atomic_load(&stats[i].stolen));
+        lookups += atomic_load(&stats[i].lookups);
+        lock_wait_ns += atomic_load(&stats[i].lock_wait_ns);
+        lock_hold_ns += atomic_load(&stats[i].lock_hold_ns);
+        idle_ns += atomic_load(&stats[i].idle_ns);
+        stolen += atomic_load(&stats[i].stolen);
+    }
+    fprintf(stderr, "%8s %10lld %14lld %14lld %14lld %10lld\n", "total", lookups,
+            lock_wait_ns / 1000, lock_hold_ns / 1000, idle_ns / 1000, stolen);
+}
+
+static void stats_line_start(const char* event, const char* type){
+    fprintf(STATS_OUT, "{\"event\":\"%s\",\"t\":%.6f,\"type\":\"%s\"",
+            event, (now_ns() - START_NS) / 1e9, type);
+}
+
+static void stats_histo_line(const char* event, const char* stage, histo* h){
+    stats_line_start(event, "stage");
+    fprintf(STATS_OUT, ",\"stage\":\"%s\",\"unit\":\"ns\",", stage);
+    histo_json(h, STATS_OUT);
+    fputs("}\n", STATS_OUT);
+}
+
+// --stats-json: one JSON object per line for every stage histogram,
+// the queue, each thread, the writer and the lookup throttle. event
+// says why (sigusr1, exit); t is seconds since start.
+static void stats_dump(const char* event){
+    int i;
+
+    pthread_mutex_lock(&stats_lock);
+    stats_histo_line(event, "parse", &H_PARSE);
+    stats_histo_line(event, "queue_wait", &H_QUEUE_WAIT);
+    stats_histo_line(event, "lookup", &H_LOOKUP);
+    stats_histo_line(event, "format", &H_FORMAT);
+    stats_histo_line(event, "write", &H_WRITE);
+    if(PRIORITY){
+        char stage[64];
+        for(i=0 ; i < PRIORITY_CLASSES ; i++){
+            snprintf(stage, sizeof(stage), "queue_wait_%s", PRIORITY_NAMES[i]);
+            stats_histo_line(event, stage, &H_CLASS_WAIT[i]);
+            snprintf(stage, sizeof(stage), "done_%s", PRIORITY_NAMES[i]);
+            stats_histo_line(event, stage, &H_CLASS_DONE[i]);
+        }
+    }
+
+    stats_line_start(event, "queue");
+    fprintf(STATS_OUT, ",\"capacity\":%d,\"depth\":%ld,\"spilled\":%ld,\"unit\":\"names\",",
+            QUEUE_SIZE, atomic_load(&QUEUED),
+            BACKPRESSURE == BACKPRESSURE_SPILL ? spill_pending(&SPILL) : 0);
+    histo_json(&H_QUEUE_DEPTH, STATS_OUT);
+    fputs("}\n", STATS_OUT);
+
+    for(i=0 ; i < NUM_PRODUCERS ; i++){
+        producer_stats* p = &PRODUCER_STATS[i];
+        stats_line_start(event, "producer");
+        fprintf(STATS_OUT, ",\"id\":%d,\"names\":%lld,\"bytes\":%lld,\"ranges\":%lld,\"push_wait_ns\":%lld,"
+                "\"full_waits\":%lld,\"blocked_ns\":%lld,\"spilled\":%lld}\n",
+                i, atomic_load(&p->names), atomic_load(&p->bytes),
+                atomic_load(&p->ranges), atomic_load(&p->push_wait_ns),
+                atomic_load(&p->full_waits), atomic_load(&p->blocked_ns),
+                atomic_load(&p->spilled));
+    }
+    int started = atomic_load(&RESOLVERS_STARTED);
+    for(i=0 ; i < started ; i++){
+        resolver_stats* r = &RESOLVER_STATS[i];
+        stats_line_start(event, "resolver");
+        fprintf(STATS_OUT, ",\"id\":%d,\"active\":%s,\"lookups\":%lld,\"lock_wait_ns\":%lld,"
+                "\"lock_hold_ns\":%lld,\"idle_ns\":%lld,\"stolen\":%lld}\n",
+                i, i < atomic_load(&POOL_TARGET) ? "true" : "false",
+                atomic_load(&r->lookups), atomic_load(&r->lock_wait_ns),
+                atomic_load(&r->lock_hold_ns), atomic_load(&r->idle_ns),
+                atomic_load(&r->stolen));
+    }
+
+    stats_line_start(event, "writer");
+    fprintf(STATS_OUT, ",\"lines\":%ld,\"writev\":%ld,\"bytes\":%lld,\"max_held\":%zu}\n",
+            atomic_load(&WRITER.lines), atomic_load(&WRITER.writes),
+            atomic_load(&WRITER.bytes), atomic_load(&WRITER.max_held));
+    if(!USE_ASYNC && !PROCS){
+        stats_line_start(event, "throttle");
+        fprintf(STATS_OUT, ",\"delayed\":%ld,\"delayed_ns\":%lld,\"capped\":%ld,\"inflight\":%d,"
+                "\"peak_inflight\":%d,\"retried\":%ld,\"gave_up\":%ld}\n",
+                atomic_load(&LIMIT.delayed), atomic_load(&LIMIT.delayed_ns),
+                atomic_load(&LIMIT.capped), atomic_load(&LIMIT.inflight),
+                atomic_load(&LIMIT.peak_inflight), atomic_load(&LIMIT.retried),
+                atomic_load(&LIMIT.gave_up));
+    }
+    stats_line_start(event, "totals");
+    fprintf(STATS_OUT, ",\"lookups\":%ld,\"failures\":%ld}\n",
+            atomic_load(&LOOKUPS_DONE), atomic_load(&LOOKUP_FAILURES));
+    fflush(STATS_OUT);
+    pthread_mutex_unlock(&stats_lock);
+}
+
+// --stats-json: sample the queue depth every STATS_INTERVAL_MS and
+// dump on SIGUSR1. Every other thread has SIGUSR1 blocked, so it is
+// only ever taken here, by sigtimedwait(), outside signal context.
+static void* stats_thread(void* arg){
+    sigset_t* set = arg;
+    struct timespec interval;
+    interval.tv_sec = STATS_INTERVAL_MS / 1000;
+    interval.tv_nsec = (STATS_INTERVAL_MS % 1000) * 1000000L;
+
+    while(!atomic_load(&STATS_STOP)){
+        int sig = sigtimedwait(set, NULL, &interval);
+        if(atomic_load(&STATS_STOP)){
+            break;
+        }
+        if(sig == SIGUSR1){
+            stats_dump("sigusr1");
+        }
+        else if(sig < 0 && errno == EAGAIN){
+            histo_record(&H_QUEUE_DEPTH, atomic_load(&QUEUED));
+        }
+    }
+    return NULL;
+}
+
+// Cache hit/miss rates and lookup time saved, printed to stderr with -s
+static void print_cache_stats(dnscache* cache){
+    dnscache_stats cs;
+    dnscache_get_stats(cache, &cs);
+    long total = cs.hits + cs.negative_hits + cs.misses;
+    double pct = total > 0 ? 100.0 / total : 0.0;
+
+    fprintf(stderr, "cache: entries=%ld hits=%ld negative_hits=%ld misses=%ld expired=%ld\n",
+            cs.entries, cs.hits, cs.negative_hits, cs.misses, cs.expired);
+    fprintf(stderr, "cache: hit_rate=%.1f%% miss_rate=%.1f%% lookup_ms=%lld saved_ms=%lld\n",
+            (cs.hits + cs.negative_hits) * pct, cs.misses * pct,
+            cs.miss_ns / 1000000, cs.saved_ns / 1000000);
+}
+
+// Slab reuse of one arena, printed to stderr with -s
+static void print_arena_stats(const char* name, arena* a){
+    fprintf(stderr, "arena %s: slab_bytes=%zu gets=%ld reused=%ld regions=%d\n",
+            name, a->slab_size, atomic_load(&a->gets), atomic_load(&a->reused),
+            atomic_load(&a->nregions));
+}
+
+// Print the cache, throttle and backend stats with -s, and free them
+static void finish_lookups(void){
+    // --procs: the workers did the lookups, and print their own
+    int print = PRINT_STATS && (!PROCS || WORKER_ID >= 0);
+    if(USE_CACHE){
+        if(print){
+            print_cache_stats(&CACHE);
+        }
+        dnscache_cleanup(&CACHE);
+    }
+    if(USE_COALESCE && !USE_ASYNC && print){
+        long lookups, coalesced;
+        dnslookup_coalesced_stats(&lookups, &coalesced);
+        fprintf(stderr, "coalesce: lookups=%ld coalesced=%ld\n", lookups, coalesced);
+    }
+    if(!USE_ASYNC){
+        if(print){
+            fprintf(stderr, "throttle: delayed=%ld delayed_ms=%lld capped=%ld peak_inflight=%d"
+                    " retried=%ld gave_up=%ld\n",
+                    atomic_load(&LIMIT.delayed), atomic_load(&LIMIT.delayed_ns) / 1000000,
+                    atomic_load(&LIMIT.capped), atomic_load(&LIMIT.peak_inflight),
+                    atomic_load(&LIMIT.retried), atomic_load(&LIMIT.gave_up));
+        }
+        dnslookup_set_throttle(NULL);
+        throttle_cleanup(&LIMIT);
+    }
+    if(USE_FAKE){
+        if(print){
+            fprintf(stderr, "fake resolver: lookups=%ld failures=%ld transient=%ld slept_us=%lld\n",
+                    atomic_load(&FAKE.lookups), atomic_load(&FAKE.failures),
+                    atomic_load(&FAKE.transient), atomic_load(&FAKE.slept_us));
+        }
+        dnsresolver_set(NULL);
+        fakeresolver_cleanup(&FAKE);
+    }
+    if(USE_DISK_CACHE){
+        if(print){
+            fprintf(stderr, "cache file: hits=%ld negative_hits=%ld misses=%ld writes=%ld\n",
+                    atomic_load(&DISK_CACHE.hits), atomic_load(&DISK_CACHE.negative_hits),
+                    atomic_load(&DISK_CACHE.misses), atomic_load(&DISK_CACHE.writes));
+        }
+        diskcache_close(&DISK_CACHE);
+    }
+}
+
+// --daemon: the resident resolvers look names up like resolve_one()
+static int daemon_lookup(void* ctx, const char* hostname, char* ips, int size){
+    (void) ctx;
+    return lookup_host(hostname, ips, size);
+}
+
+// --daemon: answer lookups on DAEMON_PATH with THREAD_MAX resolvers
+// until SIGINT or SIGTERM, keeping the caches between requests
+static int run_daemon(void){
+    lookupd daemon;
+    sigset_t stop_signals;
+    int sig;
+
+    // blocked before the daemon's threads start, so they inherit it
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, NULL);
+    if(lookupd_start(&daemon, DAEMON_PATH, THREAD_MAX, daemon_lookup, NULL) == LOOKUPD_FAILURE){
+        return EXIT_FAILURE;
+    }
+    printf("Serving lookups on %s\n", DAEMON_PATH);
+    fflush(stdout);
+    while(sigwait(&stop_signals, &sig) != 0){
+    }
+    lookupd_stop(&daemon);
+    if(PRINT_STATS){
+        fprintf(stderr, "daemon: connections=%ld requests=%ld names=%ld failed=%ld bad_requests=%ld\n",
+                atomic_load(&daemon.connections), atomic_load(&daemon.requests),
+                atomic_load(&daemon.names), atomic_load(&daemon.failed),
+                atomic_load(&daemon.bad_requests));
+    }
+    return EXIT_SUCCESS;
+}
+
+// --procs, in a worker process: send the answers batched in buf.
+// Only the reaper closes the ring, once this process is gone.
+static void worker_send(unsigned char* buf, size_t* used){
+    if(*used > 0){
+        shmring_write(WORKERS[WORKER_ID].answers, buf, *used);
+        *used = 0;
+    }
+}
+
+// --procs, in a worker process: look up the names of this worker's
+// ring, BATCH_SIZE at a time, and send back each one's answer
+static void* worker_resolve(void* arg){
+    worker_proc* w = &WORKERS[WORKER_ID];
+    unsigned char* names = malloc(WORKER_BATCH_BYTES);
+    unsigned char* answers = malloc(WORKER_BATCH_BYTES);
+    char hostname[SBUFSIZE];
+    char ips[UTIL_ADDRLIST_SIZE];
+    name_record n;
+    answer_record a;
+    unsigned char* rec;
+    unsigned char* out;
+    size_t used = 0;
+    size_t off;
+    size_t len;
+    size_t size;
+    long got;
 
-        pthread_cond_signal(&empty);
-        pthread_mutex_unlock(&queue_lock);
+    place_thread(RESOLVER_CPUS, WORKER_ID * WORKER_THREADS + (int) (intptr_t) arg);
+    if(!names || !answers){
+        fprintf(stderr, "Error allocating worker %d batches\n", WORKER_ID);
+        _exit(EXIT_FAILURE);
     }
+    while((got = shmring_read(w->names, names, WORKER_BATCH_BYTES, BATCH_SIZE)) > 0){
+        off = 0;
+        while((rec = shmring_next(names, got, &off, &len))){
+            memcpy(&n, rec, sizeof(n));
+            memcpy(hostname, rec + sizeof(n), n.len);
+            hostname[n.len] = '\0';
 
-    // Increment counter
-    pthread_mutex_lock(&inc_lock);
-    FILES_FINISHED++;
-    pthread_mutex_unlock(&inc_lock);
+            long long t_lookup = stage_start();
+            a.failed = lookup_host(hostname, ips, sizeof(ips)) == UTIL_FAILURE;
+            a.lookup_ns = STATS_OUT ? now_ns() - t_lookup : 0;
+            a.seq = n.seq;
+            a.queued_ns = n.queued_ns;
+            a.cls = n.cls;
+            a.name_len = n.len;
+            a.ips_len = a.failed ? 0 : ALL_ADDRS ? strlen(ips) : strcspn(ips, UTIL_ADDR_SEP);
 
-    // Close file and return
-    fclose(input);
+            size = sizeof(a) + a.name_len + a.ips_len;
+            out = shmring_reserve(answers, WORKER_BATCH_BYTES, &used, size);
+            if(!out){
+                worker_send(answers, &used);
+                out = shmring_reserve(answers, WORKER_BATCH_BYTES, &used, size);
+            }
+            memcpy(out, &a, sizeof(a));
+            memcpy(out + sizeof(a), hostname, a.name_len);
+            memcpy(out + sizeof(a) + a.name_len, ips, a.ips_len);
+            atomic_fetch_add_explicit(&LOOKUPS_DONE, 1, memory_order_relaxed);
+        }
+        worker_send(answers, &used);
+    }
+    free(names);
+    free(answers);
     return NULL;
 }
 
-void* producer_pool(char* input_files){
-    // pointer stuff
-    char** input_file_names = (char **) input_files;
-    pthread_t producer_threads[NUM_INPUT_FILES];
-    fflush(stdout);
+// --procs, in a worker process: its exact share of a limit, the
+// first total % PROCS workers taking one more, so the shares add up
+// to total
+static int worker_share(int total){
+    return total / PROCS + (WORKER_ID < total % PROCS);
+}
 
+// --procs: what worker id runs in place of the rest of main(). It
+// has every cache and setting main() made before the fork; it exits
+// once its name ring is closed and drained.
+static void worker_main(int id, pid_t parent, const worker_setup* setup){
+    pthread_t threads[WORKER_THREADS];
+    int started;
     int i;
-    for (i=0 ; i < NUM_INPUT_FILES ; i++){
 
-        char* input_file_name = input_file_names[i];
-        pthread_create(&producer_threads[i], NULL, (void*) read_file, (void*) input_file_name);
-        pthread_join(producer_threads[i], NULL);
+    // never outlive the parent, waiting on a ring no one fills
+    if(prctl(PR_SET_PDEATHSIG, SIGKILL) < 0 || getppid() != parent){
+        _exit(EXIT_FAILURE);
+    }
+    WORKER_ID = id;
+    // the inherited descriptor shares the parent's flock(), which
+    // would not keep workers apart; take one of its own
+    if(USE_DISK_CACHE){
+        diskcache_close(&DISK_CACHE);
+        if(diskcache_open(&DISK_CACHE, setup->cache_file, setup->cache_slots, setup->cache_ttl,
+                          setup->cache_neg_ttl) == DISKCACHE_FAILURE){
+            fprintf(stderr, "Error opening cache file %s in worker %d\n", setup->cache_file, id);
+            _exit(EXIT_FAILURE);
+        }
+    }
+    // the workers' throttles together let through what one would
+    dnslookup_set_throttle(NULL);
+    throttle_cleanup(&LIMIT);
+    if(throttle_init(&LIMIT, worker_share(setup->rate), worker_share(setup->burst),
+                     worker_share(setup->max_inflight), setup->dns_retries,
+                     setup->backoff_ms) == THROTTLE_FAILURE){
+        fprintf(stderr, "Error setting up the lookup throttle in worker %d\n", id);
+        _exit(EXIT_FAILURE);
+    }
+    dnslookup_set_throttle(&LIMIT);
+    for(started = 0; started < WORKER_THREADS; started++){
+        if(pthread_create(&threads[started], NULL, worker_resolve, (void*) (intptr_t) started)){
+            fprintf(stderr, "Error creating worker %d thread %d\n", id, started);
+            break;
+        }
+    }
+    for(i = 0; i < started; i++){
+        pthread_join(threads[i], NULL);
     }
+    shmring_close(WORKERS[id].answers);
+    if(PRINT_STATS){
+        fprintf(stderr, "worker %d: pid=%d threads=%d lookups=%ld\n",
+                id, (int) getpid(), started, atomic_load(&LOOKUPS_DONE));
+    }
+    finish_lookups();
+    _exit(started > 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
 
-    for(i=0 ; i < NUM_INPUT_FILES ; i++){
-        pthread_cond_signal(&empty);
+// --procs: map each worker's rings and fork it. Call before any
+// other thread starts; each child begins as a copy of this one.
+static int start_workers(const worker_setup* setup){
+    pid_t parent = getpid();
+    int w;
+
+    WORKERS = calloc(PROCS, sizeof(*WORKERS));
+    if(!WORKERS){
+        perror("Error allocating worker processes");
+        return -1;
+    }
+    // or the children would print it again
+    fflush(stdout);
+    for(w = 0; w < PROCS; w++){
+        WORKERS[w].names = shmring_create((size_t) RING_KB * 1024);
+        WORKERS[w].answers = shmring_create((size_t) RING_KB * 1024);
+        if(!WORKERS[w].names || !WORKERS[w].answers){
+            return -1;
+        }
+        WORKERS[w].pid = fork();
+        if(WORKERS[w].pid < 0){
+            perror("Error forking a worker process");
+            return -1;
+        }
+        if(WORKERS[w].pid == 0){
+            worker_main(w, parent, setup);
+        }
     }
+    return 0;
+}
+
+// --procs: write the lines one worker's answers carry, until it
+// closes its ring or dies
+static void* collect_answers(void* arg){
+    worker_proc* w = arg;
+    unsigned char* buf = malloc(WORKER_BATCH_BYTES);
+    char hostname[SBUFSIZE];
+    char ips[UTIL_ADDRLIST_SIZE];
+    answer_record a;
+    unsigned char* rec;
+    size_t off;
+    size_t len;
+    long got;
 
+    if(!buf){
+        fprintf(stderr, "Error allocating a collector batch\n");
+        exit(EXIT_FAILURE);
+    }
+    while((got = shmring_read(w->answers, buf, WORKER_BATCH_BYTES, 0)) > 0){
+        off = 0;
+        while((rec = shmring_next(buf, got, &off, &len))){
+            memcpy(&a, rec, sizeof(a));
+            memcpy(hostname, rec + sizeof(a), a.name_len);
+            hostname[a.name_len] = '\0';
+            memcpy(ips, rec + sizeof(a) + a.name_len, a.ips_len);
+            ips[a.ips_len] = '\0';
+            if(STATS_OUT){
+                histo_record(&H_LOOKUP, a.lookup_ns);
+            }
+            write_result(a.seq, hostname, a.failed ? NULL : ips);
+            if(PRIORITY){
+                histo_record(&H_CLASS_DONE[a.cls], now_ns() - a.queued_ns);
+            }
+            atomic_fetch_add_explicit(&w->answered, 1, memory_order_relaxed);
+        }
+    }
+    free(buf);
     return NULL;
 }
 
-void* resolve_dns(){
-    FILE* out_fp =fopen(OUT_FILE, "w");
-    if(!out_fp){
-        perror("Error opening output file");
-	return NULL;
+// --procs: wait for every worker to exit. One that fails or dies
+// gets both rings closed, so its resolver stops sending to it and
+// its collector stops waiting on it.
+static void* reap_workers(void* arg){
+    (void) arg;
+    int reaped = 0;
+    int status;
+    int w;
+
+    while(reaped < PROCS){
+        pid_t pid = waitpid(-1, &status, 0);
+        if(pid < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            break;
+        }
+        for(w = 0; w < PROCS && WORKERS[w].pid != pid; w++);
+        if(w == PROCS){
+            continue;
+        }
+        reaped++;
+        if(WIFSIGNALED(status)){
+            fprintf(stderr, "Worker %d (pid %d) killed by signal %d\n", w, (int) pid, WTERMSIG(status));
+            WORKERS[w].failed = 1;
+        }
+        else if(WEXITSTATUS(status) != 0){
+            fprintf(stderr, "Worker %d (pid %d) exited with status %d\n", w, (int) pid, WEXITSTATUS(status));
+            WORKERS[w].failed = 1;
+        }
+        shmring_close(WORKERS[w].names);
+        shmring_close(WORKERS[w].answers);
     }
+    return NULL;
+}
 
-    while(1){
-        pthread_mutex_lock(&queue_lock);
+// --procs: a collector per worker and the reaper
+static int start_collectors(void){
+    int w;
 
-        // check if queue is empty
-        while(queue_is_empty(&q)){
-            pthread_mutex_lock(&inc_lock);
-            int que_empty = 0;
-            if(FILES_FINISHED == NUM_INPUT_FILES) que_empty = 1;
-            pthread_mutex_unlock(&inc_lock);
+    for(w = 0; w < PROCS; w++){
+        if(pthread_create(&WORKERS[w].collector, NULL, collect_answers, &WORKERS[w])){
+            fprintf(stderr, "Error creating collector thread %d\n", w);
+            return -1;
+        }
+    }
+    if(pthread_create(&REAPER, NULL, reap_workers, NULL)){
+        fprintf(stderr, "Error creating the worker reaper thread\n");
+        return -1;
+    }
+    return 0;
+}
 
-            if (que_empty){
-                pthread_mutex_unlock(&queue_lock);
-                return NULL;
+// --procs: every resolver is done sending. Close the name rings,
+// then wait for the last answers and the workers. Returns -1 if a
+// worker failed or left names unanswered.
+static int finish_workers(void){
+    int ret = 0;
+    int w;
 
-            }
+    for(w = 0; w < PROCS; w++){
+        shmring_close(WORKERS[w].names);
+    }
+    for(w = 0; w < PROCS; w++){
+        pthread_join(WORKERS[w].collector, NULL);
+    }
+    pthread_join(REAPER, NULL);
+    for(w = 0; w < PROCS; w++){
+        long unanswered = atomic_load(&WORKERS[w].sent) - atomic_load(&WORKERS[w].answered)
+                        + atomic_load(&WORKERS[w].lost);
+        if(WORKERS[w].failed || unanswered > 0){
+            fprintf(stderr, "Worker %d left %ld names unresolved\n", w, unanswered);
+            ret = -1;
+        }
+    }
+    return ret;
+}
 
-            pthread_cond_wait(&empty, &queue_lock);
+// Worker processes and their rings' traffic, printed with -s
+static void print_worker_stats(void){
+    long names = 0, answers = 0, name_waits = 0, answer_waits = 0, lost = 0;
+    int w;
 
-        }
-        char* single_hostname = (char*) queue_pop(&q);
-        pthread_cond_signal(&full);
+    for(w = 0; w < PROCS; w++){
+        names += atomic_load(&WORKERS[w].sent);
+        answers += atomic_load(&WORKERS[w].answered);
+        lost += atomic_load(&WORKERS[w].lost);
+        name_waits += WORKERS[w].names->write_waits;
+        answer_waits += WORKERS[w].answers->write_waits;
+    }
+    fprintf(stderr, "procs: workers=%d threads=%d ring_bytes=%zu names=%ld answers=%ld"
+            " name_waits=%ld answer_waits=%ld lost=%ld\n",
+            PROCS, WORKER_THREADS, WORKERS[0].names->size, names, answers,
+            name_waits, answer_waits, lost);
+}
 
+static void cleanup_workers(void){
+    int w;
 
-        char first_ip[INET6_ADDRSTRLEN];
+    for(w = 0; w < PROCS; w++){
+        shmring_destroy(WORKERS[w].names);
+        shmring_destroy(WORKERS[w].answers);
+    }
+    free(WORKERS);
+}
 
-        if(dnslookup(single_hostname, first_ip, sizeof(first_ip)) == UTIL_FAILURE){
-            fprintf(stderr, "DNS lookup error hostname: %s\n", single_hostname);
-            strncpy(first_ip, "", sizeof(first_ip));
+// Start resolvers until started reaches want; returns the new count
+static int start_resolvers(pthread_t* threads, resolver_stats* stats, int started, int want){
+    while(started < want){
+        stats[started].id = started;
+        if(pthread_create(&threads[started], NULL, resolve_dns, &stats[started])){
+            fprintf(stderr, "Error creating resolver thread %d\n", started);
+            break;
         }
+        started++;
+        atomic_store(&RESOLVERS_STARTED, started);
+    }
+    return started;
+}
 
-        pthread_mutex_lock(&out_lock);
-        fprintf(out_fp, "%s, %s\n", single_hostname, first_ip);
-        pthread_mutex_unlock(&out_lock);
+// --max-threads: every ADAPT_MS sample the queue and lookup rate,
+// let adapt_step() pick a pool size, and log each change. Resolvers
+// above the target park after their current batch. Returns the
+// number of threads started.
+static int adapt_pool(pthread_t* threads, resolver_stats* stats, int started){
+    adapt ctl;
+    adapt_sample s;
+    const char* reason;
+    long long t0 = now_ns();
+    long long t_last = t0;
+    long last_done = 0;
+    long long last_ns = 0;
+    int drained = 0;
 
-	free(single_hostname);
+    adapt_init(&ctl, MIN_THREADS, MAX_THREADS, atomic_load(&POOL_TARGET));
+    while(!drained){
+        struct timespec until;
+        deadline_after_ms(&until, ADAPT_MS);
+        pthread_mutex_lock(&pool_lock);
+        while(!POOL_DRAINED && pthread_cond_timedwait(&pool_cond, &pool_lock, &until) != ETIMEDOUT);
+        drained = POOL_DRAINED;
+        pthread_mutex_unlock(&pool_lock);
+        if(drained){
+            break;
+        }
 
-        pthread_mutex_unlock(&queue_lock);
+        long long t_now = now_ns();
+        long done = atomic_load(&LOOKUPS_DONE);
+        long long busy_ns = atomic_load(&LOOKUP_NS);
+        pthread_mutex_lock(&inc_lock);
+        s.input_done = PRODUCERS_FINISHED == NUM_PRODUCERS;
+        pthread_mutex_unlock(&inc_lock);
+        // names a producer is still waiting to push, or spilled, count too
+        long backlog = atomic_load(&QUEUED);
+        if(BACKPRESSURE == BACKPRESSURE_SPILL){
+            backlog += spill_pending(&SPILL);
+        }
+        s.occupancy = (double) backlog / QUEUE_SIZE;
+        s.rate = (done - last_done) * 1e9 / (t_now - t_last);
+        s.latency_us = done > last_done ? (busy_ns - last_ns) / 1e3 / (done - last_done) : 0.0;
+
+        int before = ctl.threads;
+        int after = adapt_step(&ctl, &s, &reason);
+        if(after != before){
+            if(after > started){
+                started = start_resolvers(threads, stats, started, after);
+                after = started > before ? started : before;
+                ctl.threads = after;
+            }
+            if(SCHEDULE == SCHEDULE_STEAL){
+                workq_set_active(&WORKQ, after);
+            }
+            pthread_mutex_lock(&pool_lock);
+            atomic_store(&POOL_TARGET, after);
+            pthread_cond_broadcast(&pool_cond);
+            pthread_mutex_unlock(&pool_lock);
+            fprintf(stderr, "adapt: %.2fs threads %d -> %d (%s) queue=%ld/%d rate=%.0f/s latency=%.0fus\n",
+                    (t_now - t0) / 1e9, before, after, reason, atomic_load(&QUEUED),
+                    QUEUE_SIZE, s.rate, s.latency_us);
+        }
+        t_last = t_now;
+        last_done = done;
+        last_ns = busy_ns;
     }
-    fclose(out_fp);
-    return NULL;
+    return started;
 }
 
 void* consumer_pool(){
-    // Creates threads for resolver
-    pthread_t consumer_threads[NUM_INPUT_FILES];
+    // Creates threads for resolver, all running at once; with
+    // --max-threads only the starting count runs at first
+    pthread_t consumer_threads[RESOLVER_SLOTS];
+    resolver_stats* stats = RESOLVER_STATS;
+    int started = start_resolvers(consumer_threads, stats, 0, atomic_load(&POOL_TARGET));
     int i;
-    for (i=0; i < THREAD_MAX ; i++){
-        pthread_create(&consumer_threads[i], NULL, resolve_dns, NULL);
+    if(started > 0 && MAX_THREADS > 0){
+        started = adapt_pool(consumer_threads, stats, started);
+    }
+    for (i=0; i < started ; i++){
         pthread_join(consumer_threads[i], NULL);
     }
+    if(PRINT_STATS){
+        print_resolver_stats(stats, started);
+    }
     return NULL;
 }
 
+// Where each role ran and how often threads moved, printed with -s
+static void print_affinity_stats(void){
+    const affinity_set* roles[3] = {PRODUCER_CPUS, RESOLVER_CPUS, WRITER_CPUS};
+    char placed[3][256];
+    long long migrations = 0, node_migrations = 0;
+    int i;
+
+    for(i = 0; i < 3; i++){
+        if(roles[i]){
+            affinity_format(roles[i], placed[i], sizeof(placed[i]));
+        }
+        else{
+            strcpy(placed[i], NUMA ? "numa" : "any");
+        }
+    }
+    for(i = 0; i < NUM_PRODUCERS; i++){
+        migrations += atomic_load(&PRODUCER_STATS[i].migrations);
+        node_migrations += atomic_load(&PRODUCER_STATS[i].node_migrations);
+    }
+    for(i = 0; i < RESOLVER_SLOTS; i++){
+        migrations += atomic_load(&RESOLVER_STATS[i].migrations);
+        node_migrations += atomic_load(&RESOLVER_STATS[i].node_migrations);
+    }
+    fprintf(stderr, "affinity: nodes=%d producers=%s resolvers=%s writer=%s migrations=%lld node_migrations=%lld",
+            TOPOLOGY.nnodes, placed[0], placed[1], placed[2], migrations, node_migrations);
+    if(SCHEDULE == SCHEDULE_STEAL){
+        fprintf(stderr, " remote_steals=%ld", atomic_load(&WORKQ.remote_steals));
+    }
+    fputc('\n', stderr);
+}
+
+// Per class names, queue wait and time to done, printed with -s
+static void print_priority_stats(void){
+    int i;
+
+    for(i=0 ; i < PRIORITY_CLASSES ; i++){
+        fprintf(stderr, "priority: class=%s names=%ld wait_p50_us=%lld wait_p99_us=%lld"
+                " done_p50_us=%lld done_p99_us=%lld starved=%ld",
+                PRIORITY_NAMES[i], atomic_load(&H_CLASS_WAIT[i].count),
+                histo_percentile(&H_CLASS_WAIT[i], 50) / 1000,
+                histo_percentile(&H_CLASS_WAIT[i], 99) / 1000,
+                histo_percentile(&H_CLASS_DONE[i], 50) / 1000,
+                histo_percentile(&H_CLASS_DONE[i], 99) / 1000,
+                atomic_load(&PRIO.starved[i]));
+        if(i == PRIORITY_BULK){
+            fprintf(stderr, " starve_limit=%d", STARVE_LIMIT);
+        }
+        fputc('\n', stderr);
+    }
+}
+
+// Parse an integer option in [min, max], reporting bad values
+static int parse_int_opt(const char* name, const char* arg, int min, int max, int* out){
+    char* end;
+    long v = strtol(arg, &end, 10);
+    if(*arg == '\0' || *end != '\0' || v < min || v > max){
+        fprintf(stderr, "Option %s must be %d to %d: %s\n", name, min, max, arg);
+        return -1;
+    }
+    *out = (int) v;
+    return 0;
+}
+
+static void usage(const char* prog){
+    fprintf(stderr, "Using:\n %s %s\n %s %s\n%s", prog, USAGE, prog, DAEMON_USAGE, OPTIONS_HELP);
+}
+
+enum {
+    OPT_CACHE_TTL = 256,
+    OPT_CACHE_NEG_TTL,
+    OPT_CACHE_SHARDS,
+    OPT_NO_CACHE,
+    OPT_CACHE_FILE,
+    OPT_CACHE_SLOTS,
+    OPT_NO_COALESCE,
+    OPT_ENGINE,
+    OPT_NAMESERVER,
+    OPT_DNS_TIMEOUT,
+    OPT_DNS_RETRIES,
+    OPT_MAX_INFLIGHT,
+    OPT_EVENT_LOOPS,
+    OPT_ORDERED,
+    OPT_MIN_THREADS,
+    OPT_MAX_THREADS,
+    OPT_ADAPT_MS,
+    OPT_STATS_JSON,
+    OPT_STATS_INTERVAL,
+    OPT_RESOLVER,
+    OPT_BACKPRESSURE,
+    OPT_SPILL_DIR,
+    OPT_SCHEDULE,
+    OPT_CHECKPOINT,
+    OPT_CHECKPOINT_INTERVAL,
+    OPT_RESUME,
+    OPT_RATE,
+    OPT_BURST,
+    OPT_BACKOFF_MS,
+    OPT_DAEMON,
+    OPT_FORMAT,
+    OPT_DEDUP,
+    OPT_PIN_PRODUCERS,
+    OPT_PIN_RESOLVERS,
+    OPT_PIN_WRITER,
+    OPT_NUMA,
+    OPT_URGENT,
+    OPT_STARVE_LIMIT,
+    OPT_PROCS,
+    OPT_RING_KB,
+};
+
+static const struct option long_options[] = {
+    {"threads",       required_argument, NULL, 't'},
+    {"batch",         required_argument, NULL, 'b'},
+    {"producers",     required_argument, NULL, 'p'},
+    {"stats",         no_argument,       NULL, 's'},
+    {"all",           no_argument,       NULL, 'a'},
+    {"cache-ttl",     required_argument, NULL, OPT_CACHE_TTL},
+    {"cache-neg-ttl", required_argument, NULL, OPT_CACHE_NEG_TTL},
+    {"cache-shards",  required_argument, NULL, OPT_CACHE_SHARDS},
+    {"no-cache",      no_argument,       NULL, OPT_NO_CACHE},
+    {"cache",         required_argument, NULL, OPT_CACHE_FILE},
+    {"cache-slots",   required_argument, NULL, OPT_CACHE_SLOTS},
+    {"no-coalesce",   no_argument,       NULL, OPT_NO_COALESCE},
+    {"engine",        required_argument, NULL, OPT_ENGINE},
+    {"nameserver",    required_argument, NULL, OPT_NAMESERVER},
+    {"dns-timeout",   required_argument, NULL, OPT_DNS_TIMEOUT},
+    {"dns-retries",   required_argument, NULL, OPT_DNS_RETRIES},
+    {"max-inflight",  required_argument, NULL, OPT_MAX_INFLIGHT},
+    {"event-loops",   required_argument, NULL, OPT_EVENT_LOOPS},
+    {"ordered",       no_argument,       NULL, OPT_ORDERED},
+    {"min-threads",   required_argument, NULL, OPT_MIN_THREADS},
+    {"max-threads",   required_argument, NULL, OPT_MAX_THREADS},
+    {"adapt-ms",      required_argument, NULL, OPT_ADAPT_MS},
+    {"stats-json",    required_argument, NULL, OPT_STATS_JSON},
+    {"stats-interval", required_argument, NULL, OPT_STATS_INTERVAL},
+    {"resolver",      required_argument, NULL, OPT_RESOLVER},
+    {"queue-size",    required_argument, NULL, 'q'},
+    {"backpressure",  required_argument, NULL, OPT_BACKPRESSURE},
+    {"spill-dir",     required_argument, NULL, OPT_SPILL_DIR},
+    {"schedule",      required_argument, NULL, OPT_SCHEDULE},
+    {"checkpoint",    required_argument, NULL, OPT_CHECKPOINT},
+    {"checkpoint-interval", required_argument, NULL, OPT_CHECKPOINT_INTERVAL},
+    {"resume",        no_argument,       NULL, OPT_RESUME},
+    {"rate",          required_argument, NULL, OPT_RATE},
+    {"burst",         required_argument, NULL, OPT_BURST},
+    {"backoff-ms",    required_argument, NULL, OPT_BACKOFF_MS},
+    {"daemon",        required_argument, NULL, OPT_DAEMON},
+    {"format",        required_argument, NULL, OPT_FORMAT},
+    {"dedup",         no_argument,       NULL, OPT_DEDUP},
+    {"pin-producers", required_argument, NULL, OPT_PIN_PRODUCERS},
+    {"pin-resolvers", required_argument, NULL, OPT_PIN_RESOLVERS},
+    {"pin-writer",    required_argument, NULL, OPT_PIN_WRITER},
+    {"numa",          no_argument,       NULL, OPT_NUMA},
+    {"urgent",        required_argument, NULL, OPT_URGENT},
+    {"starve-limit",  required_argument, NULL, OPT_STARVE_LIMIT},
+    {"procs",         required_argument, NULL, OPT_PROCS},
+    {"ring-kb",       required_argument, NULL, OPT_RING_KB},
+    {"help",          no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
 int main(int argc, char* argv[]){
-    FILES_FINISHED = 0;
-    NUM_INPUT_FILES = argc - 2;
-    char* input_files[NUM_INPUT_FILES];
-    OUT_FILE = argv[argc-1];
+    // argv moves past the options; keep the name for usage()
+    const char* prog = argv[0];
+    int opt;
+    int cache_ttl = DNSCACHE_DEFAULT_TTL;
+    int cache_neg_ttl = DNSCACHE_DEFAULT_NEG_TTL;
+    int cache_shards = DNSCACHE_DEFAULT_SHARDS;
+    char* cache_file = NULL;
+    int cache_slots = DISKCACHE_DEFAULT_SLOTS;
+    char* nameservers = NULL;
+    int dns_timeout = DNSASYNC_DEFAULT_TIMEOUT_MS;
+    int dns_retries = DNSASYNC_DEFAULT_RETRIES;
+    int max_inflight = 0;           // 0: the async default, no getaddrinfo cap
+    int rate = 0;
+    int burst = THROTTLE_DEFAULT_BURST;
+    int backoff_ms = THROTTLE_DEFAULT_BACKOFF_MS;
+    int dedup = 0;
+    // --urgent input files
+    const char* urgent_files[argc];
+    int nurgent = 0;
+    // producers, resolvers, writer
+    const char* pin_lists[3] = {NULL, NULL, NULL};
+    const affinity_set** pin_roles[3] = {&PRODUCER_CPUS, &RESOLVER_CPUS, &WRITER_CPUS};
+    int event_loops = DNSASYNC_DEFAULT_LOOPS;
+    char* stats_json = NULL;
+    char* resolver_spec = NULL;
+    char* spill_dir = NULL;
+    int auto_queue;
+    sigset_t stats_signals;
+    pthread_t stats_id;
+    START_NS = now_ns();
     THREAD_MAX = sysconf(_SC_NPROCESSORS_ONLN);
-    printf("Resolving threads dynamically, set to %d\n",THREAD_MAX);
+
+    while((opt = getopt_long(argc, argv, "ab:hp:q:st:", long_options, NULL)) != -1){
+        int bad = 0;
+        switch(opt){
+        case 'a':
+            ALL_ADDRS = 1;
+            break;
+        case 'b':
+            bad = parse_int_opt("-b", optarg, 1, MAX_BATCH_SIZE, &BATCH_SIZE);
+            break;
+        case 'h':
+            usage(prog);
+            return EXIT_SUCCESS;
+        case 'p':
+            bad = parse_int_opt("-p", optarg, 1, 65536, &NUM_PRODUCERS);
+            break;
+        case 'q':
+            if(strcmp(optarg, "auto") == 0){
+                QUEUE_SIZE = 0;
+            }
+            else{
+                bad = parse_int_opt("-q", optarg, 1, MAX_QUEUE_SIZE, &QUEUE_SIZE);
+            }
+            break;
+        case 's':
+            PRINT_STATS = 1;
+            break;
+        case 't':
+            bad = parse_int_opt("-t", optarg, 1, 65536, &THREAD_MAX);
+            break;
+        case OPT_CACHE_TTL:
+            bad = parse_int_opt("--cache-ttl", optarg, 0, 86400 * 365, &cache_ttl);
+            break;
+        case OPT_CACHE_NEG_TTL:
+            bad = parse_int_opt("--cache-neg-ttl", optarg, 0, 86400 * 365, &cache_neg_ttl);
+            break;
+        case OPT_CACHE_SHARDS:
+            bad = parse_int_opt("--cache-shards", optarg, 1, 1 << 16, &cache_shards);
+            break;
+        case OPT_NO_CACHE:
+            USE_CACHE = 0;
+            break;
+        case OPT_CACHE_FILE:
+            cache_file = optarg;
+            break;
+        case OPT_CACHE_SLOTS:
+            bad = parse_int_opt("--cache-slots", optarg, 1, 1 << 30, &cache_slots);
+            break;
+        case OPT_NO_COALESCE:
+            USE_COALESCE = 0;
+            break;
+        case OPT_ENGINE:
+            if(strcmp(optarg, "async") == 0){
+                USE_ASYNC = 1;
+            }
+            else if(strcmp(optarg, "getaddrinfo") == 0){
+                USE_ASYNC = 0;
+            }
+            else{
+                fprintf(stderr, "Unknown engine: %s\n", optarg);
+                bad = 1;
+            }
+            break;
+        case OPT_NAMESERVER:
+            nameservers = optarg;
+            break;
+        case OPT_DNS_TIMEOUT:
+            bad = parse_int_opt("--dns-timeout", optarg, 1, 600000, &dns_timeout);
+            break;
+        case OPT_DNS_RETRIES:
+            bad = parse_int_opt("--dns-retries", optarg, 0, 100, &dns_retries);
+            break;
+        case OPT_MAX_INFLIGHT:
+            bad = parse_int_opt("--max-inflight", optarg, 1, 1 << 20, &max_inflight);
+            break;
+        case OPT_EVENT_LOOPS:
+            bad = parse_int_opt("--event-loops", optarg, 1, 256, &event_loops);
+            break;
+        case OPT_ORDERED:
+            ORDERED = 1;
+            break;
+        case OPT_MIN_THREADS:
+            bad = parse_int_opt("--min-threads", optarg, 1, 65536, &MIN_THREADS);
+            break;
+        case OPT_MAX_THREADS:
+            bad = parse_int_opt("--max-threads", optarg, 1, 65536, &MAX_THREADS);
+            break;
+        case OPT_ADAPT_MS:
+            bad = parse_int_opt("--adapt-ms", optarg, 1, 600000, &ADAPT_MS);
+            break;
+        case OPT_STATS_JSON:
+            stats_json = optarg;
+            break;
+        case OPT_STATS_INTERVAL:
+            bad = parse_int_opt("--stats-interval", optarg, 1, 600000, &STATS_INTERVAL_MS);
+            break;
+        case OPT_BACKPRESSURE:
+            if(strcmp(optarg, "block") == 0){
+                BACKPRESSURE = BACKPRESSURE_BLOCK;
+            }
+            else if(strcmp(optarg, "spin") == 0){
+                BACKPRESSURE = BACKPRESSURE_SPIN;
+            }
+            else if(strcmp(optarg, "spill") == 0){
+                BACKPRESSURE = BACKPRESSURE_SPILL;
+            }
+            else{
+                fprintf(stderr, "Unknown backpressure policy: %s\n", optarg);
+                bad = 1;
+            }
+            break;
+        case OPT_SPILL_DIR:
+            spill_dir = optarg;
+            break;
+        case OPT_SCHEDULE:
+            if(strcmp(optarg, "shared") == 0){
+                SCHEDULE = SCHEDULE_SHARED;
+            }
+            else if(strcmp(optarg, "steal") == 0){
+                SCHEDULE = SCHEDULE_STEAL;
+            }
+            else{
+                fprintf(stderr, "Unknown schedule: %s\n", optarg);
+                bad = 1;
+            }
+            break;
+        case OPT_CHECKPOINT:
+            CHECKPOINT_PATH = optarg;
+            break;
+        case OPT_CHECKPOINT_INTERVAL:
+            bad = parse_int_opt("--checkpoint-interval", optarg, 1, 86400000, &CHECKPOINT_MS);
+            break;
+        case OPT_RESUME:
+            RESUMING = 1;
+            break;
+        case OPT_RATE:
+            bad = parse_int_opt("--rate", optarg, 1, 100000000, &rate);
+            break;
+        case OPT_BURST:
+            bad = parse_int_opt("--burst", optarg, 1, 1 << 20, &burst);
+            break;
+        case OPT_BACKOFF_MS:
+            bad = parse_int_opt("--backoff-ms", optarg, 0, 600000, &backoff_ms);
+            break;
+        case OPT_DAEMON:
+            DAEMON_PATH = optarg;
+            break;
+        case OPT_FORMAT:
+            if(strcmp(optarg, "text") == 0){
+                BINARY_OUT = 0;
+            }
+            else if(strcmp(optarg, "binary") == 0){
+                BINARY_OUT = 1;
+            }
+            else{
+                fprintf(stderr, "Unknown output format: %s\n", optarg);
+                bad = 1;
+            }
+            break;
+        case OPT_DEDUP:
+            dedup = 1;
+            break;
+        case OPT_PIN_PRODUCERS:
+        case OPT_PIN_RESOLVERS:
+        case OPT_PIN_WRITER:
+            pin_lists[opt - OPT_PIN_PRODUCERS] = optarg;
+            break;
+        case OPT_NUMA:
+            NUMA = 1;
+            break;
+        case OPT_URGENT:
+            urgent_files[nurgent++] = optarg;
+            PRIORITY = 1;
+            break;
+        case OPT_STARVE_LIMIT:
+            bad = parse_int_opt("--starve-limit", optarg, 1, 1 << 30, &STARVE_LIMIT);
+            break;
+        case OPT_PROCS:
+            bad = parse_int_opt("--procs", optarg, 1, 256, &PROCS);
+            break;
+        case OPT_RING_KB:
+            bad = parse_int_opt("--ring-kb", optarg, MIN_RING_KB, 1 << 20, &RING_KB);
+            break;
+        case OPT_RESOLVER:
+            resolver_spec = strcmp(optarg, "getaddrinfo") == 0 ? NULL : optarg;
+            break;
+        default:
+            bad = 1;
+        }
+        if(bad){
+            usage(prog);
+            return EXIT_FAILURE;
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if(DAEMON_PATH){
+        if(argc > 1 || USE_ASYNC || CHECKPOINT_PATH || stats_json || BINARY_OUT || PRIORITY){
+            fprintf(stderr, "--daemon takes no files, --engine async, --checkpoint, --stats-json, --format binary or --urgent\n");
+            return EXIT_FAILURE;
+        }
+    }
+    else if(argc < MINARGS){
+        fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
+        usage(prog);
+        return EXIT_FAILURE;
+    }
+    // workers run fixed getaddrinfo pools; their lookups come back
+    // through the rings, not a socket
+    if(PROCS && (USE_ASYNC || MAX_THREADS > 0 || DAEMON_PATH)){
+        fprintf(stderr, "--procs does not go with --engine async, --max-threads or --daemon\n");
+        return EXIT_FAILURE;
+    }
+    // every worker must get at least 1 of each limit it is split by
+    if(PROCS && ((rate && (rate < PROCS || burst < PROCS))
+                 || (max_inflight && max_inflight < PROCS))){
+        fprintf(stderr, "--rate, --burst and --max-inflight must be at least --procs %d\n", PROCS);
+        return EXIT_FAILURE;
+    }
+
+    // every list must name CPUs this process may use
+    if(NUMA || PRINT_STATS || pin_lists[0] || pin_lists[1] || pin_lists[2]){
+        if(affinity_load(&TOPOLOGY) == AFFINITY_FAILURE){
+            return EXIT_FAILURE;
+        }
+    }
+    int role;
+    for(role = 0; role < 3; role++){
+        char allowed[256];
+        if(!pin_lists[role]){
+            continue;
+        }
+        if(affinity_parse(pin_lists[role], &PIN_SETS[role]) == AFFINITY_FAILURE){
+            fprintf(stderr, "Bad CPU list: %s\n", pin_lists[role]);
+            return EXIT_FAILURE;
+        }
+        if(!affinity_subset(&PIN_SETS[role], &TOPOLOGY.all)){
+            affinity_format(&TOPOLOGY.all, allowed, sizeof(allowed));
+            fprintf(stderr, "CPUs %s are not all available (allowed: %s)\n", pin_lists[role], allowed);
+            return EXIT_FAILURE;
+        }
+        *pin_roles[role] = &PIN_SETS[role];
+    }
+    // --numa: each node's resolvers share the producers' pushes
+    if(NUMA){
+        SCHEDULE = SCHEDULE_STEAL;
+    }
+
+    // spilled names would lose their class; deques have none
+    if(PRIORITY && (SCHEDULE == SCHEDULE_STEAL || BACKPRESSURE == BACKPRESSURE_SPILL)){
+        fprintf(stderr, "--urgent needs --schedule shared and --backpressure block or spin\n");
+        return EXIT_FAILURE;
+    }
+    int u, f;
+    for(u = 0; u < nurgent; u++){
+        for(f = 1; f < argc - 1 && strcmp(urgent_files[u], argv[f]) != 0; f++);
+        if(f == argc - 1){
+            fprintf(stderr, "--urgent %s is not an input file\n", urgent_files[u]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(dedup && !BINARY_OUT){
+        fprintf(stderr, "--dedup needs --format binary\n");
+        return EXIT_FAILURE;
+    }
+    // the table at the end of a binary file cannot be cut back
+    if(BINARY_OUT && CHECKPOINT_PATH){
+        fprintf(stderr, "--checkpoint needs --format text\n");
+        return EXIT_FAILURE;
+    }
+
+    if(RESUMING){
+        if(!CHECKPOINT_PATH){
+            fprintf(stderr, "--resume needs --checkpoint PATH\n");
+            return EXIT_FAILURE;
+        }
+        if(checkpoint_load(&RESUME_FROM, CHECKPOINT_PATH) == CHECKPOINT_FAILURE){
+            if(errno != ENOENT){
+                fprintf(stderr, "Error reading checkpoint %s: %s\n", CHECKPOINT_PATH, strerror(errno));
+                return EXIT_FAILURE;
+            }
+            printf("No checkpoint at %s, starting from the beginning\n", CHECKPOINT_PATH);
+            RESUMING = 0;
+        }
+    }
+
+    if(resolver_spec){
+        if(USE_ASYNC){
+            fprintf(stderr, "--resolver does not apply to --engine async\n");
+            return EXIT_FAILURE;
+        }
+        // made-up answers must not outlive the run in a shared file;
+        // this also keeps them out of every --procs worker's copy
+        if(cache_file){
+            fprintf(stderr, "--cache does not go with --resolver fake\n");
+            return EXIT_FAILURE;
+        }
+        if(fakeresolver_init(&FAKE, resolver_spec) == FAKERESOLVER_FAILURE){
+            return EXIT_FAILURE;
+        }
+        dnsresolver_set(&FAKE.resolver);
+        USE_FAKE = 1;
+    }
+
+    PRODUCERS_FINISHED = 0;
+    NUM_INPUT_FILES = DAEMON_PATH ? 0 : argc - 2;
+    // one producer per file unless -p says otherwise
+    if(NUM_PRODUCERS == 0){
+        NUM_PRODUCERS = NUM_INPUT_FILES > 0 ? NUM_INPUT_FILES : 1;
+    }
+    input_file input_files[NUM_INPUT_FILES > 0 ? NUM_INPUT_FILES : 1];
+    if(MAX_THREADS > 0){
+        if(MIN_THREADS > MAX_THREADS){
+            fprintf(stderr, "--min-threads %d is above --max-threads %d\n", MIN_THREADS, MAX_THREADS);
+            return EXIT_FAILURE;
+        }
+        THREAD_MAX = THREAD_MAX < MIN_THREADS ? MIN_THREADS
+                   : THREAD_MAX > MAX_THREADS ? MAX_THREADS : THREAD_MAX;
+        printf("Resolving threads adaptively, %d to %d, starting at %d\n",
+               MIN_THREADS, MAX_THREADS, THREAD_MAX);
+    }
+    else if(PROCS){
+        // one resolver per worker forwards its names
+        WORKER_THREADS = THREAD_MAX;
+        THREAD_MAX = PROCS;
+        printf("Resolving in %d worker processes, %d threads each\n", PROCS, WORKER_THREADS);
+    }
+    else{
+        printf("Resolving threads dynamically, set to %d\n",THREAD_MAX);
+    }
+    atomic_init(&POOL_TARGET, THREAD_MAX);
+    RESOLVER_SLOTS = MAX_THREADS > 0 ? MAX_THREADS : THREAD_MAX;
+    PRODUCER_STATS = calloc(NUM_PRODUCERS, sizeof(*PRODUCER_STATS));
+    RESOLVER_STATS = calloc(RESOLVER_SLOTS, sizeof(*RESOLVER_STATS));
+    if(!PRODUCER_STATS || !RESOLVER_STATS){
+        perror("Error allocating thread stats");
+        return EXIT_FAILURE;
+    }
+
+    if(stats_json){
+        STATS_OUT = strcmp(stats_json, "-") == 0 ? stderr : fopen(stats_json, "a");
+        if(!STATS_OUT){
+            fprintf(stderr, "Error opening stats file %s: %s\n", stats_json, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        histo_init(&H_PARSE);
+        histo_init(&H_QUEUE_WAIT);
+        histo_init(&H_LOOKUP);
+        histo_init(&H_FORMAT);
+        histo_init(&H_WRITE);
+        histo_init(&H_QUEUE_DEPTH);
+        pthread_mutex_init(&stats_lock, NULL);
+        // before any thread starts, so every thread inherits the mask
+        sigemptyset(&stats_signals);
+        sigaddset(&stats_signals, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &stats_signals, NULL);
+    }
+
+    if(USE_CACHE && dnscache_init(&CACHE, cache_shards, cache_ttl, cache_neg_ttl) == DNSCACHE_FAILURE){
+        return EXIT_FAILURE;
+    }
+
+    if(cache_file){
+        if(diskcache_open(&DISK_CACHE, cache_file, cache_slots, cache_ttl, cache_neg_ttl) == DISKCACHE_FAILURE){
+            fprintf(stderr, "Error opening cache file %s\n", cache_file);
+            return EXIT_FAILURE;
+        }
+        USE_DISK_CACHE = 1;
+    }
+
+    if(USE_ASYNC && (dnsasync_init(&ENGINE, nameservers, event_loops, max_inflight,
+                                   dns_timeout, dns_retries) == DNSASYNC_FAILURE
+                     || (rate && dnsasync_set_rate(&ENGINE, rate, burst) == DNSASYNC_FAILURE))){
+        return EXIT_FAILURE;
+    }
+    // getaddrinfo picks its own nameserver, so one bucket covers it
+    if(!USE_ASYNC){
+        if(throttle_init(&LIMIT, rate, burst, max_inflight, dns_retries,
+                         backoff_ms) == THROTTLE_FAILURE){
+            fprintf(stderr, "Error setting up the lookup throttle\n");
+            return EXIT_FAILURE;
+        }
+        dnslookup_set_throttle(&LIMIT);
+    }
+
+    if(PROCS){
+        worker_setup setup = {cache_file, cache_slots, cache_ttl, cache_neg_ttl,
+                              rate, burst, max_inflight, dns_retries, backoff_ms};
+        if(start_workers(&setup) < 0){
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(DAEMON_PATH){
+        int status = run_daemon();
+        finish_lookups();
+        return status;
+    }
 
     fflush(stdout);
 
-    queue_init(&q, 16);
+    // Single output stream, written only by the writer thread
+    OUT_FD = open(argv[argc-1], O_WRONLY | O_CREAT | (RESUMING ? 0 : O_TRUNC), 0644);
+    if(OUT_FD < 0){
+        perror("Error opening output file");
+        return EXIT_FAILURE;
+    }
+    // --resume: drop whatever the last run wrote after its checkpoint
+    if(RESUMING){
+        off_t size = lseek(OUT_FD, 0, SEEK_END);
+        if(size < RESUME_FROM.output_bytes){
+            fprintf(stderr, "Output file %s is shorter than checkpoint %s says\n",
+                    argv[argc-1], CHECKPOINT_PATH);
+            return EXIT_FAILURE;
+        }
+        if(ftruncate(OUT_FD, RESUME_FROM.output_bytes) < 0
+           || lseek(OUT_FD, 0, SEEK_END) != RESUME_FROM.output_bytes){
+            perror("Error cutting back output file");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Auto: every resolver can hold a batch while a few more wait, so
+    // slow lookups never starve a resolver and fast ones rarely block
+    // a producer. The async engine drains the queue max_inflight deep.
+    auto_queue = QUEUE_SIZE == 0;
+    if(auto_queue){
+        long slots = (long) QUEUE_BATCHES_PER_RESOLVER * RESOLVER_SLOTS * BATCH_SIZE;
+        if(USE_ASYNC && slots < ENGINE.max_inflight){
+            slots = ENGINE.max_inflight;
+        }
+        QUEUE_SIZE = slots < MIN_AUTO_QUEUE_SIZE ? MIN_AUTO_QUEUE_SIZE
+                   : slots > MAX_AUTO_QUEUE_SIZE ? MAX_AUTO_QUEUE_SIZE : (int) slots;
+    }
+    if(BACKPRESSURE == BACKPRESSURE_SPILL
+       && spill_init(&SPILL, spill_dir, sizeof(host_item)) == SPILL_FAILURE){
+        return EXIT_FAILURE;
+    }
+    int queue_slots = PRIORITY ? queue_prio_init(&PRIO, PRIORITY_CLASSES, QUEUE_SIZE, STARVE_LIMIT)
+                               : queue_init(&q, QUEUE_SIZE);
+    if(queue_slots == QUEUE_FAILURE){
+        fprintf(stderr, "Error allocating a %d slot queue\n", QUEUE_SIZE);
+        return EXIT_FAILURE;
+    }
+    // the lock-free ring may round a tiny size up
+    QUEUE_SIZE = queue_slots;
+    // steal: the same slots split between the resolvers' deques
+    if(SCHEDULE == SCHEDULE_STEAL){
+        if(workq_init(&WORKQ, RESOLVER_SLOTS,
+                      (QUEUE_SIZE + RESOLVER_SLOTS - 1) / RESOLVER_SLOTS) == WORKQ_FAILURE){
+            return EXIT_FAILURE;
+        }
+        workq_set_active(&WORKQ, THREAD_MAX);
+        if(NUMA){
+            workq_set_groups(&WORKQ, TOPOLOGY.nnodes);
+        }
+    }
     pthread_cond_init(&empty, NULL);
     pthread_cond_init(&full, NULL);
     pthread_mutex_init(&queue_lock, NULL);
     pthread_mutex_init(&inc_lock, NULL);
-    pthread_mutex_init(&out_lock, NULL);
-
-    if(argc < MINARGS){
-        fprintf(stderr, "Not enough arguments: %d\n", (argc - 1));
-        fprintf(stderr, "Using:\n %s %s\n", argv[0], USAGE);
-        return EXIT_FAILURE;
-    }
+    pthread_mutex_init(&pool_lock, NULL);
+    pthread_cond_init(&pool_cond, NULL);
 
     // input array
     int i;
     for (i=0 ; i < NUM_INPUT_FILES ; i++){
-        input_files[i] = argv[i+1];
+        memset(&input_files[i], 0, sizeof(input_files[i]));
+        input_files[i].name = argv[i+1];
+        input_files[i].priority = PRIORITY_BULK;
+    }
+    for (u=0 ; u < nurgent ; u++){
+        for (i=0 ; i < NUM_INPUT_FILES ; i++){
+            if(strcmp(urgent_files[u], input_files[i].name) == 0){
+                input_files[i].priority = PRIORITY_URGENT;
+            }
+        }
+    }
+    if(PRIORITY){
+        for (i=0 ; i < PRIORITY_CLASSES ; i++){
+            histo_init(&H_CLASS_WAIT[i]);
+            histo_init(&H_CLASS_DONE[i]);
+        }
+    }
+    INPUT_FILES = input_files;
+    if(split_inputs(input_files) < 0){
+        return EXIT_FAILURE;
+    }
+    if(RESUMING){
+        long long input_bytes = 0;
+        for (i=0 ; i < NUM_INPUT_FILES ; i++){
+            input_bytes += RESUME_FROM.files[i].size;
+        }
+        printf("Resuming from %s: %lld of %lld input bytes done\n", CHECKPOINT_PATH,
+               checkpoint_done_bytes(&RESUME_FROM), input_bytes);
+        fflush(stdout);
+    }
+    if(BINARY_OUT && (resultfile_init(&RESULTS, dedup ? RESULTFILE_DEDUP : 0) == RESULTFILE_FAILURE
+                      || resultfile_begin(&RESULTS, OUT_FD) == RESULTFILE_FAILURE)){
+        perror("Error starting the result file");
+        return EXIT_FAILURE;
+    }
+    if(outwriter_init(&WRITER, OUT_FD, ORDERED, NUM_RANGES,
+                      STATS_OUT ? &H_WRITE : NULL) == OUTWRITER_FAILURE){
+        return EXIT_FAILURE;
+    }
+    // --numa puts the writer with the first node's pipeline
+    if((WRITER_CPUS || NUMA)
+       && affinity_pin(WRITER.thread, WRITER_CPUS ? WRITER_CPUS : &TOPOLOGY.nodes[0]) == AFFINITY_FAILURE){
+        fprintf(stderr, "Error pinning the writer thread to CPUs\n");
+    }
+    if(PROCS && start_collectors() < 0){
+        return EXIT_FAILURE;
+    }
+    pthread_t checkpoint_id;
+    if(CHECKPOINT_PATH){
+        pthread_mutex_init(&checkpoint_lock, NULL);
+        pthread_cond_init(&checkpoint_cond, NULL);
+        if(outwriter_track(&WRITER) == OUTWRITER_FAILURE
+           || pthread_create(&checkpoint_id, NULL, checkpoint_thread, NULL)){
+            fprintf(stderr, "Error starting checkpoints\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if(arena_init(&HOSTS, sizeof(host_slab)) == ARENA_FAILURE
+       || arena_init(&LOOKUPS, sizeof(async_lookup)) == ARENA_FAILURE){
+        fprintf(stderr, "Error creating hostname arenas\n");
+        return EXIT_FAILURE;
+    }
+    if(STATS_OUT && pthread_create(&stats_id, NULL, stats_thread, &stats_signals)){
+        fprintf(stderr, "Error creating stats thread\n");
+        return EXIT_FAILURE;
     }
 
 
     pthread_t producer_id, consumer_id;
 
-    int producer = pthread_create(&producer_id, NULL, (void*) producer_pool, input_files);
+    int producer = pthread_create(&producer_id, NULL, (void*) producer_pool, NULL);
     int consumer = pthread_create(&consumer_id, NULL, (void*) consumer_pool, NULL);
 
-    if(producer || consumer) printf("error\n");
-    pthread_join(consumer_id, NULL);
+    if(producer || consumer){
+        fprintf(stderr, "Error creating thread pools\n");
+        return EXIT_FAILURE;
+    }
     pthread_join(producer_id, NULL);
+    pthread_join(consumer_id, NULL);
 
-    queue_cleanup(&q);
-    pthread_mutex_destroy(&out_lock);
+    // --procs: every name is sent; wait for the last answers
+    int workers_failed = PROCS && finish_workers() < 0;
+
+    // Resolvers are done submitting; wait for the last answers
+    if(USE_ASYNC){
+        dnsasync_cleanup(&ENGINE);
+        if(PRINT_STATS){
+            fprintf(stderr, "async: sent=%ld resent=%ld answered=%ld failed=%ld timeouts=%ld mismatched=%ld\n",
+                    atomic_load(&ENGINE.sent), atomic_load(&ENGINE.resent),
+                    atomic_load(&ENGINE.answered), atomic_load(&ENGINE.failed),
+                    atomic_load(&ENGINE.timeouts_hit), atomic_load(&ENGINE.mismatched));
+        }
+    }
+
+    if(CHECKPOINT_PATH){
+        pthread_mutex_lock(&checkpoint_lock);
+        CHECKPOINT_STOP = 1;
+        pthread_cond_signal(&checkpoint_cond);
+        pthread_mutex_unlock(&checkpoint_lock);
+        pthread_join(checkpoint_id, NULL);
+    }
+
+    // Every line has been queued; flush what the writer still holds
+    if(outwriter_finish(&WRITER) == OUTWRITER_FAILURE){
+        fprintf(stderr, "Error writing output file %s\n", argv[argc-1]);
+    }
+    // then the hostname table and index after the records
+    else if(BINARY_OUT && resultfile_finish(&RESULTS, OUT_FD) == RESULTFILE_FAILURE){
+        fprintf(stderr, "Error writing output file %s\n", argv[argc-1]);
+    }
+    // the last checkpoint: everything, unless a write failed
+    if(CHECKPOINT_PATH){
+        checkpoint_write();
+        outwriter_untrack(&WRITER);
+        pthread_mutex_destroy(&checkpoint_lock);
+        pthread_cond_destroy(&checkpoint_cond);
+    }
+    if(PRINT_STATS){
+        fprintf(stderr, "queue: size=%d%s backpressure=%s",
+                QUEUE_SIZE, auto_queue ? " (auto)" : "", BACKPRESSURE_NAMES[BACKPRESSURE]);
+        if(BACKPRESSURE == BACKPRESSURE_SPILL){
+            fprintf(stderr, " spilled=%ld peak=%ld file_bytes=%lld",
+                    atomic_load(&SPILL.puts), atomic_load(&SPILL.peak),
+                    atomic_load(&SPILL.file_bytes));
+        }
+        fputc('\n', stderr);
+        if(SCHEDULE == SCHEDULE_STEAL){
+            fprintf(stderr, "schedule: steal deques=%d capacity=%d steals=%ld stolen=%ld\n",
+                    WORKQ.workers, WORKQ.capacity, atomic_load(&WORKQ.steals),
+                    atomic_load(&WORKQ.stolen));
+        }
+        fprintf(stderr, "writer: lines=%ld writev=%ld bytes=%lld max_held=%zu\n",
+                atomic_load(&WRITER.lines), atomic_load(&WRITER.writes),
+                atomic_load(&WRITER.bytes), atomic_load(&WRITER.max_held));
+        print_affinity_stats();
+        if(PROCS){
+            print_worker_stats();
+        }
+        if(PRIORITY){
+            print_priority_stats();
+        }
+        if(BINARY_OUT){
+            fprintf(stderr, "format: binary%s hosts=%u results=%ld failed=%ld\n",
+                    dedup ? " dedup" : "", resultfile_hosts(&RESULTS),
+                    atomic_load(&RESULTS.records), atomic_load(&RESULTS.failed));
+        }
+        if(CHECKPOINT_PATH){
+            fprintf(stderr, "checkpoint: saved=%ld resumed_bytes=%lld\n",
+                    CHECKPOINTS_SAVED, RESUME_FROM.output_bytes);
+        }
+        print_arena_stats("hosts", &HOSTS);
+        if(USE_ASYNC){
+            print_arena_stats("lookups", &LOOKUPS);
+        }
+    }
+    if(STATS_OUT){
+        // wake the stats thread so it sees STATS_STOP, then the final dump
+        atomic_store(&STATS_STOP, 1);
+        pthread_kill(stats_id, SIGUSR1);
+        pthread_join(stats_id, NULL);
+        stats_dump("exit");
+        if(STATS_OUT != stderr){
+            fclose(STATS_OUT);
+        }
+        pthread_mutex_destroy(&stats_lock);
+    }
+    free(PRODUCER_STATS);
+    free(RESOLVER_STATS);
+    if(BACKPRESSURE == BACKPRESSURE_SPILL){
+        spill_cleanup(&SPILL);
+    }
+    if(SCHEDULE == SCHEDULE_STEAL){
+        workq_cleanup(&WORKQ);
+    }
+    arena_cleanup(&HOSTS);
+    arena_cleanup(&LOOKUPS);
+    if(PROCS){
+        cleanup_workers();
+    }
+    if(BINARY_OUT){
+        resultfile_free(&RESULTS);
+    }
+
+    // Queued names pointed into the inputs; nothing uses them now
+    for (i=0 ; i < NUM_INPUT_FILES ; i++){
+        hostreader_close(&input_files[i].reader);
+    }
+    free(RANGES);
+    checkpoint_cleanup(&RESUME_FROM);
+
+    finish_lookups();
+
+    close(OUT_FD);
+    if(PRIORITY){
+        queue_prio_cleanup(&PRIO);
+    }
+    else{
+        queue_cleanup(&q);
+    }
+    pthread_cond_destroy(&full);
+    pthread_cond_destroy(&empty);
     pthread_mutex_destroy(&queue_lock);
     pthread_mutex_destroy(&inc_lock);
+    pthread_mutex_destroy(&pool_lock);
+    pthread_cond_destroy(&pool_cond);
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return workers_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
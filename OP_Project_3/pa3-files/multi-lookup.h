@@ -11,22 +11,268 @@
 #include <stdio.h>
 #include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <getopt.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
 #include "util.h"
 #include "queue.h"
+#include "dnscache.h"
+#include "diskcache.h"
+#include "dnsasync.h"
+#include "hostreader.h"
+#include "outwriter.h"
+#include "arena.h"
+#include "adapt.h"
+#include "histo.h"
+#include "fakeresolver.h"
+#include "spill.h"
+#include "workq.h"
+#include "checkpoint.h"
+#include "throttle.h"
+#include "lookupd.h"
+#include "resultfile.h"
+#include "affinity.h"
+#include "shmring.h"
 
 #define MINARGS 3
-#define USAGE "<inputFilePath> <outputFilePath>"
+#define USAGE "[options] <inputFilePath> ... <outputFilePath>"
+#define DAEMON_USAGE "[options] --daemon <socketPath>"
+#define OPTIONS_HELP \
+    "Options:\n" \
+    " -t, --threads N        resolver threads (default: online CPUs); with\n" \
+    "                        --max-threads, the starting count\n" \
+    " -b, --batch N          hostnames moved per queue operation (default 1)\n" \
+    " -p, --producers N      producer threads; big files are split between\n" \
+    "                        them at whitespace (default: one per file)\n" \
+    " -q, --queue-size N     hostname queue slots, or auto (default): four\n" \
+    "                        batches per resolver, 16 to 65536, and at\n" \
+    "                        least --max-inflight with --engine async\n" \
+    "     --backpressure P   when the queue is full: block (default), spin\n" \
+    "                        (retry a while before blocking) or spill (write\n" \
+    "                        the overflow to a temporary file, never block)\n" \
+    "     --spill-dir DIR    where spill writes it (default $TMPDIR or /tmp)\n" \
+    "     --schedule S       shared (default): one queue for every resolver,\n" \
+    "                        or steal: a queue per resolver, filled in turn,\n" \
+    "                        idle resolvers taking from the busiest\n" \
+    "     --urgent FILE      resolve the names of input FILE ahead of the\n" \
+    "                        other files (may be given more than once); each\n" \
+    "                        class gets its own -q slots. Not with --schedule\n" \
+    "                        steal or --backpressure spill\n" \
+    "     --starve-limit N   names of urgent files let ahead of waiting\n" \
+    "                        names of the others before they get a batch\n" \
+    "                        (default 256)\n" \
+    "     --checkpoint PATH  save which input bytes are in the output file\n" \
+    "                        to PATH as the run goes, and at the end\n" \
+    "     --checkpoint-interval MS  how often (default 10000)\n" \
+    "     --resume           continue the run --checkpoint PATH saved: skip\n" \
+    "                        the input done and append to the output cut\n" \
+    "                        back to the checkpoint (a fresh start if there\n" \
+    "                        is no checkpoint yet)\n" \
+    " -s, --stats            print resolver and cache stats to stderr\n" \
+    " -a, --all              write every IPv4 and IPv6 address, not just the first\n" \
+    "     --ordered          write lines in input order (default: as resolved)\n" \
+    "     --format F         text (default) or binary: a table of unique\n" \
+    "                        hostnames and packed addresses, read back with\n" \
+    "                        lookup-text\n" \
+    "     --dedup            binary: one record per unique hostname, in\n" \
+    "                        input order, with how often it came up\n" \
+    "     --cache-ttl SECS   keep resolved names this long (default 300)\n" \
+    "     --cache-neg-ttl SECS  keep failed lookups this long (default 30)\n" \
+    "     --cache-shards N   cache lock shards (default 64)\n" \
+    "     --no-cache         resolve every name with getaddrinfo\n" \
+    "     --cache PATH       also keep results in a file shared across runs\n" \
+    "     --cache-slots N    entries in a new cache file (default 65536)\n" \
+    "     --no-coalesce      do not share concurrent lookups of one name\n" \
+    "     --engine NAME      getaddrinfo (default) or async: raw UDP queries\n" \
+    "                        from event loop threads, A records only\n" \
+    "     --resolver SPEC    getaddrinfo (default) or a fake backend,\n" \
+    "                        fake[:latency=exp:US,fail=RATE,again=RATE,...]\n" \
+    "                        (see fakeresolver.h); not with --engine async\n" \
+    "                        or --cache\n" \
+    "     --nameserver LIST  async servers, host[:port],... (default resolv.conf)\n" \
+    "     --dns-timeout MS   async per try timeout (default 2000)\n" \
+    "     --dns-retries N    retries after the first try: of async timeouts,\n" \
+    "                        or of EAI_AGAIN and other transient failures\n" \
+    "                        (default 2)\n" \
+    "     --backoff-ms MS    wait up to MS before the first getaddrinfo\n" \
+    "                        retry, twice that before the next, and so on\n" \
+    "                        (default 100)\n" \
+    "     --rate QPS         lookups a second (with --engine async, to each\n" \
+    "                        --nameserver) (default no limit)\n" \
+    "     --burst N          lookups --rate lets through at once (default 10)\n" \
+    "     --max-inflight N   lookups outstanding at once: async queries\n" \
+    "                        (default 1024), or getaddrinfo calls (default\n" \
+    "                        no cap)\n" \
+    "     --event-loops N    async event loop threads (default 1)\n" \
+    "     --max-threads N    resize the resolver pool as it runs, up to N\n" \
+    "                        threads, logging every change to stderr\n" \
+    "     --min-threads N    smallest adaptive pool (default 1)\n" \
+    "     --adapt-ms MS      adaptive pool sampling interval (default 200)\n" \
+    "     --stats-json PATH  append stage latency histograms, queue depth and\n" \
+    "                        per thread counters as JSON lines on SIGUSR1 and\n" \
+    "                        at exit (- for stderr)\n" \
+    "     --stats-interval MS  queue depth sampling interval (default 100)\n" \
+    "     --pin-producers CPUS  run producer i on the i-th CPU of the list\n" \
+    "                        CPUS (like 0-3,8), round and round\n" \
+    "     --pin-resolvers CPUS  the same for resolvers\n" \
+    "     --pin-writer CPUS  run the output writer on CPUS\n" \
+    "     --numa             one pipeline per NUMA node: producers and\n" \
+    "                        resolvers spread over the nodes, each producer\n" \
+    "                        feeding its own node's resolvers (implies\n" \
+    "                        --schedule steal); --pin-* still win\n" \
+    "     --procs K          resolve in K worker processes of -t threads\n" \
+    "                        each, fed through shared memory rings; this\n" \
+    "                        process still reads, queues and writes.\n" \
+    "                        --rate, --burst and --max-inflight are split\n" \
+    "                        between them, so each must be at least K. Not\n" \
+    "                        with --engine async, --max-threads or --daemon\n" \
+    "     --ring-kb N        each worker's name and answer ring (default\n" \
+    "                        1024, at least 128)\n" \
+    "     --daemon PATH      instead of reading files, keep the resolvers and\n" \
+    "                        cache running and answer lookup-client and\n" \
+    "                        lookup-load on the Unix socket PATH until\n" \
+    "                        SIGINT or SIGTERM\n" \
+    " -h, --help             show this help\n"
 #define SBUFSIZE 1025
-#define INPUTFS "%1024s"
+#define MAX_BATCH_SIZE 4096
+#define MIN_AUTO_QUEUE_SIZE 16
+#define MAX_AUTO_QUEUE_SIZE 65536
+#define QUEUE_BATCHES_PER_RESOLVER 4
+#define MAX_QUEUE_SIZE (1 << 24)
+// --backpressure spin: queue-full retries before blocking
+#define BACKPRESSURE_SPINS 64
+#define CHECKPOINT_DEFAULT_INTERVAL_MS 10000
+// --procs: ring sizes, and the records a thread moves per write
+#define DEFAULT_RING_KB 1024
+#define MIN_RING_KB 128
+#define WORKER_BATCH_BYTES 65536
+#define HOST_SLAB_SHIFT 8
+#define HOST_SLAB_ITEMS (1 << HOST_SLAB_SHIFT)
 
-// Producer hostname push
-void* read_file(char* filename);
+// Per resolver thread counters. Only the owning thread writes them;
+// they are atomic so --stats-json can read them while it runs.
+typedef struct resolver_stats_s{
+    int id;                   // pool slot; parks while id >= POOL_TARGET
+    atomic_llong lookups;
+    atomic_llong lock_wait_ns; // blocked in pthread_mutex_lock(&queue_lock)
+    atomic_llong lock_hold_ns; // queue_lock held, condvar sleep excluded
+    atomic_llong idle_ns;     // asleep waiting for the queue to fill
+    atomic_llong stolen;      // names taken from other resolvers' deques
+    atomic_llong migrations;  // -s: batches begun on another CPU than the last
+    atomic_llong node_migrations; // ... on another NUMA node
+} resolver_stats;
+
+// Per producer thread counters, same rules
+typedef struct producer_stats_s{
+    atomic_llong names;
+    atomic_llong bytes;
+    atomic_llong ranges;
+    atomic_llong push_wait_ns; // in hostq_push, measured with --stats-json or --urgent
+    atomic_llong full_waits;  // pushes that found the queue full
+    atomic_llong blocked_ns;  // spinning or asleep on a full queue
+    atomic_llong spilled;     // names written to the spill file
+    atomic_llong migrations;  // -s: batches pushed from another CPU than the last
+    atomic_llong node_migrations; // ... from another NUMA node
+} producer_stats;
+
+enum backpressure { BACKPRESSURE_BLOCK, BACKPRESSURE_SPIN, BACKPRESSURE_SPILL };
+
+enum schedule { SCHEDULE_SHARED, SCHEDULE_STEAL };
+
+// --urgent: queue classes, most urgent first
+enum priority { PRIORITY_URGENT, PRIORITY_BULK, PRIORITY_CLASSES };
+
+// One input file and its mapped contents
+typedef struct input_file_s{
+    char* name;
+    hostreader reader;
+    int priority;               // PRIORITY_BULK unless --urgent
+} input_file;
+
+// A byte range of one input file, handed to one producer
+typedef struct input_range_s{
+    input_file* file;
+    size_t begin;
+    size_t end;
+    // --checkpoint: names counted so far, and where the last one ends
+    hostreader scan;
+    uint64_t scanned;
+    size_t scanned_end;
+} input_range;
+
+// A queued hostname: a slice of a mapped input and its place there
+typedef struct host_item_s{
+    const char* name;
+    uint64_t seq;               // OUTWRITER_SEQ(range, index)
+    long long queued_ns;        // when it was pushed (--stats-json, --urgent)
+} host_item;
+
+// Items are taken HOST_SLAB_ITEMS at a time from the HOSTS arena by
+// one producer; the slab goes back when the last line is written.
+// The queue carries handles, slab << HOST_SLAB_SHIFT | item.
+typedef struct host_slab_s{
+    atomic_int refs;
+    host_item items[HOST_SLAB_ITEMS];
+} host_slab;
+
+// --procs: a name sent to a worker process, then the name's bytes
+typedef struct name_record_s{
+    uint64_t seq;
+    int64_t queued_ns;
+    int32_t cls;
+    uint32_t len;
+} name_record;
+
+// Its answer, then the name's bytes and the address list's
+typedef struct answer_record_s{
+    uint64_t seq;
+    int64_t queued_ns;
+    int64_t lookup_ns;          // --stats-json, else 0
+    int32_t cls;
+    int32_t failed;
+    uint32_t name_len;
+    uint32_t ips_len;
+} answer_record;
+
+// --procs: one worker process, its rings, and what the parent saw
+typedef struct worker_proc_s{
+    pid_t pid;
+    shmring* names;             // resolver -> worker
+    shmring* answers;           // worker -> collector
+    pthread_t collector;
+    atomic_long sent;
+    atomic_long answered;
+    atomic_long lost;           // names its closed ring refused
+    int failed;                 // exited other than with status 0
+} worker_proc;
+
+// --procs: what main() hands a worker to set itself up with
+typedef struct worker_setup_s{
+    const char* cache_file;     // NULL: no --cache
+    int cache_slots;
+    int cache_ttl;
+    int cache_neg_ttl;
+    // the whole run's limits; each worker takes its share
+    int rate;
+    int burst;
+    int max_inflight;
+    int dns_retries;
+    int backoff_ms;
+} worker_setup;
+
+// Producer hostname push, arg is this thread's producer_stats
+void* read_ranges(void* arg);
 
 // Pool for producers, thread creation
-void* producer_pool(char* input_files);
+void* producer_pool();
 
-// resolve dns
-void* resolve_dns();
+// resolve dns, arg is this thread's resolver_stats
+void* resolve_dns(void* arg);
 
 // Pool for consumers, thread creation
 void* consumer_pool();
@@ -34,4 +280,4 @@ void* consumer_pool();
 // main
 int main(int argc, char* argv[]);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,611 @@
+/*
+ * File: outwriter.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the output stage. Lines are copied into
+ *      64 KiB per thread chunks; a full chunk is the only thing
+ *      that crosses threads, so the lock is taken once per chunk
+ *      rather than once per line.
+ *
+ *      Unordered, the writer sends each chunk as one iovec. In
+ *      ordered mode it keeps a min-heap of line positions and
+ *      sends the run of lines that continues the input order,
+ *      merging lines that sit next to each other in a chunk into
+ *      one iovec. A chunk is freed once all its lines are out.
+ *
+ *      Progress is recorded after each writev() returns: in
+ *      ordered mode as the position reached, unordered line by
+ *      line, each range keeping a min-heap of the lines written
+ *      past its first gap until the gap fills.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/uio.h>
+
+#include "outwriter.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* Each outwriter_init() gets a new generation, so a thread's
+ * chunk from an earlier writer is never reused */
+static atomic_ulong outwriter_generations;
+static __thread outwriter_thread* self;
+static __thread unsigned long self_generation;
+
+/* Hand a filled chunk to the writer thread */
+static void outwriter_hand_over(outwriter* w, outwriter_chunk* c){
+    c->next = NULL;
+    pthread_mutex_lock(&w->lock);
+    if(w->full_tail){
+	w->full_tail->next = c;
+    }
+    else{
+	w->full_head = c;
+    }
+    w->full_tail = c;
+    pthread_cond_signal(&w->ready);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/* This thread's chunk holder, registered on first use */
+static outwriter_thread* outwriter_self(outwriter* w){
+    if(self && self_generation == w->generation){
+	return self;
+    }
+    self = calloc(1, sizeof(*self));
+    if(!self){
+	return NULL;
+    }
+    self_generation = w->generation;
+    pthread_mutex_lock(&w->lock);
+    self->next = w->threads;
+    w->threads = self;
+    pthread_mutex_unlock(&w->lock);
+    return self;
+}
+
+static long long outwriter_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* writev() all of iov, resuming after partial writes */
+static void outwriter_writev(outwriter* w, struct iovec* iov, int count){
+    long long start = 0;
+    ssize_t n;
+
+    while(count > 0){
+	if(w->write_ns){
+	    start = outwriter_now_ns();
+	}
+	n = writev(w->fd, iov, count);
+	if(w->write_ns){
+	    histo_record(w->write_ns, outwriter_now_ns() - start);
+	}
+	if(n < 0){
+	    if(errno == EINTR){
+		continue;
+	    }
+	    perror("Error writing output file");
+	    w->error = 1;
+	    return;
+	}
+	atomic_fetch_add_explicit(&w->writes, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->bytes, n, memory_order_relaxed);
+	while(count > 0 && (size_t) n >= iov->iov_len){
+	    n -= iov->iov_len;
+	    iov++;
+	    count--;
+	}
+	if(count > 0){
+	    iov->iov_base = (char*) iov->iov_base + n;
+	    iov->iov_len -= n;
+	}
+    }
+}
+
+static void later_push(outwriter_progress* p, uint64_t index){
+    uint64_t* grown;
+    size_t i = p->nlater++;
+    size_t parent;
+
+    if(p->nlater > p->later_cap){
+	p->later_cap = p->later_cap ? p->later_cap * 2 : 64;
+	grown = realloc(p->later, p->later_cap * sizeof(*grown));
+	if(!grown){
+	    perror("Error growing output progress");
+	    exit(EXIT_FAILURE);
+	}
+	p->later = grown;
+    }
+    while(i > 0){
+	parent = (i - 1) / 2;
+	if(p->later[parent] <= index){
+	    break;
+	}
+	p->later[i] = p->later[parent];
+	i = parent;
+    }
+    p->later[i] = index;
+}
+
+static void later_pop(outwriter_progress* p){
+    uint64_t last = p->later[--p->nlater];
+    size_t i = 0;
+    size_t child;
+
+    while((child = 2 * i + 1) < p->nlater){
+	if(child + 1 < p->nlater && p->later[child + 1] < p->later[child]){
+	    child++;
+	}
+	if(last <= p->later[child]){
+	    break;
+	}
+	p->later[i] = p->later[child];
+	i = child;
+    }
+    if(p->nlater > 0){
+	p->later[i] = last;
+    }
+}
+
+/* Unordered: the lines of chunks up to (not including) stop are in
+ * the file */
+static void progress_chunks(outwriter* w, outwriter_chunk* list, outwriter_chunk* stop){
+    outwriter_progress* p;
+    uint64_t seq, index;
+    uint32_t range;
+    int i;
+
+    if(!w->progress || w->error){
+	return;
+    }
+    pthread_mutex_lock(&w->progress_lock);
+    for(; list != stop; list = list->next){
+	for(i = 0; i < list->nlines; i++){
+	    seq = list->lines[i].seq;
+	    range = seq >> OUTWRITER_RANGE_SHIFT;
+	    index = seq & ((1ULL << OUTWRITER_RANGE_SHIFT) - 1);
+	    if(range >= (uint32_t) w->nranges){
+		continue;
+	    }
+	    p = &w->progress[range];
+	    if(index != p->done){
+		later_push(p, index);
+		continue;
+	    }
+	    p->done++;
+	    while(p->nlater > 0 && p->later[0] <= p->done){
+		if(p->later[0] == p->done){
+		    p->done++;
+		}
+		later_pop(p);
+	    }
+	}
+    }
+    w->flushed = atomic_load(&w->bytes);
+    pthread_mutex_unlock(&w->progress_lock);
+}
+
+/* Ordered: every line before (range, index) is in the file */
+static void progress_upto(outwriter* w, uint32_t range, uint64_t index){
+    if(!w->progress || w->error){
+	return;
+    }
+    pthread_mutex_lock(&w->progress_lock);
+    /* the writer only steps past a range once its count is known */
+    for(; w->progress_range < range; w->progress_range++){
+	w->progress[w->progress_range].done = atomic_load(&w->range_counts[w->progress_range]);
+    }
+    if(range < (uint32_t) w->nranges){
+	w->progress[range].done = index;
+    }
+    w->flushed = atomic_load(&w->bytes);
+    pthread_mutex_unlock(&w->progress_lock);
+}
+
+/* Unordered: each chunk is one iovec */
+static void outwriter_write_chunks(outwriter* w, outwriter_chunk* list){
+    struct iovec iov[IOV_MAX];
+    outwriter_chunk* batch = list;
+    outwriter_chunk* next;
+    int n = 0;
+
+    while(list){
+	iov[n].iov_base = list->data;
+	iov[n].iov_len = list->used;
+	n++;
+	list = list->next;
+	if(n == IOV_MAX || !list){
+	    outwriter_writev(w, iov, n);
+	    progress_chunks(w, batch, list);
+	    for(; batch != list; batch = next){
+		next = batch->next;
+		free(batch);
+	    }
+	    n = 0;
+	}
+    }
+}
+
+static void held_push(outwriter* w, outwriter_held h){
+    outwriter_held* grown;
+    size_t i = w->nheld++;
+    size_t parent;
+
+    if(w->nheld > w->held_cap){
+	w->held_cap = w->held_cap ? w->held_cap * 2 : 1024;
+	grown = realloc(w->held, w->held_cap * sizeof(*grown));
+	if(!grown){
+	    perror("Error growing output reorder buffer");
+	    exit(EXIT_FAILURE);
+	}
+	w->held = grown;
+    }
+    while(i > 0){
+	parent = (i - 1) / 2;
+	if(w->held[parent].seq <= h.seq){
+	    break;
+	}
+	w->held[i] = w->held[parent];
+	i = parent;
+    }
+    w->held[i] = h;
+    if(w->nheld > atomic_load_explicit(&w->max_held, memory_order_relaxed)){
+	atomic_store_explicit(&w->max_held, w->nheld, memory_order_relaxed);
+    }
+}
+
+static outwriter_held held_pop(outwriter* w){
+    outwriter_held top = w->held[0];
+    outwriter_held last = w->held[--w->nheld];
+    size_t i = 0;
+    size_t child;
+
+    while((child = 2 * i + 1) < w->nheld){
+	if(child + 1 < w->nheld && w->held[child + 1].seq < w->held[child].seq){
+	    child++;
+	}
+	if(last.seq <= w->held[child].seq){
+	    break;
+	}
+	w->held[i] = w->held[child];
+	i = child;
+    }
+    if(w->nheld > 0){
+	w->held[i] = last;
+    }
+    return top;
+}
+
+/* Ordered: hold every line of the new chunks */
+static void outwriter_hold_chunks(outwriter* w, outwriter_chunk* list){
+    outwriter_chunk* next;
+    outwriter_held h;
+    int i;
+
+    for(; list; list = next){
+	next = list->next;
+	list->unwritten = list->nlines;
+	if(list->nlines == 0){
+	    free(list);
+	    continue;
+	}
+	for(i = 0; i < list->nlines; i++){
+	    h.seq = list->lines[i].seq;
+	    h.data = list->data + list->lines[i].offset;
+	    h.len = list->lines[i].len;
+	    h.chunk = list;
+	    held_push(w, h);
+	}
+    }
+}
+
+/* Ordered: write the held lines that continue the input order.
+ * With all set, write whatever is held even across gaps. */
+static void outwriter_write_held(outwriter* w, int all){
+    struct iovec iov[IOV_MAX];
+    outwriter_chunk* done = NULL;
+    outwriter_chunk* next;
+    outwriter_held h;
+    long long count;
+    uint32_t upto_range = w->next_range;
+    uint64_t upto_index = w->next_index;
+    int n = 0;
+
+    for(;;){
+	/* step over finished ranges */
+	while(w->next_range < (uint32_t) w->nranges){
+	    count = atomic_load(&w->range_counts[w->next_range]);
+	    if(count < 0 || w->next_index < (uint64_t) count){
+		break;
+	    }
+	    w->next_range++;
+	    w->next_index = 0;
+	}
+	if(w->nheld == 0){
+	    break;
+	}
+	if(w->held[0].seq > OUTWRITER_SEQ(w->next_range, w->next_index)){
+	    if(!all){
+		break;
+	    }
+	    w->error = 1;
+	}
+	h = held_pop(w);
+	if(h.seq >= OUTWRITER_SEQ(w->next_range, w->next_index)){
+	    /* next line, or with all set the next one there is */
+	    w->next_range = h.seq >> OUTWRITER_RANGE_SHIFT;
+	    w->next_index = (h.seq & ((1ULL << OUTWRITER_RANGE_SHIFT) - 1)) + 1;
+	    if(n > 0 && (const char*) iov[n-1].iov_base + iov[n-1].iov_len == h.data){
+		iov[n-1].iov_len += h.len;
+	    }
+	    else{
+		if(n == IOV_MAX){
+		    outwriter_writev(w, iov, n);
+		    progress_upto(w, upto_range, upto_index);
+		    n = 0;
+		}
+		iov[n].iov_base = (void*) h.data;
+		iov[n].iov_len = h.len;
+		n++;
+	    }
+	    upto_range = w->next_range;
+	    upto_index = w->next_index;
+	}
+	/* else a repeated sequence number: drop the line */
+	if(--h.chunk->unwritten == 0){
+	    h.chunk->next = done;
+	    done = h.chunk;
+	}
+    }
+    if(n > 0){
+	outwriter_writev(w, iov, n);
+    }
+    /* past the lines written, and any finished ranges after them */
+    if(w->next_range > upto_range){
+	upto_range = w->next_range;
+	upto_index = w->next_index;
+    }
+    progress_upto(w, upto_range, upto_index);
+    for(; done; done = next){
+	next = done->next;
+	free(done);
+    }
+}
+
+static void* outwriter_run(void* arg){
+    outwriter* w = arg;
+    outwriter_chunk* list;
+    unsigned long seen = 0;
+    int finishing;
+
+    for(;;){
+	pthread_mutex_lock(&w->lock);
+	while(!w->full_head && !w->finishing && w->range_events == seen){
+	    pthread_cond_wait(&w->ready, &w->lock);
+	}
+	list = w->full_head;
+	w->full_head = w->full_tail = NULL;
+	seen = w->range_events;
+	finishing = w->finishing;
+	pthread_mutex_unlock(&w->lock);
+
+	if(w->ordered){
+	    outwriter_hold_chunks(w, list);
+	    outwriter_write_held(w, 0);
+	}
+	else{
+	    outwriter_write_chunks(w, list);
+	}
+	/* finishing is only set once every chunk was handed over */
+	if(finishing){
+	    break;
+	}
+    }
+    return NULL;
+}
+
+int outwriter_init(outwriter* w, int fd, int ordered, int nranges, histo* write_ns){
+    int i;
+
+    memset(w, 0, sizeof(*w));
+    w->fd = fd;
+    w->ordered = ordered;
+    w->nranges = nranges;
+    w->write_ns = write_ns;
+    w->generation = atomic_fetch_add(&outwriter_generations, 1) + 1;
+    if(ordered){
+	w->range_counts = malloc((nranges > 0 ? nranges : 1) * sizeof(*w->range_counts));
+	if(!w->range_counts){
+	    perror("Error allocating output ranges");
+	    return OUTWRITER_FAILURE;
+	}
+	for(i = 0; i < nranges; i++){
+	    atomic_init(&w->range_counts[i], -1);
+	}
+    }
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->ready, NULL);
+    if(pthread_create(&w->thread, NULL, outwriter_run, w)){
+	fprintf(stderr, "Error creating writer thread\n");
+	return OUTWRITER_FAILURE;
+    }
+    return OUTWRITER_SUCCESS;
+}
+
+void outwriter_write(outwriter* w, uint64_t seq, const char* line, size_t len){
+    outwriter_thread* t = outwriter_self(w);
+    outwriter_chunk* c;
+
+    if(!t){
+	w->error = 1;
+	return;
+    }
+    if(len > OUTWRITER_CHUNK_SIZE){
+	len = OUTWRITER_CHUNK_SIZE;
+    }
+    c = t->chunk;
+    if(!c || c->used + len > OUTWRITER_CHUNK_SIZE
+       || c->nlines == OUTWRITER_CHUNK_LINES){
+	if(c){
+	    outwriter_hand_over(w, c);
+	}
+	/* only the header and line table need clearing */
+	c = t->chunk = malloc(sizeof(*c));
+	if(!c){
+	    w->error = 1;
+	    return;
+	}
+	c->used = 0;
+	c->nlines = 0;
+    }
+    c->lines[c->nlines].seq = seq;
+    c->lines[c->nlines].offset = c->used;
+    c->lines[c->nlines].len = len;
+    c->nlines++;
+    memcpy(c->data + c->used, line, len);
+    c->used += len;
+    atomic_fetch_add(&w->lines, 1);
+}
+
+void outwriter_range_done(outwriter* w, uint32_t range, uint64_t count){
+    if(range >= (uint32_t) w->nranges){
+	return;
+    }
+    if(w->progress){
+	pthread_mutex_lock(&w->progress_lock);
+	w->progress[range].count = (long long) count;
+	pthread_mutex_unlock(&w->progress_lock);
+    }
+    if(!w->ordered){
+	return;
+    }
+    atomic_store(&w->range_counts[range], (long long) count);
+    pthread_mutex_lock(&w->lock);
+    w->range_events++;
+    pthread_cond_signal(&w->ready);
+    pthread_mutex_unlock(&w->lock);
+}
+
+int outwriter_finish(outwriter* w){
+    outwriter_thread* t;
+    outwriter_thread* next;
+
+    /* hand over every thread's last partial chunk */
+    pthread_mutex_lock(&w->lock);
+    for(t = w->threads; t; t = next){
+	next = t->next;
+	if(t->chunk){
+	    t->chunk->next = NULL;
+	    if(w->full_tail){
+		w->full_tail->next = t->chunk;
+	    }
+	    else{
+		w->full_head = t->chunk;
+	    }
+	    w->full_tail = t->chunk;
+	}
+	free(t);
+    }
+    w->threads = NULL;
+    w->finishing = 1;
+    pthread_cond_signal(&w->ready);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+
+    if(w->ordered){
+	/* lines after a gap that never filled: write them anyway */
+	if(w->nheld > 0){
+	    outwriter_write_held(w, 1);
+	}
+	free(w->held);
+	free(w->range_counts);
+    }
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->ready);
+
+    return w->error ? OUTWRITER_FAILURE : OUTWRITER_SUCCESS;
+}
+
+int outwriter_track(outwriter* w){
+    int i;
+
+    w->progress = calloc(w->nranges > 0 ? w->nranges : 1, sizeof(*w->progress));
+    if(!w->progress){
+	perror("Error allocating output progress");
+	return OUTWRITER_FAILURE;
+    }
+    for(i = 0; i < w->nranges; i++){
+	w->progress[i].count = -1;
+    }
+    pthread_mutex_init(&w->progress_lock, NULL);
+    return OUTWRITER_SUCCESS;
+}
+
+static int later_cmp(const void* a, const void* b){
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+int outwriter_snapshot(outwriter* w, outwriter_progress* out, long long* bytes){
+    int i;
+
+    if(!w->progress){
+	return OUTWRITER_FAILURE;
+    }
+    pthread_mutex_lock(&w->progress_lock);
+    for(i = 0; i < w->nranges; i++){
+	out[i] = w->progress[i];
+	out[i].later = NULL;
+	out[i].later_cap = out[i].nlater;
+	if(out[i].nlater == 0){
+	    continue;
+	}
+	out[i].later = malloc(out[i].nlater * sizeof(*out[i].later));
+	if(!out[i].later){
+	    perror("Error copying output progress");
+	    pthread_mutex_unlock(&w->progress_lock);
+	    while(i-- > 0){
+		free(out[i].later);
+	    }
+	    return OUTWRITER_FAILURE;
+	}
+	memcpy(out[i].later, w->progress[i].later, out[i].nlater * sizeof(*out[i].later));
+    }
+    *bytes = w->flushed;
+    pthread_mutex_unlock(&w->progress_lock);
+    for(i = 0; i < w->nranges; i++){
+	if(out[i].nlater > 1){
+	    qsort(out[i].later, out[i].nlater, sizeof(*out[i].later), later_cmp);
+	}
+    }
+    return OUTWRITER_SUCCESS;
+}
+
+void outwriter_untrack(outwriter* w){
+    int i;
+
+    if(!w->progress){
+	return;
+    }
+    for(i = 0; i < w->nranges; i++){
+	free(w->progress[i].later);
+    }
+    free(w->progress);
+    w->progress = NULL;
+    pthread_mutex_destroy(&w->progress_lock);
+}
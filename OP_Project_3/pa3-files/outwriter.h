@@ -0,0 +1,164 @@
+/*
+ * File: outwriter.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for the output stage. Threads that
+ *      produce lines append them to a buffer of their own with
+ *      no lock; full buffers are handed to one writer thread,
+ *      which sends many of them to the output file per writev().
+ *
+ *      In ordered mode every line carries a sequence number
+ *      (OUTWRITER_SEQ(range, index)) and the writer holds lines
+ *      back until all earlier ones have been written, so the
+ *      file comes out in input order. Ranges are numbered from
+ *      0 and indexes from 0 within each range; the writer moves
+ *      to the next range once outwriter_range_done() has
+ *      reported how many lines the current one has.
+ *
+ *      Buffers are per thread (thread local), so a process has
+ *      at most one outwriter at a time.
+ *
+ *      With outwriter_track() the writer also keeps, per range,
+ *      which lines have reached the file, so a checkpoint can say
+ *      exactly what a restart may skip.
+ *
+ */
+
+#ifndef OUTWRITER_H
+#define OUTWRITER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "histo.h"
+
+#define OUTWRITER_FAILURE -1
+#define OUTWRITER_SUCCESS 0
+
+#define OUTWRITER_CHUNK_SIZE (64 * 1024)
+#define OUTWRITER_CHUNK_LINES 1024
+#define OUTWRITER_RANGE_SHIFT 40
+#define OUTWRITER_SEQ(range, index) \
+    (((uint64_t) (range) << OUTWRITER_RANGE_SHIFT) | (uint64_t) (index))
+
+/* Where one line sits in its chunk (ordered mode) */
+typedef struct outwriter_line_s{
+    uint64_t seq;
+    uint32_t offset;
+    uint32_t len;
+} outwriter_line;
+
+/* A buffer of lines filled by one thread */
+typedef struct outwriter_chunk_s{
+    struct outwriter_chunk_s* next;
+    size_t used;
+    int nlines;
+    int unwritten;                      /* ordered: lines still held */
+    outwriter_line lines[OUTWRITER_CHUNK_LINES];
+    char data[OUTWRITER_CHUNK_SIZE];
+} outwriter_chunk;
+
+/* One producing thread's current chunk */
+typedef struct outwriter_thread_s{
+    struct outwriter_thread_s* next;
+    outwriter_chunk* chunk;
+} outwriter_thread;
+
+/* A held line waiting for its turn (ordered mode) */
+typedef struct outwriter_held_s{
+    uint64_t seq;
+    const char* data;
+    uint32_t len;
+    outwriter_chunk* chunk;
+} outwriter_held;
+
+/* Lines of one range that are in the file (outwriter_track) */
+typedef struct outwriter_progress_s{
+    uint64_t done;                      /* lines 0 .. done-1 */
+    long long count;                    /* lines in the range, -1 until done */
+    uint64_t* later;                    /* written past a gap; a min-heap */
+    size_t nlater;
+    size_t later_cap;
+} outwriter_progress;
+
+typedef struct outwriter_s{
+    int fd;
+    int ordered;
+    unsigned long generation;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    outwriter_chunk* full_head;         /* handed over, oldest first */
+    outwriter_chunk* full_tail;
+    outwriter_thread* threads;          /* every thread with a chunk */
+    int finishing;
+    unsigned long range_events;         /* outwriter_range_done() calls */
+    int error;
+    /* ordered mode; writer thread only except range_counts */
+    int nranges;
+    atomic_llong* range_counts;         /* -1 until the range is done */
+    uint32_t next_range;
+    uint64_t next_index;
+    outwriter_held* held;               /* min-heap on seq */
+    size_t nheld;
+    size_t held_cap;
+    /* counters, readable while the writer runs */
+    atomic_long lines;
+    atomic_long writes;
+    atomic_llong bytes;
+    atomic_size_t max_held;
+    histo* write_ns;                    /* optional writev() latency */
+    /* outwriter_track() */
+    outwriter_progress* progress;       /* per range, under progress_lock */
+    pthread_mutex_t progress_lock;
+    uint32_t progress_range;            /* ordered: ranges before it are done */
+    long long flushed;                  /* file bytes progress accounts for */
+} outwriter;
+
+/* Function to start the writer thread on fd
+ * ordered selects input order; nranges is then the number of
+ * ranges sequence numbers will use. write_ns, if not NULL,
+ * records how long each writev() takes.
+ * Returns OUTWRITER_SUCCESS or OUTWRITER_FAILURE
+ */
+int outwriter_init(outwriter* w, int fd, int ordered, int nranges, histo* write_ns);
+
+/* Function to queue one line from the calling thread
+ * seq is ignored in unordered mode
+ */
+void outwriter_write(outwriter* w, uint64_t seq, const char* line, size_t len);
+
+/* Function to report that range has count lines in total
+ * (ordered mode; a no-op otherwise)
+ */
+void outwriter_range_done(outwriter* w, uint32_t range, uint64_t count);
+
+/* Function to start keeping track of which lines are in the file
+ * Call before the first outwriter_write().
+ * Returns OUTWRITER_SUCCESS or OUTWRITER_FAILURE
+ */
+int outwriter_track(outwriter* w);
+
+/* Function to copy the tracked progress of every range to out
+ * (nranges entries) and the file size it accounts for to *bytes.
+ * Each out[i].later is a sorted, malloc'd copy the caller frees.
+ * Also valid after outwriter_finish().
+ * Returns OUTWRITER_SUCCESS or OUTWRITER_FAILURE
+ */
+int outwriter_snapshot(outwriter* w, outwriter_progress* out, long long* bytes);
+
+/* Function to free what outwriter_track() set up */
+void outwriter_untrack(outwriter* w);
+
+/* Function to write everything still buffered and stop the writer
+ * Every thread that called outwriter_write() must be finished
+ * with it. Returns OUTWRITER_SUCCESS or OUTWRITER_FAILURE if a
+ * write failed or ordered lines were missing.
+ */
+int outwriter_finish(outwriter* w);
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * File: outwriterTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the output writer. Several
+ *      threads write the lines of a set of ranges (some empty) in
+ *      shuffled order. Unordered, every line must come out once;
+ *      ordered, the file must be exactly in range/index order. A
+ *      line that is never written must make ordered mode report
+ *      an error but still write everything else. Either way the
+ *      tracked progress must stop at the missing line, count
+ *      every later line in an unordered file, and account for
+ *      exactly the bytes in the file.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include "outwriter.h"
+
+#define TEST_PATH "outwriterTest.tmp"
+#define TEST_THREADS 4
+#define TEST_RANGES 8
+#define TEST_LINE_SIZE 64
+
+static const int range_sizes[TEST_RANGES] = {300, 0, 20000, 1, 0, 5000, 700, 0};
+
+typedef struct test_thread_s{
+    outwriter* w;
+    uint64_t* seqs;
+    int count;
+    unsigned int seed;
+} test_thread;
+
+static int test_line(uint64_t seq, char* line){
+    return snprintf(line, TEST_LINE_SIZE, "line %u %u\n",
+		    (unsigned) (seq >> OUTWRITER_RANGE_SHIFT),
+		    (unsigned) (seq & ((1ULL << OUTWRITER_RANGE_SHIFT) - 1)));
+}
+
+static void* writer_thread(void* arg){
+    test_thread* t = arg;
+    char line[TEST_LINE_SIZE];
+    uint64_t tmp;
+    int i, j, len;
+
+    /* shuffle, then write */
+    for(i = t->count - 1; i > 0; i--){
+	j = rand_r(&t->seed) % (i + 1);
+	tmp = t->seqs[i];
+	t->seqs[i] = t->seqs[j];
+	t->seqs[j] = tmp;
+    }
+    for(i = 0; i < t->count; i++){
+	len = test_line(t->seqs[i], line);
+	outwriter_write(t->w, t->seqs[i], line, len);
+    }
+    return NULL;
+}
+
+/* The progress after outwriter_finish() must match what run() wrote */
+static void check_progress(outwriter* w, int ordered, uint64_t skip){
+    outwriter_progress p[TEST_RANGES];
+    long long bytes;
+    uint32_t skip_range = skip >> OUTWRITER_RANGE_SHIFT;
+    uint64_t skip_index = skip & ((1ULL << OUTWRITER_RANGE_SHIFT) - 1);
+    uint64_t done, later;
+    off_t size = lseek(w->fd, 0, SEEK_END);
+    int r;
+
+    if(outwriter_snapshot(w, p, &bytes) != OUTWRITER_SUCCESS){
+	fprintf(stderr, "error: no progress snapshot\n");
+	return;
+    }
+    for(r = 0; r < TEST_RANGES; r++){
+	done = range_sizes[r];
+	later = 0;
+	if(skip != ~0ULL && (uint32_t) r == skip_range){
+	    done = skip_index;
+	    later = ordered ? 0 : range_sizes[r] - skip_index - 1;
+	}
+	/* ordered stops writing at the gap */
+	else if(skip != ~0ULL && ordered && (uint32_t) r > skip_range){
+	    done = 0;
+	}
+	if(p[r].done != done || p[r].nlater != later || p[r].count != range_sizes[r]){
+	    fprintf(stderr, "error: range %d progress %lu+%zu of %lld, expected %lu+%lu\n",
+		    r, (unsigned long) p[r].done, p[r].nlater, p[r].count,
+		    (unsigned long) done, (unsigned long) later);
+	}
+	if(later > 0 && (p[r].later[0] != skip_index + 1
+			 || p[r].later[later - 1] != (uint64_t) range_sizes[r] - 1)){
+	    fprintf(stderr, "error: range %d later lines out of order\n", r);
+	}
+	free(p[r].later);
+    }
+    /* ordered lines after a gap are written, but not tracked */
+    if(skip == ~0ULL || !ordered ? bytes != size : bytes >= size){
+	fprintf(stderr, "error: progress covers %lld of %lld bytes\n", bytes, (long long) size);
+    }
+}
+
+/* Write every line but skip (if not ~0), return outwriter_finish() */
+static int run(int ordered, uint64_t skip){
+    static uint64_t seqs[TEST_THREADS][30000];
+    test_thread threads[TEST_THREADS];
+    pthread_t ids[TEST_THREADS];
+    outwriter w;
+    uint64_t seq;
+    int fd, r, i, n = 0;
+    int ret;
+
+    fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || outwriter_init(&w, fd, ordered, TEST_RANGES, NULL) == OUTWRITER_FAILURE){
+	fprintf(stderr, "error: could not start the writer\n");
+	exit(EXIT_FAILURE);
+    }
+    if(outwriter_track(&w) != OUTWRITER_SUCCESS){
+	fprintf(stderr, "error: could not track progress\n");
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	threads[i].w = &w;
+	threads[i].seqs = seqs[i];
+	threads[i].count = 0;
+	threads[i].seed = i + 1;
+    }
+    for(r = 0; r < TEST_RANGES; r++){
+	for(i = 0; i < range_sizes[r]; i++){
+	    seq = OUTWRITER_SEQ(r, i);
+	    if(seq != skip){
+		test_thread* t = &threads[n++ % TEST_THREADS];
+		t->seqs[t->count++] = seq;
+	    }
+	}
+	/* some ranges are reported before their lines, some after */
+	if(r % 2 == 0){
+	    outwriter_range_done(&w, r, range_sizes[r]);
+	}
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_create(&ids[i], NULL, writer_thread, &threads[i]);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(ids[i], NULL);
+    }
+    for(r = 1; r < TEST_RANGES; r += 2){
+	outwriter_range_done(&w, r, range_sizes[r]);
+    }
+    ret = outwriter_finish(&w);
+    check_progress(&w, ordered, skip);
+    outwriter_untrack(&w);
+    close(fd);
+    return ret;
+}
+
+/* Read the file back and check its lines; ordered checks the order,
+ * otherwise only that every line (but skip) is there once */
+static int check(const char* label, int ordered, uint64_t skip){
+    static char seen[TEST_RANGES][30000];
+    char expect[TEST_LINE_SIZE];
+    char line[TEST_LINE_SIZE];
+    unsigned int r, i;
+    int expect_r = 0, expect_i = 0;
+    int errors = 0;
+    FILE* f = fopen(TEST_PATH, "r");
+
+    if(!f){
+	fprintf(stderr, "error: %s: could not read output\n", label);
+	return 1;
+    }
+    memset(seen, 0, sizeof(seen));
+    while(!errors && fgets(line, sizeof(line), f)){
+	if(sscanf(line, "line %u %u", &r, &i) != 2 || r >= TEST_RANGES
+	   || i >= (unsigned) range_sizes[r] || seen[r][i]++){
+	    fprintf(stderr, "error: %s: bad or repeated line %s", label, line);
+	    errors++;
+	    break;
+	}
+	if(ordered){
+	    for(;;){
+		while(expect_r < TEST_RANGES && expect_i == range_sizes[expect_r]){
+		    expect_r++;
+		    expect_i = 0;
+		}
+		if(OUTWRITER_SEQ(expect_r, expect_i) != skip){
+		    break;
+		}
+		expect_i++;
+	    }
+	    test_line(OUTWRITER_SEQ(expect_r, expect_i), expect);
+	    if(strcmp(line, expect) != 0){
+		fprintf(stderr, "error: %s: got %s expected %s", label, line, expect);
+		errors++;
+	    }
+	    expect_i++;
+	}
+    }
+    fclose(f);
+    for(r = 0; !errors && r < TEST_RANGES; r++){
+	for(i = 0; i < (unsigned) range_sizes[r]; i++){
+	    if(!seen[r][i] && OUTWRITER_SEQ(r, i) != skip){
+		fprintf(stderr, "error: %s: line %u %u missing\n", label, r, i);
+		errors++;
+		break;
+	    }
+	}
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    const uint64_t none = ~0ULL;
+    const uint64_t gap = OUTWRITER_SEQ(2, 100);
+
+    /* Test unordered output */
+    if(run(0, none) != OUTWRITER_SUCCESS){
+	fprintf(stderr, "error: unordered writer failed\n");
+    }
+    check("unordered", 0, none);
+
+    /* Test a missing line is tracked as a gap */
+    if(run(0, gap) != OUTWRITER_SUCCESS){
+	fprintf(stderr, "error: unordered writer failed with a gap\n");
+    }
+    check("unordered gap", 0, gap);
+
+    /* Test ordered output */
+    if(run(1, none) != OUTWRITER_SUCCESS){
+	fprintf(stderr, "error: ordered writer failed\n");
+    }
+    check("ordered", 1, none);
+
+    /* Test a line that never arrives */
+    if(run(1, gap) != OUTWRITER_FAILURE){
+	fprintf(stderr, "error: ordered writer missed a gap\n");
+    }
+    check("ordered gap", 1, gap);
+
+    unlink(TEST_PATH);
+    return 0;
+}
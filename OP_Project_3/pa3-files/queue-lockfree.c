@@ -0,0 +1,288 @@
+/*
+ * File: queue-lockfree.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains a lock-free bounded multi-producer
+ *      multi-consumer FIFO queue behind the queue.h interface.
+ *      Compile with -DQUEUE_LOCKFREE.
+ *
+ *      Each slot carries a sequence number. A slot at position
+ *      pos is free for a producer when seq == pos and holds a
+ *      payload for a consumer when seq == pos + 1. Producers and
+ *      consumers claim positions with a CAS on rear/front, so
+ *      neither side ever blocks the other. The _many calls claim
+ *      a run of consecutive slots with a single CAS. Blocking
+ *      variants sleep on a futex that is only touched when
+ *      someone is actually waiting.
+ *  
+ */
+
+#ifndef QUEUE_LOCKFREE
+#error "queue-lockfree.c must be built with -DQUEUE_LOCKFREE"
+#endif
+
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "queue.h"
+
+static void futex_wait(atomic_uint* word, unsigned int val){
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint* word, int count){
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+int queue_init(queue* q, int size){
+
+    int i;
+
+    /* user specified size or default; a one slot ring cannot tell
+     * its full slot from the same slot free a lap later, so it
+     * gets two */
+    if(size>1) {
+	q->maxSize = size;
+    }
+    else if(size == 1) {
+	q->maxSize = 2;
+    }
+    else {
+	q->maxSize = QUEUEMAXSIZE;
+    }
+
+    q->array = aligned_alloc(QUEUE_CACHELINE,
+			     ((sizeof(queue_node) * q->maxSize
+			       + QUEUE_CACHELINE - 1)
+			      / QUEUE_CACHELINE) * QUEUE_CACHELINE);
+    if(!(q->array)){
+	perror("Error on queue Malloc");
+	return QUEUE_FAILURE;
+    }
+
+    /* slot i is free for the producer at position i */
+    for(i=0; i < q->maxSize; ++i){
+	atomic_init(&q->array[i].seq, (size_t) i);
+	q->array[i].payload = NULL;
+    }
+
+    atomic_init(&q->front, 0);
+    atomic_init(&q->rear, 0);
+    atomic_init(&q->push_events, 0);
+    atomic_init(&q->empty_waiters, 0);
+    atomic_init(&q->pop_events, 0);
+    atomic_init(&q->full_waiters, 0);
+    atomic_init(&q->closed, 0);
+
+    return q->maxSize;
+}
+
+/* Snapshots only: other threads may change the answer at once */
+int queue_is_empty(queue* q){
+    size_t front = atomic_load(&q->front);
+    size_t rear = atomic_load(&q->rear);
+    return front >= rear;
+}
+
+int queue_is_full(queue* q){
+    size_t front = atomic_load(&q->front);
+    size_t rear = atomic_load(&q->rear);
+    return rear >= front && rear - front >= (size_t) q->maxSize;
+}
+
+int queue_push_many(queue* q, void* const* payloads, int count){
+    queue_node* node;
+    size_t pos = atomic_load_explicit(&q->rear, memory_order_relaxed);
+    size_t seq;
+    long diff;
+    int n, i;
+
+    if(count <= 0){
+	return 0;
+    }
+
+    for(;;){
+	node = &q->array[pos % q->maxSize];
+	seq = atomic_load_explicit(&node->seq, memory_order_acquire);
+	diff = (long) seq - (long) pos;
+	if(diff < 0){
+	    /* slot still holds the payload from one lap ago */
+	    return 0;
+	}
+	if(diff > 0){
+	    /* another producer took pos */
+	    pos = atomic_load_explicit(&q->rear, memory_order_relaxed);
+	    continue;
+	}
+	/* extend the run over every free slot after pos */
+	for(n = 1; n < count && n < q->maxSize; n++){
+	    node = &q->array[(pos + n) % q->maxSize];
+	    seq = atomic_load_explicit(&node->seq, memory_order_acquire);
+	    if(seq != pos + n){
+		break;
+	    }
+	}
+	/* claim the whole run with one CAS */
+	if(atomic_compare_exchange_weak_explicit(&q->rear, &pos, pos + n,
+						 memory_order_relaxed,
+						 memory_order_relaxed)){
+	    break;
+	}
+    }
+
+    for(i = 0; i < n; i++){
+	node = &q->array[(pos + i) % q->maxSize];
+	node->payload = payloads[i];
+	atomic_store_explicit(&node->seq, pos + i + 1, memory_order_release);
+    }
+
+    atomic_fetch_add(&q->push_events, 1);
+    if(atomic_load(&q->empty_waiters)){
+	futex_wake(&q->push_events, n);
+    }
+
+    return n;
+}
+
+int queue_pop_many(queue* q, void** out, int max){
+    queue_node* node;
+    size_t pos = atomic_load_explicit(&q->front, memory_order_relaxed);
+    size_t seq;
+    long diff;
+    int n, i;
+
+    if(max <= 0){
+	return 0;
+    }
+
+    for(;;){
+	node = &q->array[pos % q->maxSize];
+	seq = atomic_load_explicit(&node->seq, memory_order_acquire);
+	diff = (long) seq - (long) (pos + 1);
+	if(diff < 0){
+	    /* nothing published at this position yet */
+	    return 0;
+	}
+	if(diff > 0){
+	    /* another consumer took pos */
+	    pos = atomic_load_explicit(&q->front, memory_order_relaxed);
+	    continue;
+	}
+	/* extend the run over every published slot after pos */
+	for(n = 1; n < max && n < q->maxSize; n++){
+	    node = &q->array[(pos + n) % q->maxSize];
+	    seq = atomic_load_explicit(&node->seq, memory_order_acquire);
+	    if(seq != pos + n + 1){
+		break;
+	    }
+	}
+	if(atomic_compare_exchange_weak_explicit(&q->front, &pos, pos + n,
+						 memory_order_relaxed,
+						 memory_order_relaxed)){
+	    break;
+	}
+    }
+
+    for(i = 0; i < n; i++){
+	node = &q->array[(pos + i) % q->maxSize];
+	out[i] = node->payload;
+	/* free the slot for the producer one lap ahead */
+	atomic_store_explicit(&node->seq, pos + i + q->maxSize,
+			      memory_order_release);
+    }
+
+    atomic_fetch_add(&q->pop_events, 1);
+    if(atomic_load(&q->full_waiters)){
+	futex_wake(&q->pop_events, n);
+    }
+
+    return n;
+}
+
+int queue_push(queue* q, void* new_payload){
+    return queue_push_many(q, &new_payload, 1) == 1 ?
+	QUEUE_SUCCESS : QUEUE_FAILURE;
+}
+
+void* queue_pop(queue* q){
+    void* ret_payload;
+
+    if(queue_pop_many(q, &ret_payload, 1) != 1){
+	return NULL;
+    }
+    return ret_payload;
+}
+
+int queue_push_many_wait(queue* q, void* const* payloads, int count){
+    unsigned int events;
+    int pushed = 0;
+
+    for(;;){
+	/* sample before trying so a pop in between is not missed */
+	events = atomic_load(&q->pop_events);
+	if(atomic_load(&q->closed)){
+	    return pushed;
+	}
+	pushed += queue_push_many(q, payloads + pushed, count - pushed);
+	if(pushed == count){
+	    return pushed;
+	}
+	atomic_fetch_add(&q->full_waiters, 1);
+	futex_wait(&q->pop_events, events);
+	atomic_fetch_sub(&q->full_waiters, 1);
+    }
+}
+
+int queue_pop_many_wait(queue* q, void** out, int max){
+    unsigned int events;
+    int popped;
+
+    for(;;){
+	events = atomic_load(&q->push_events);
+	if((popped = queue_pop_many(q, out, max)) > 0){
+	    return popped;
+	}
+	if(atomic_load(&q->closed)){
+	    /* pushes finished before close; take any stragglers */
+	    return queue_pop_many(q, out, max);
+	}
+	atomic_fetch_add(&q->empty_waiters, 1);
+	futex_wait(&q->push_events, events);
+	atomic_fetch_sub(&q->empty_waiters, 1);
+    }
+}
+
+int queue_push_wait(queue* q, void* payload){
+    return queue_push_many_wait(q, &payload, 1) == 1 ?
+	QUEUE_SUCCESS : QUEUE_FAILURE;
+}
+
+void* queue_pop_wait(queue* q){
+    void* payload;
+
+    if(queue_pop_many_wait(q, &payload, 1) != 1){
+	return NULL;
+    }
+    return payload;
+}
+
+void queue_close(queue* q){
+    atomic_store(&q->closed, 1);
+    atomic_fetch_add(&q->push_events, 1);
+    atomic_fetch_add(&q->pop_events, 1);
+    futex_wake(&q->push_events, INT_MAX);
+    futex_wake(&q->pop_events, INT_MAX);
+}
+
+void queue_cleanup(queue* q)
+{
+    while(queue_pop(q)){
+    }
+
+    free(q->array);
+}
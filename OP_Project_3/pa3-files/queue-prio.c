@@ -0,0 +1,202 @@
+/*
+ * File: queue-prio.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains priority classes over the queue.h FIFO
+ *      queue: a bucket per class, each a queue of its own, so it
+ *      builds against either backend. With -DQUEUE_LOCKFREE the
+ *      blocking calls sleep on a futex shared by every class.
+ *
+ *      Which class is served next is decided from a snapshot of
+ *      the class heads; with concurrent pops the starvation counts
+ *      are kept with plain atomic adds and may be off by a batch,
+ *      which only moves the bound, never loses a payload.
+ *
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+
+#include "queue.h"
+
+#ifdef QUEUE_LOCKFREE
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+static void futex_wait(atomic_uint* word, unsigned int val){
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint* word, int count){
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#endif
+
+int queue_prio_init(queue_prio* p, int nclasses, int size, int starve_limit){
+
+    int slots = QUEUE_FAILURE;
+    int i;
+
+    if(nclasses < 1 || nclasses > QUEUE_MAX_CLASSES){
+	return QUEUE_FAILURE;
+    }
+    p->nclasses = nclasses;
+    p->starve_limit = starve_limit > 0 ? starve_limit : QUEUE_DEFAULT_STARVE_LIMIT;
+
+    for(i=0; i < nclasses; ++i){
+	slots = queue_init(&p->classes[i], size);
+	if(slots == QUEUE_FAILURE){
+	    while(i-- > 0){
+		queue_cleanup(&p->classes[i]);
+	    }
+	    return QUEUE_FAILURE;
+	}
+	atomic_init(&p->passed[i], 0);
+	atomic_init(&p->starved[i], 0);
+    }
+
+#ifdef QUEUE_LOCKFREE
+    atomic_init(&p->push_events, 0);
+    atomic_init(&p->empty_waiters, 0);
+    atomic_init(&p->pop_events, 0);
+    atomic_init(&p->full_waiters, 0);
+    atomic_init(&p->closed, 0);
+#endif
+
+    return slots;
+}
+
+int queue_prio_is_empty(queue_prio* p){
+    int i;
+
+    for(i=0; i < p->nclasses; ++i){
+	if(!queue_is_empty(&p->classes[i])){
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+int queue_prio_is_full(queue_prio* p, int cls){
+    return queue_is_full(&p->classes[cls]);
+}
+
+int queue_prio_push_many(queue_prio* p, int cls, void* const* payloads, int count){
+    int pushed = queue_push_many(&p->classes[cls], payloads, count);
+
+#ifdef QUEUE_LOCKFREE
+    if(pushed > 0){
+	atomic_fetch_add(&p->push_events, 1);
+	if(atomic_load(&p->empty_waiters)){
+	    futex_wake(&p->push_events, pushed);
+	}
+    }
+#endif
+
+    return pushed;
+}
+
+int queue_prio_pop_many(queue_prio* p, void** out, int max, int* cls){
+    int popped = 0;
+    int chosen = -1;
+    int i;
+
+    /* a class that has waited long enough goes before the rest */
+    for(i=1; i < p->nclasses && chosen < 0; ++i){
+	if(atomic_load_explicit(&p->passed[i], memory_order_relaxed) >= p->starve_limit
+	   && (popped = queue_pop_many(&p->classes[i], out, max)) > 0){
+	    chosen = i;
+	    atomic_fetch_add_explicit(&p->starved[i], 1, memory_order_relaxed);
+	}
+    }
+    /* otherwise the most urgent class with payloads */
+    for(i=0; i < p->nclasses && chosen < 0; ++i){
+	if((popped = queue_pop_many(&p->classes[i], out, max)) > 0){
+	    chosen = i;
+	}
+    }
+    if(chosen < 0){
+	return 0;
+    }
+
+    /* every less urgent class still waiting was passed over */
+    atomic_store_explicit(&p->passed[chosen], 0, memory_order_relaxed);
+    for(i=chosen + 1; i < p->nclasses; ++i){
+	if(!queue_is_empty(&p->classes[i])){
+	    atomic_fetch_add_explicit(&p->passed[i], popped, memory_order_relaxed);
+	}
+    }
+    *cls = chosen;
+
+#ifdef QUEUE_LOCKFREE
+    atomic_fetch_add(&p->pop_events, 1);
+    if(atomic_load(&p->full_waiters)){
+	/* the sleepers may be pushing to any class; wake them all */
+	futex_wake(&p->pop_events, INT_MAX);
+    }
+#endif
+
+    return popped;
+}
+
+void queue_prio_cleanup(queue_prio* p){
+    int i;
+
+    for(i=0; i < p->nclasses; ++i){
+	queue_cleanup(&p->classes[i]);
+    }
+}
+
+#ifdef QUEUE_LOCKFREE
+
+int queue_prio_push_many_wait(queue_prio* p, int cls, void* const* payloads, int count){
+    unsigned int events;
+    int pushed = 0;
+
+    for(;;){
+	/* sample before trying so a pop in between is not missed */
+	events = atomic_load(&p->pop_events);
+	if(atomic_load(&p->closed)){
+	    return pushed;
+	}
+	pushed += queue_prio_push_many(p, cls, payloads + pushed, count - pushed);
+	if(pushed == count){
+	    return pushed;
+	}
+	atomic_fetch_add(&p->full_waiters, 1);
+	futex_wait(&p->pop_events, events);
+	atomic_fetch_sub(&p->full_waiters, 1);
+    }
+}
+
+int queue_prio_pop_many_wait(queue_prio* p, void** out, int max, int* cls){
+    unsigned int events;
+    int popped;
+
+    for(;;){
+	events = atomic_load(&p->push_events);
+	if((popped = queue_prio_pop_many(p, out, max, cls)) > 0){
+	    return popped;
+	}
+	if(atomic_load(&p->closed)){
+	    /* pushes finished before close; take any stragglers */
+	    return queue_prio_pop_many(p, out, max, cls);
+	}
+	atomic_fetch_add(&p->empty_waiters, 1);
+	futex_wait(&p->push_events, events);
+	atomic_fetch_sub(&p->empty_waiters, 1);
+    }
+}
+
+void queue_prio_close(queue_prio* p){
+    atomic_store(&p->closed, 1);
+    atomic_fetch_add(&p->push_events, 1);
+    atomic_fetch_add(&p->pop_events, 1);
+    futex_wake(&p->push_events, INT_MAX);
+    futex_wake(&p->pop_events, INT_MAX);
+}
+
+#endif
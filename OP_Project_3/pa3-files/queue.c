@@ -7,6 +7,7 @@
  * Create Date: 2010/02/12
  * Modify Date: 2011/02/04
  * Modify Date: 2012/02/01
+ * Modify Date: 2026/10/17
  * Description:
  * 	This file contains an implementation of a simple FIFO queue.
  *  
@@ -92,6 +93,27 @@ int queue_push(queue* q, void* new_payload){
     return QUEUE_SUCCESS;
 }
 
+int queue_push_many(queue* q, void* const* payloads, int count){
+    int pushed = 0;
+
+    while(pushed < count && queue_push(q, payloads[pushed]) == QUEUE_SUCCESS){
+	pushed++;
+    }
+
+    return pushed;
+}
+
+int queue_pop_many(queue* q, void** out, int max){
+    int popped = 0;
+    void* payload;
+
+    while(popped < max && (payload = queue_pop(q)) != NULL){
+	out[popped++] = payload;
+    }
+
+    return popped;
+}
+
 void queue_cleanup(queue* q)
 {
     while(!queue_is_empty(q)){
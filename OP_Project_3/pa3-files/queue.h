@@ -7,8 +7,15 @@
  * Create Date: 2010/02/12
  * Modify Date: 2011/02/05
  * Modify Date: 2012/02/01
+ * Modify Date: 2026/10/17
  * Description:
  * 	This is the header file for an implemenation of a simple FIFO queue.
+ *      Defining QUEUE_LOCKFREE swaps in a thread-safe lock-free backend
+ *      with the same interface.
+ *
+ *      queue_prio layers priority classes over either backend: one
+ *      FIFO ring per class, 0 the most urgent, always drained first
+ *      unless a less urgent class has waited too long.
  * 
  */
 
@@ -16,12 +23,49 @@
 #define QUEUE_H
 
 #include <stdio.h>
+#include <stdatomic.h>
 
 #define QUEUEMAXSIZE 50
 
 #define QUEUE_FAILURE -1
 #define QUEUE_SUCCESS 0
 
+#ifdef QUEUE_LOCKFREE
+
+/* Lock-free bounded MPMC backend (queue-lockfree.c).
+ * Build every object that includes this header with
+ * -DQUEUE_LOCKFREE to select it. All functions below are
+ * then safe to call from any number of threads at once
+ * without an external lock.
+ */
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define QUEUE_CACHELINE 64
+
+typedef struct queue_node_s{
+    atomic_size_t seq;
+    void* payload;
+} queue_node;
+
+typedef struct queue_s{
+    /* read-only after queue_init */
+    _Alignas(QUEUE_CACHELINE) queue_node* array;
+    int maxSize;
+    /* producer position */
+    _Alignas(QUEUE_CACHELINE) atomic_size_t rear;
+    /* consumer position */
+    _Alignas(QUEUE_CACHELINE) atomic_size_t front;
+    /* futex words, bumped on every push/pop */
+    _Alignas(QUEUE_CACHELINE) atomic_uint push_events;
+    atomic_uint empty_waiters;
+    _Alignas(QUEUE_CACHELINE) atomic_uint pop_events;
+    atomic_uint full_waiters;
+    atomic_int closed;
+} queue;
+
+#else
+
 typedef struct queue_node_s{
     void* payload;
 } queue_node;
@@ -33,6 +77,8 @@ typedef struct queue_s{
     int maxSize;
 } queue;
 
+#endif
+
 /* Function to initilze a new queue
  * On success, returns queue size
  * On failure, returns QUEUE_FAILURE
@@ -61,7 +107,130 @@ int queue_push(queue* q, void* payload);
  */
 void* queue_pop(queue* q);
 
+/* Function to add up to count payloads, in order, to the end
+ * of the FIFO queue in one call
+ * Returns the number pushed (0 if the queue is full)
+ */
+int queue_push_many(queue* q, void* const* payloads, int count);
+
+/* Function to remove up to max payloads in FIFO order into out
+ * Returns the number popped (0 if the queue is empty)
+ */
+int queue_pop_many(queue* q, void** out, int max);
+
 /* Function to free queue memory */
 void queue_cleanup(queue* q);
 
+#ifdef QUEUE_LOCKFREE
+
+/* Function to add all count payloads, sleeping while the
+ * queue is full
+ * Returns the number pushed, short only if the queue is closed
+ */
+int queue_push_many_wait(queue* q, void* const* payloads, int count);
+
+/* Function to remove between 1 and max payloads, sleeping
+ * while the queue is empty
+ * Returns 0 once the queue is closed and drained
+ */
+int queue_pop_many_wait(queue* q, void** out, int max);
+
+/* Function to add payload, sleeping while the queue is full
+ * Returns QUEUE_SUCCESS once pushed
+ * Returns QUEUE_FAILURE if the queue is closed
+ */
+int queue_push_wait(queue* q, void* payload);
+
+/* Function to return element in FIFO order, sleeping while
+ * the queue is empty
+ * Returns NULL pointer once the queue is closed and drained
+ */
+void* queue_pop_wait(queue* q);
+
+/* Function to mark the end of input. Wakes every waiter;
+ * queued payloads can still be popped.
+ */
+void queue_close(queue* q);
+
+#endif
+
+/* Priority classes (queue-prio.c), over whichever backend is built.
+ * Each class is a queue of its own, so a pop looks at a few ring
+ * heads instead of sifting a heap, and names of one class stay in
+ * FIFO order. A pop takes from the most urgent class with payloads,
+ * except that a waiting class which has let starve_limit payloads of
+ * more urgent classes go ahead is served next. With the mutex
+ * backend the caller locks, as for queue; with QUEUE_LOCKFREE every
+ * call is thread-safe and the _wait calls sleep.
+ */
+#define QUEUE_MAX_CLASSES 4
+#define QUEUE_DEFAULT_STARVE_LIMIT 256
+
+typedef struct queue_prio_s{
+    queue classes[QUEUE_MAX_CLASSES];
+    int nclasses;
+    int starve_limit;
+    /* payloads of more urgent classes popped while each waited */
+    atomic_int passed[QUEUE_MAX_CLASSES];
+    /* pops of a class served because it had waited starve_limit */
+    atomic_long starved[QUEUE_MAX_CLASSES];
+#ifdef QUEUE_LOCKFREE
+    /* futex words over every class, bumped on every push/pop */
+    _Alignas(QUEUE_CACHELINE) atomic_uint push_events;
+    atomic_uint empty_waiters;
+    _Alignas(QUEUE_CACHELINE) atomic_uint pop_events;
+    atomic_uint full_waiters;
+    atomic_int closed;
+#endif
+} queue_prio;
+
+/* Function to initilze nclasses classes of size slots each
+ * On success, returns the slots of each class
+ * On failure, returns QUEUE_FAILURE
+ */
+int queue_prio_init(queue_prio* p, int nclasses, int size, int starve_limit);
+
+/* Function to test if every class is empty
+ * Returns 1 if empty, 0 otherwise
+ */
+int queue_prio_is_empty(queue_prio* p);
+
+/* Function to test if class cls is full
+ * Returns 1 if full, 0 otherwise
+ */
+int queue_prio_is_full(queue_prio* p, int cls);
+
+/* Function to add up to count payloads, in order, to class cls
+ * Returns the number pushed (0 if the class is full)
+ */
+int queue_prio_push_many(queue_prio* p, int cls, void* const* payloads, int count);
+
+/* Function to remove up to max payloads of one class into out,
+ * the class chosen as above and stored in *cls
+ * Returns the number popped (0 if every class is empty)
+ */
+int queue_prio_pop_many(queue_prio* p, void** out, int max, int* cls);
+
+/* Function to free every class */
+void queue_prio_cleanup(queue_prio* p);
+
+#ifdef QUEUE_LOCKFREE
+
+/* Function to add all count payloads to class cls, sleeping while
+ * it is full
+ * Returns the number pushed, short only if closed
+ */
+int queue_prio_push_many_wait(queue_prio* p, int cls, void* const* payloads, int count);
+
+/* Function to remove between 1 and max payloads of one class,
+ * sleeping while every class is empty
+ * Returns 0 once closed and drained
+ */
+int queue_prio_pop_many_wait(queue_prio* p, void** out, int max, int* cls);
+
+/* Function to mark the end of input and wake every waiter */
+void queue_prio_close(queue_prio* p);
+
+#endif
+
 #endif
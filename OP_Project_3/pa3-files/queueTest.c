@@ -4,9 +4,14 @@
  * Project: CSCI 3753 Programming Assignment 2
  * Create Date: 2012/02/05
  * Modify Date: 2012/02/05
+ * Modify Date: 2026/10/17
  * Description:
  * 	This file contains test code for the included
- *      queue.
+ *      queue. Run with -s for a multi-threaded stress test
+ *      that checks for lost or duplicated payloads and
+ *      reports throughput. Priority classes must come out
+ *      urgent first, with bulk let through after the starvation
+ *      limit.
  *  
  */
 
@@ -14,16 +19,198 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "queue.h"
 
 #define TEST_SIZE 10
 
+#define STRESS_ITEMS 1000000
+#define STRESS_THREADS 4
+#define STRESS_QSIZE 1024
+
+#ifdef QUEUE_LOCKFREE
+#define QUEUE_BACKEND "lockfree"
+#else
+#define QUEUE_BACKEND "mutex"
+#endif
+
+/* Shared state for the multi-threaded stress test */
+static queue stress_q;
+static long stress_items;
+static atomic_long stress_next;
+static atomic_uchar* stress_seen;
+static atomic_long stress_dups;
+#ifndef QUEUE_LOCKFREE
+static pthread_mutex_t stress_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stress_not_full = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t stress_not_empty = PTHREAD_COND_INITIALIZER;
+static int stress_done;
+#endif
+
+/* Blocking push/pop; the mutex backend needs an external lock */
+static void stress_push(void* payload){
+#ifdef QUEUE_LOCKFREE
+    queue_push_wait(&stress_q, payload);
+#else
+    pthread_mutex_lock(&stress_lock);
+    while(queue_is_full(&stress_q)){
+	pthread_cond_wait(&stress_not_full, &stress_lock);
+    }
+    queue_push(&stress_q, payload);
+    pthread_cond_signal(&stress_not_empty);
+    pthread_mutex_unlock(&stress_lock);
+#endif
+}
+
+static void* stress_pop(void){
+#ifdef QUEUE_LOCKFREE
+    return queue_pop_wait(&stress_q);
+#else
+    void* payload;
+    pthread_mutex_lock(&stress_lock);
+    while(queue_is_empty(&stress_q) && !stress_done){
+	pthread_cond_wait(&stress_not_empty, &stress_lock);
+    }
+    payload = queue_pop(&stress_q);
+    pthread_cond_signal(&stress_not_full);
+    pthread_mutex_unlock(&stress_lock);
+    return payload;
+#endif
+}
+
+static void stress_close(void){
+#ifdef QUEUE_LOCKFREE
+    queue_close(&stress_q);
+#else
+    pthread_mutex_lock(&stress_lock);
+    stress_done = 1;
+    pthread_cond_broadcast(&stress_not_empty);
+    pthread_mutex_unlock(&stress_lock);
+#endif
+}
+
+/* Producers hand out the values 1..stress_items exactly once */
+static void* stress_producer(void* arg){
+    long v;
+    (void) arg;
+
+    while((v = atomic_fetch_add(&stress_next, 1)) <= stress_items){
+	stress_push((void*) (uintptr_t) v);
+    }
+    return NULL;
+}
+
+/* Consumers mark every value they see */
+static void* stress_consumer(void* arg){
+    void* payload;
+    (void) arg;
+
+    while((payload = stress_pop()) != NULL){
+	if(atomic_fetch_add(&stress_seen[(uintptr_t) payload - 1], 1)){
+	    atomic_fetch_add(&stress_dups, 1);
+	}
+    }
+    return NULL;
+}
+
+/* Push stress_items values through the queue from many threads
+ * and check that each one came out exactly once.
+ * Returns 0 on success, 1 on loss or duplication.
+ */
+static int stress_test(int producers, int consumers, long items, int qSize){
+    pthread_t threads[producers + consumers];
+    struct timespec t0, t1;
+    double secs;
+    long i, lost = 0;
+    int t;
+
+    stress_items = items;
+    atomic_init(&stress_next, 1);
+    atomic_init(&stress_dups, 0);
+    stress_seen = calloc(items, sizeof(*stress_seen));
+    if(!stress_seen){
+	perror("Error allocating stress test state");
+	return 1;
+    }
+    if(queue_init(&stress_q, qSize) == QUEUE_FAILURE){
+	fprintf(stderr, "error: queue_init failed!\n");
+	return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(t=0; t<consumers; t++){
+	pthread_create(&threads[producers + t], NULL, stress_consumer, NULL);
+    }
+    for(t=0; t<producers; t++){
+	pthread_create(&threads[t], NULL, stress_producer, NULL);
+    }
+    for(t=0; t<producers; t++){
+	pthread_join(threads[t], NULL);
+    }
+    stress_close();
+    for(t=0; t<consumers; t++){
+	pthread_join(threads[producers + t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for(i=0; i<items; i++){
+	if(!atomic_load(&stress_seen[i])){
+	    lost++;
+	}
+    }
+
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%s: %d producers, %d consumers, queue %d, %ld items: "
+	   "%.3f s, %.0f ops/sec\n",
+	   QUEUE_BACKEND, producers, consumers, qSize, items,
+	   secs, 2.0 * items / secs);
+
+    if(lost || atomic_load(&stress_dups)){
+	fprintf(stderr,
+		"error: stress test lost %ld and duplicated %ld payloads\n",
+		lost, atomic_load(&stress_dups));
+    }
+
+    queue_cleanup(&stress_q);
+    free(stress_seen);
+    return (lost || atomic_load(&stress_dups)) ? 1 : 0;
+}
+
 int main(int argc, char* argv[]){
 
-    /* Void Unused Variables */
-    (void) argc;
-    (void) argv;
+    int opt;
+    int stress = 0;
+    int producers = STRESS_THREADS;
+    int consumers = STRESS_THREADS;
+    long items = STRESS_ITEMS;
+    int stressQSize = STRESS_QSIZE;
+
+    /* -s runs the threaded stress test instead of the unit test */
+    while((opt = getopt(argc, argv, "sp:c:n:q:")) != -1){
+	switch(opt){
+	case 's': stress = 1; break;
+	case 'p': producers = atoi(optarg); break;
+	case 'c': consumers = atoi(optarg); break;
+	case 'n': items = atol(optarg); break;
+	case 'q': stressQSize = atoi(optarg); break;
+	default:
+	    fprintf(stderr, "Usage:\n %s [-s [-p producers] [-c consumers]"
+		    " [-n items] [-q queueSize]]\n", argv[0]);
+	    return EXIT_FAILURE;
+	}
+    }
+    if(stress){
+	if(producers < 1 || consumers < 1 || items < 1){
+	    fprintf(stderr, "error: stress counts must be positive\n");
+	    return EXIT_FAILURE;
+	}
+	return stress_test(producers, consumers, items, stressQSize);
+    }
 
     /* Setup local vars */
     queue q;
@@ -154,9 +341,104 @@ int main(int argc, char* argv[]){
 		" NULL when empty!\n");
     }
 
+    /* Offset front/rear so the batch test wraps around */
+    for(i=0; i<3; i++){
+	queue_push(&q, payload_in[i]);
+	queue_pop(&q);
+    }
+
+    /* Test batched push fills the queue in one call */
+    if(queue_push_many(&q, (void**) payload_in, TEST_SIZE) != TEST_SIZE){
+	fprintf(stderr,
+		"error: queue_push_many did not push"
+		" %d payloads!\n", TEST_SIZE);
+    }
+
+    /* Test that batched push pushes nothing when full */
+    if(queue_push_many(&q, (void**) payload_in, 1) != 0){
+	fprintf(stderr,
+		"error: queue_push_many did not fail"
+		" when full!\n");
+    }
+
+    /* Test batched pop, split over two calls */
+    for(i=0; i<TEST_SIZE; i++){
+	payload_out[i] = NULL;
+    }
+    if(queue_pop_many(&q, (void**) payload_out, 4) != 4 ||
+       queue_pop_many(&q, (void**) payload_out + 4, TEST_SIZE)
+       != TEST_SIZE - 4){
+	fprintf(stderr,
+		"error: queue_pop_many returned the"
+		" wrong count!\n");
+    }
+    for(i=0; i<TEST_SIZE; i++){
+	if(payload_in[i] != payload_out[i]){
+	    fprintf(stderr,
+		    "error: batched push/pop mismatch!\n"
+		    "Payload Index: %d\n", i);
+	}
+    }
+
+    /* Test that batched pop returns nothing when empty */
+    if(queue_pop_many(&q, (void**) payload_out, TEST_SIZE) != 0){
+	fprintf(stderr,
+		"error: queue_pop_many did not return"
+		" 0 when empty!\n");
+    }
+
     /* Cleanup Queue */
     queue_cleanup(&q);
 
+    /* Test priority classes: urgent first, bulk after 4 passed */
+    queue_prio pq;
+    const int prio_order[TEST_SIZE] = {5, 6, 7, 8, 0, 9, 1, 2, 3, 4};
+    const int prio_class[TEST_SIZE] = {0, 0, 0, 0, 1, 0, 1, 1, 1, 1};
+    int cls;
+    if(queue_prio_init(&pq, 2, qSize, 4) == QUEUE_FAILURE){
+	fprintf(stderr,
+		"error: queue_prio_init failed!\n");
+	return 0;
+    }
+    if(queue_prio_push_many(&pq, 1, (void**) payload_in, 5) != 5 ||
+       queue_prio_push_many(&pq, 0, (void**) payload_in + 5, 5) != 5){
+	fprintf(stderr,
+		"error: queue_prio_push_many did not push"
+		" 5 payloads!\n");
+    }
+    for(i=0; i<TEST_SIZE; i++){
+	if(queue_prio_pop_many(&pq, (void**) payload_out, 1, &cls) != 1 ||
+	   payload_out[0] != payload_in[prio_order[i]] ||
+	   cls != prio_class[i]){
+	    fprintf(stderr,
+		    "error: priority pop %d mismatch!\n", i);
+	}
+    }
+    if(!queue_prio_is_empty(&pq) ||
+       queue_prio_pop_many(&pq, (void**) payload_out, 1, &cls) != 0 ||
+       atomic_load(&pq.starved[1]) != 1){
+	fprintf(stderr,
+		"error: priority queue should report empty\n");
+    }
+
+    /* Test that a full class leaves the others room */
+    queue_prio_push_many(&pq, 0, (void**) payload_in, TEST_SIZE);
+    if(!queue_prio_is_full(&pq, 0) || queue_prio_is_full(&pq, 1) ||
+       queue_prio_push_many(&pq, 1, (void**) payload_in, 1) != 1){
+	fprintf(stderr,
+		"error: one full class filled the other\n");
+    }
+#ifdef QUEUE_LOCKFREE
+    /* Test that a closed priority queue drains, then returns 0 */
+    queue_prio_close(&pq);
+    for(i=0; queue_prio_pop_many_wait(&pq, (void**) payload_out, TEST_SIZE, &cls) > 0; i++);
+    if(i != 2){
+	fprintf(stderr,
+		"error: closed priority queue took %d pops\n", i);
+    }
+#endif
+    queue_prio_cleanup(&pq);
+
     /* Cleanup payload_in */
     for(i=0; i<TEST_SIZE; i++){
 	free(payload_in[i]);
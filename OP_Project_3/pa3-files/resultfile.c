@@ -0,0 +1,489 @@
+/*
+ * File: resultfile.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the binary result file. Hostnames are
+ *      numbered as they first come in, in a table striped by the
+ *      hostname hash so resolvers rarely share a lock; the table
+ *      becomes the string table and index when the run finishes.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+#include "resultfile.h"
+
+#define RESULTFILE_INITIAL_BUCKETS 64
+#define RESULTFILE_BUF_SIZE (64 * 1024)
+
+/* Buffered appends to the output file */
+typedef struct resultfile_out_s{
+    int fd;
+    int error;
+    size_t used;
+    unsigned char buf[RESULTFILE_BUF_SIZE];
+} resultfile_out;
+
+static void put32(unsigned char* p, uint32_t v){
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static void put64(unsigned char* p, uint64_t v){
+    put32(p, v & 0xFFFFFFFF);
+    put32(p + 4, v >> 32);
+}
+
+static uint32_t get32(const unsigned char* p){
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static uint64_t get64(const unsigned char* p){
+    return (uint64_t) get32(p) | (uint64_t) get32(p + 4) << 32;
+}
+
+/* 64 bit FNV-1a */
+static uint64_t resultfile_hash(const char* s){
+    uint64_t h = 14695981039346656037ULL;
+    while(*s){
+	h ^= (unsigned char) *s++;
+	h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static int write_all(int fd, const void* buf, size_t n){
+    size_t put = 0;
+    ssize_t w;
+
+    while(put < n){
+	w = write(fd, (const char*) buf + put, n - put);
+	if(w < 0 && errno == EINTR){
+	    continue;
+	}
+	if(w <= 0){
+	    return RESULTFILE_FAILURE;
+	}
+	put += w;
+    }
+    return RESULTFILE_SUCCESS;
+}
+
+static void out_flush(resultfile_out* o){
+    if(o->used && !o->error && write_all(o->fd, o->buf, o->used) == RESULTFILE_FAILURE){
+	o->error = 1;
+    }
+    o->used = 0;
+}
+
+static void out_put(resultfile_out* o, const void* data, size_t n){
+    size_t part;
+
+    while(n > 0){
+	if(o->used == sizeof(o->buf)){
+	    out_flush(o);
+	}
+	part = sizeof(o->buf) - o->used;
+	part = part < n ? part : n;
+	memcpy(o->buf + o->used, data, part);
+	o->used += part;
+	data = (const char*) data + part;
+	n -= part;
+    }
+}
+
+/* Pack the addresses in ips (len bytes) into a record for host
+ * id. Returns the record length. */
+static size_t pack_record(uint32_t id, const char* ips, size_t len, unsigned char* out){
+    unsigned char packed[RESULTFILE_MAX_ADDRS * 16];
+    unsigned char bitmap[(RESULTFILE_MAX_ADDRS + 7) / 8];
+    char addr[INET6_ADDRSTRLEN];
+    const char* end = ips ? ips + len : NULL;
+    const char* p = ips;
+    const char* sep;
+    size_t used = 0;
+    size_t alen;
+    size_t nbitmap;
+    int n = 0;
+
+    memset(bitmap, 0, sizeof(bitmap));
+    while(p && p < end && n < RESULTFILE_MAX_ADDRS){
+	sep = strstr(p, UTIL_ADDR_SEP);
+	alen = (sep && sep < end ? sep : end) - p;
+	if(alen < sizeof(addr)){
+	    memcpy(addr, p, alen);
+	    addr[alen] = '\0';
+	    if(inet_pton(AF_INET, addr, packed + used) == 1){
+		used += 4;
+		n++;
+	    }
+	    else if(inet_pton(AF_INET6, addr, packed + used) == 1){
+		bitmap[n / 8] |= 1 << (n % 8);
+		used += 16;
+		n++;
+	    }
+	}
+	p += alen + strlen(UTIL_ADDR_SEP);
+    }
+
+    nbitmap = (n + 7) / 8;
+    put32(out, id);
+    out[4] = ips ? RESULTFILE_RESOLVED : RESULTFILE_FAILED;
+    out[5] = n;
+    memcpy(out + 6, bitmap, nbitmap);
+    memcpy(out + 6 + nbitmap, packed, used);
+    return 6 + nbitmap + used;
+}
+
+/* Double the bucket array once the stripe averages one host per
+ * bucket. Caller holds the stripe lock. */
+static void resultfile_grow(resultfile_stripe* s){
+    size_t nbuckets = s->nbuckets * 2;
+    resultfile_host** buckets = calloc(nbuckets, sizeof(*buckets));
+    resultfile_host* h;
+    resultfile_host* next;
+    size_t i;
+
+    if(!buckets){
+	/* keep the longer chains */
+	return;
+    }
+    for(i = 0; i < s->nbuckets; i++){
+	for(h = s->buckets[i]; h; h = next){
+	    next = h->next;
+	    h->next = buckets[h->hash & (nbuckets - 1)];
+	    buckets[h->hash & (nbuckets - 1)] = h;
+	}
+    }
+    free(s->buckets);
+    s->buckets = buckets;
+    s->nbuckets = nbuckets;
+}
+
+int resultfile_init(resultfile* f, int flags){
+    int i;
+
+    memset(f, 0, sizeof(*f));
+    f->flags = flags;
+    for(i = 0; i < RESULTFILE_STRIPES; i++){
+	pthread_mutex_init(&f->stripes[i].lock, NULL);
+	f->stripes[i].nbuckets = RESULTFILE_INITIAL_BUCKETS;
+	f->stripes[i].buckets = calloc(RESULTFILE_INITIAL_BUCKETS, sizeof(resultfile_host*));
+	if(!f->stripes[i].buckets){
+	    perror("Error allocating the result table");
+	    return RESULTFILE_FAILURE;
+	}
+    }
+    return RESULTFILE_SUCCESS;
+}
+
+int resultfile_begin(resultfile* f, int fd){
+    unsigned char header[RESULTFILE_HEADER_SIZE];
+
+    memcpy(header, RESULTFILE_MAGIC, 8);
+    put32(header + 8, RESULTFILE_VERSION);
+    put32(header + 12, f->flags);
+    return write_all(fd, header, sizeof(header));
+}
+
+int resultfile_add(resultfile* f, uint64_t seq, const char* hostname,
+		   const char* ips, size_t len, unsigned char* record){
+
+    uint64_t hash = resultfile_hash(hostname);
+    resultfile_stripe* s = &f->stripes[(hash >> 40) % RESULTFILE_STRIPES];
+    resultfile_host** link;
+    resultfile_host* h;
+    unsigned char* copy;
+    size_t record_len;
+    size_t name_len;
+    int dedup = f->flags & RESULTFILE_DEDUP;
+    int ret = RESULTFILE_SUCCESS;
+
+    /* the host number goes in once it is known */
+    record_len = pack_record(0, ips, len, record);
+
+    pthread_mutex_lock(&s->lock);
+    link = &s->buckets[hash & (s->nbuckets - 1)];
+    while((h = *link) && !(h->hash == hash && strcmp(h->name, hostname) == 0)){
+	link = &h->next;
+    }
+    if(!h){
+	name_len = strlen(hostname);
+	h = calloc(1, sizeof(*h) + name_len + 1);
+	if(!h){
+	    pthread_mutex_unlock(&s->lock);
+	    return RESULTFILE_FAILURE;
+	}
+	h->hash = hash;
+	h->id = atomic_fetch_add(&f->next_id, 1);
+	h->first_seq = UINT64_MAX;
+	h->name_len = name_len;
+	memcpy(h->name, hostname, name_len + 1);
+	*link = h;
+	if(++s->nhosts > s->nbuckets){
+	    resultfile_grow(s);
+	}
+    }
+    h->count++;
+    /* dedup keeps the first occurrence's record, whichever
+     * resolver got to it first */
+    if(dedup && seq < h->first_seq){
+	copy = realloc(h->record, record_len);
+	if(copy){
+	    memcpy(copy, record, record_len);
+	    h->record = copy;
+	    h->record_len = record_len;
+	}
+	else{
+	    ret = RESULTFILE_FAILURE;
+	}
+    }
+    if(seq < h->first_seq){
+	h->first_seq = seq;
+    }
+    put32(record, h->id);
+    pthread_mutex_unlock(&s->lock);
+
+    atomic_fetch_add_explicit(&f->records, 1, memory_order_relaxed);
+    if(!ips){
+	atomic_fetch_add_explicit(&f->failed, 1, memory_order_relaxed);
+    }
+    if(ret == RESULTFILE_FAILURE){
+	return RESULTFILE_FAILURE;
+    }
+    return dedup ? 0 : (int) record_len;
+}
+
+static int by_first_seq(const void* a, const void* b){
+    const resultfile_host* x = *(resultfile_host* const*) a;
+    const resultfile_host* y = *(resultfile_host* const*) b;
+    return x->first_seq < y->first_seq ? -1 : x->first_seq > y->first_seq;
+}
+
+int resultfile_finish(resultfile* f, int fd){
+    uint32_t nhosts = atomic_load(&f->next_id);
+    resultfile_host** hosts = calloc(nhosts ? nhosts : 1, sizeof(*hosts));
+    resultfile_out* o = malloc(sizeof(*o));
+    unsigned char* index = malloc((size_t) (nhosts ? nhosts : 1) * RESULTFILE_INDEX_ENTRY);
+    unsigned char trailer[RESULTFILE_TRAILER_SIZE];
+    resultfile_host* h;
+    uint64_t records_end, strings_offset, index_offset, name_offset = 0;
+    uint64_t nrecords = atomic_load(&f->records);
+    off_t here = lseek(fd, 0, SEEK_CUR);
+    size_t i, n = 0;
+    int ret = RESULTFILE_SUCCESS;
+
+    if(!hosts || !o || !index || here < RESULTFILE_HEADER_SIZE){
+	free(hosts);
+	free(o);
+	free(index);
+	return RESULTFILE_FAILURE;
+    }
+    o->fd = fd;
+    o->error = 0;
+    o->used = 0;
+
+    for(i = 0; i < RESULTFILE_STRIPES; i++){
+	for(n = 0; n < f->stripes[i].nbuckets; n++){
+	    for(h = f->stripes[i].buckets[n]; h; h = h->next){
+		hosts[h->id] = h;
+	    }
+	}
+    }
+
+    /* dedup: one record per host, renumbered in input order */
+    records_end = here;
+    if(f->flags & RESULTFILE_DEDUP){
+	qsort(hosts, nhosts, sizeof(*hosts), by_first_seq);
+	for(i = 0; i < nhosts; i++){
+	    hosts[i]->id = i;
+	    put32(hosts[i]->record, i);
+	    out_put(o, hosts[i]->record, hosts[i]->record_len);
+	    records_end += hosts[i]->record_len;
+	}
+	nrecords = nhosts;
+    }
+
+    strings_offset = records_end;
+    for(i = 0; i < nhosts; i++){
+	put64(index + i * RESULTFILE_INDEX_ENTRY, name_offset);
+	put64(index + i * RESULTFILE_INDEX_ENTRY + 8, hosts[i]->count);
+	out_put(o, hosts[i]->name, hosts[i]->name_len + 1);
+	name_offset += hosts[i]->name_len + 1;
+    }
+    index_offset = strings_offset + name_offset;
+    out_put(o, index, (size_t) nhosts * RESULTFILE_INDEX_ENTRY);
+
+    put64(trailer, RESULTFILE_HEADER_SIZE);
+    put64(trailer + 8, records_end - RESULTFILE_HEADER_SIZE);
+    put64(trailer + 16, nrecords);
+    put64(trailer + 24, strings_offset);
+    put64(trailer + 32, index_offset);
+    put32(trailer + 40, nhosts);
+    put32(trailer + 44, f->flags);
+    memcpy(trailer + 48, RESULTFILE_END_MAGIC, 8);
+    out_put(o, trailer, sizeof(trailer));
+    out_flush(o);
+    if(o->error){
+	perror("Error writing the result file index");
+	ret = RESULTFILE_FAILURE;
+    }
+
+    free(hosts);
+    free(o);
+    free(index);
+    return ret;
+}
+
+uint32_t resultfile_hosts(resultfile* f){
+    return atomic_load(&f->next_id);
+}
+
+void resultfile_free(resultfile* f){
+    resultfile_host* h;
+    resultfile_host* next;
+    size_t i, n;
+
+    for(i = 0; i < RESULTFILE_STRIPES; i++){
+	for(n = 0; n < f->stripes[i].nbuckets; n++){
+	    for(h = f->stripes[i].buckets[n]; h; h = next){
+		next = h->next;
+		free(h->record);
+		free(h);
+	    }
+	}
+	free(f->stripes[i].buckets);
+	pthread_mutex_destroy(&f->stripes[i].lock);
+    }
+}
+
+int resultfile_open(resultfile_reader* r, const char* path){
+    const unsigned char* t;
+    struct stat st;
+    uint64_t records_offset, records_size, strings_offset, index_offset, index_end;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    fd = open(path, O_RDONLY);
+    if(fd < 0){
+	return RESULTFILE_FAILURE;
+    }
+    if(fstat(fd, &st) < 0 || st.st_size < RESULTFILE_HEADER_SIZE + RESULTFILE_TRAILER_SIZE){
+	close(fd);
+	errno = EINVAL;
+	return RESULTFILE_FAILURE;
+    }
+    r->size = st.st_size;
+    r->map = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(r->map == MAP_FAILED){
+	r->map = NULL;
+	return RESULTFILE_FAILURE;
+    }
+
+    /* every section must sit in order between header and trailer;
+     * sizes are checked by subtraction so no offset can wrap */
+    index_end = r->size - RESULTFILE_TRAILER_SIZE;
+    t = r->map + index_end;
+    records_offset = get64(t);
+    records_size = get64(t + 8);
+    strings_offset = get64(t + 24);
+    index_offset = get64(t + 32);
+    r->nrecords = get64(t + 16);
+    r->nhosts = get32(t + 40);
+    r->flags = get32(t + 44);
+    if(memcmp(r->map, RESULTFILE_MAGIC, 8) != 0 || get32(r->map + 8) != RESULTFILE_VERSION
+       || memcmp(t + 48, RESULTFILE_END_MAGIC, 8) != 0
+       || records_offset != RESULTFILE_HEADER_SIZE
+       || records_size > r->size || records_offset + records_size != strings_offset
+       || strings_offset > index_offset || index_offset > index_end
+       || r->nhosts > (index_end - index_offset) / RESULTFILE_INDEX_ENTRY
+       || index_end - index_offset != (uint64_t) r->nhosts * RESULTFILE_INDEX_ENTRY
+       || (index_offset > strings_offset && r->map[index_offset - 1] != '\0')){
+	resultfile_close(r);
+	errno = EINVAL;
+	return RESULTFILE_FAILURE;
+    }
+    r->next = r->map + records_offset;
+    r->records_end = r->map + strings_offset;
+    r->strings = r->map + strings_offset;
+    r->strings_size = index_offset - strings_offset;
+    r->index = r->map + index_offset;
+    return RESULTFILE_SUCCESS;
+}
+
+int resultfile_next(resultfile_reader* r, resultfile_entry* e){
+    const unsigned char* p = r->next;
+    const unsigned char* addr;
+    uint64_t name_offset;
+    uint32_t id;
+    size_t left = r->records_end - p;
+    size_t nbitmap, size, used = 0;
+    int v6;
+    int i;
+
+    if(left == 0){
+	return 0;
+    }
+    if(left < 6){
+	return RESULTFILE_FAILURE;
+    }
+    id = get32(p);
+    e->result = p[4];
+    e->naddrs = p[5];
+    nbitmap = (e->naddrs + 7) / 8;
+    size = 6 + nbitmap;
+    for(i = 0; i < e->naddrs && size <= left; i++){
+	size += p[6 + i / 8] & (1 << (i % 8)) ? 16 : 4;
+    }
+    if(id >= r->nhosts || size > left){
+	return RESULTFILE_FAILURE;
+    }
+    name_offset = get64(r->index + (size_t) id * RESULTFILE_INDEX_ENTRY);
+    if(name_offset >= r->strings_size){
+	return RESULTFILE_FAILURE;
+    }
+    e->hostname = (const char*) r->strings + name_offset;
+    e->count = get64(r->index + (size_t) id * RESULTFILE_INDEX_ENTRY + 8);
+
+    e->ips[0] = '\0';
+    addr = p + 6 + nbitmap;
+    for(i = 0; i < e->naddrs; i++){
+	v6 = p[6 + i / 8] & (1 << (i % 8));
+	/* the text list never held more than fits */
+	if(used + strlen(UTIL_ADDR_SEP) + INET6_ADDRSTRLEN > sizeof(e->ips)){
+	    break;
+	}
+	if(i > 0){
+	    strcpy(e->ips + used, UTIL_ADDR_SEP);
+	    used += strlen(UTIL_ADDR_SEP);
+	}
+	if(!inet_ntop(v6 ? AF_INET6 : AF_INET, addr, e->ips + used, sizeof(e->ips) - used)){
+	    e->ips[used] = '\0';
+	    break;
+	}
+	used += strlen(e->ips + used);
+	addr += v6 ? 16 : 4;
+    }
+    r->next = p + size;
+    return 1;
+}
+
+void resultfile_close(resultfile_reader* r){
+    if(r->map){
+	munmap(r->map, r->size);
+    }
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,173 @@
+/*
+ * File: resultfile.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for the binary result file, a
+ *      compact stand in for the "hostname, addresses" text that
+ *      later jobs do not have to parse. Each hostname is stored
+ *      once in a string table; each output line is a small record
+ *      naming the host by number, with its addresses packed as 4
+ *      or 16 bytes. With RESULTFILE_DEDUP there is one record per
+ *      unique hostname, in order of first appearance, and the
+ *      index says how many times the name came up.
+ *
+ *      All integers are little endian.
+ *
+ *      header      8 byte magic (RESULTFILE_MAGIC), u32 version,
+ *                  u32 flags
+ *      records     each u32 host, u8 result (0 resolved, 1
+ *                  failed), u8 address count, a bitmap of
+ *                  (count + 7) / 8 bytes with bit i set if
+ *                  address i is IPv6, then the addresses in order
+ *      strings     every hostname, NUL terminated
+ *      index       per host, u64 string offset (from the start of
+ *                  the strings) and u64 times seen
+ *      trailer     u64 records offset, u64 records size, u64
+ *                  record count, u64 strings offset, u64 index
+ *                  offset, u32 host count, u32 flags, 8 byte magic
+ *                  (RESULTFILE_END_MAGIC)
+ *
+ *      Records are written while lookups run (through the output
+ *      writer, like text lines); the rest is appended by
+ *      resultfile_finish(), so the trailer is found from the end.
+ *
+ */
+
+#ifndef RESULTFILE_H
+#define RESULTFILE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "util.h"
+
+#define RESULTFILE_FAILURE -1
+#define RESULTFILE_SUCCESS 0
+
+#define RESULTFILE_MAGIC "MLRESULT"
+#define RESULTFILE_END_MAGIC "MLRESEND"
+#define RESULTFILE_VERSION 1
+#define RESULTFILE_HEADER_SIZE 16
+#define RESULTFILE_TRAILER_SIZE 56
+#define RESULTFILE_INDEX_ENTRY 16
+
+/* flags */
+#define RESULTFILE_DEDUP 1
+
+/* record results */
+#define RESULTFILE_RESOLVED 0
+#define RESULTFILE_FAILED 1
+
+/* longest address list kept per record; longer lists lose their
+ * trailing addresses */
+#define RESULTFILE_MAX_ADDRS 255
+#define RESULTFILE_MAX_RECORD (6 + (RESULTFILE_MAX_ADDRS + 7) / 8 + RESULTFILE_MAX_ADDRS * 16)
+#define RESULTFILE_STRIPES 64
+
+/* One unique hostname */
+typedef struct resultfile_host_s{
+    struct resultfile_host_s* next;
+    uint64_t hash;
+    uint32_t id;
+    uint64_t count;                     /* times seen */
+    uint64_t first_seq;                 /* lowest sequence number seen */
+    unsigned char* record;              /* dedup: the first one's record */
+    size_t record_len;
+    size_t name_len;
+    char name[];
+} resultfile_host;
+
+typedef struct resultfile_stripe_s{
+    _Alignas(64) pthread_mutex_t lock;
+    resultfile_host** buckets;
+    size_t nbuckets;
+    size_t nhosts;
+} resultfile_stripe;
+
+typedef struct resultfile_s{
+    int flags;
+    resultfile_stripe stripes[RESULTFILE_STRIPES];
+    atomic_uint next_id;
+    /* counters */
+    atomic_long records;                /* results added */
+    atomic_long failed;                 /* of them, failed lookups */
+} resultfile;
+
+/* One record read back, with its addresses as text */
+typedef struct resultfile_entry_s{
+    const char* hostname;
+    uint64_t count;                     /* times the host was seen */
+    int result;                         /* RESULTFILE_RESOLVED or _FAILED */
+    int naddrs;
+    char ips[UTIL_ADDRLIST_SIZE];       /* joined by UTIL_ADDR_SEP */
+} resultfile_entry;
+
+typedef struct resultfile_reader_s{
+    unsigned char* map;
+    size_t size;
+    int flags;
+    uint32_t nhosts;
+    uint64_t nrecords;
+    const unsigned char* strings;
+    size_t strings_size;
+    const unsigned char* index;
+    const unsigned char* next;          /* next record */
+    const unsigned char* records_end;
+} resultfile_reader;
+
+/* Function to set up an empty result table
+ * flags is 0 or RESULTFILE_DEDUP
+ * Returns RESULTFILE_SUCCESS or RESULTFILE_FAILURE
+ */
+int resultfile_init(resultfile* f, int flags);
+
+/* Function to write the file header to fd, before any record
+ * Returns RESULTFILE_SUCCESS or RESULTFILE_FAILURE
+ */
+int resultfile_begin(resultfile* f, int fd);
+
+/* Function to add the result of looking up hostname, seq being
+ * its place in the input. ips holds len bytes of addresses
+ * joined by UTIL_ADDR_SEP, or is NULL if the lookup failed.
+ * Safe to call from many threads at once.
+ * Returns the length of the record put in record (at least
+ * RESULTFILE_MAX_RECORD bytes) for the caller to write, 0 with
+ * RESULTFILE_DEDUP (resultfile_finish() writes it), or
+ * RESULTFILE_FAILURE if out of memory
+ */
+int resultfile_add(resultfile* f, uint64_t seq, const char* hostname,
+		   const char* ips, size_t len, unsigned char* record);
+
+/* Function to append the deduplicated records, strings, index
+ * and trailer at fd's current offset, which must be the end of
+ * the records written so far
+ * Returns RESULTFILE_SUCCESS or RESULTFILE_FAILURE
+ */
+int resultfile_finish(resultfile* f, int fd);
+
+/* Function to return the number of unique hostnames added */
+uint32_t resultfile_hosts(resultfile* f);
+
+/* Function to free the result table */
+void resultfile_free(resultfile* f);
+
+/* Function to open the result file at path for reading
+ * Returns RESULTFILE_SUCCESS, or RESULTFILE_FAILURE if it cannot
+ * be read or is not a complete result file
+ */
+int resultfile_open(resultfile_reader* r, const char* path);
+
+/* Function to read the next record into e
+ * Returns 1, 0 after the last record, or RESULTFILE_FAILURE if
+ * the record is corrupt
+ */
+int resultfile_next(resultfile_reader* r, resultfile_entry* e);
+
+/* Function to close a reader */
+void resultfile_close(resultfile_reader* r);
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * File: resultfileTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the binary result file.
+ *      Records must read back as the same text, IPv4 and IPv6
+ *      mixed in their order, failures included; each hostname
+ *      must be stored once and counted; a dedup file must hold
+ *      one record per hostname in input order; many threads
+ *      adding at once must agree on the numbering; and a cut
+ *      short or damaged file must be refused.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include "resultfile.h"
+
+#define TEST_PATH "resultfileTest.tmp"
+#define TEST_THREADS 4
+#define TEST_NAMES 2000
+#define TEST_UNIQUE 100
+
+static resultfile shared;
+
+/* Store v little endian in n bytes, as the file does */
+static void put_le(unsigned char* p, uint64_t v, int n){
+    int i;
+
+    for(i = 0; i < n; i++){
+	p[i] = (unsigned char) (v >> (8 * i));
+    }
+}
+
+/* Add one result, writing its record like the output writer */
+static void add(resultfile* f, int fd, uint64_t seq, const char* hostname, const char* ips){
+    unsigned char record[RESULTFILE_MAX_RECORD];
+    int len = resultfile_add(f, seq, hostname, ips, ips ? strlen(ips) : 0, record);
+
+    if(len == RESULTFILE_FAILURE || (len > 0 && write(fd, record, len) != len)){
+	fprintf(stderr, "error: could not add %s\n", hostname);
+    }
+}
+
+static int write_file(int dedup, int fd){
+    resultfile f;
+
+    if(resultfile_init(&f, dedup ? RESULTFILE_DEDUP : 0) == RESULTFILE_FAILURE
+       || resultfile_begin(&f, fd) == RESULTFILE_FAILURE){
+	return RESULTFILE_FAILURE;
+    }
+    /* added out of input order, as resolvers finish */
+    add(&f, fd, 2, "b.example", "2001:db8::1, 192.0.2.2, 2001:db8:0:0:1::2");
+    add(&f, fd, 0, "a.example", "192.0.2.1");
+    add(&f, fd, 1, "bad.example", NULL);
+    add(&f, fd, 4, "a.example", "192.0.2.1");
+    add(&f, fd, 3, "a.example", "192.0.2.1");
+    if(resultfile_hosts(&f) != 3 || atomic_load(&f.records) != 5 || atomic_load(&f.failed) != 1){
+	fprintf(stderr, "error: counted %u hosts, %ld results\n",
+		resultfile_hosts(&f), atomic_load(&f.records));
+    }
+    if(resultfile_finish(&f, fd) == RESULTFILE_FAILURE){
+	return RESULTFILE_FAILURE;
+    }
+    resultfile_free(&f);
+    return RESULTFILE_SUCCESS;
+}
+
+/* Read TEST_PATH back as "count host, ips" lines into out */
+static int read_text(char* out, size_t size){
+    resultfile_reader r;
+    resultfile_entry e;
+    size_t used = 0;
+    int ret;
+
+    out[0] = '\0';
+    if(resultfile_open(&r, TEST_PATH) == RESULTFILE_FAILURE){
+	return RESULTFILE_FAILURE;
+    }
+    while((ret = resultfile_next(&r, &e)) == 1){
+	used += snprintf(out + used, size - used, "%d %s, %s|", (int) e.count, e.hostname, e.ips);
+	if(e.result != (strcmp(e.hostname, "bad.example") == 0 ? RESULTFILE_FAILED : RESULTFILE_RESOLVED)){
+	    fprintf(stderr, "error: wrong result for %s\n", e.hostname);
+	}
+    }
+    resultfile_close(&r);
+    return ret;
+}
+
+static void* adder(void* arg){
+    unsigned char record[RESULTFILE_MAX_RECORD];
+    long self = (long) arg;
+    char name[32];
+    int i;
+
+    for(i = 0; i < TEST_NAMES; i++){
+	snprintf(name, sizeof(name), "host%d.example", (int) (self * 7 + i) % TEST_UNIQUE);
+	if(resultfile_add(&shared, self * TEST_NAMES + i, name, "192.0.2.9", 9, record) < 0){
+	    fprintf(stderr, "error: thread %ld could not add\n", self);
+	    break;
+	}
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    pthread_t threads[TEST_THREADS];
+    resultfile_reader r;
+    resultfile_entry e;
+    char text[1024];
+    unsigned char damaged[RESULTFILE_HEADER_SIZE + RESULTFILE_TRAILER_SIZE];
+    long total = 0;
+    off_t size;
+    int fd;
+    long i;
+
+    /* Test records read back as the text they came from */
+    fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || write_file(0, fd) == RESULTFILE_FAILURE){
+	fprintf(stderr, "error: could not write a result file\n");
+	return 0;
+    }
+    close(fd);
+    if(read_text(text, sizeof(text)) != 0
+       || strcmp(text, "1 b.example, 2001:db8::1, 192.0.2.2, 2001:db8::1:0:0:2|"
+		 "3 a.example, 192.0.2.1|1 bad.example, |3 a.example, 192.0.2.1|"
+		 "3 a.example, 192.0.2.1|") != 0){
+	fprintf(stderr, "error: records read back as %s\n", text);
+    }
+
+    /* Test counts and the hostnames stored once */
+    if(resultfile_open(&r, TEST_PATH) == RESULTFILE_FAILURE){
+	fprintf(stderr, "error: could not reopen the result file\n");
+	return 0;
+    }
+    if(r.nhosts != 3 || r.nrecords != 5
+       || r.strings_size != sizeof("b.example") + sizeof("a.example") + sizeof("bad.example")){
+	fprintf(stderr, "error: %u hosts, %lu records, %zu string bytes\n",
+		r.nhosts, (unsigned long) r.nrecords, r.strings_size);
+    }
+    while(resultfile_next(&r, &e) == 1){
+	total += strcmp(e.hostname, "a.example") == 0 && e.count == 3;
+    }
+    if(total != 3){
+	fprintf(stderr, "error: a.example has %ld records counting 3\n", total);
+    }
+    resultfile_close(&r);
+
+    /* Test dedup keeps one record per host in input order */
+    fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || write_file(1, fd) == RESULTFILE_FAILURE){
+	fprintf(stderr, "error: could not write a dedup file\n");
+	return 0;
+    }
+    size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    if(read_text(text, sizeof(text)) != 0
+       || strcmp(text, "3 a.example, 192.0.2.1|1 bad.example, |"
+		 "1 b.example, 2001:db8::1, 192.0.2.2, 2001:db8::1:0:0:2|") != 0){
+	fprintf(stderr, "error: dedup records read back as %s\n", text);
+    }
+
+    /* Test a file cut short is refused */
+    if(truncate(TEST_PATH, size - 1) < 0 || resultfile_open(&r, TEST_PATH) != RESULTFILE_FAILURE){
+	fprintf(stderr, "error: a cut short file was accepted\n");
+    }
+
+    /* Test an index offset that wraps past the trailer is refused */
+    memset(damaged, 0, sizeof(damaged));
+    memcpy(damaged, RESULTFILE_MAGIC, 8);
+    put_le(damaged + 8, RESULTFILE_VERSION, 4);
+    put_le(damaged + 16, RESULTFILE_HEADER_SIZE, 8);
+    put_le(damaged + 40, RESULTFILE_HEADER_SIZE, 8);
+    put_le(damaged + 48, RESULTFILE_HEADER_SIZE - 2 * RESULTFILE_INDEX_ENTRY, 8);
+    put_le(damaged + 56, 2, 4);
+    memcpy(damaged + 64, RESULTFILE_END_MAGIC, 8);
+    fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || write(fd, damaged, sizeof(damaged)) != (ssize_t) sizeof(damaged)){
+	fprintf(stderr, "error: could not write a damaged file\n");
+	return 0;
+    }
+    close(fd);
+    if(resultfile_open(&r, TEST_PATH) != RESULTFILE_FAILURE){
+	fprintf(stderr, "error: a wrapped index offset was accepted\n");
+	resultfile_close(&r);
+    }
+
+    /* Test many threads agree on the numbering */
+    if(resultfile_init(&shared, RESULTFILE_DEDUP) == RESULTFILE_FAILURE){
+	fprintf(stderr, "error: could not set up a shared table\n");
+	return 0;
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_create(&threads[i], NULL, adder, (void*) i);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(threads[i], NULL);
+    }
+    fd = open(TEST_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || resultfile_begin(&shared, fd) == RESULTFILE_FAILURE
+       || resultfile_finish(&shared, fd) == RESULTFILE_FAILURE){
+	fprintf(stderr, "error: could not write the shared table\n");
+	return 0;
+    }
+    close(fd);
+    resultfile_free(&shared);
+    total = 0;
+    if(resultfile_open(&r, TEST_PATH) == RESULTFILE_FAILURE || r.nhosts != TEST_UNIQUE){
+	fprintf(stderr, "error: shared table has %u hosts\n", r.nhosts);
+    }
+    for(i = 0; resultfile_next(&r, &e) == 1; i++){
+	total += e.count;
+	/* host0 is first in thread 0's input, host1 next */
+	if(i < 2 && strcmp(e.hostname, i ? "host1.example" : "host0.example") != 0){
+	    fprintf(stderr, "error: dedup record %ld is %s\n", i, e.hostname);
+	}
+    }
+    if(i != TEST_UNIQUE || total != TEST_THREADS * TEST_NAMES){
+	fprintf(stderr, "error: %ld records counting %ld names\n", i, total);
+    }
+    resultfile_close(&r);
+    unlink(TEST_PATH);
+
+    return 0;
+}
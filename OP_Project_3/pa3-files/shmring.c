@@ -0,0 +1,225 @@
+/*
+ * File: shmring.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the shared memory ring buffer. head and
+ *      tail only grow; a byte's place in data is its position
+ *      modulo size, so a batch wraps with two memcpy calls and
+ *      a record header, 8 byte aligned, never does. Condvars
+ *      are only signalled when someone sleeps on them.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "shmring.h"
+
+static size_t padded(size_t len){
+    return (len + 7) & ~(size_t) 7;
+}
+
+/* Note the ring broken once a dead process's lock is recovered */
+static void ring_recover(shmring* r, int ret){
+    if(ret == EOWNERDEAD){
+	pthread_mutex_consistent(&r->lock);
+	r->broken = 1;
+	r->closed = 1;
+	pthread_cond_broadcast(&r->readable);
+	pthread_cond_broadcast(&r->writable);
+    }
+}
+
+static void ring_lock(shmring* r){
+    ring_recover(r, pthread_mutex_lock(&r->lock));
+}
+
+static void ring_wait(shmring* r, pthread_cond_t* cond){
+    ring_recover(r, pthread_cond_wait(cond, &r->lock));
+}
+
+static void copy_in(shmring* r, uint64_t pos, const void* src, size_t n){
+    size_t at = pos & (r->size - 1);
+    size_t first = n < r->size - at ? n : r->size - at;
+
+    memcpy(r->data + at, src, first);
+    memcpy(r->data, (const unsigned char*) src + first, n - first);
+}
+
+static void copy_out(shmring* r, uint64_t pos, void* dst, size_t n){
+    size_t at = pos & (r->size - 1);
+    size_t first = n < r->size - at ? n : r->size - at;
+
+    memcpy(dst, r->data + at, first);
+    memcpy((unsigned char*) dst + first, r->data, n - first);
+}
+
+shmring* shmring_create(size_t size){
+    pthread_mutexattr_t mattr;
+    pthread_condattr_t cattr;
+    size_t data_size = SHMRING_MIN_SIZE;
+    size_t map_size;
+    shmring* r;
+
+    while(data_size < size){
+	data_size <<= 1;
+    }
+    map_size = sizeof(shmring) + data_size;
+    r = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(r == MAP_FAILED){
+	perror("Error mapping a shared ring");
+	return NULL;
+    }
+    memset(r, 0, sizeof(*r));
+    r->size = data_size;
+    r->map_size = map_size;
+
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    if(pthread_mutex_init(&r->lock, &mattr) || pthread_cond_init(&r->readable, &cattr)
+       || pthread_cond_init(&r->writable, &cattr)){
+	fprintf(stderr, "Error setting up a shared ring's locks\n");
+	munmap(r, map_size);
+	r = NULL;
+    }
+    pthread_mutexattr_destroy(&mattr);
+    pthread_condattr_destroy(&cattr);
+
+    return r;
+}
+
+void* shmring_reserve(void* buf, size_t size, size_t* used, size_t len){
+    unsigned char* at = (unsigned char*) buf + *used;
+    uint32_t header[2] = {(uint32_t) len, 0};
+
+    if(len > UINT32_MAX || *used + SHMRING_HEADER + padded(len) > size){
+	return NULL;
+    }
+    memcpy(at, header, sizeof(header));
+    *used += SHMRING_HEADER + padded(len);
+    return at + SHMRING_HEADER;
+}
+
+void* shmring_next(void* buf, size_t bytes, size_t* off, size_t* len){
+    unsigned char* at = (unsigned char*) buf + *off;
+    uint32_t header[2];
+
+    if(*off + SHMRING_HEADER > bytes){
+	return NULL;
+    }
+    memcpy(header, at, sizeof(header));
+    *len = header[0];
+    *off += SHMRING_HEADER + padded(header[0]);
+    return at + SHMRING_HEADER;
+}
+
+int shmring_write(shmring* r, const void* buf, size_t bytes){
+    int waited = 0;
+
+    if(bytes > r->size){
+	return SHMRING_FAILURE;
+    }
+    ring_lock(r);
+    while(!r->closed && r->size - (r->head - r->tail) < bytes){
+	if(!waited){
+	    r->write_waits++;
+	    waited = 1;
+	}
+	r->writers_waiting++;
+	ring_wait(r, &r->writable);
+	r->writers_waiting--;
+    }
+    if(r->closed){
+	pthread_mutex_unlock(&r->lock);
+	return SHMRING_FAILURE;
+    }
+
+    copy_in(r, r->head, buf, bytes);
+    r->head += bytes;
+    r->writes++;
+    if(r->head - r->tail > r->peak){
+	r->peak = r->head - r->tail;
+    }
+    if(r->readers_waiting){
+	pthread_cond_broadcast(&r->readable);
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    return SHMRING_SUCCESS;
+}
+
+long shmring_read(shmring* r, void* buf, size_t size, int max){
+    uint32_t header[2];
+    uint64_t pos;
+    size_t bytes = 0;
+    int count = 0;
+    int waited = 0;
+
+    ring_lock(r);
+    while(r->head == r->tail && !r->closed){
+	if(!waited){
+	    r->read_waits++;
+	    waited = 1;
+	}
+	r->readers_waiting++;
+	ring_wait(r, &r->readable);
+	r->readers_waiting--;
+    }
+    if(r->broken){
+	pthread_mutex_unlock(&r->lock);
+	return SHMRING_FAILURE;
+    }
+
+    /* as many whole records as buf and max allow */
+    for(pos = r->tail; pos < r->head && (max <= 0 || count < max); count++){
+	memcpy(header, r->data + (pos & (r->size - 1)), sizeof(header));
+	if(bytes + SHMRING_HEADER + padded(header[0]) > size){
+	    break;
+	}
+	bytes += SHMRING_HEADER + padded(header[0]);
+	pos += SHMRING_HEADER + padded(header[0]);
+    }
+    if(bytes == 0 && r->head != r->tail){
+	pthread_mutex_unlock(&r->lock);
+	return SHMRING_FAILURE;
+    }
+
+    copy_out(r, r->tail, buf, bytes);
+    r->tail += bytes;
+    if(bytes > 0){
+	r->reads++;
+    }
+    /* what is left is for the next sleeping reader */
+    if(r->readers_waiting && r->head != r->tail){
+	pthread_cond_signal(&r->readable);
+    }
+    if(r->writers_waiting && bytes > 0){
+	pthread_cond_broadcast(&r->writable);
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    return (long) bytes;
+}
+
+void shmring_close(shmring* r){
+    ring_lock(r);
+    r->closed = 1;
+    pthread_cond_broadcast(&r->readable);
+    pthread_cond_broadcast(&r->writable);
+    pthread_mutex_unlock(&r->lock);
+}
+
+void shmring_destroy(shmring* r){
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->readable);
+    pthread_cond_destroy(&r->writable);
+    munmap(r, r->map_size);
+}
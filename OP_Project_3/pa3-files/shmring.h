@@ -0,0 +1,103 @@
+/*
+ * File: shmring.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a ring buffer in shared memory,
+ *      for passing records between processes. Create it before
+ *      fork() and every child sees the same ring. Records have
+ *      any length up to the ring's size; each is a 8 byte header
+ *      and its bytes padded to 8.
+ *
+ *      A writer packs records into a batch of its own with
+ *      shmring_reserve() and moves the whole batch in with one
+ *      shmring_write(); a reader takes whole records out in one
+ *      shmring_read() and steps through them with shmring_next().
+ *      Any number of threads in any number of processes may
+ *      write and read at once; one process-shared mutex guards
+ *      the positions. The mutex is robust: if a process dies
+ *      holding it, the next one to lock it marks the ring broken
+ *      and closed rather than waiting forever.
+ *
+ */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define SHMRING_FAILURE -1
+#define SHMRING_SUCCESS 0
+
+#define SHMRING_HEADER 8
+#define SHMRING_MIN_SIZE 4096
+
+typedef struct shmring_s{
+    pthread_mutex_t lock;
+    pthread_cond_t readable;
+    pthread_cond_t writable;
+    uint64_t head;              /* bytes ever written */
+    uint64_t tail;              /* bytes ever read */
+    size_t size;                /* data bytes, a power of two */
+    size_t map_size;
+    int readers_waiting;
+    int writers_waiting;
+    int closed;                 /* no more writes; reads drain */
+    int broken;                 /* a process died holding the lock */
+    /* counters, read under lock or after the writers are done */
+    long writes;
+    long reads;
+    long write_waits;           /* writes that found no room */
+    long read_waits;            /* reads that found it empty */
+    uint64_t peak;              /* most bytes held at once */
+    _Alignas(64) unsigned char data[];
+} shmring;
+
+/* Function to map a new ring of at least size data bytes
+ * (rounded up to a power of two, SHMRING_MIN_SIZE or more)
+ * shared with every process forked after it
+ * Returns the ring, or NULL on failure
+ */
+shmring* shmring_create(size_t size);
+
+/* Function to add a len byte record to the batch in buf (size
+ * bytes, *used of them filled), which should be 8 byte aligned
+ * Returns where to write the record's bytes, or NULL if it
+ * does not fit
+ */
+void* shmring_reserve(void* buf, size_t size, size_t* used, size_t len);
+
+/* Function to step through the records of a batch of bytes
+ * bytes from *off on; stores the record's length in *len
+ * Returns the record, or NULL after the last one
+ */
+void* shmring_next(void* buf, size_t bytes, size_t* off, size_t* len);
+
+/* Function to move a batch of bytes bytes into the ring,
+ * sleeping until there is room for all of it
+ * Returns SHMRING_SUCCESS, or SHMRING_FAILURE if the ring is
+ * closed or the batch is bigger than the ring
+ */
+int shmring_write(shmring* r, const void* buf, size_t bytes);
+
+/* Function to take whole records out of the ring into buf
+ * (size bytes), at most max of them (0: no limit), sleeping
+ * while the ring is empty
+ * Returns the bytes taken, 0 once closed and drained, or
+ * SHMRING_FAILURE if the ring is broken or the next record is
+ * bigger than size
+ */
+long shmring_read(shmring* r, void* buf, size_t size, int max);
+
+/* Function to end writing: sleeping readers and writers wake,
+ * and reads return 0 once what is left is read
+ */
+void shmring_close(shmring* r);
+
+/* Function to unmap the ring; no process may use it after */
+void shmring_destroy(shmring* r);
+
+#endif
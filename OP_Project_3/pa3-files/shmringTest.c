@@ -0,0 +1,183 @@
+/*
+ * File: shmringTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the shared memory ring.
+ *      Records packed into a batch must step back out the same;
+ *      records of every length written by two child processes
+ *      through a small ring must arrive whole and in each
+ *      writer's order, then the closed ring must read as done;
+ *      oversized batches and records must be refused; and a
+ *      process dying with the lock held must leave the ring
+ *      broken, not hung.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "shmring.h"
+
+#define TEST_WRITERS 2
+#define TEST_RECORDS 20000
+#define TEST_RING 4096
+
+/* Record i of writer w: its ids, then i % 300 bytes from them */
+static size_t fill(unsigned char* rec, int w, int i){
+    size_t len = 8 + i % 300;
+    size_t j;
+
+    memcpy(rec, &w, sizeof(w));
+    memcpy(rec + 4, &i, sizeof(i));
+    for(j = 8; j < len; j++){
+	rec[j] = (unsigned char) (w * 31 + i + j);
+    }
+    return len;
+}
+
+static int check(const unsigned char* rec, size_t len, int* w, int* i){
+    unsigned char want[320];
+
+    memcpy(w, rec, sizeof(*w));
+    memcpy(i, rec + 4, sizeof(*i));
+    return *w >= 0 && *w < TEST_WRITERS && len == fill(want, *w, *i) && memcmp(rec, want, len) == 0;
+}
+
+/* Child: write every record in batches of up to 7 */
+static void writer(shmring* r, int w){
+    _Alignas(8) unsigned char batch[TEST_RING / 2];
+    unsigned char rec[320];
+    size_t used = 0;
+    void* at;
+    size_t len;
+    int i;
+
+    for(i = 0; i < TEST_RECORDS; i++){
+	len = fill(rec, w, i);
+	if(i % 7 == 0 || !(at = shmring_reserve(batch, sizeof(batch), &used, len))){
+	    if(used > 0 && shmring_write(r, batch, used) == SHMRING_FAILURE){
+		_exit(1);
+	    }
+	    used = 0;
+	    at = shmring_reserve(batch, sizeof(batch), &used, len);
+	}
+	memcpy(at, rec, len);
+    }
+    if(used > 0 && shmring_write(r, batch, used) == SHMRING_FAILURE){
+	_exit(1);
+    }
+    _exit(0);
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    _Alignas(8) unsigned char buf[TEST_RING];
+    int next[TEST_WRITERS] = {0};
+    pid_t pids[TEST_WRITERS];
+    unsigned char* rec;
+    size_t used = 0;
+    size_t off;
+    size_t len;
+    shmring* r;
+    long got;
+    long bad = 0;
+    int status;
+    int reads = 0;
+    int w, i;
+
+    /* Test records step back out of a batch */
+    rec = shmring_reserve(buf, 64, &used, 5);
+    memcpy(rec, "hello", 5);
+    rec = shmring_reserve(buf, 64, &used, 0);
+    if(used != 24 || shmring_reserve(buf, 64, &used, 33)){
+	fprintf(stderr, "error: reserved up to %zu bytes\n", used);
+    }
+    off = 0;
+    rec = shmring_next(buf, used, &off, &len);
+    if(!rec || len != 5 || memcmp(rec, "hello", 5) != 0
+       || !shmring_next(buf, used, &off, &len) || len != 0 || shmring_next(buf, used, &off, &len)){
+	fprintf(stderr, "error: batch read back wrong\n");
+    }
+
+    /* Test two writer processes through a ring that wraps */
+    r = shmring_create(TEST_RING);
+    if(!r || r->size != TEST_RING){
+	fprintf(stderr, "error: could not create a ring\n");
+	return 0;
+    }
+    for(w = 0; w < TEST_WRITERS; w++){
+	pids[w] = fork();
+	if(pids[w] == 0){
+	    writer(r, w);
+	}
+    }
+    while(next[0] < TEST_RECORDS || next[1] < TEST_RECORDS){
+	got = shmring_read(r, buf, sizeof(buf), reads++ % 5);
+	if(got <= 0){
+	    fprintf(stderr, "error: read returned %ld\n", got);
+	    break;
+	}
+	off = 0;
+	while((rec = shmring_next(buf, got, &off, &len))){
+	    if(!check(rec, len, &w, &i) || i != next[w]){
+		bad++;
+	    }
+	    else{
+		next[w]++;
+	    }
+	}
+    }
+    for(w = 0; w < TEST_WRITERS; w++){
+	if(waitpid(pids[w], &status, 0) != pids[w] || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+	    fprintf(stderr, "error: writer %d failed\n", w);
+	}
+    }
+    if(bad || next[0] != TEST_RECORDS || next[1] != TEST_RECORDS || r->peak > r->size){
+	fprintf(stderr, "error: %ld bad records, got %d and %d\n", bad, next[0], next[1]);
+    }
+
+    /* Test a closed ring drains to 0 and refuses writes */
+    used = 0;
+    shmring_reserve(buf, sizeof(buf), &used, 100);
+    shmring_write(r, buf, used);
+    shmring_close(r);
+    if(shmring_read(r, buf, sizeof(buf), 0) != (long) used || shmring_read(r, buf, sizeof(buf), 0) != 0
+       || shmring_write(r, buf, used) != SHMRING_FAILURE){
+	fprintf(stderr, "error: closed ring did not drain\n");
+    }
+    shmring_destroy(r);
+
+    /* Test oversized batches and records are refused */
+    r = shmring_create(0);
+    used = 0;
+    shmring_reserve(buf, sizeof(buf), &used, 100);
+    shmring_write(r, buf, used);
+    if(shmring_write(r, buf, r->size + 8) != SHMRING_FAILURE
+       || shmring_read(r, buf, 64, 0) != SHMRING_FAILURE
+       || shmring_read(r, buf, sizeof(buf), 0) != (long) used){
+	fprintf(stderr, "error: oversized batch or record accepted\n");
+    }
+
+    /* Test a process dying with the lock breaks the ring */
+    if(fork() == 0){
+	pthread_mutex_lock(&r->lock);
+	_exit(0);
+    }
+    wait(&status);
+    if(shmring_read(r, buf, sizeof(buf), 0) != SHMRING_FAILURE || !r->broken
+       || shmring_write(r, buf, used) != SHMRING_FAILURE){
+	fprintf(stderr, "error: ring not broken by a dead lock holder\n");
+    }
+    shmring_destroy(r);
+
+    return 0;
+}
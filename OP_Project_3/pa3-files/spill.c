@@ -0,0 +1,202 @@
+/*
+ * File: spill.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the spill file. The oldest records are
+ *      in rbuf, then in the file between read_off and write_off,
+ *      then in wbuf from wpos; a reader that has caught up with
+ *      the file takes records straight from wbuf.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "spill.h"
+
+#define SPILL_TEMPLATE "/multi-lookup-spill-XXXXXX"
+
+static int spill_pwrite(int fd, const char* buf, size_t len, off_t off){
+    ssize_t n;
+
+    while(len > 0){
+	n = pwrite(fd, buf, len, off);
+	if(n < 0){
+	    if(errno == EINTR){
+		continue;
+	    }
+	    return SPILL_FAILURE;
+	}
+	buf += n;
+	len -= n;
+	off += n;
+    }
+    return SPILL_SUCCESS;
+}
+
+/* Write out what is left of wbuf; the lock is held */
+static int spill_flush(spill* s){
+    size_t len = s->wlen - s->wpos;
+
+    if(len > 0){
+	if(spill_pwrite(s->fd, s->wbuf + s->wpos, len, s->write_off) == SPILL_FAILURE){
+	    return SPILL_FAILURE;
+	}
+	s->write_off += len;
+	atomic_fetch_add_explicit(&s->file_bytes, len, memory_order_relaxed);
+    }
+    s->wpos = 0;
+    s->wlen = 0;
+    return SPILL_SUCCESS;
+}
+
+int spill_init(spill* s, const char* dir, size_t record_size){
+    char* path;
+
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+    if(record_size == 0 || record_size > SPILL_BUFFER_SIZE){
+	return SPILL_FAILURE;
+    }
+    s->record_size = record_size;
+
+    if(!dir){
+	dir = getenv("TMPDIR");
+    }
+    if(!dir || !*dir){
+	dir = "/tmp";
+    }
+    path = malloc(strlen(dir) + sizeof(SPILL_TEMPLATE));
+    if(!path){
+	return SPILL_FAILURE;
+    }
+    strcpy(path, dir);
+    strcat(path, SPILL_TEMPLATE);
+    s->fd = mkstemp(path);
+    if(s->fd < 0){
+	fprintf(stderr, "Error creating spill file in %s: %s\n", dir, strerror(errno));
+	free(path);
+	return SPILL_FAILURE;
+    }
+    /* gone from the directory as soon as it is closed */
+    unlink(path);
+    free(path);
+    pthread_mutex_init(&s->lock, NULL);
+
+    s->rbuf = malloc(SPILL_BUFFER_SIZE);
+    s->wbuf = malloc(SPILL_BUFFER_SIZE);
+    if(!s->rbuf || !s->wbuf){
+	spill_cleanup(s);
+	return SPILL_FAILURE;
+    }
+    atomic_init(&s->pending, 0);
+    atomic_init(&s->puts, 0);
+    atomic_init(&s->peak, 0);
+    atomic_init(&s->file_bytes, 0);
+    return SPILL_SUCCESS;
+}
+
+int spill_put(spill* s, const void* records, int count){
+    /* whole records only, so a buffer never splits one */
+    size_t cap = SPILL_BUFFER_SIZE - SPILL_BUFFER_SIZE % s->record_size;
+    const char* src = records;
+    size_t left = count * s->record_size;
+    size_t n;
+    long pending;
+    long peak;
+
+    pthread_mutex_lock(&s->lock);
+    while(left > 0){
+	if(s->wlen == cap && spill_flush(s) == SPILL_FAILURE){
+	    pthread_mutex_unlock(&s->lock);
+	    return SPILL_FAILURE;
+	}
+	n = cap - s->wlen < left ? cap - s->wlen : left;
+	memcpy(s->wbuf + s->wlen, src, n);
+	s->wlen += n;
+	src += n;
+	left -= n;
+    }
+    atomic_fetch_add_explicit(&s->puts, count, memory_order_relaxed);
+    pending = atomic_fetch_add_explicit(&s->pending, count, memory_order_release) + count;
+    peak = atomic_load_explicit(&s->peak, memory_order_relaxed);
+    if(pending > peak){
+	atomic_store_explicit(&s->peak, pending, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return SPILL_SUCCESS;
+}
+
+int spill_get(spill* s, void* records, int max){
+    char* dst = records;
+    size_t want = max * s->record_size;
+    size_t got = 0;
+    size_t n;
+    ssize_t r;
+
+    pthread_mutex_lock(&s->lock);
+    while(got < want){
+	if(s->rpos < s->rlen){
+	    n = s->rlen - s->rpos < want - got ? s->rlen - s->rpos : want - got;
+	    memcpy(dst + got, s->rbuf + s->rpos, n);
+	    s->rpos += n;
+	    got += n;
+	}
+	else if(s->read_off < s->write_off){
+	    n = s->write_off - s->read_off;
+	    if(n > SPILL_BUFFER_SIZE){
+		n = SPILL_BUFFER_SIZE - SPILL_BUFFER_SIZE % s->record_size;
+	    }
+	    r = pread(s->fd, s->rbuf, n, s->read_off);
+	    if(r < 0 && errno == EINTR){
+		continue;
+	    }
+	    if(r <= 0){
+		pthread_mutex_unlock(&s->lock);
+		return SPILL_FAILURE;
+	    }
+	    s->rpos = 0;
+	    s->rlen = r;
+	    s->read_off += r;
+	}
+	else if(s->wpos < s->wlen){
+	    n = s->wlen - s->wpos < want - got ? s->wlen - s->wpos : want - got;
+	    memcpy(dst + got, s->wbuf + s->wpos, n);
+	    s->wpos += n;
+	    got += n;
+	}
+	else{
+	    break;
+	}
+    }
+
+    /* all caught up: start the file over */
+    if(s->rpos == s->rlen && s->read_off == s->write_off && s->wpos == s->wlen){
+	if(s->write_off > 0 && ftruncate(s->fd, 0) == 0){
+	    s->read_off = 0;
+	    s->write_off = 0;
+	}
+	s->rpos = s->rlen = 0;
+	s->wpos = s->wlen = 0;
+    }
+    atomic_fetch_sub_explicit(&s->pending, got / s->record_size, memory_order_relaxed);
+    pthread_mutex_unlock(&s->lock);
+    return got / s->record_size;
+}
+
+void spill_cleanup(spill* s){
+    if(s->fd >= 0){
+	close(s->fd);
+	pthread_mutex_destroy(&s->lock);
+    }
+    s->fd = -1;
+    free(s->rbuf);
+    free(s->wbuf);
+    s->rbuf = NULL;
+    s->wbuf = NULL;
+}
@@ -0,0 +1,74 @@
+/*
+ * File: spill.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a spill file: a FIFO of fixed
+ *      size records kept in an unlinked temporary file, for work
+ *      that does not fit in a bounded in memory queue. Records
+ *      are appended through a 64 KiB write buffer and read back
+ *      through a 64 KiB read buffer; once every record written
+ *      has been read the file is truncated, so it only grows as
+ *      far as the largest backlog.
+ *
+ *      Any number of threads may put and get at once; one mutex
+ *      guards the buffers and offsets.
+ *
+ */
+
+#ifndef SPILL_H
+#define SPILL_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define SPILL_FAILURE -1
+#define SPILL_SUCCESS 0
+
+#define SPILL_BUFFER_SIZE (64 * 1024)
+
+typedef struct spill_s{
+    pthread_mutex_t lock;
+    int fd;
+    size_t record_size;
+    /* records are read from rbuf, then the file, then wbuf */
+    char* rbuf;
+    size_t rpos;
+    size_t rlen;
+    off_t read_off;
+    off_t write_off;
+    char* wbuf;
+    size_t wpos;
+    size_t wlen;
+    /* records put and not yet got */
+    atomic_long pending;
+    atomic_long puts;
+    atomic_long peak;
+    atomic_llong file_bytes;
+} spill;
+
+/* Function to create the spill file in dir (NULL for $TMPDIR
+ * or /tmp). record_size must be at most SPILL_BUFFER_SIZE.
+ */
+int spill_init(spill* s, const char* dir, size_t record_size);
+
+/* Function to append count records */
+int spill_put(spill* s, const void* records, int count);
+
+/* Function to take up to max records, oldest first
+ * Returns the number taken (0 if none are pending), or
+ * SPILL_FAILURE if the file could not be read
+ */
+int spill_get(spill* s, void* records, int max);
+
+static inline long spill_pending(spill* s){
+    return atomic_load_explicit(&s->pending, memory_order_acquire);
+}
+
+/* Function to close and free the spill file */
+void spill_cleanup(spill* s);
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * File: spillTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the spill file. Records
+ *      put and got in uneven runs, past the buffer size and while
+ *      the reader is caught up with the writer, must come back
+ *      once each in order; and records put by several threads
+ *      while another gets must all come back exactly once.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "spill.h"
+
+#define TEST_THREADS 4
+#define TEST_RECORDS 200000
+
+/* not a power of two, so records straddle 4 KiB blocks */
+typedef struct test_record_s{
+    long id;
+    char pad[28];
+} test_record;
+
+static spill shared;
+static atomic_int putters_done;
+
+static void* put_many(void* arg){
+    long base = *(long*) arg;
+    test_record r[7];
+    long i;
+    int j;
+
+    memset(r, 0, sizeof(r));
+    for(i = 0; i < TEST_RECORDS; i += 7){
+	for(j = 0; j < 7; j++){
+	    r[j].id = base + i + j;
+	}
+	spill_put(&shared, r, i + 7 <= TEST_RECORDS ? 7 : TEST_RECORDS - i);
+    }
+    atomic_fetch_add(&putters_done, 1);
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static test_record out[5000];
+    static char seen[TEST_THREADS * TEST_RECORDS];
+    test_record in[5000];
+    spill s;
+    pthread_t ids[TEST_THREADS];
+    long bases[TEST_THREADS];
+    long next_put = 0;
+    long next_get = 0;
+    long total = 0;
+    int round;
+    int i, n;
+
+    if(spill_init(&s, NULL, sizeof(test_record)) != SPILL_SUCCESS){
+	fprintf(stderr, "error: could not create a spill file\n");
+	return 0;
+    }
+
+    /* Test FIFO order through every buffer state */
+    memset(in, 0, sizeof(in));
+    for(round = 0; round < 200; round++){
+	int puts = (round * 7919) % 5000 + 1;
+	int gets = (round * 104729) % 4000 + 1;
+	for(i = 0; i < puts; i++){
+	    in[i].id = next_put++;
+	}
+	if(spill_put(&s, in, puts) != SPILL_SUCCESS){
+	    fprintf(stderr, "error: put failed in round %d\n", round);
+	    break;
+	}
+	n = spill_get(&s, out, gets);
+	for(i = 0; i < n; i++){
+	    if(out[i].id != next_get++){
+		fprintf(stderr, "error: got %ld expected %ld\n", out[i].id, next_get - 1);
+		round = 200;
+		break;
+	    }
+	}
+    }
+    while((n = spill_get(&s, out, 5000)) > 0){
+	for(i = 0; i < n; i++){
+	    if(out[i].id != next_get++){
+		fprintf(stderr, "error: drained %ld expected %ld\n", out[i].id, next_get - 1);
+		break;
+	    }
+	}
+    }
+    if(next_get != next_put || spill_pending(&s) != 0 || atomic_load(&s.puts) != next_put){
+	fprintf(stderr, "error: put %ld got %ld, %ld pending\n", next_put, next_get, spill_pending(&s));
+    }
+    if(atomic_load(&s.file_bytes) == 0){
+	fprintf(stderr, "error: nothing reached the file\n");
+    }
+    spill_cleanup(&s);
+
+    /* Test concurrent puts with one getter */
+    if(spill_init(&shared, NULL, sizeof(test_record)) != SPILL_SUCCESS){
+	fprintf(stderr, "error: could not create a spill file\n");
+	return 0;
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	bases[i] = (long) i * TEST_RECORDS;
+	pthread_create(&ids[i], NULL, put_many, &bases[i]);
+    }
+    for(;;){
+	int done = atomic_load(&putters_done) == TEST_THREADS;
+	n = spill_get(&shared, out, 5000);
+	for(i = 0; i < n; i++){
+	    if(out[i].id < 0 || out[i].id >= TEST_THREADS * TEST_RECORDS || seen[out[i].id]++){
+		fprintf(stderr, "error: bad or repeated record %ld\n", out[i].id);
+	    }
+	}
+	total += n;
+	if(done && n == 0){
+	    break;
+	}
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(ids[i], NULL);
+    }
+    if(total != TEST_THREADS * TEST_RECORDS){
+	fprintf(stderr, "error: got %ld of %d records\n", total, TEST_THREADS * TEST_RECORDS);
+    }
+    spill_cleanup(&shared);
+
+    return 0;
+}
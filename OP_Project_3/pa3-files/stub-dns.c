@@ -0,0 +1,240 @@
+/*
+ * File: stub-dns.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	A tiny UDP nameserver on 127.0.0.1 for testing the async
+ *      DNS engine without a network. Every A query is answered
+ *      with the same 10.x.y.z address stub-resolver.so gives,
+ *      except names ending in ".invalid" (NXDOMAIN) and
+ *      ".servfail" (SERVFAIL).
+ *
+ *      Usage: stub-dns [-p port] [-d delayMs] [-l lossPct] [-b]
+ *      -p 0 picks a free port. The port is printed as
+ *      "listening on port N" once the socket is bound.
+ *      -d holds each answer back, -l drops that percentage of
+ *      queries, and -b sends a reply with the wrong ID before
+ *      each real one.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#define STUB_MAX_PACKET 512
+#define STUB_MAX_PENDING 65536
+#define STUB_HEADER_SIZE 12
+#define STUB_SOCKBUF (4 * 1024 * 1024)
+
+/* A reply waiting out the configured delay */
+typedef struct stub_pending_s{
+    long long due_ns;
+    struct sockaddr_storage to;
+    socklen_t tolen;
+    int len;
+    unsigned char packet[STUB_MAX_PACKET];
+} stub_pending;
+
+static stub_pending* pending;
+static int pending_head = 0;
+static int pending_count = 0;
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int ends_with(const char* s, const char* suffix){
+    size_t n = strlen(s);
+    size_t m = strlen(suffix);
+    return n >= m && strcasecmp(s + n - m, suffix) == 0;
+}
+
+/* Turn query into its reply in place. Returns the reply
+ * length, or -1 to ignore the packet. */
+static int build_reply(unsigned char* buf, int len){
+    char name[256];
+    int off = STUB_HEADER_SIZE;
+    int n = 0;
+    int qend;
+    int rcode = 0;
+    unsigned long hash = 5381;
+    unsigned long addr;
+    const char* c;
+
+    if(len < STUB_HEADER_SIZE || (buf[2] & 0x80)
+       || buf[4] != 0 || buf[5] != 1){
+	return -1;
+    }
+    while(off < len && buf[off] != 0){
+	int l = buf[off];
+	if(l > 63 || off + 1 + l >= len || n + l + 1 >= (int) sizeof(name)){
+	    return -1;
+	}
+	if(n){
+	    name[n++] = '.';
+	}
+	memcpy(name + n, buf + off + 1, l);
+	n += l;
+	off += l + 1;
+    }
+    name[n] = '\0';
+    qend = off + 5;
+    if(qend > len){
+	return -1;
+    }
+
+    if(ends_with(name, ".invalid")){
+	rcode = 3;
+    }
+    else if(ends_with(name, ".servfail")){
+	rcode = 2;
+    }
+
+    /* QR, RD copied, RA; counts: 1 question, 0/1 answers */
+    buf[2] = 0x80 | (buf[2] & 0x01);
+    buf[3] = 0x80 | rcode;
+    memset(buf + 6, 0, 6);
+    if(rcode || buf[qend - 4] != 0 || buf[qend - 3] != 1){
+	return qend;
+    }
+    buf[7] = 1;
+
+    /* djb2, folded into 10.0.0.0/8, same as stub-resolver.so */
+    for(c = name; *c; c++){
+	hash = hash * 33 + (unsigned char) *c;
+    }
+    addr = htonl(0x0A000000UL | (hash & 0x00FFFFFFUL));
+
+    off = qend;
+    buf[off++] = 0xC0;                  /* pointer to the question name */
+    buf[off++] = STUB_HEADER_SIZE;
+    buf[off++] = 0; buf[off++] = 1;     /* type A */
+    buf[off++] = 0; buf[off++] = 1;     /* class IN */
+    buf[off++] = 0; buf[off++] = 0;     /* TTL 60 */
+    buf[off++] = 0; buf[off++] = 60;
+    buf[off++] = 0; buf[off++] = 4;
+    memcpy(buf + off, &addr, 4);
+    return off + 4;
+}
+
+static void send_due(int sock, long long now){
+    stub_pending* p;
+
+    while(pending_count > 0){
+	p = &pending[pending_head];
+	if(p->due_ns > now){
+	    return;
+	}
+	sendto(sock, p->packet, p->len, 0, (struct sockaddr*) &p->to, p->tolen);
+	pending_head = (pending_head + 1) % STUB_MAX_PENDING;
+	pending_count--;
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    int port = 0;
+    long delay_ms = 0;
+    int loss = 0;
+    int bogus = 0;
+    int opt, sock, len, timeout;
+    int bufsize = STUB_SOCKBUF;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    struct pollfd pfd;
+    stub_pending* p;
+    unsigned char buf[STUB_MAX_PACKET];
+    unsigned int seed = (unsigned int) getpid();
+
+    while((opt = getopt(argc, argv, "p:d:l:b")) != -1){
+	switch(opt){
+	case 'p':
+	    port = atoi(optarg);
+	    break;
+	case 'd':
+	    delay_ms = atol(optarg);
+	    break;
+	case 'l':
+	    loss = atoi(optarg);
+	    break;
+	case 'b':
+	    bogus = 1;
+	    break;
+	default:
+	    fprintf(stderr, "Usage:\n %s [-p port] [-d delayMs] [-l lossPct] [-b]\n",
+		    argv[0]);
+	    return EXIT_FAILURE;
+	}
+    }
+
+    pending = malloc(STUB_MAX_PENDING * sizeof(stub_pending));
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if(!pending || sock < 0){
+	perror("Error setting up stub-dns");
+	return EXIT_FAILURE;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(sock, (struct sockaddr*) &addr, sizeof(addr)) < 0
+       || getsockname(sock, (struct sockaddr*) &addr, &addrlen) < 0){
+	perror("Error binding stub-dns socket");
+	return EXIT_FAILURE;
+    }
+    printf("listening on port %d\n", ntohs(addr.sin_port));
+    fflush(stdout);
+
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    for(;;){
+	timeout = -1;
+	if(pending_count > 0){
+	    timeout = (int) ((pending[pending_head].due_ns - now_ns()
+			      + 999999) / 1000000);
+	    if(timeout < 0){
+		timeout = 0;
+	    }
+	}
+	if(poll(&pfd, 1, timeout) > 0){
+	    p = &pending[(pending_head + pending_count) % STUB_MAX_PENDING];
+	    p->tolen = sizeof(p->to);
+	    len = recvfrom(sock, buf, sizeof(buf), 0,
+			   (struct sockaddr*) &p->to, &p->tolen);
+	    if(len > 0 && (loss <= 0 || (int) (rand_r(&seed) % 100) >= loss)){
+		len = build_reply(buf, len);
+		if(len > 0 && bogus){
+		    buf[0] ^= 0x5A;
+		    sendto(sock, buf, len, 0, (struct sockaddr*) &p->to, p->tolen);
+		    buf[0] ^= 0x5A;
+		}
+		if(len > 0 && delay_ms <= 0){
+		    sendto(sock, buf, len, 0, (struct sockaddr*) &p->to, p->tolen);
+		}
+		else if(len > 0 && pending_count < STUB_MAX_PENDING){
+		    memcpy(p->packet, buf, len);
+		    p->len = len;
+		    p->due_ns = now_ns() + delay_ms * 1000000LL;
+		    pending_count++;
+		}
+	    }
+	}
+	send_due(sock, now_ns());
+    }
+
+    return EXIT_SUCCESS;
+}
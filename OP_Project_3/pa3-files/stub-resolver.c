@@ -0,0 +1,97 @@
+/*
+ * File: stub-resolver.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	A local stand-in for the system resolver, loaded with
+ *      LD_PRELOAD. getaddrinfo() sleeps for a fixed delay and
+ *      answers every name with a 10.x.y.z address derived from
+ *      the name, so lookup throughput can be measured without
+ *      a network.
+ *
+ *      STUB_RESOLVER_DELAY_US sets the per lookup delay
+ *      (default 1000 microseconds).
+ *  
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+#define STUB_DEFAULT_DELAY_US 1000
+
+/* addrinfo and its address live in one allocation */
+typedef struct stub_result_s{
+    struct addrinfo info;
+    struct sockaddr_in addr;
+} stub_result;
+
+static long stub_delay_us(void){
+    static long delay = -1;
+    const char* env;
+
+    if(delay < 0){
+	env = getenv("STUB_RESOLVER_DELAY_US");
+	delay = env ? atol(env) : STUB_DEFAULT_DELAY_US;
+	if(delay < 0){
+	    delay = 0;
+	}
+    }
+    return delay;
+}
+
+int getaddrinfo(const char* node, const char* service,
+		const struct addrinfo* hints, struct addrinfo** res){
+
+    stub_result* r;
+    struct timespec ts;
+    unsigned long hash = 5381;
+    const char* c;
+    long delay = stub_delay_us();
+
+    (void) service;
+    (void) hints;
+
+    if(!node){
+	return EAI_NONAME;
+    }
+
+    if(delay > 0){
+	ts.tv_sec = delay / 1000000;
+	ts.tv_nsec = (delay % 1000000) * 1000;
+	while(nanosleep(&ts, &ts) != 0){
+	}
+    }
+
+    r = calloc(1, sizeof(*r));
+    if(!r){
+	return EAI_MEMORY;
+    }
+
+    /* djb2, folded into 10.0.0.0/8 */
+    for(c = node; *c; c++){
+	hash = hash * 33 + (unsigned char) *c;
+    }
+    r->addr.sin_family = AF_INET;
+    r->addr.sin_addr.s_addr = htonl(0x0A000000UL | (hash & 0x00FFFFFFUL));
+
+    r->info.ai_family = AF_INET;
+    r->info.ai_socktype = SOCK_STREAM;
+    r->info.ai_addrlen = sizeof(r->addr);
+    r->info.ai_addr = (struct sockaddr*) &r->addr;
+    r->info.ai_next = NULL;
+
+    *res = &r->info;
+    return 0;
+}
+
+void freeaddrinfo(struct addrinfo* res){
+    /* info is the first member of stub_result */
+    free(res);
+}
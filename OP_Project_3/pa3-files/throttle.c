@@ -0,0 +1,157 @@
+/*
+ * File: throttle.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains lookup throttles. Taking a token moves
+ *      full_at to max(full_at, now) + interval; the token is due
+ *      once that is no more than burst intervals away.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "throttle.h"
+
+static __thread unsigned int backoff_seed;
+
+static long long throttle_now_ns(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void throttle_sleep_ns(long long ns){
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while(nanosleep(&ts, &ts) != 0 && errno == EINTR){
+    }
+}
+
+int throttle_init(throttle* t, double rate, int burst, int maxInflight,
+		  int retries, int backoffMs){
+
+    memset(t, 0, sizeof(*t));
+    if(rate < 0.0 || burst < 0 || maxInflight < 0 || retries < 0 || backoffMs < 0){
+	return THROTTLE_FAILURE;
+    }
+    if(rate > 0.0){
+	t->interval_ns = (long long) (1e9 / rate);
+	if(t->interval_ns < 1){
+	    t->interval_ns = 1;
+	}
+	t->burst_ns = (burst > 0 ? burst : 1) * t->interval_ns;
+    }
+    t->max_inflight = maxInflight;
+    if(maxInflight > 0 && sem_init(&t->slots, 0, maxInflight) != 0){
+	perror("Error creating throttle slots");
+	return THROTTLE_FAILURE;
+    }
+    t->retries = retries;
+    t->backoff_ns = backoffMs * 1000000LL;
+    t->backoff_max_ns = THROTTLE_MAX_BACKOFF_MS * 1000000LL;
+    if(t->backoff_max_ns < t->backoff_ns){
+	t->backoff_max_ns = t->backoff_ns;
+    }
+    atomic_init(&t->full_at, 0);
+    atomic_init(&t->inflight, 0);
+    atomic_init(&t->peak_inflight, 0);
+    atomic_init(&t->delayed, 0);
+    atomic_init(&t->delayed_ns, 0);
+    atomic_init(&t->capped, 0);
+    atomic_init(&t->retried, 0);
+    atomic_init(&t->gave_up, 0);
+    return THROTTLE_SUCCESS;
+}
+
+long long throttle_reserve(throttle* t, long long now_ns){
+    long long full = atomic_load_explicit(&t->full_at, memory_order_relaxed);
+    long long next;
+
+    if(t->interval_ns == 0){
+	return 0;
+    }
+    do{
+	next = (full > now_ns ? full : now_ns) + t->interval_ns;
+    } while(!atomic_compare_exchange_weak_explicit(&t->full_at, &full, next,
+						   memory_order_relaxed,
+						   memory_order_relaxed));
+    next -= t->burst_ns + now_ns;
+    return next > 0 ? next : 0;
+}
+
+void throttle_enter(throttle* t){
+    long long wait;
+    int n, peak;
+
+    if(t->interval_ns){
+	wait = throttle_reserve(t, throttle_now_ns());
+	if(wait > 0){
+	    atomic_fetch_add_explicit(&t->delayed, 1, memory_order_relaxed);
+	    atomic_fetch_add_explicit(&t->delayed_ns, wait, memory_order_relaxed);
+	    throttle_sleep_ns(wait);
+	}
+    }
+    if(t->max_inflight){
+	if(sem_trywait(&t->slots) != 0){
+	    atomic_fetch_add_explicit(&t->capped, 1, memory_order_relaxed);
+	    while(sem_wait(&t->slots) != 0){
+	    }
+	}
+	n = atomic_fetch_add_explicit(&t->inflight, 1, memory_order_relaxed) + 1;
+	peak = atomic_load_explicit(&t->peak_inflight, memory_order_relaxed);
+	while(n > peak && !atomic_compare_exchange_weak_explicit(&t->peak_inflight, &peak, n,
+								 memory_order_relaxed,
+								 memory_order_relaxed)){
+	}
+    }
+}
+
+void throttle_leave(throttle* t){
+    if(t->max_inflight){
+	atomic_fetch_sub_explicit(&t->inflight, 1, memory_order_relaxed);
+	sem_post(&t->slots);
+    }
+}
+
+long long throttle_backoff_ns(const throttle* t, int attempt){
+    long long cap = t->backoff_ns;
+
+    while(attempt-- > 0 && cap < t->backoff_max_ns){
+	cap *= 2;
+    }
+    if(cap > t->backoff_max_ns){
+	cap = t->backoff_max_ns;
+    }
+    if(backoff_seed == 0){
+	backoff_seed = (unsigned int) (throttle_now_ns() ^ (long long) pthread_self()) | 1;
+    }
+    /* full jitter, so threads that failed together spread out */
+    return (long long) (cap * (rand_r(&backoff_seed) / (RAND_MAX + 1.0)));
+}
+
+int throttle_retry(throttle* t, int attempt){
+    if(attempt >= t->retries){
+	atomic_fetch_add_explicit(&t->gave_up, 1, memory_order_relaxed);
+	return 0;
+    }
+    atomic_fetch_add_explicit(&t->retried, 1, memory_order_relaxed);
+    throttle_sleep_ns(throttle_backoff_ns(t, attempt));
+    return 1;
+}
+
+void throttle_cleanup(throttle* t){
+    if(t->max_inflight){
+	sem_destroy(&t->slots);
+    }
+    t->max_inflight = 0;
+}
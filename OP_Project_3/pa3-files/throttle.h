@@ -0,0 +1,92 @@
+/*
+ * File: throttle.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for lookup throttles: what keeps
+ *      many resolver threads from flooding one nameserver. A
+ *      throttle is a token bucket (rate lookups a second, up to
+ *      burst at once after a quiet spell), a cap on lookups
+ *      outstanding at once, and a retry policy for transient
+ *      failures such as EAI_AGAIN: up to retries more tries,
+ *      waiting a random time up to backoff, then twice that, and
+ *      so on up to backoff_max.
+ *
+ *      The bucket is kept as one atomic time, the moment it will
+ *      next be full (GCRA); a caller takes a token by moving that
+ *      time forward with compare and swap, then sleeps until its
+ *      token is due. The cap is a semaphore. No lock is shared
+ *      between the threads.
+ *
+ */
+
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <semaphore.h>
+#include <stdatomic.h>
+
+#define THROTTLE_FAILURE -1
+#define THROTTLE_SUCCESS 0
+
+#define THROTTLE_DEFAULT_BURST 10
+#define THROTTLE_DEFAULT_RETRIES 2
+#define THROTTLE_DEFAULT_BACKOFF_MS 100
+#define THROTTLE_MAX_BACKOFF_MS 5000
+
+typedef struct throttle_s{
+    long long interval_ns;      /* between tokens, 0 for no rate limit */
+    long long burst_ns;         /* burst tokens' worth of time */
+    int max_inflight;           /* 0 for no cap */
+    int retries;
+    long long backoff_ns;
+    long long backoff_max_ns;
+    sem_t slots;
+    _Alignas(64) atomic_llong full_at;  /* when the bucket is next full */
+    _Alignas(64) atomic_int inflight;
+    /* counters */
+    atomic_int peak_inflight;
+    atomic_long delayed;        /* calls that slept for a token */
+    atomic_llong delayed_ns;
+    atomic_long capped;         /* calls that waited for a slot */
+    atomic_long retried;
+    atomic_long gave_up;        /* transient failures out of retries */
+} throttle;
+
+/* Function to set up t
+ * rate is tokens a second, 0 for none; burst, maxInflight (0 for
+ * no cap), retries and backoffMs must not be negative
+ * Returns THROTTLE_SUCCESS or THROTTLE_FAILURE
+ */
+int throttle_init(throttle* t, double rate, int burst, int maxInflight,
+		  int retries, int backoffMs);
+
+/* Function to take a token at monotonic time now_ns
+ * Returns how many nanoseconds the caller must wait before
+ * using it, 0 if it may go at once
+ */
+long long throttle_reserve(throttle* t, long long now_ns);
+
+/* Function to wait for a token and a free slot before a lookup */
+void throttle_enter(throttle* t);
+
+/* Function to give back the slot taken by throttle_enter() */
+void throttle_leave(throttle* t);
+
+/* Function to return the wait before retry number attempt
+ * (0 for the first), in nanoseconds: a random time up to
+ * backoff * 2^attempt, capped at backoff_max
+ */
+long long throttle_backoff_ns(const throttle* t, int attempt);
+
+/* Function to decide whether to retry after attempt transient
+ * failures in a row. Sleeps for the backoff and returns 1 if
+ * there are retries left, returns 0 otherwise.
+ */
+int throttle_retry(throttle* t, int attempt);
+
+/* Function to free t */
+void throttle_cleanup(throttle* t);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * File: throttleTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for lookup throttles. A bucket
+ *      must hand out burst tokens at once and then one per
+ *      interval, and fill back up after a quiet spell; threads
+ *      sharing it must not beat the rate, nor go past the
+ *      in-flight cap; backoff must double up to its cap; and
+ *      dnslookup_all() must retry transient failures, and only
+ *      those, as many times as allowed.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "throttle.h"
+#include "util.h"
+
+#define TEST_THREADS 4
+#define TEST_CALLS 50
+#define TEST_RATE 2000.0
+#define MS 1000000LL
+
+static throttle shared;
+static atomic_int inside;
+static atomic_int most_inside;
+static atomic_int tries_left;
+
+static long long now_ns(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* call(void* arg){
+    int n, most;
+    int i;
+
+    (void) arg;
+    for(i = 0; i < TEST_CALLS; i++){
+	throttle_enter(&shared);
+	n = atomic_fetch_add(&inside, 1) + 1;
+	most = atomic_load(&most_inside);
+	while(n > most && !atomic_compare_exchange_weak(&most_inside, &most, n)){
+	}
+	usleep(100);
+	atomic_fetch_sub(&inside, 1);
+	throttle_leave(&shared);
+    }
+    return NULL;
+}
+
+/* Fails transiently until tries_left runs out, then answers */
+static int flaky_lookup(void* ctx, const char* hostname, dnsresult* result){
+    (void) hostname;
+    if(atomic_fetch_sub(&tries_left, 1) > 0){
+	return ctx ? UTIL_TRANSIENT : UTIL_FAILURE;
+    }
+    return dnsresult_add(result, "192.0.2.1");
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    static const dnsresolver transient = {"flaky", flaky_lookup, &tries_left};
+    static const dnsresolver permanent = {"broken", flaky_lookup, NULL};
+    pthread_t threads[TEST_THREADS];
+    throttle t;
+    dnsresult r;
+    long long start, elapsed, wait;
+    long long b;
+    int i;
+
+    if(throttle_init(&t, -1.0, 1, 0, 0, 0) != THROTTLE_FAILURE
+       || throttle_init(&t, 1.0, 1, -1, 0, 0) != THROTTLE_FAILURE){
+	fprintf(stderr, "error: negative settings accepted\n");
+    }
+
+    /* Test the bucket: 1000/s, burst 5, at a fixed clock */
+    throttle_init(&t, 1000.0, 5, 0, 0, 0);
+    start = 1000 * MS;
+    for(i = 0; i < 5; i++){
+	if((wait = throttle_reserve(&t, start)) != 0){
+	    fprintf(stderr, "error: burst token %d waits %lld ns\n", i, wait);
+	}
+    }
+    if((wait = throttle_reserve(&t, start)) != 1 * MS
+       || (wait = throttle_reserve(&t, start)) != 2 * MS){
+	fprintf(stderr, "error: token past the burst waits %lld ns\n", wait);
+    }
+    /* 2 tokens are owed at start + 2ms; 100ms later it is full */
+    for(i = 0; i < 5; i++){
+	if((wait = throttle_reserve(&t, start + 100 * MS)) != 0){
+	    fprintf(stderr, "error: refilled token %d waits %lld ns\n", i, wait);
+	}
+    }
+    if(throttle_reserve(&t, start + 100 * MS) != 1 * MS){
+	fprintf(stderr, "error: refilled bucket held more than the burst\n");
+    }
+    throttle_cleanup(&t);
+
+    /* Test no rate means no wait */
+    throttle_init(&t, 0.0, 0, 0, 0, 0);
+    if(throttle_reserve(&t, 0) != 0 || throttle_reserve(&t, 0) != 0){
+	fprintf(stderr, "error: unlimited throttle made a caller wait\n");
+    }
+    throttle_cleanup(&t);
+
+    /* Test threads share the rate and the cap */
+    throttle_init(&shared, TEST_RATE, 1, 2, 0, 0);
+    start = now_ns();
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_create(&threads[i], NULL, call, NULL);
+    }
+    for(i = 0; i < TEST_THREADS; i++){
+	pthread_join(threads[i], NULL);
+    }
+    elapsed = now_ns() - start;
+    /* the first token is free, each later one a 0.5 ms interval */
+    if(elapsed < (long long) ((TEST_THREADS * TEST_CALLS - 1) * (1e9 / TEST_RATE))){
+	fprintf(stderr, "error: %d calls at %.0f/s took only %lld ns\n",
+		TEST_THREADS * TEST_CALLS, TEST_RATE, elapsed);
+    }
+    if(atomic_load(&most_inside) > 2 || atomic_load(&shared.peak_inflight) > 2){
+	fprintf(stderr, "error: %d calls in flight past a cap of 2\n", atomic_load(&most_inside));
+    }
+    if(atomic_load(&shared.delayed) == 0){
+	fprintf(stderr, "error: no call waited for a token\n");
+    }
+    throttle_cleanup(&shared);
+
+    /* Test backoff doubles up to its cap */
+    throttle_init(&t, 0.0, 0, 0, 3, 1000);
+    for(i = 0; i < 200; i++){
+	b = throttle_backoff_ns(&t, 2);
+	if(b < 0 || b > 4000 * MS){
+	    fprintf(stderr, "error: third backoff of 1s was %lld ns\n", b);
+	}
+	b = throttle_backoff_ns(&t, 10);
+	if(b < 0 || b > THROTTLE_MAX_BACKOFF_MS * MS){
+	    fprintf(stderr, "error: backoff went past its cap: %lld ns\n", b);
+	}
+    }
+    throttle_cleanup(&t);
+
+    /* Test dnslookup_all() retries transient failures */
+    throttle_init(&t, 0.0, 0, 0, 3, 1);
+    dnslookup_set_throttle(&t);
+    dnsresolver_set(&transient);
+    atomic_store(&tries_left, 3);
+    dnsresult_init(&r);
+    if(dnslookup_all("flaky.example.com", &r) != UTIL_SUCCESS || r.count != 1
+       || atomic_load(&t.retried) != 3 || atomic_load(&t.gave_up) != 0){
+	fprintf(stderr, "error: 3 transient failures and 3 retries did not resolve (%ld retried)\n",
+		atomic_load(&t.retried));
+    }
+    dnsresult_free(&r);
+    atomic_store(&tries_left, 4);
+    if(dnslookup_all("flaky.example.com", &r) != UTIL_FAILURE || atomic_load(&t.gave_up) != 1){
+	fprintf(stderr, "error: 4 transient failures with 3 retries resolved\n");
+    }
+    dnsresult_free(&r);
+
+    /* a permanent failure is not retried */
+    dnsresolver_set(&permanent);
+    atomic_store(&tries_left, 1);
+    if(dnslookup_all("broken.example.com", &r) != UTIL_FAILURE || atomic_load(&tries_left) != 0
+       || atomic_load(&t.retried) != 6){
+	fprintf(stderr, "error: permanent failure was retried\n");
+    }
+    dnsresult_free(&r);
+
+    /* without a throttle nothing is retried */
+    dnslookup_set_throttle(NULL);
+    dnsresolver_set(&transient);
+    atomic_store(&tries_left, 1);
+    if(dnslookup_all("flaky.example.com", &r) != UTIL_FAILURE){
+	fprintf(stderr, "error: retried without a throttle\n");
+    }
+    dnsresult_free(&r);
+    dnsresolver_set(NULL);
+    throttle_cleanup(&t);
+
+    return 0;
+}
@@ -4,80 +4,368 @@
  * Project: CSCI 3753 Programming Assignment 2
  * Create Date: 2012/02/01
  * Modify Date: 2012/02/01
+ * Modify Date: 2026/10/17
  * Description:
  * 	This file contains declarations of utility functions for
  *      Programming Assignment 2.
  *  
  */
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
 #include "util.h"
 
-int dnslookup(const char* hostname, char* firstIPstr, int maxSize){
+/* Number of independently locked in-flight tables */
+#define FLIGHT_SHARDS 64
+
+/* One lookup in progress and the callers waiting on it */
+typedef struct flight_s{
+    struct flight_s* next;
+    char* hostname;
+    int waiters;
+    int done;
+    int result;
+    char list[UTIL_ADDRLIST_SIZE];
+    pthread_cond_t cond;
+} flight;
+
+typedef struct flight_shard_s{
+    pthread_mutex_t lock;
+    flight* head;
+} flight_shard;
+
+static flight_shard flights[FLIGHT_SHARDS];
+static pthread_once_t flights_once = PTHREAD_ONCE_INIT;
+static atomic_long flight_lookups;
+static atomic_long flight_coalesced;
+static const dnsresolver* active_resolver;
+static throttle* active_throttle;
+
+void dnsresult_init(dnsresult* result){
+    result->count = 0;
+    result->capacity = UTIL_INLINE_ADDRS;
+    result->addrs = result->inline_addrs;
+}
+
+void dnsresult_free(dnsresult* result){
+    if(result->addrs != result->inline_addrs){
+	free(result->addrs);
+    }
+    dnsresult_init(result);
+}
+
+/* Make room for one more address, spilling to the heap once
+ * the inline array is full */
+static int dnsresult_reserve(dnsresult* result){
+    char (*grown)[INET6_ADDRSTRLEN];
+    int capacity;
+
+    if(result->count < result->capacity){
+	return UTIL_SUCCESS;
+    }
+    capacity = result->capacity * 2;
+    if(result->addrs == result->inline_addrs){
+	grown = malloc(capacity * sizeof(*grown));
+	if(grown){
+	    memcpy(grown, result->inline_addrs, sizeof(result->inline_addrs));
+	}
+    }
+    else{
+	grown = realloc(result->addrs, capacity * sizeof(*grown));
+    }
+    if(!grown){
+	return UTIL_FAILURE;
+    }
+    result->addrs = grown;
+    result->capacity = capacity;
+    return UTIL_SUCCESS;
+}
+
+void dnsresolver_set(const dnsresolver* resolver){
+    active_resolver = resolver;
+}
+
+void dnslookup_set_throttle(throttle* t){
+    active_throttle = t;
+}
+
+int dnsresult_add(dnsresult* result, const char* ipstr){
+    int i;
+
+    for(i = 0; i < result->count; i++){
+	if(strcmp(result->addrs[i], ipstr) == 0){
+	    return UTIL_SUCCESS;
+	}
+    }
+    if(dnsresult_reserve(result) == UTIL_FAILURE){
+	return UTIL_FAILURE;
+    }
+    strncpy(result->addrs[result->count], ipstr, INET6_ADDRSTRLEN - 1);
+    result->addrs[result->count][INET6_ADDRSTRLEN - 1] = '\0';
+    result->count++;
+    return UTIL_SUCCESS;
+}
+
+/* One try at hostname; *addrError is getaddrinfo()'s error */
+static int dnslookup_once(const char* hostname, dnsresult* result, int* addrError){
 
     /* Local vars */
+    struct addrinfo hints;
     struct addrinfo* headresult = NULL;
-    struct addrinfo* result = NULL;
-    struct sockaddr_in* ipv4sock = NULL;
-    struct in_addr* ipv4addr = NULL;
-    char ipv4str[INET_ADDRSTRLEN];
+    struct addrinfo* res = NULL;
+    const void* addr;
     char ipstr[INET6_ADDRSTRLEN];
-    int addrError = 0;
+    int ret;
+
+    *addrError = 0;
+    if(active_resolver){
+	ret = active_resolver->lookup(active_resolver->ctx, hostname, result);
+	if(ret != UTIL_SUCCESS){
+	    return ret;
+	}
+	return result->count > 0 ? UTIL_SUCCESS : UTIL_FAILURE;
+    }
+
+    /* One socket type, so each address comes back once */
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
 
-    /* DEBUG: Print Hostname*/
-#ifdef UTIL_DEBUG
-    fprintf(stderr, "%s\n", hostname);
-#endif
-   
     /* Lookup Hostname */
-    addrError = getaddrinfo(hostname, NULL, NULL, &headresult);
-    if(addrError){
-	fprintf(stderr, "Error looking up Address: %s\n",
-		gai_strerror(addrError));
-	return UTIL_FAILURE;
+    *addrError = getaddrinfo(hostname, NULL, &hints, &headresult);
+    if(*addrError){
+	return *addrError == EAI_AGAIN ? UTIL_TRANSIENT : UTIL_FAILURE;
     }
     /* Loop Through result Linked List */
-    for(result=headresult; result != NULL; result = result->ai_next){
+    for(res=headresult; res != NULL; res = res->ai_next){
 	/* Extract IP Address and Convert to String */
-	if(result->ai_addr->sa_family == AF_INET){
-	    /* IPv4 Address Handling */
-	    ipv4sock = (struct sockaddr_in*)(result->ai_addr);
-	    ipv4addr = &(ipv4sock->sin_addr);
-	    if(!inet_ntop(result->ai_family, ipv4addr,
-			  ipv4str, sizeof(ipv4str))){
-		perror("Error Converting IP to String");
-		return UTIL_FAILURE;
-	    }
-#ifdef UTIL_DEBUG
-	    fprintf(stdout, "%s\n", ipv4str);
-#endif
-	    strncpy(ipstr, ipv4str, sizeof(ipstr));
-	    ipstr[sizeof(ipstr)-1] = '\0';
+	if(res->ai_addr->sa_family == AF_INET){
+	    addr = &((struct sockaddr_in*) res->ai_addr)->sin_addr;
 	}
-	else if(result->ai_addr->sa_family == AF_INET6){
-	    /* IPv6 Handling */
-#ifdef UTIL_DEBUG
-	    fprintf(stdout, "IPv6 Address: Not Handled\n");
-#endif
-	    strncpy(ipstr, "UNHANDELED", sizeof(ipstr));
-	    ipstr[sizeof(ipstr)-1] = '\0';
+	else if(res->ai_addr->sa_family == AF_INET6){
+	    addr = &((struct sockaddr_in6*) res->ai_addr)->sin6_addr;
 	}
 	else{
 	    /* Unhandlded Protocol Handling */
 #ifdef UTIL_DEBUG
 	    fprintf(stdout, "Unknown Protocol: Not Handled\n");
 #endif
-	    strncpy(ipstr, "UNHANDELED", sizeof(ipstr));
-	    ipstr[sizeof(ipstr)-1] = '\0';
+	    continue;
+	}
+	if(!inet_ntop(res->ai_addr->sa_family, addr, ipstr, sizeof(ipstr))){
+	    perror("Error Converting IP to String");
+	    continue;
 	}
-	/* Save First IP Address */
-	if(result==headresult){
-	    strncpy(firstIPstr, ipstr, maxSize);
-	    firstIPstr[maxSize-1] = '\0';
+#ifdef UTIL_DEBUG
+	fprintf(stdout, "%s\n", ipstr);
+#endif
+	/* Some resolvers ignore hints: dnsresult_add() drops repeats */
+	if(dnsresult_add(result, ipstr) == UTIL_FAILURE){
+	    break;
 	}
     }
 
     /* Cleanup */
     freeaddrinfo(headresult);
 
-    return UTIL_SUCCESS;
+    return result->count > 0 ? UTIL_SUCCESS : UTIL_FAILURE;
+}
+
+int dnslookup_all(const char* hostname, dnsresult* result){
+    int addrError;
+    int attempt = 0;
+    int ret;
+
+    /* DEBUG: Print Hostname*/
+#ifdef UTIL_DEBUG
+    fprintf(stderr, "%s\n", hostname);
+#endif
+
+    for(;;){
+	if(active_throttle){
+	    throttle_enter(active_throttle);
+	}
+	ret = dnslookup_once(hostname, result, &addrError);
+	if(active_throttle){
+	    throttle_leave(active_throttle);
+	}
+	if(ret != UTIL_TRANSIENT || !active_throttle
+	   || !throttle_retry(active_throttle, attempt++)){
+	    break;
+	}
+	dnsresult_free(result);
+    }
+
+    if(addrError){
+	fprintf(stderr, "Error looking up Address: %s\n",
+		gai_strerror(addrError));
+    }
+    return ret == UTIL_SUCCESS ? UTIL_SUCCESS : UTIL_FAILURE;
+}
+
+int dnsresult_join(const dnsresult* result, char* list, int maxSize){
+    int len = 0;
+    int n;
+    int i;
+
+    if(maxSize > 0){
+	list[0] = '\0';
+    }
+    for(i = 0; i < result->count; i++){
+	n = snprintf(list + len, maxSize - len, "%s%s",
+		     i ? UTIL_ADDR_SEP : "", result->addrs[i]);
+	if(n >= maxSize - len){
+	    list[len] = '\0';
+	    break;
+	}
+	len += n;
+    }
+    return i;
+}
+
+int dnslookup(const char* hostname, char* firstIPstr, int maxSize){
+    dnsresult result;
+    int ret;
+
+    dnsresult_init(&result);
+    ret = dnslookup_all(hostname, &result);
+    if(ret == UTIL_SUCCESS){
+	strncpy(firstIPstr, result.addrs[0], maxSize);
+	firstIPstr[maxSize-1] = '\0';
+    }
+    dnsresult_free(&result);
+
+    return ret;
+}
+
+int dnslookup_list(const char* hostname, char* list, int maxSize){
+    dnsresult result;
+    int ret;
+
+    dnsresult_init(&result);
+    ret = dnslookup_all(hostname, &result);
+    if(ret == UTIL_SUCCESS){
+	dnsresult_join(&result, list, maxSize);
+    }
+    dnsresult_free(&result);
+
+    return ret;
+}
+
+static void flights_init(void){
+    int i;
+    for(i=0; i<FLIGHT_SHARDS; i++){
+	pthread_mutex_init(&flights[i].lock, NULL);
+	flights[i].head = NULL;
+    }
+}
+
+static flight_shard* flight_shard_for(const char* hostname){
+    uint32_t h = 2166136261u;
+    while(*hostname){
+	h ^= (unsigned char) *hostname++;
+	h *= 16777619u;
+    }
+    return &flights[h % FLIGHT_SHARDS];
+}
+
+/* Copy the whole address list, or just its first address */
+static void flight_copy_result(flight* f, char* out, int maxSize, int all){
+    size_t len;
+
+    if(f->result != UTIL_SUCCESS){
+	return;
+    }
+    len = all ? strlen(f->list) : strcspn(f->list, UTIL_ADDR_SEP);
+    if(len >= (size_t) maxSize){
+	len = maxSize - 1;
+    }
+    memcpy(out, f->list, len);
+    out[len] = '\0';
+}
+
+static int coalesced_lookup(const char* hostname, char* out, int maxSize,
+			    int all){
+
+    flight_shard* shard;
+    flight* f;
+    flight** link;
+    int ret;
+
+    pthread_once(&flights_once, flights_init);
+    shard = flight_shard_for(hostname);
+
+    pthread_mutex_lock(&shard->lock);
+    for(f = shard->head; f; f = f->next){
+	if(strcmp(f->hostname, hostname) == 0){
+	    break;
+	}
+    }
+
+    if(f){
+	/* Someone is already resolving it: wait for their answer */
+	f->waiters++;
+	while(!f->done){
+	    pthread_cond_wait(&f->cond, &shard->lock);
+	}
+	flight_copy_result(f, out, maxSize, all);
+	ret = f->result;
+	if(--f->waiters == 0){
+	    pthread_cond_destroy(&f->cond);
+	    free(f->hostname);
+	    free(f);
+	}
+	pthread_mutex_unlock(&shard->lock);
+	atomic_fetch_add(&flight_coalesced, 1);
+	return ret;
+    }
+
+    /* First caller: publish the flight, then resolve unlocked */
+    f = calloc(1, sizeof(*f));
+    if(!f || !(f->hostname = strdup(hostname))){
+	pthread_mutex_unlock(&shard->lock);
+	free(f);
+	return all ? dnslookup_list(hostname, out, maxSize)
+	    : dnslookup(hostname, out, maxSize);
+    }
+    pthread_cond_init(&f->cond, NULL);
+    f->waiters = 1;
+    f->next = shard->head;
+    shard->head = f;
+    pthread_mutex_unlock(&shard->lock);
+
+    ret = dnslookup_list(hostname, f->list, sizeof(f->list));
+    atomic_fetch_add(&flight_lookups, 1);
+
+    pthread_mutex_lock(&shard->lock);
+    f->result = ret;
+    f->done = 1;
+    for(link = &shard->head; *link != f; link = &(*link)->next){
+    }
+    *link = f->next;
+    pthread_cond_broadcast(&f->cond);
+    flight_copy_result(f, out, maxSize, all);
+    if(--f->waiters == 0){
+	pthread_cond_destroy(&f->cond);
+	free(f->hostname);
+	free(f);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return ret;
+}
+
+int dnslookup_coalesced(const char* hostname, char* firstIPstr, int maxSize){
+    return coalesced_lookup(hostname, firstIPstr, maxSize, 0);
+}
+
+int dnslookup_list_coalesced(const char* hostname, char* list, int maxSize){
+    return coalesced_lookup(hostname, list, maxSize, 1);
+}
+
+void dnslookup_coalesced_stats(long* lookups, long* coalesced){
+    *lookups = atomic_load(&flight_lookups);
+    *coalesced = atomic_load(&flight_coalesced);
 }
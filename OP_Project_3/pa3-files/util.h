@@ -4,6 +4,7 @@
  * Project: CSCI 3753 Programming Assignment 2
  * Create Date: 2012/02/01
  * Modify Date: 2012/02/01
+ * Modify Date: 2026/10/17
  * Description:
  * 	This file contains declarations of utility functions for
  *      Programming Assignment 2.
@@ -26,8 +27,55 @@
 #include <sys/socket.h>
 #include <netdb.h>
 
+#include "throttle.h"
+
 #define UTIL_FAILURE -1
 #define UTIL_SUCCESS 0
+/* A failure worth retrying, like EAI_AGAIN */
+#define UTIL_TRANSIENT -2
+
+/* Addresses a dnsresult holds without allocating */
+#define UTIL_INLINE_ADDRS 8
+/* Separator and buffer size for joined address lists */
+#define UTIL_ADDR_SEP ", "
+#define UTIL_ADDRLIST_SIZE 1024
+
+/* Every address found for a name, as inet_ntop() strings.
+ * addrs points at inline_addrs until more than
+ * UTIL_INLINE_ADDRS are found, so a dnsresult must not be
+ * copied by value.
+ */
+typedef struct dnsresult_s{
+    int count;
+    int capacity;
+    char (*addrs)[INET6_ADDRSTRLEN];
+    char inline_addrs[UTIL_INLINE_ADDRS][INET6_ADDRSTRLEN];
+} dnsresult;
+
+/* A pluggable lookup backend. lookup adds every address found
+ * for hostname to result with dnsresult_add() and returns
+ * UTIL_SUCCESS, UTIL_FAILURE, or UTIL_TRANSIENT if trying again
+ * later might work. It is called from many threads at once
+ * with the same ctx.
+ */
+typedef struct dnsresolver_s{
+    const char* name;
+    int (*lookup)(void* ctx, const char* hostname, dnsresult* result);
+    void* ctx;
+} dnsresolver;
+
+/* Function to send every lookup below through resolver instead
+ * of getaddrinfo(); NULL goes back to getaddrinfo(). Call it
+ * before any lookup starts: the switch is not synchronized.
+ */
+void dnsresolver_set(const dnsresolver* resolver);
+
+/* Function to pace every lookup below with t: each one waits
+ * for a token and a slot, and transient failures are retried
+ * with t's backoff. NULL (the default) looks up at once and
+ * never retries. Not synchronized, like dnsresolver_set().
+ */
+void dnslookup_set_throttle(throttle* t);
 
 /* Fuction to return the first IP address found
  * for hostname. IP address returned as string
@@ -37,4 +85,59 @@ int dnslookup(const char* hostname,
 	      char* firstIPstr,
 	      int maxSize);
 
+/* Function to prepare an empty dnsresult */
+void dnsresult_init(dnsresult* result);
+
+/* Function to free any addresses that spilled past the
+ * inline array; result is empty and reusable afterwards
+ */
+void dnsresult_free(dnsresult* result);
+
+/* Function to append one address string to result unless it
+ * is already there. Returns UTIL_FAILURE only if out of memory.
+ */
+int dnsresult_add(dnsresult* result, const char* ipstr);
+
+/* Function to return every IPv4 and IPv6 address found for
+ * hostname from one getaddrinfo() call (or the resolver set
+ * with dnsresolver_set()), in resolver order with duplicates
+ * dropped. result must be initilized. EAI_AGAIN and other
+ * transient failures are retried as dnslookup_set_throttle()
+ * says.
+ */
+int dnslookup_all(const char* hostname, dnsresult* result);
+
+/* Function to join result's addresses with UTIL_ADDR_SEP into
+ * list of size maxSize. Addresses that do not fit are left
+ * out whole. Returns the number of addresses written.
+ */
+int dnsresult_join(const dnsresult* result, char* list, int maxSize);
+
+/* Same as dnslookup(), but returns every address joined by
+ * dnsresult_join() in list of size maxSize
+ */
+int dnslookup_list(const char* hostname, char* list, int maxSize);
+
+/* Same as dnslookup(), but concurrent calls for the same
+ * hostname share one lookup: the first caller resolves it
+ * and later callers wait for and copy its result.
+ * Safe to call from any number of threads.
+ */
+int dnslookup_coalesced(const char* hostname,
+			char* firstIPstr,
+			int maxSize);
+
+/* Counters for dnslookup_coalesced(): lookups actually
+ * performed, and calls that waited on another thread's
+ * lookup instead
+ */
+void dnslookup_coalesced_stats(long* lookups, long* coalesced);
+
+/* Same as dnslookup_list(), sharing lookups the same way as
+ * dnslookup_coalesced()
+ */
+int dnslookup_list_coalesced(const char* hostname,
+			     char* list,
+			     int maxSize);
+
 #endif
@@ -0,0 +1,319 @@
+/*
+ * File: workq.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains the work stealing queue. Each deque is
+ *      a ring of capacity items under its own mutex. queued is
+ *      raised after items go into a deque and lowered after they
+ *      come out, so it can dip below zero for a moment; a worker
+ *      only sleeps when it reads zero or less after announcing
+ *      itself in idle_workers, and a producer only wakes one when
+ *      it reads idle_workers after raising queued, so a wakeup is
+ *      never lost. Producers and taken work the same way.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "workq.h"
+
+int workq_init(workq* w, int workers, int capacity){
+    int i;
+
+    memset(w, 0, sizeof(*w));
+    if(workers < 1 || capacity < 1){
+	return WORKQ_FAILURE;
+    }
+    /* sizeof(workq_deque) is a whole number of cache lines */
+    w->deques = aligned_alloc(WORKQ_CACHELINE, sizeof(workq_deque) * workers);
+    if(!w->deques){
+	perror("Error allocating work queues");
+	return WORKQ_FAILURE;
+    }
+    for(i = 0; i < workers; i++){
+	workq_deque* d = &w->deques[i];
+	pthread_mutex_init(&d->lock, NULL);
+	d->items = malloc(capacity * sizeof(*d->items));
+	d->head = 0;
+	d->count = 0;
+	atomic_init(&d->size, 0);
+	if(!d->items){
+	    perror("Error allocating work queues");
+	    w->workers = i + 1;
+	    workq_cleanup(w);
+	    return WORKQ_FAILURE;
+	}
+    }
+    w->workers = workers;
+    w->capacity = capacity;
+    w->groups = 1;
+    atomic_init(&w->active, workers);
+    atomic_init(&w->next, 0);
+    atomic_init(&w->queued, 0);
+    atomic_init(&w->taken, 0);
+    atomic_init(&w->closed, 0);
+    pthread_mutex_init(&w->sleep_lock, NULL);
+    pthread_cond_init(&w->work_cond, NULL);
+    pthread_cond_init(&w->room_cond, NULL);
+    atomic_init(&w->idle_workers, 0);
+    atomic_init(&w->full_producers, 0);
+    atomic_init(&w->steals, 0);
+    atomic_init(&w->stolen, 0);
+    atomic_init(&w->remote_steals, 0);
+    return WORKQ_SUCCESS;
+}
+
+void workq_set_groups(workq* w, int groups){
+    w->groups = groups < 1 ? 1 : groups > w->workers ? w->workers : groups;
+}
+
+int workq_place(workq* w, int self){
+    workq_deque* d = &w->deques[self];
+    void** items = malloc(w->capacity * sizeof(*items));
+    void** old;
+    int i;
+
+    if(!items){
+	return WORKQ_FAILURE;
+    }
+    /* first touch, outside the lock */
+    memset(items, 0, w->capacity * sizeof(*items));
+    pthread_mutex_lock(&d->lock);
+    for(i = 0; i < d->count; i++){
+	items[i] = d->items[(d->head + i) % w->capacity];
+    }
+    old = d->items;
+    d->items = items;
+    d->head = 0;
+    pthread_mutex_unlock(&d->lock);
+    free(old);
+    return WORKQ_SUCCESS;
+}
+
+void workq_set_active(workq* w, int active){
+    if(active < 1){
+	active = 1;
+    }
+    if(active > w->workers){
+	active = w->workers;
+    }
+    atomic_store(&w->active, active);
+}
+
+/* Append up to count items to d's back; returns how many fit */
+static int deque_push(workq* w, workq_deque* d, void* const* items, int count){
+    int n, i;
+
+    pthread_mutex_lock(&d->lock);
+    n = w->capacity - d->count;
+    if(n > count){
+	n = count;
+    }
+    for(i = 0; i < n; i++){
+	d->items[(d->head + d->count + i) % w->capacity] = items[i];
+    }
+    d->count += n;
+    atomic_store_explicit(&d->size, d->count, memory_order_relaxed);
+    pthread_mutex_unlock(&d->lock);
+    return n;
+}
+
+/* Owner: take up to max items from d's front */
+static int deque_take_front(workq* w, workq_deque* d, void** out, int max){
+    int n, i;
+
+    if(atomic_load_explicit(&d->size, memory_order_relaxed) == 0){
+	return 0;
+    }
+    pthread_mutex_lock(&d->lock);
+    n = d->count < max ? d->count : max;
+    for(i = 0; i < n; i++){
+	out[i] = d->items[(d->head + i) % w->capacity];
+    }
+    d->head = (d->head + n) % w->capacity;
+    d->count -= n;
+    atomic_store_explicit(&d->size, d->count, memory_order_relaxed);
+    pthread_mutex_unlock(&d->lock);
+    return n;
+}
+
+/* Thief: take half (rounded up, at most max) of d from its back,
+ * so the owner keeps the oldest items */
+static int deque_take_back(workq* w, workq_deque* d, void** out, int max){
+    int n, i;
+
+    pthread_mutex_lock(&d->lock);
+    n = (d->count + 1) / 2;
+    if(n > max){
+	n = max;
+    }
+    for(i = 0; i < n; i++){
+	out[i] = d->items[(d->head + d->count - n + i) % w->capacity];
+    }
+    d->count -= n;
+    atomic_store_explicit(&d->size, d->count, memory_order_relaxed);
+    pthread_mutex_unlock(&d->lock);
+    return n;
+}
+
+/* Steal from the fullest other deque, by the unlocked size hints,
+ * looking in self's own group first */
+static int workq_steal(workq* w, int self, void** out, int max){
+    int best = -1;
+    int best_size = 0;
+    int remote = 0;
+    int pass, i, v, size, n;
+
+    for(pass = 0; pass < (w->groups > 1 ? 2 : 1) && best < 0; pass++){
+	for(i = 1; i < w->workers; i++){
+	    v = (self + i) % w->workers;
+	    if(w->groups > 1 && (v % w->groups == self % w->groups) == pass){
+		continue;
+	    }
+	    size = atomic_load_explicit(&w->deques[v].size, memory_order_relaxed);
+	    if(size > best_size){
+		best = v;
+		best_size = size;
+	    }
+	}
+	remote = pass;
+    }
+    if(best < 0){
+	return 0;
+    }
+    n = deque_take_back(w, &w->deques[best], out, max);
+    if(n > 0){
+	atomic_fetch_add_explicit(&w->steals, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->stolen, n, memory_order_relaxed);
+	if(remote){
+	    atomic_fetch_add_explicit(&w->remote_steals, 1, memory_order_relaxed);
+	}
+    }
+    return n;
+}
+
+int workq_push_many(workq* w, void* const* items, int count, int wait){
+    return workq_push_group(w, -1, items, count, wait);
+}
+
+int workq_push_group(workq* w, int group, void* const* items, int count, int wait){
+    unsigned long taken;
+    int pushed = 0;
+    int active, targets, stride, full, idx, n;
+
+    while(pushed < count){
+	taken = atomic_load(&w->taken);
+	active = atomic_load_explicit(&w->active, memory_order_relaxed);
+	/* the group's active workers are group, group + groups, ... */
+	if(group >= 0 && w->groups > 1 && group % w->groups < active){
+	    targets = (active - group % w->groups + w->groups - 1) / w->groups;
+	    stride = w->groups;
+	}
+	else{
+	    targets = active;
+	    stride = 1;
+	}
+	full = 0;
+	while(pushed < count && full < targets){
+	    idx = atomic_fetch_add_explicit(&w->next, 1, memory_order_relaxed) % targets * stride
+		+ (stride > 1 ? group % w->groups : 0);
+	    n = deque_push(w, &w->deques[idx], items + pushed, count - pushed);
+	    if(n == 0){
+		full++;
+		continue;
+	    }
+	    full = 0;
+	    pushed += n;
+	    atomic_fetch_add(&w->queued, n);
+	    if(atomic_load(&w->idle_workers) > 0){
+		pthread_mutex_lock(&w->sleep_lock);
+		if(n > 1){
+		    pthread_cond_broadcast(&w->work_cond);
+		}
+		else{
+		    pthread_cond_signal(&w->work_cond);
+		}
+		pthread_mutex_unlock(&w->sleep_lock);
+	    }
+	}
+	if(pushed == count || !wait || atomic_load(&w->closed)){
+	    break;
+	}
+
+	/* every target deque was full: sleep until a worker takes some */
+	pthread_mutex_lock(&w->sleep_lock);
+	atomic_fetch_add(&w->full_producers, 1);
+	while(atomic_load(&w->taken) == taken && !atomic_load(&w->closed)){
+	    pthread_cond_wait(&w->room_cond, &w->sleep_lock);
+	}
+	atomic_fetch_sub(&w->full_producers, 1);
+	pthread_mutex_unlock(&w->sleep_lock);
+    }
+    return pushed;
+}
+
+int workq_pop_many(workq* w, int self, void** out, int max, int wait, int* stolen){
+    int n, done;
+
+    *stolen = 0;
+    for(;;){
+	n = deque_take_front(w, &w->deques[self], out, max);
+	if(n == 0 && (n = workq_steal(w, self, out, max)) > 0){
+	    *stolen = n;
+	}
+	if(n > 0){
+	    atomic_fetch_sub(&w->queued, n);
+	    atomic_fetch_add(&w->taken, n);
+	    if(atomic_load(&w->full_producers) > 0){
+		pthread_mutex_lock(&w->sleep_lock);
+		pthread_cond_broadcast(&w->room_cond);
+		pthread_mutex_unlock(&w->sleep_lock);
+	    }
+	    return n;
+	}
+	if(!wait){
+	    return 0;
+	}
+
+	pthread_mutex_lock(&w->sleep_lock);
+	atomic_fetch_add(&w->idle_workers, 1);
+	while(atomic_load(&w->queued) <= 0 && !atomic_load(&w->closed)){
+	    pthread_cond_wait(&w->work_cond, &w->sleep_lock);
+	}
+	atomic_fetch_sub(&w->idle_workers, 1);
+	/* nothing is pushed after close, so queued is exact by then */
+	done = atomic_load(&w->closed) && atomic_load(&w->queued) <= 0;
+	pthread_mutex_unlock(&w->sleep_lock);
+	if(done){
+	    return 0;
+	}
+    }
+}
+
+void workq_close(workq* w){
+    pthread_mutex_lock(&w->sleep_lock);
+    atomic_store(&w->closed, 1);
+    pthread_cond_broadcast(&w->work_cond);
+    pthread_cond_broadcast(&w->room_cond);
+    pthread_mutex_unlock(&w->sleep_lock);
+}
+
+void workq_cleanup(workq* w){
+    int i;
+
+    for(i = 0; i < w->workers; i++){
+	pthread_mutex_destroy(&w->deques[i].lock);
+	free(w->deques[i].items);
+    }
+    free(w->deques);
+    w->deques = NULL;
+    if(w->capacity > 0){
+	pthread_mutex_destroy(&w->sleep_lock);
+	pthread_cond_destroy(&w->work_cond);
+	pthread_cond_destroy(&w->room_cond);
+    }
+}
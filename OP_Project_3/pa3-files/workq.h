@@ -0,0 +1,122 @@
+/*
+ * File: workq.h
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This is the header file for a work stealing queue: one
+ *      bounded deque per worker instead of one shared queue.
+ *      Producers hand each batch to the next active worker's
+ *      deque in turn; a worker takes from the front of its own
+ *      deque and, when that is empty, steals half of the back of
+ *      the fullest one it finds. Each deque has its own lock,
+ *      taken by its owner, one producer or one thief at a time,
+ *      so there is no lock every thread goes through.
+ *
+ *      With groups (one per NUMA node, say) worker i is in group
+ *      i % groups; a producer may keep its pushes to its own
+ *      group's deques, and a thief looks in its own group before
+ *      the others, so most items stay on the node they were
+ *      queued on.
+ *
+ *      Sleeping workers and producers wait on event counts
+ *      (items queued, items taken); the shared mutex and
+ *      condition variables behind them are only touched by a
+ *      thread about to sleep, or by one that sees a sleeper.
+ *
+ */
+
+#ifndef WORKQ_H
+#define WORKQ_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define WORKQ_FAILURE -1
+#define WORKQ_SUCCESS 0
+
+#define WORKQ_CACHELINE 64
+
+typedef struct workq_deque_s{
+    _Alignas(WORKQ_CACHELINE) pthread_mutex_t lock;
+    void** items;
+    int head;
+    int count;
+    /* unlocked hint for thieves choosing a victim */
+    atomic_int size;
+} workq_deque;
+
+typedef struct workq_s{
+    workq_deque* deques;
+    int workers;
+    int capacity;             /* per deque */
+    int groups;               /* worker i is in group i % groups */
+    _Alignas(WORKQ_CACHELINE) atomic_int active;
+    atomic_uint next;         /* round robin producer cursor */
+    _Alignas(WORKQ_CACHELINE) atomic_long queued;
+    atomic_ulong taken;
+    atomic_int closed;
+    /* slow path: sleeping workers and producers */
+    _Alignas(WORKQ_CACHELINE) pthread_mutex_t sleep_lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t room_cond;
+    atomic_int idle_workers;
+    atomic_int full_producers;
+    /* stats */
+    atomic_long steals;
+    atomic_long stolen;
+    atomic_long remote_steals;  /* from another group's deque */
+} workq;
+
+/* Function to set up workers deques of capacity items each.
+ * All workers start active.
+ */
+int workq_init(workq* w, int workers, int capacity);
+
+/* Function to spread future pushes over workers 0 .. active-1
+ * only. Items already in the other deques are left to thieves.
+ */
+void workq_set_active(workq* w, int active);
+
+/* Function to split the workers into groups (1, the default,
+ * is no grouping). Call before any push or pop.
+ */
+void workq_set_groups(workq* w, int groups);
+
+/* Function for worker self to move its deque into memory it
+ * allocates and touches itself, so a pinned worker's deque is on
+ * its own node. Safe while others push and steal.
+ * Returns WORKQ_SUCCESS or WORKQ_FAILURE (the deque is kept)
+ */
+int workq_place(workq* w, int self);
+
+/* Function to add count items, a deque at a time in round robin
+ * order. With wait, sleeps while every active deque is full;
+ * without, returns once they are.
+ * Returns the number added.
+ */
+int workq_push_many(workq* w, void* const* items, int count, int wait);
+
+/* Function to add count items like workq_push_many(), to the
+ * active deques of group only (all of them if group is -1 or
+ * has no active worker)
+ * Returns the number added.
+ */
+int workq_push_group(workq* w, int group, void* const* items, int count, int wait);
+
+/* Function to take up to max items for worker self: from the
+ * front of its own deque, or else stolen from another's back
+ * (*stolen is then set to the count). With wait, sleeps while
+ * every deque is empty.
+ * Returns 0 once closed and drained (or, without wait, when
+ * there is nothing to take).
+ */
+int workq_pop_many(workq* w, int self, void** out, int max, int wait, int* stolen);
+
+/* Function to mark the end of input and wake every sleeper */
+void workq_close(workq* w);
+
+/* Function to free the deques */
+void workq_cleanup(workq* w);
+
+#endif
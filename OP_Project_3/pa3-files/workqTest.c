@@ -0,0 +1,185 @@
+/*
+ * File: workqTest.c
+ * Project: CSCI 3753 Programming Assignment 2
+ * Create Date: 2026/10/17
+ * Modify Date: 2026/10/17
+ * Description:
+ * 	This file contains test code for the work stealing queue.
+ *      A worker must see its own items oldest first; an idle
+ *      worker must steal from the back of a busy one; pushes
+ *      must stop at capacity without wait; and with several
+ *      producers and workers, one of them slow, every item must
+ *      be taken exactly once, with the slow worker's share
+ *      stolen by the others. Grouped pushes must stay in their
+ *      group, and a thief must look in its own group first.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "workq.h"
+
+#define TEST_PRODUCERS 3
+#define TEST_WORKERS 4
+#define TEST_ITEMS 30000
+#define TEST_BATCH 8
+
+static workq shared;
+static atomic_int seen[TEST_PRODUCERS * TEST_ITEMS + 1];
+static atomic_long taken_by[TEST_WORKERS];
+static atomic_long stolen_by[TEST_WORKERS];
+static atomic_int producers_left = TEST_PRODUCERS;
+
+static void* produce(void* arg){
+    long base = *(long*) arg;
+    void* batch[TEST_BATCH];
+    long i;
+    int n = 0;
+
+    for(i = 1; i <= TEST_ITEMS; i++){
+	batch[n++] = (void*) (uintptr_t) (base + i);
+	if(n == TEST_BATCH || i == TEST_ITEMS){
+	    if(workq_push_many(&shared, batch, n, 1) != n){
+		fprintf(stderr, "error: blocking push came back short\n");
+	    }
+	    n = 0;
+	}
+    }
+    if(atomic_fetch_sub(&producers_left, 1) == 1){
+	workq_close(&shared);
+    }
+    return NULL;
+}
+
+static void* work(void* arg){
+    int self = *(int*) arg;
+    void* out[TEST_BATCH];
+    int stolen;
+    int n, i;
+
+    while((n = workq_pop_many(&shared, self, out, TEST_BATCH, 1, &stolen)) > 0){
+	for(i = 0; i < n; i++){
+	    uintptr_t v = (uintptr_t) out[i];
+	    if(v == 0 || v > TEST_PRODUCERS * TEST_ITEMS || atomic_fetch_add(&seen[v], 1)){
+		fprintf(stderr, "error: bad or repeated item %lu\n", (unsigned long) v);
+	    }
+	}
+	atomic_fetch_add(&taken_by[self], n);
+	atomic_fetch_add(&stolen_by[self], stolen);
+	/* worker 0 is a slow resolver */
+	if(self == 0){
+	    usleep(200);
+	}
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]){
+
+    /* Void Unused Variables */
+    (void) argc;
+    (void) argv;
+
+    workq w;
+    void* in[8] = {(void*) 1, (void*) 2, (void*) 3, (void*) 4,
+		   (void*) 5, (void*) 6, (void*) 7, (void*) 8};
+    void* out[8];
+    pthread_t producers[TEST_PRODUCERS];
+    pthread_t workers[TEST_WORKERS];
+    long bases[TEST_PRODUCERS];
+    int ids[TEST_WORKERS];
+    long total = 0;
+    int stolen;
+    int n, i;
+
+    if(workq_init(&w, 0, 4) != WORKQ_FAILURE){
+	fprintf(stderr, "error: zero workers accepted\n");
+    }
+
+    /* Test a lone worker sees its items in order, and capacity holds */
+    workq_init(&w, 2, 4);
+    workq_set_active(&w, 1);
+    n = workq_push_many(&w, in, 8, 0);
+    if(n != 4){
+	fprintf(stderr, "error: pushed %d into one 4 item deque\n", n);
+    }
+    n = workq_pop_many(&w, 0, out, 2, 0, &stolen);
+    if(n != 2 || out[0] != in[0] || out[1] != in[1] || stolen != 0){
+	fprintf(stderr, "error: owner took %d, first %p\n", n, out[0]);
+    }
+
+    /* Test an idle worker steals the back half */
+    n = workq_pop_many(&w, 1, out, 8, 0, &stolen);
+    if(n != 1 || out[0] != in[3] || stolen != 1 || atomic_load(&w.steals) != 1){
+	fprintf(stderr, "error: thief took %d (%p), stolen %d\n", n, n ? out[0] : NULL, stolen);
+    }
+    n = workq_pop_many(&w, 0, out, 8, 0, &stolen);
+    if(n != 1 || out[0] != in[2]){
+	fprintf(stderr, "error: owner left with %d\n", n);
+    }
+    if(workq_pop_many(&w, 1, out, 8, 0, &stolen) != 0){
+	fprintf(stderr, "error: took from an empty queue\n");
+    }
+    workq_close(&w);
+    if(workq_pop_many(&w, 0, out, 8, 1, &stolen) != 0){
+	fprintf(stderr, "error: closed empty queue did not return 0\n");
+    }
+    workq_cleanup(&w);
+
+    /* Test group pushes stay in the group, and thieves look there first */
+    workq_init(&w, 4, 4);
+    workq_set_groups(&w, 2);
+    workq_place(&w, 1);
+    n = workq_push_group(&w, 1, in, 8, 0);
+    if(n != 8 || atomic_load(&w.deques[0].size) != 0 || atomic_load(&w.deques[2].size) != 0){
+	fprintf(stderr, "error: group push of %d reached group 0\n", n);
+    }
+    n = workq_pop_many(&w, 3, out, 8, 0, &stolen);
+    if(n != 4 || stolen != 0 || out[0] != in[4]){
+	fprintf(stderr, "error: group owner took %d, first %p\n", n, out[0]);
+    }
+    n = workq_pop_many(&w, 0, out, 8, 0, &stolen);
+    if(n != 2 || stolen != 2 || atomic_load(&w.remote_steals) != 1){
+	fprintf(stderr, "error: remote thief took %d\n", n);
+    }
+    n = workq_pop_many(&w, 3, out, 8, 0, &stolen);
+    if(n != 1 || stolen != 1 || atomic_load(&w.remote_steals) != 1){
+	fprintf(stderr, "error: local thief took %d, %ld remote\n", n, atomic_load(&w.remote_steals));
+    }
+    workq_cleanup(&w);
+
+    /* Test producers and workers at once, with a slow worker */
+    workq_init(&shared, TEST_WORKERS, 16);
+    for(i = 0; i < TEST_WORKERS; i++){
+	ids[i] = i;
+	pthread_create(&workers[i], NULL, work, &ids[i]);
+    }
+    for(i = 0; i < TEST_PRODUCERS; i++){
+	bases[i] = (long) i * TEST_ITEMS;
+	pthread_create(&producers[i], NULL, produce, &bases[i]);
+    }
+    for(i = 0; i < TEST_PRODUCERS; i++){
+	pthread_join(producers[i], NULL);
+    }
+    for(i = 0; i < TEST_WORKERS; i++){
+	pthread_join(workers[i], NULL);
+	total += atomic_load(&taken_by[i]);
+    }
+    if(total != TEST_PRODUCERS * TEST_ITEMS){
+	fprintf(stderr, "error: took %ld of %d items\n", total, TEST_PRODUCERS * TEST_ITEMS);
+    }
+    /* a quarter of the pushes land on worker 0's deque */
+    if(atomic_load(&taken_by[0]) >= total / TEST_WORKERS
+       || atomic_load(&shared.stolen) == 0){
+	fprintf(stderr, "error: slow worker took %ld of %ld, %ld stolen\n",
+		atomic_load(&taken_by[0]), total, atomic_load(&shared.stolen));
+    }
+    workq_cleanup(&shared);
+
+    return 0;
+}